@@ -0,0 +1,222 @@
+/*
+ * ADCAcquire.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#include "ADCAcquire.h"
+#include "DMAService.h"
+#include "Timebase.h"
+
+#define ADCACQUIRE_TIMER	(TIMER_A0_BASE)
+#define REFERENCE_MV		2500
+#define TEMPERATURE_30		300		// Tenths of a degree, the calibration points
+#define TEMPERATURE_85		850
+#define FACTOR_ONE			0x8000	// TLV gain and reference factors are Q15
+
+// Place of each channel in a set
+#define SUPPLY				0
+#define TEMPERATURE			1
+#define ANALOG				2
+
+#ifdef DRIVERLIB_HOST_SIM
+// Where the DMA model can reach it, see tools/sim/sim.h
+#define ADCACQUIRE_BUFFER	((uint16_t (*)[ADCACQUIRE_BLOCK]) &Sim_memory[SIM_RAM_ADC])
+#define ADCACQUIRE_ADDRESS(half)	(SIM_RAM_ADC + (half) * 2 * ADCACQUIRE_BLOCK)
+#else
+static uint16_t buffer[2][ADCACQUIRE_BLOCK];
+#define ADCACQUIRE_BUFFER	buffer
+#define ADCACQUIRE_ADDRESS(half)	((uint32_t) (uintptr_t) buffer[half])
+#endif
+
+static const uint8_t inputs[ADCACQUIRE_CHANNELS] = {
+		ADC12_A_INPUT_BATTERYMONITOR,	// (AVCC - AVSS) / 2
+		ADC12_A_INPUT_TEMPSENSOR,
+		ADC12_A_INPUT_A0 };
+
+// Data sheet typicals, 680 mV at 0 C and 2.25 mV/C, for a part without
+// the TLV records
+static const struct s_TLV_ADC_Cal_Data uncalibrated = { FACTOR_ONE, 0, 0, 0, 0,
+		0, 1225, 1427 };
+
+static const struct s_TLV_ADC_Cal_Data *adcCal = &uncalibrated;
+static uint16_t refFactor = FACTOR_ONE;
+static volatile uint8_t dmaHalf;		// Being filled
+static volatile uint8_t fullHalf;
+static volatile bool full = false;		// fullHalf is the main loop's until read
+static volatile uint32_t fullTime;
+static Scheduler_Task *blockTask = 0;
+static ADC_Reading latest;
+static bool haveLatest = false;
+
+volatile uint16_t ADCAcquire_overruns = 0;
+
+//private functions
+static void ADCAcquire_calibration() {
+	const struct s_TLV_REF_Cal_Data *refCal;
+	uint8_t length;
+	TLV_getInfo(TLV_TAG_ADC12CAL, 0, &length, (uint16_t **) &adcCal);
+	if (length == 0 || adcCal->adc_ref25_85_temp <= adcCal->adc_ref25_30_temp)
+		adcCal = &uncalibrated;
+	TLV_getInfo(TLV_TAG_REFCAL, 0, &length, (uint16_t **) &refCal);
+	refFactor = length ? refCal->ref_ref25 : FACTOR_ONE;
+}
+
+// The reference, then the ADC gain and offset, as SLAU208 applies them
+static uint16_t ADCAcquire_correct(uint16_t raw) {
+	int32_t code = (int32_t) (((uint32_t) raw * refFactor) >> 15);
+	code = (int32_t) (((uint32_t) code * adcCal->adc_gain_factor) >> 15)
+			+ adcCal->adc_offset;
+	if (code < 0)
+		return 0;
+	return (code > 4095) ? 4095 : (uint16_t) code;
+}
+
+static uint16_t ADCAcquire_millivolts(uint16_t code) {
+	return (uint16_t) (((uint32_t) code * REFERENCE_MV + 2048) >> 12);
+}
+
+// Straight line through the codes read at 30 C and 85 C
+static int16_t ADCAcquire_temperature(uint16_t raw) {
+	int32_t span = (int32_t) adcCal->adc_ref25_85_temp - adcCal->adc_ref25_30_temp;
+	return (int16_t) (((int32_t) raw - adcCal->adc_ref25_30_temp)
+			* (TEMPERATURE_85 - TEMPERATURE_30) / span + TEMPERATURE_30);
+}
+
+// DMA completion: a block is in dmaHalf
+static bool ADCAcquire_blockDone() {
+	bool handed = !full;
+	if (handed) {
+		fullHalf = dmaHalf;
+		fullTime = Timebase_now();
+		full = true;
+		dmaHalf ^= 1;
+	} else {
+		ADCAcquire_overruns++;	// Main loop still has the other half, refill this
+	}
+	DMA_setDstAddress(DMASERVICE_ADC_CHANNEL, ADCACQUIRE_ADDRESS(dmaHalf),
+			DMA_DIRECTION_INCREMENT);
+	DMA_enableTransfers(DMASERVICE_ADC_CHANNEL);
+	if (handed && blockTask)
+		Scheduler_post(blockTask);
+	return handed;
+}
+
+//public functions
+/** Start sampling.  TA0, the reference and DMASERVICE_ADC_CHANNEL are this
+ * module's until ADCAcquire_stop().
+ */
+void ADCAcquire_start() {
+	ADC12_A_configureMemoryParam memory = { 0 };
+	DMA_initializeParam dma = { 0 };
+	TIMER_A_outputPWMParam pwm = { 0 };
+	uint8_t i;
+
+	ADCAcquire_calibration();
+	GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P6, GPIO_PIN0);
+	REF_setReferenceVoltage(REF_BASE, REF_VREF2_5V);
+	REF_enableReferenceVoltage(REF_BASE);
+	REF_enableTempSensor(REF_BASE);
+
+	ADC12_A_init(ADC12_A_BASE, ADC12_A_SAMPLEHOLDSOURCE_1,
+			ADC12_A_CLOCKSOURCE_ADC12OSC, ADC12_A_CLOCKDIVIDER_1);
+	ADC12_A_enable(ADC12_A_BASE);
+	// About 50 us on ADC12OSC; the temperature sensor needs 30
+	ADC12_A_setupSamplingTimer(ADC12_A_BASE, ADC12_A_CYCLEHOLD_256_CYCLES,
+			ADC12_A_CYCLEHOLD_256_CYCLES, ADC12_A_MULTIPLESAMPLESDISABLE);
+	memory.positiveRefVoltageSourceSelect = ADC12_A_VREFPOS_INT;
+	memory.negativeRefVoltageSourceSelect = ADC12_A_VREFNEG_AVSS;
+	for (i = 0; i < ADCACQUIRE_BLOCK; i++) {
+		memory.memoryBufferControlIndex = i;
+		memory.inputSourceSelect = inputs[i % ADCACQUIRE_CHANNELS];
+		memory.endOfSequence = (i == ADCACQUIRE_BLOCK - 1) ? ADC12_A_ENDOFSEQUENCE
+				: ADC12_A_NOTENDOFSEQUENCE;
+		ADC12_A_configureMemory(ADC12_A_BASE, &memory);
+	}
+
+	// A block transfer, re-armed on the other half by each completion
+	dma.channelSelect = DMASERVICE_ADC_CHANNEL;
+	dma.transferModeSelect = DMA_TRANSFER_BLOCK;
+	dma.transferSize = ADCACQUIRE_BLOCK;
+	dma.triggerSourceSelect = DMASERVICE_TRIGGER_ADC12IFG;
+	dma.transferUnitSelect = DMA_SIZE_SRCWORD_DSTWORD;
+	dma.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+	DMA_initialize(&dma);
+	DMA_setSrcAddress(DMASERVICE_ADC_CHANNEL,
+			ADC12_A_getMemoryAddressForDMA(ADC12_A_BASE, ADC12_A_MEMORY_0),
+			DMA_DIRECTION_INCREMENT);
+	dmaHalf = 0;
+	full = false;
+	haveLatest = false;
+	ADCAcquire_overruns = 0;
+	DMA_setDstAddress(DMASERVICE_ADC_CHANNEL, ADCACQUIRE_ADDRESS(0),
+			DMA_DIRECTION_INCREMENT);
+	DMAService_setHandler(DMASERVICE_ADC_CHANNEL, ADCAcquire_blockDone);
+	DMA_enableInterrupt(DMASERVICE_ADC_CHANNEL);
+	DMA_enableTransfers(DMASERVICE_ADC_CHANNEL);
+
+	// Waits for the first edge of TA0.1
+	ADC12_A_startConversion(ADC12_A_BASE, ADC12_A_MEMORY_0,
+			ADC12_A_REPEATED_SEQOFCHANNELS);
+	pwm.clockSource = TIMER_A_CLOCKSOURCE_ACLK;
+	pwm.clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+	pwm.timerPeriod = ADCACQUIRE_CONVERSION_TICKS - 1;
+	pwm.compareRegister = TIMER_A_CAPTURECOMPARE_REGISTER_1;
+	pwm.compareOutputMode = TIMER_A_OUTPUTMODE_RESET_SET;
+	pwm.dutyCycle = ADCACQUIRE_CONVERSION_TICKS / 2;
+	TIMER_A_outputPWM(ADCACQUIRE_TIMER, &pwm);
+}
+
+void ADCAcquire_stop() {
+	TIMER_A_stop(ADCACQUIRE_TIMER);
+	ADC12_A_disableConversions(ADC12_A_BASE, ADC12_A_PREEMPTCONVERSION);
+	ADC12_A_disable(ADC12_A_BASE);
+	DMA_disableTransfers(DMASERVICE_ADC_CHANNEL);
+	DMA_disableInterrupt(DMASERVICE_ADC_CHANNEL);
+	REF_disableTempSensor(REF_BASE);
+	REF_disableReferenceVoltage(REF_BASE);
+}
+
+/** Take the oldest complete block, corrected, a set per reading.
+ * @return false if there's no block waiting
+ */
+bool ADCAcquire_read(ADC_Reading readings[ADCACQUIRE_SETS]) {
+	const uint16_t *raw;
+	uint32_t time;
+	uint8_t i;
+	if (!full)
+		return false;
+	raw = ADCACQUIRE_BUFFER[fullHalf];
+	time = fullTime - (ADCACQUIRE_SETS - 1) * ADCACQUIRE_SET_TICKS;
+	for (i = 0; i < ADCACQUIRE_SETS; i++) {
+		readings[i].timestamp = time;
+		readings[i].supply = 2 * ADCAcquire_millivolts(ADCAcquire_correct(raw[SUPPLY]));
+		readings[i].temperature = ADCAcquire_temperature(raw[TEMPERATURE]);
+		readings[i].analog = ADCAcquire_millivolts(ADCAcquire_correct(raw[ANALOG]));
+		raw += ADCACQUIRE_CHANNELS;
+		time += ADCACQUIRE_SET_TICKS;
+	}
+	latest = readings[ADCACQUIRE_SETS - 1];
+	haveLatest = true;
+	full = false;		// Hands the half back to the DMA
+	return true;
+}
+
+/** The last set ADCAcquire_read() took.
+ * @return false if it hasn't taken one yet
+ */
+bool ADCAcquire_latest(ADC_Reading *reading) {
+	if (!haveLatest)
+		return false;
+	*reading = latest;
+	return true;
+}
+
+/** Post a scheduler task whenever a block is complete.
+ * @param task Task to post, or 0 for none
+ */
+void ADCAcquire_notify(Scheduler_Task *task) {
+	blockTask = task;
+}
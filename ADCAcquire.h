@@ -0,0 +1,57 @@
+/*
+ * ADCAcquire.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Background sampling of the supply voltage, the die temperature and A0
+ * (P6.0) on ADC12_A, for temperature compensation and power monitoring
+ * alongside the magnetometer.  The CPU does nothing per conversion:
+ *   - TA0 counts ACLK in up mode with output 1 in reset/set, so the output
+ *     rises every ADCACQUIRE_CONVERSION_TICKS; each rising edge is a
+ *     sample-and-hold trigger for the next conversion of a repeated
+ *     sequence of supply, temperature, A0 through ADC12MEM0-14, five sets;
+ *   - the end of the sequence triggers DMASERVICE_ADC_CHANNEL, which block
+ *     transfers ADC12MEM0-14 into one half of a double buffer;
+ *   - the DMA interrupt hands that half to the main loop, points the
+ *     channel at the other half and posts the notify task, so the CPU is
+ *     woken once per block, every half second.
+ * All three channels convert against the 2.5 V reference, which stays on
+ * while sampling runs; the ADC12 oscillator only runs for each conversion,
+ * and both keep going in LPM3.
+ *
+ * A block the main loop hasn't taken by the time the next is complete is
+ * kept and the newer one dropped, counted in ADCAcquire_overruns, so the
+ * DMA never writes the half being read.  Readings are corrected with the
+ * TLV calibration as ADCAcquire_read() takes them.
+ */
+
+#ifndef ADCACQUIRE_H_
+#define ADCACQUIRE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Scheduler.h"
+
+#define ADCACQUIRE_CHANNELS			3		// Supply, temperature, A0
+#define ADCACQUIRE_SETS				5		// Per block
+#define ADCACQUIRE_BLOCK			(ADCACQUIRE_CHANNELS * ADCACQUIRE_SETS)	// ADC12MEMx used, of 16
+#define ADCACQUIRE_CONVERSION_TICKS	1092	// ACLK, a set every 100 ms
+#define ADCACQUIRE_SET_TICKS		(ADCACQUIRE_CHANNELS * ADCACQUIRE_CONVERSION_TICKS)
+
+typedef struct ADC_Reading {
+	uint32_t timestamp;		// Timebase ticks at the set's last conversion
+	uint16_t supply;		// AVCC, mV
+	int16_t temperature;	// Tenths of a degree C
+	uint16_t analog;		// A0, mV
+} ADC_Reading;
+
+void ADCAcquire_start();
+void ADCAcquire_stop();
+bool ADCAcquire_read(ADC_Reading readings[ADCACQUIRE_SETS]);
+bool ADCAcquire_latest(ADC_Reading *reading);
+void ADCAcquire_notify(Scheduler_Task *task);
+
+extern volatile uint16_t ADCAcquire_overruns;	// Blocks dropped, main loop behind
+
+#endif /* ADCACQUIRE_H_ */
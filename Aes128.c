@@ -0,0 +1,150 @@
+/*
+ * Aes128.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#if defined(__MSP430__) || defined(DRIVERLIB_HOST_SIM)
+#include <driverlib.h>
+#endif
+#include "Aes128.h"
+
+#ifdef __MSP430_HAS_AES__
+#define AES128_MODULE
+#endif
+
+#ifdef AES128_MODULE
+static const Aes128_Key *loaded = 0;	// Whose key the module holds
+#else
+static const uint8_t sbox[256] = { 0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F,
+		0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76, 0xCA, 0x82, 0xC9,
+		0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72,
+		0xC0, 0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5,
+		0xF1, 0x71, 0xD8, 0x31, 0x15, 0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05,
+		0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75, 0x09, 0x83, 0x2C,
+		0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F,
+		0x84, 0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE,
+		0x39, 0x4A, 0x4C, 0x58, 0xCF, 0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33,
+		0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8, 0x51, 0xA3, 0x40,
+		0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3,
+		0xD2, 0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E,
+		0x3D, 0x64, 0x5D, 0x19, 0x73, 0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90,
+		0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB, 0xE0, 0x32, 0x3A,
+		0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4,
+		0x79, 0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4,
+		0xEA, 0x65, 0x7A, 0xAE, 0x08, 0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4,
+		0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A, 0x70, 0x3E, 0xB5,
+		0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D,
+		0x9E, 0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87,
+		0xE9, 0xCE, 0x55, 0x28, 0xDF, 0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42,
+		0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16 };
+// ShiftRows as a gather: state byte i comes from byte shift[i].  Bytes are
+// in column order, four to a column.
+static const uint8_t shift[16] = { 0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12,
+		1, 6, 11 };
+static uint8_t pending[AES128_BLOCK_SIZE];	// Started and not yet finished
+#endif
+
+//private functions
+#ifndef AES128_MODULE
+// Multiply by x in GF(2^8)
+static uint8_t Aes128_xtime(uint8_t value) {
+	return (uint8_t) ((value << 1) ^ ((value & 0x80) ? 0x1B : 0));
+}
+
+static void Aes128_mixColumns(uint8_t s[AES128_BLOCK_SIZE]) {
+	uint8_t c, a0, all;
+	for (c = 0; c < AES128_BLOCK_SIZE; c += 4) {
+		a0 = s[c];
+		all = s[c] ^ s[c + 1] ^ s[c + 2] ^ s[c + 3];
+		s[c] ^= all ^ Aes128_xtime(s[c] ^ s[c + 1]);
+		s[c + 1] ^= all ^ Aes128_xtime(s[c + 1] ^ s[c + 2]);
+		s[c + 2] ^= all ^ Aes128_xtime(s[c + 2] ^ s[c + 3]);
+		s[c + 3] ^= all ^ Aes128_xtime(s[c + 3] ^ a0);
+	}
+}
+
+static void Aes128_cipher(const uint8_t *schedule, const uint8_t in[AES128_BLOCK_SIZE],
+		uint8_t out[AES128_BLOCK_SIZE]) {
+	uint8_t s[AES128_BLOCK_SIZE], t[AES128_BLOCK_SIZE];
+	uint8_t round, i;
+	for (i = 0; i < AES128_BLOCK_SIZE; i++)
+		s[i] = in[i] ^ schedule[i];
+	for (round = 1; round <= 10; round++) {
+		schedule += AES128_BLOCK_SIZE;
+		for (i = 0; i < AES128_BLOCK_SIZE; i++)
+			t[i] = sbox[s[shift[i]]];	// SubBytes and ShiftRows
+		if (round != 10)
+			Aes128_mixColumns(t);
+		for (i = 0; i < AES128_BLOCK_SIZE; i++)
+			s[i] = t[i] ^ schedule[i];
+	}
+	for (i = 0; i < AES128_BLOCK_SIZE; i++)
+		out[i] = s[i];
+}
+#endif
+
+//public functions
+/** Prepare a key for use.  k may be set again, but not while a block is in
+ * progress with it.
+ */
+void Aes128_setKey(Aes128_Key *k, const uint8_t key[AES128_KEY_SIZE]) {
+	uint8_t i;
+#ifdef AES128_MODULE
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		k->schedule[i] = key[i];
+	if (loaded == k)
+		loaded = 0;			// Load the new contents on next use
+#else
+	uint8_t *w = k->schedule;
+	uint8_t t[4], rcon = 1, j;
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		w[i] = key[i];
+	for (; i < AES128_SCHEDULE_SIZE; i += 4) {
+		for (j = 0; j < 4; j++)
+			t[j] = w[i - 4 + j];
+		if (i % AES128_KEY_SIZE == 0) {		// RotWord, SubWord, Rcon
+			j = t[0];
+			t[0] = sbox[t[1]] ^ rcon;
+			t[1] = sbox[t[2]];
+			t[2] = sbox[t[3]];
+			t[3] = sbox[j];
+			rcon = Aes128_xtime(rcon);
+		}
+		for (j = 0; j < 4; j++)
+			w[i + j] = w[i - AES128_KEY_SIZE + j] ^ t[j];
+	}
+#endif
+}
+
+/** Begin encrypting one block; in may be reused once this returns. */
+void Aes128_start(const Aes128_Key *k, const uint8_t in[AES128_BLOCK_SIZE]) {
+#ifdef AES128_MODULE
+	if (loaded != k) {
+		AES_setCipherKey(AES_BASE, k->schedule);
+		loaded = k;
+	}
+	AES_startEncryptData(AES_BASE, in, 0);	// Output is read by Aes128_finish()
+#else
+	Aes128_cipher(k->schedule, in, pending);
+#endif
+}
+
+/** Wait for the block Aes128_start() began, and copy it out. */
+void Aes128_finish(uint8_t out[AES128_BLOCK_SIZE]) {
+#ifdef AES128_MODULE
+	while (AES_getDataOut(AES_BASE, out) != STATUS_SUCCESS)
+		;
+#else
+	uint8_t i;
+	for (i = 0; i < AES128_BLOCK_SIZE; i++)
+		out[i] = pending[i];
+#endif
+}
+
+/** One block, start to finish.  out may be in. */
+void Aes128_encrypt(const Aes128_Key *k, const uint8_t in[AES128_BLOCK_SIZE],
+		uint8_t out[AES128_BLOCK_SIZE]) {
+	Aes128_start(k, in);
+	Aes128_finish(out);
+}
@@ -0,0 +1,40 @@
+/*
+ * Aes128.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * AES-128 block encryption (FIPS-197), the forward cipher only: CTR and
+ * CBC-MAC, all Ccm needs, never run it backwards.
+ *
+ * Parts with the AES module (__MSP430_HAS_AES__) use it through aes.c,
+ * loading the key when a different Aes128_Key is used than last time.  The
+ * F5529 has none, and neither does the host, so there the same calls run a
+ * byte oriented software AES over a key schedule expanded once by
+ * Aes128_setKey(), which is most of the 176 bytes of an Aes128_Key.
+ *
+ * Aes128_start() and Aes128_finish() split a block so the CPU can do other
+ * work while the module runs; in software start does the whole block.  One
+ * block may be in progress at a time, and neither path is for ISRs.
+ */
+
+#ifndef AES128_H_
+#define AES128_H_
+
+#include <stdint.h>
+
+#define AES128_BLOCK_SIZE		16
+#define AES128_KEY_SIZE			16
+#define AES128_SCHEDULE_SIZE	176		// 11 round keys
+
+typedef struct Aes128_Key {
+	uint8_t schedule[AES128_SCHEDULE_SIZE];	// Just the key with the module
+} Aes128_Key;
+
+void Aes128_setKey(Aes128_Key *k, const uint8_t key[AES128_KEY_SIZE]);
+void Aes128_start(const Aes128_Key *k, const uint8_t in[AES128_BLOCK_SIZE]);
+void Aes128_finish(uint8_t out[AES128_BLOCK_SIZE]);
+void Aes128_encrypt(const Aes128_Key *k, const uint8_t in[AES128_BLOCK_SIZE],
+		uint8_t out[AES128_BLOCK_SIZE]);
+
+#endif /* AES128_H_ */
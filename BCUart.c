@@ -31,95 +31,343 @@
  * --/COPYRIGHT--*/
  
 #include "msp430.h"
+#include <driverlib.h>
+#include <string.h>
 #include "BCUart.h"
+#include "DMAService.h"
+#include "Trace.h"
 
-// Receive buffer for the UART.  Incoming bytes need a place to go immediately,
+#define BC_TXBUF_MASK  (BC_TXBUF_SIZE - 1)
+
+#define BC_RXBUF_MASK  (BC_RXBUF_SIZE - 1)
+
+// Receive ring for the UART.  Incoming bytes need a place to go immediately,
 // otherwise there might be an overrun when the next comes in.  The USCI ISR
-// puts them here.
+// puts them here.  Only the ISR moves the head and only main() moves the
+// tail; both are single word writes, so neither side has to lock the other
+// out.
 uint8_t  bcUartRcvBuf[BC_RXBUF_SIZE];
 
-// The index within bcUartRcvBuf, where the next byte will be written.
-uint16_t bcUartRcvBufIndex = 0;
+// Where the ISR writes the next byte, free running like the TX indices
+volatile uint16_t bcUartRcvBufIndex = 0;
 
-// Boolean flag indicating whether bcUartRcvBufIndex has reached the
+// The next byte main() will read
+volatile uint16_t bcUartRcvBufTail = 0;
+
+// Boolean flag indicating whether the unread count has reached the
 // threshold BC_RX_WAKE_THRESH.  0 = FALSE, 1 = TRUE
 uint8_t  bcUartRxThreshReached = 0;
 
+volatile uint16_t bcUartRxOverruns = 0;
+
+// Transmit ring.  The indices run freely and are masked on use, so
+// head - next is the number of queued bytes even after they wrap.
+#ifdef DRIVERLIB_HOST_SIM
+// Where the DMA model can reach it, see tools/sim/sim.h
+#define bcUartXmtBuf  (&Sim_memory[SIM_RAM_UART_TX])
+#define BC_TXBUF_ADDRESS(offset)  ((uint32_t)(SIM_RAM_UART_TX + (offset)))
+#else
+static uint8_t  bcUartXmtBuf[BC_TXBUF_SIZE];
+#define BC_TXBUF_ADDRESS(offset)  ((uint32_t)(uintptr_t)&bcUartXmtBuf[offset])
+#endif
+static volatile uint16_t bcUartXmtHead = 0;      // Where bcUartSend() writes next
+static volatile uint16_t bcUartXmtNext = 0;      // First byte not yet given to the DMA
+static volatile uint16_t bcUartXmtInFlight = 0;  // Bytes in the running DMA block
+static volatile uint8_t  bcUartXmtWaiting = 0;   // main() is asleep on TX progress
+static uint8_t  bcUartXmtPolicy = BC_TX_POLICY;
+
+volatile uint16_t bcUartTxDropped = 0;
+
+
+// Hands the next contiguous run of the ring to the DMA, if it is idle.
+// Call with interrupts disabled, or from the DMA ISR.
+static void bcUartXmtStart(void)
+{
+    uint16_t offset = bcUartXmtNext & BC_TXBUF_MASK;
+    uint16_t count = bcUartXmtHead - bcUartXmtNext;
+
+    if (bcUartXmtInFlight || count == 0)
+        return;
+    if (count > BC_TXBUF_SIZE - offset)
+        count = BC_TXBUF_SIZE - offset;     // Stop at the end of the ring
+
+    DMA_setSrcAddress(DMASERVICE_UART_TX_CHANNEL,
+            BC_TXBUF_ADDRESS(offset), DMA_DIRECTION_INCREMENT);
+    DMA_setTransferSize(DMASERVICE_UART_TX_CHANNEL, count);
+    DMA_enableTransfers(DMASERVICE_UART_TX_CHANNEL);
+    bcUartXmtNext += count;
+    bcUartXmtInFlight = count;
+
+    // The DMA triggers on a rising TXIFG.  If TXBUF is already empty the flag
+    // is sitting high, so make the edge by hand.  Otherwise the USCI makes it
+    // when the byte now in TXBUF moves into the shift register.
+    if (UCA1IFG & UCTXIFG)
+    {
+        UCA1IFG &= ~UCTXIFG;
+        UCA1IFG |= UCTXIFG;
+    }
+}
+
+
+// DMA completion handler: the last byte of the block is in TXBUF.
+static bool bcUartXmtComplete(void)
+{
+    TRACE(TRACE_UART_TX_DONE);
+    bcUartXmtInFlight = 0;
+    bcUartXmtStart();
+    return bcUartXmtWaiting;
+}
+
+
+// Sleeps in LPM0 until the DMA finishes a block (or something else wakes
+// main).  Call with interrupts disabled; returns with them disabled.
+static void bcUartXmtSleep(void)
+{
+    bcUartXmtWaiting = 1;
+    __bis_SR_register(LPM0_bits + GIE);
+    __disable_interrupt();
+    bcUartXmtWaiting = 0;
+}
+
 
 // Initializes the USCI_A1 module as a UART, using baudrate settings in
 // bcUart.h.  The baudrate is dependent on SMCLK speed.
 void bcUartInit(void)
 {
+    DMA_initializeParam dma = { 0 };
+    BaudRate_Setting baud;
+
+    bcUartRcvBufIndex = 0;
+    bcUartRcvBufTail = 0;
+    bcUartRxOverruns = 0;
+    bcUartXmtHead = 0;
+    bcUartXmtNext = 0;
+    bcUartXmtInFlight = 0;
+    bcUartTxDropped = 0;
+
     // Always use the step-by-step init procedure listed in the USCI chapter of
     // the F5xx Family User's Guide
     UCA1CTL1 |= UCSWRST;        // Put the USCI state machine in reset
     UCA1CTL1 |= UCSSEL__SMCLK;  // Use SMCLK as the bit clock
 
     // Set the baudrate
-    UCA1BR0 = UCA1_BR0;
-    UCA1BR1 = UCA1_BR1;
-    UCA1MCTL = (UCA1_BRF << 4) | (UCA1_BRS << 1) | (UCA1_OS);
+    BaudRate_solve(UCS_getSMCLK(), BC_DEFAULT_BAUDRATE, &baud);
+    UCA1BRW = baud.ucbr;
+    UCA1MCTL = BaudRate_mctl(&baud);
 
     P4SEL |= BIT4+BIT5;         // Configure these pins as TXD/RXD
 
     UCA1CTL1 &= ~UCSWRST;       // Take the USCI out of reset
     UCA1IE |= UCRXIE;           // Enable the RX interrupt.  Now, when bytes are
                                 // rcv'ed, the USCI_A1 vector will be generated.
+
+    // Transmit goes through the DMA, one transfer per TXIFG, so there is no
+    // TX interrupt.
+    dma.channelSelect = DMASERVICE_UART_TX_CHANNEL;
+    dma.transferModeSelect = DMA_TRANSFER_SINGLE;
+    dma.triggerSourceSelect = DMASERVICE_TRIGGER_UCA1TXIFG;
+    dma.transferUnitSelect = DMA_SIZE_SRCBYTE_DSTBYTE;
+    dma.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+    DMA_initialize(&dma);
+    DMA_setDstAddress(DMASERVICE_UART_TX_CHANNEL,
+            USCI_A_UART_getTransmitBufferAddressForDMA(USCI_A1_BASE),
+            DMA_DIRECTION_UNCHANGED);
+    DMAService_setHandler(DMASERVICE_UART_TX_CHANNEL, bcUartXmtComplete);
+    DMA_enableInterrupt(DMASERVICE_UART_TX_CHANNEL);
 }
 
 
-// Sends 'len' bytes, starting at 'buf'
+// Switches to 'baudrate' once everything already queued has gone out at the
+// old rate.  The divisors come from SMCLK as it is now.  If 'setting' isn't
+// 0 it receives the divisors and their error.  Returns STATUS_FAIL, leaving
+// the rate alone, if SMCLK can't make the rate within BAUDRATE_MAX_ERROR.
+bool bcUartSetBaudRate(uint32_t baudrate, BaudRate_Setting* setting)
+{
+    BaudRate_Setting baud;
+
+    if (!BaudRate_solve(UCS_getSMCLK(), baudrate, &baud))
+        return STATUS_FAIL;
+    if (setting)
+        *setting = baud;
+
+    bcUartFlush();
+    UCA1CTL1 |= UCSWRST;
+    UCA1BRW = baud.ucbr;
+    UCA1MCTL = BaudRate_mctl(&baud);
+    UCA1CTL1 &= ~UCSWRST;
+    UCA1IE |= UCRXIE;           // Releasing UCSWRST cleared it
+    return STATUS_SUCCESS;
+}
+
+
+// Queues 'len' bytes, starting at 'buf', and returns as soon as they are in
+// the ring; the DMA sends them in the background.  When the ring is full the
+// TX policy decides what gives.  Only one caller may be sending at a time.
+// From an ISR, or with interrupts off, a message that would have to wait is
+// dropped instead, whatever the policy.
 void bcUartSend(uint8_t * buf, uint8_t len)
 {
-    uint8_t i = 0;
+    uint16_t sr, space, queued, offset, count;
 
-    // Write each byte in buf to USCI TX buffer, which sends it out
-    while (i < len)
+    sr = __get_SR_register();
+    __disable_interrupt();
+    while (len)
     {
-        UCA1TXBUF = *(buf+(i++));
+        space = BC_TXBUF_SIZE - (bcUartXmtHead - bcUartXmtNext) - bcUartXmtInFlight;
+        if (space < len && bcUartXmtPolicy == BC_TX_DROP)
+        {
+            bcUartTxDropped += len;
+            break;
+        }
+        if (space < len && bcUartXmtPolicy == BC_TX_OVERWRITE)
+        {
+            // Make room out of the oldest bytes the DMA hasn't started on
+            queued = bcUartXmtHead - bcUartXmtNext;
+            count = len - space;
+            if (count > queued)
+                count = queued;
+            bcUartXmtNext += count;
+            bcUartTxDropped += count;
+            space += count;
+        }
+        if (space == 0)
+        {
+            if (!(sr & GIE))
+            {
+                bcUartTxDropped += len;     // Can't sleep here
+                break;
+            }
+            bcUartXmtSleep();
+            continue;
+        }
 
-        // Wait until each bit has been clocked out...
-        while(!(UCTXIFG==(UCTXIFG & UCA1IFG))&&((UCA1STAT & UCBUSY)==UCBUSY));
+        // Nothing but this function writes past head, so copy with
+        // interrupts back on.
+        offset = bcUartXmtHead & BC_TXBUF_MASK;
+        count = (len < space) ? len : space;
+        if (count > BC_TXBUF_SIZE - offset)
+            count = BC_TXBUF_SIZE - offset;
+        __bis_SR_register(sr & GIE);
+        memcpy(&bcUartXmtBuf[offset], buf, count);
+        __disable_interrupt();
+        bcUartXmtHead += count;
+        buf += count;
+        len -= count;
+        bcUartXmtStart();
     }
+    __bis_SR_register(sr & GIE);
+}
+
+
+// Selects BC_TX_DROP, BC_TX_BLOCK or BC_TX_OVERWRITE for later sends.
+void bcUartSetTxPolicy(uint8_t policy)
+{
+    bcUartXmtPolicy = policy;
+}
+
+
+// Returns the number of bytes queued or in flight that have not yet been
+// written to TXBUF.
+uint16_t bcUartTxPending(void)
+{
+    uint16_t sr, pending;
+
+    sr = __get_SR_register();
+    __disable_interrupt();
+    pending = (bcUartXmtHead - bcUartXmtNext) + bcUartXmtInFlight;
+    __bis_SR_register(sr & GIE);
+    return pending;
+}
+
+
+// Sleeps until everything queued has left the UART, e.g. before entering
+// LPM3 or reconfiguring the baud rate.
+void bcUartFlush(void)
+{
+    __disable_interrupt();
+    while (bcUartXmtInFlight)
+        bcUartXmtSleep();
+    __enable_interrupt();
+
+    // The last byte may still be in TXBUF or the shift register
+    while (UCA1STAT & UCBUSY);
 }
 
 
 // Copies into 'buf' whatever bytes have been received on the UART since the
-// last fetch.  Returns the number of bytes copied.
+// last fetch.  'buf' must hold BC_RXBUF_SIZE bytes.  Returns the number of
+// bytes copied.
 uint16_t bcUartReceiveBytesInBuffer(uint8_t* buf)
 {
-    uint16_t i, count;
+    uint8_t* data;
+    uint16_t n, count = 0;
 
-    // Hold off ints for incoming data during the copy
-    UCA1IE &= ~UCRXIE;
-
-    for(i=0; i<bcUartRcvBufIndex; i++)
+    // Usually two runs at most, either side of the end of the ring.  Bytes
+    // that arrive meanwhile are taken too, up to the size of 'buf'.
+    while (count < BC_RXBUF_SIZE && (n = bcUartRxPeek(&data)) != 0)
     {
-        buf[i] = bcUartRcvBuf[i];
+        if (n > BC_RXBUF_SIZE - count)
+            n = BC_RXBUF_SIZE - count;
+        memcpy(buf + count, data, n);
+        count += n;
+        bcUartRxConsume(n);
     }
+    return count;
+}
+
 
-    count = bcUartRcvBufIndex;
-    bcUartRcvBufIndex = 0;     // Move index back to the beginning of the buffer
-    bcUartRxThreshReached = 0;
+// Returns the number of received bytes not yet consumed.
+uint16_t bcUartRxAvailable(void)
+{
+    return bcUartRcvBufIndex - bcUartRcvBufTail;
+}
 
-    // Restore USCI interrupts, to resume receiving data.
-    UCA1IE |= UCRXIE;
 
+// Points 'data' at the oldest unread byte, in place in the ring, and returns
+// how many unread bytes follow it before the ring wraps.  Nothing is removed
+// until bcUartRxConsume().
+uint16_t bcUartRxPeek(uint8_t** data)
+{
+    uint16_t tail = bcUartRcvBufTail;
+    uint16_t count = bcUartRcvBufIndex - tail;
+    uint16_t offset = tail & BC_RXBUF_MASK;
+
+    if (count > BC_RXBUF_SIZE - offset)
+        count = BC_RXBUF_SIZE - offset;
+    *data = &bcUartRcvBuf[offset];
     return count;
 }
 
 
+// Releases 'count' bytes from the front of the ring back to the ISR.
+void bcUartRxConsume(uint16_t count)
+{
+    bcUartRcvBufTail += count;
+    if (bcUartRcvBufIndex - bcUartRcvBufTail < BC_RX_WAKE_THRESH)
+        bcUartRxThreshReached = 0;
+}
+
+
 
 // The USCI_A1 receive interrupt service routine (ISR).  Executes every time a
 // byte is received on the back-channel UART.
 #pragma vector=USCI_A1_VECTOR
 __interrupt void bcUartISR(void)
 {
-    bcUartRcvBuf[bcUartRcvBufIndex++] = UCA1RXBUF;  // Fetch the byte, store
-                                                    // it in the buffer.
+    uint8_t data = UCA1RXBUF;       // Fetch the byte; this also clears RXIFG
+    uint16_t head = bcUartRcvBufIndex;
+
+    TRACE(TRACE_UART_RX);
+    if ((uint16_t)(head - bcUartRcvBufTail) >= BC_RXBUF_SIZE)
+    {
+        bcUartRxOverruns++;         // Full; drop it rather than overwrite
+        return;
+    }
+    bcUartRcvBuf[head & BC_RXBUF_MASK] = data;     // Store it in the ring
+    bcUartRcvBufIndex = ++head;
 
     // Wake main, to fetch data from the buffer.
-    if(bcUartRcvBufIndex >= BC_RX_WAKE_THRESH)
+    if((uint16_t)(head - bcUartRcvBufTail) >= BC_RX_WAKE_THRESH)
     {
         bcUartRxThreshReached = 1;
         __bic_SR_register_on_exit(LPM3_bits);       // Exit LPM0-3
@@ -40,35 +40,22 @@
 #define BCUART_H_
 
 #include "stdint.h"
+#include "BaudRate.h"
 
 
 /*****************************************************************************
  *** SET THESE CONSTANTS, TO CONFIGURE THE BACKCHANNEL UART LIBRARY **********
 
-1) Set the SMCLK speed and desired baudrate.
+1) Set the default baudrate.
 
    The baudrate is determined by the UCA1BR0, UCA1BR1, and UCA1MCTL registers.
-   UCA1MCTL has three relevant fields:  UCA1BRF, UCA1BRS, and UCOS16.  The
-   settings below are for:
-   SMCLK = 8MHz
-   baudrate = 28.8kbps
+   Their values are no longer fixed here: BaudRate_solve() works them out at
+   run time from UCS_getSMCLK() and the requested rate, the same way as the
+   tables in the USCI chapter of the F5xx Family User's Guide, so they follow
+   any change to the clock setup.  bcUartSetBaudRate() switches rates later;
+   call it again after changing SMCLK.  */
 
-   If you change the SMCLK speed, or want a different baudrate, you need to
-   change these values.  An easy way to determine them is the calculator at
-   the MSP430 wiki page:
-
-http://processors.wiki.ti.com/index.php/USCI_UART_Baud_Rate_Gen_Mode_Selection
-
-   (If the link is somehow broken, the wiki page name is "USCI UART Baud Rate
-   Gen Mode Selection", or try web-searching "msp430 usci calculator".
-   Ultimately, the final reference is the UCS chapter of the F5xx Family User's
-   Guide.) */
-
-#define UCA1_OS   1    // 1 = oversampling mode, 0 = low-freq mode
-#define UCA1_BR0  17   // Value of UCA1BR0 register
-#define UCA1_BR1  0    // Value of UCA1BR1 register
-#define UCA1_BRS  0    // Value of UCBRS field in UCA1MCTL register
-#define UCA1_BRF  6    // Value of UCBRF field in UCA1MCTL register
+#define BC_DEFAULT_BAUDRATE  (57600)
 
 
 // There is no hardware RTS/CTS handshaking in this example.  Your code must
@@ -81,20 +68,53 @@ http://processors.wiki.ti.com/index.php/USCI_UART_Baud_Rate_Gen_Mode_Selection
 
 The size of the UART receive buffer.  Set smaller if RAM is in short supply.
 Set larger if larger data chunks are to be received, or if the application
-can't process incoming data very often   */
+can't process incoming data very often.  Must be a power of two: the buffer
+is a ring the ISR fills and main() drains without disabling interrupts.  */
 #define BC_RXBUF_SIZE  (128)
 
-/* The threshold within bcUartRcvBuf at which main() will be awakened.  Must
-be less than BC_RXBUF_SIZE.  A value of '1' will alert main() whenever
+/* The number of unread bytes in bcUartRcvBuf at which main() will be
+awakened.  Must be less than BC_RXBUF_SIZE.  A value of '1' will alert main() whenever
 even a single byte is received.  If no wake is desired, set to
 BC_RXBUF_SIZE+1     */
 #define BC_RX_WAKE_THRESH  (1)
 
+/* The size of the UART transmit ring.  bcUartSend() copies into it and
+returns; DMA channel DMASERVICE_UART_TX_CHANNEL drains it into UCA1TXBUF.
+Must be a power of two.  */
+#define BC_TXBUF_SIZE  (256)
+
+/* What bcUartSend() does when the ring can't hold the whole message:
+   BC_TX_DROP       discard the new message and count it in bcUartTxDropped
+   BC_TX_BLOCK      sleep in LPM0 until the DMA has made room
+   BC_TX_OVERWRITE  discard the oldest queued bytes (never the ones already
+                    handed to the DMA) and count those instead
+The policy can be changed at run time with bcUartSetTxPolicy().  */
+#define BC_TX_DROP       (0)
+#define BC_TX_BLOCK      (1)
+#define BC_TX_OVERWRITE  (2)
+#define BC_TX_POLICY     (BC_TX_DROP)
+
 // ****************************************************************************
 
 
 void bcUartInit(void);
+bool bcUartSetBaudRate(uint32_t baudrate, BaudRate_Setting* setting);
 void bcUartSend(uint8_t* buf, uint8_t len);
+void bcUartSetTxPolicy(uint8_t policy);
+uint16_t bcUartTxPending(void);
+void bcUartFlush(void);
 uint16_t bcUartReceiveBytesInBuffer(uint8_t* buf);
+uint16_t bcUartRxAvailable(void);
+uint16_t bcUartRxPeek(uint8_t** data);
+void bcUartRxConsume(uint16_t count);
+
+// Bytes thrown away by the overflow policy since bcUartInit()
+extern volatile uint16_t bcUartTxDropped;
+
+// Bytes lost because the receive ring was full
+extern volatile uint16_t bcUartRxOverruns;
+
+// Head of the receive ring, free running: it moves with every byte received
+extern volatile uint16_t bcUartRcvBufIndex;
 
 #endif /* BCUART_H_ */
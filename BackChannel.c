@@ -8,17 +8,62 @@
 #include <strings.h>
 #include "BCUart.h"
 #include "BackChannel.h"
+#include "Format.h"
+#include "Timebase.h"
+
+#define PRINTF_CHUNK	32	// Stack used by BackChannel_Printf()
 long BackChannel_BaudRate = 0;
+int16_t BackChannel_BaudRateError = 0;	// Worst bit edge, 1/100 % of a bit
+static bool linkUp = false;
+static uint16_t linkRxIndex = 0;		// bcUartRcvBufIndex when last looked at
+static uint32_t linkRxTime;				// Timebase_now() when it last moved
+
+// Port open, so diagnostics written now go out, whether or not anyone reads them
 bool BackChannel_Connected()
 {
 	return BackChannel_BaudRate > 0;
 }
 
-void BackChannel_Open(uint16_t baudrate)
+// Up while the host has sent something in the last BACKCHANNEL_LINK_TIMEOUT.
+// The USB bridge passes neither DTR nor a cable detect to the UART, so
+// received bytes are the only sign anyone is there.
+bool BackChannel_HostPresent()
+{
+	uint16_t index = bcUartRcvBufIndex;
+	if (index != linkRxIndex)
+	{
+		linkRxIndex = index;
+		linkRxTime = Timebase_now();
+		linkUp = true;
+	}
+	else if (linkUp && Timebase_now() - linkRxTime > BACKCHANNEL_LINK_TIMEOUT)
+		linkUp = false;
+	return linkUp;
+}
+
+void BackChannel_Open(uint32_t baudrate)
 {
 	bcUartInit();
-	//TODO:Support passing in the baud rate
-	BackChannel_BaudRate = 57600;
+	linkUp = false;
+	linkRxIndex = bcUartRcvBufIndex;
+	BackChannel_BaudRate = BC_DEFAULT_BAUDRATE;
+	BackChannel_SetBaudRate(baudrate);
+}
+
+// Keeps the current rate if SMCLK can't make the new one accurately enough
+bool BackChannel_SetBaudRate(uint32_t baudrate)
+{
+	BaudRate_Setting setting;
+	if (bcUartSetBaudRate(baudrate, &setting) != STATUS_SUCCESS)
+		return STATUS_FAIL;
+	BackChannel_BaudRate = baudrate;
+	BackChannel_BaudRateError = setting.error;
+	return STATUS_SUCCESS;
+}
+
+int16_t BackChannel_BaudError()
+{
+	return BackChannel_BaudRateError;
 }
 
 void BackChannel_Write(unsigned char text[])
@@ -33,3 +78,33 @@ void BackChannel_WriteLine(unsigned char text[])
 	BackChannel_Write(text);
 	BackChannel_Write("\r\n");
 }
+
+static void BackChannel_FlushChunk(const char data[], uint16_t length)
+{
+	bcUartSend((uint8_t *)data, length);
+}
+
+// Formats straight into the TX ring a chunk at a time, see Format.h for the
+// conversions
+void BackChannel_Printf(const char *format, ...)
+{
+	char chunk[PRINTF_CHUNK];
+	Format_Builder builder;
+	va_list args;
+	Format_begin(&builder, chunk, sizeof chunk, BackChannel_FlushChunk);
+	va_start(args, format);
+	Format_vappend(&builder, format, args);
+	va_end(args);
+	Format_end(&builder);
+}
+
+void BackChannel_WriteBytes(const uint8_t data[], uint16_t length)
+{
+	while (length > 0xFF)
+	{
+		bcUartSend((uint8_t *)data, 0xFF);
+		data += 0xFF;
+		length -= 0xFF;
+	}
+	bcUartSend((uint8_t *)data, length);
+}
@@ -8,8 +8,21 @@
 #ifndef BACKCHANNEL_H_
 #define BACKCHANNEL_H_
 
-void BackChannel_Open();
+#include "Timebase.h"
+
+// A host that wants the samples sent rather than logged sends something,
+// a bare CR will do, at least this often; tools/telemetry_decode does
+#define BACKCHANNEL_LINK_TIMEOUT	(5 * TIMEBASE_TICKS_PER_SEC)
+
+extern long BackChannel_BaudRate;
+
+void BackChannel_Open(uint32_t baudrate);
+bool BackChannel_SetBaudRate(uint32_t baudrate);
+int16_t BackChannel_BaudError();
 void BackChannel_Write(unsigned char text[]);
 void BackChannel_WriteLine(unsigned char text[]);
+void BackChannel_WriteBytes(const uint8_t data[], uint16_t length);
+void BackChannel_Printf(const char *format, ...);
 bool BackChannel_Connected();
+bool BackChannel_HostPresent();
 #endif /* BACKCHANNEL_H_ */
@@ -0,0 +1,99 @@
+/*
+ * BaudRate.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include "BaudRate.h"
+
+// BITCLK modulation patterns for UCBRSx, bit i set means bit i of the frame
+// gets one extra clock (user's guide, BITCLK modulation pattern table).
+static const uint8_t modulation[8] = {
+		0x00, 0x02, 0x22, 0x2A, 0xAA, 0xAE, 0xEE, 0xFE };
+
+//private functions
+// Worst bit edge error of a setting over one frame, 1/100 % of a bit
+static int16_t BaudRate_error(uint32_t clock, uint32_t baudrate,
+		const BaudRate_Setting *s) {
+	int64_t clocks = 0;		// BRCLK cycles from the start edge
+	int64_t error;
+	int16_t worst = 0, e;
+	uint8_t i, m;
+	for (i = 0; i < BAUDRATE_FRAME_BITS; i++) {
+		m = (modulation[s->ucbrs] >> (i & 7)) & 1;
+		if (s->ucos16)
+			clocks += (uint32_t) (16 + m) * s->ucbr + s->ucbrf;
+		else
+			clocks += s->ucbr + m;
+		// (actual end of bit i - ideal) / bit time
+		error = (clocks * baudrate - (int64_t) (i + 1) * clock) * 10000 / clock;
+		if (error > 32767 || error < -32767)
+			return 32767;
+		e = (int16_t) error;
+		if (e < 0)
+			e = -e;
+		if (e > worst)
+			worst = e;
+	}
+	return worst;
+}
+
+static void BaudRate_try(uint32_t clock, uint32_t baudrate,
+		BaudRate_Setting *candidate, BaudRate_Setting *best) {
+	candidate->error = BaudRate_error(clock, baudrate, candidate);
+	if (candidate->error < best->error)
+		*best = *candidate;
+}
+
+//public functions
+/** Find the divisor setting with the smallest bit edge error in one mode.
+ * @param clock BRCLK in Hz, e.g. UCS_getSMCLK()
+ * @param ucos16 true for oversampling, which needs 16 clocks per bit, false
+ * for low frequency mode, which needs 3
+ * @return false if no setting is within BAUDRATE_MAX_ERROR; setting still
+ * holds the best found
+ */
+bool BaudRate_solveMode(uint32_t clock, uint32_t baudrate, bool ucos16,
+		BaudRate_Setting *setting) {
+	BaudRate_Setting candidate;
+	uint32_t n;
+	setting->ucbr = 0;
+	setting->ucbrs = 0;
+	setting->ucbrf = 0;
+	setting->ucos16 = ucos16;
+	setting->error = 32767;
+	if (baudrate == 0)
+		return false;
+	n = clock / baudrate;
+	if (ucos16)
+		n /= 16;
+	if (n < (ucos16 ? 1 : 3) || n > 0xFFFF)
+		return false;
+
+	candidate.ucos16 = ucos16;
+	candidate.ucbr = (uint16_t) n;
+	for (candidate.ucbrf = 0; candidate.ucbrf < (ucos16 ? 16 : 1); candidate.ucbrf++)
+		for (candidate.ucbrs = 0; candidate.ucbrs < 8; candidate.ucbrs++)
+			BaudRate_try(clock, baudrate, &candidate, setting);
+	return setting->error <= BAUDRATE_MAX_ERROR;
+}
+
+/** Find the divisor setting with the smallest bit edge error.
+ * From 16 clocks per bit oversampling is used, as the user's guide
+ * recommends, since the receiver then takes a majority vote of three
+ * samples per bit; low frequency mode is the fallback.
+ * @param clock BRCLK in Hz, e.g. UCS_getSMCLK()
+ * @return false if no setting is within BAUDRATE_MAX_ERROR; setting still
+ * holds the best found in the last mode tried
+ */
+bool BaudRate_solve(uint32_t clock, uint32_t baudrate, BaudRate_Setting *setting) {
+	if (BaudRate_solveMode(clock, baudrate, true, setting))
+		return true;
+	return BaudRate_solveMode(clock, baudrate, false, setting);
+}
+
+/** UCAxMCTL value for a solved setting. */
+uint8_t BaudRate_mctl(const BaudRate_Setting *setting) {
+	return (setting->ucbrf << 4) | (setting->ucbrs << 1)
+			| (setting->ucos16 ? 1 : 0);
+}
@@ -0,0 +1,40 @@
+/*
+ * BaudRate.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * USCI UART divisor solver.  Given the BRCLK frequency and a baud rate it
+ * picks UCBRx, UCBRSx, UCBRFx and UCOS16 the way the baud rate tables in
+ * the F5xx family user's guide are built: for each candidate setting the
+ * transmit bit edges of an 8N1 frame are laid out with the modulation
+ * patterns and compared against the ideal edges, and the setting with the
+ * smallest worst case error wins.  No hardware access, so it can be run on
+ * the host; tools/baudrate_check tests it against TI's tables.
+ */
+
+#ifndef BAUDRATE_H_
+#define BAUDRATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BAUDRATE_FRAME_BITS		10		// Start, 8 data, stop
+// The receiver samples mid-bit, so an edge a quarter of a bit out is still
+// read correctly.  The worst entry in TI's tables (32768 Hz, 9600) is 21%.
+#define BAUDRATE_MAX_ERROR		2500	// Worst bit edge, 1/100 % of a bit
+
+typedef struct BaudRate_Setting {
+	uint16_t ucbr;			// UCAxBRW
+	uint8_t ucbrs;			// Second stage modulation, 0-7
+	uint8_t ucbrf;			// First stage modulation, 0-15, oversampling only
+	bool ucos16;			// Oversampling mode
+	int16_t error;			// Worst TX bit edge error, 1/100 % of a bit
+} BaudRate_Setting;
+
+bool BaudRate_solve(uint32_t clock, uint32_t baudrate, BaudRate_Setting *setting);
+bool BaudRate_solveMode(uint32_t clock, uint32_t baudrate, bool ucos16,
+		BaudRate_Setting *setting);
+uint8_t BaudRate_mctl(const BaudRate_Setting *setting);
+
+#endif /* BAUDRATE_H_ */
@@ -0,0 +1,317 @@
+/*
+ * Bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include <math.h>
+#include "Bench.h"
+#include "BackChannel.h"
+#include "BCUart.h"
+#include "Ccm.h"
+#include "DeltaCodec.h"
+#include "FixedMath.h"
+#include "Format.h"
+#include "HMC5883L.h"
+#include "HMCAcquire.h"
+#include "Heading.h"
+#include "Scheduler.h"
+#include "SecureLink.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+
+typedef struct Bench_Result {
+	const char *name;
+	uint16_t runs;
+	uint32_t min;
+	uint32_t max;
+	uint32_t total;
+	uint16_t busTime;		// us per run
+} Bench_Result;
+
+enum {
+	STAGE_I2C_READ, STAGE_HEADING, STAGE_HEADING_FLOAT, STAGE_FORMAT,
+	STAGE_UART_WRITE, STAGE_SAMPLE, STAGE_DELTA, STAGE_MATVEC_MPY32,
+	STAGE_MATVEC_C, STAGE_MATVEC_FLOAT, STAGE_NORM_MPY32, STAGE_NORM_FLOAT,
+	STAGE_SEAL_FRAME, STAGE_SEAL_BLOCK, STAGES
+};
+
+static Bench_Result results[STAGES] = { { "i2c_read" }, { "heading" }, {
+		"heading_float" }, { "format" }, { "uart_write" }, { "sample" }, {
+		"delta_encode" }, { "matvec_mpy32" }, { "matvec_c" }, { "matvec_float" },
+		{ "norm_mpy32" }, { "norm_float" }, { "seal_frame" }, { "seal_block" } };
+// A soft iron correction with every term in use, in Q15 and as floats
+static const int16_t matrix[9] = { 31000, -1200, 450, -1200, 29800, 800, 450,
+		800, 32100 };
+static const float matrixFloat[9] = { 0.946f, -0.0366f, 0.0137f, -0.0366f,
+		0.909f, 0.0244f, 0.0137f, 0.0244f, 0.980f };
+static volatile int16_t sink;			// Keeps results the optimiser would drop
+static volatile uint16_t overflows = 0;
+static uint32_t overhead = 0;			// Cycles for a back to back pair of Bench_now()
+static uint32_t lastIdle, lastBusy, lastSamples, lastTime;
+static char line[80];
+static uint8_t block[TELEMETRY_BLOCK_MAX];
+// The FIPS-197 example key; sealing takes as long under any key
+static const uint8_t keyBytes[AES128_KEY_SIZE] = { 0, 1, 2, 3, 4, 5, 6, 7, 8,
+		9, 10, 11, 12, 13, 14, 15 };
+static Aes128_Key key;
+static uint8_t frame[TELEMETRY_DELTA_MAX];
+
+//private functions
+static void Bench_record(Bench_Result *r, uint32_t start) {
+	uint32_t cycles = Bench_now() - start;
+	cycles = (cycles > overhead) ? cycles - overhead : 0;
+	if (r->runs == 0 || cycles < r->min)
+		r->min = cycles;
+	if (cycles > r->max)
+		r->max = cycles;
+	r->total += cycles;
+	r->runs++;
+}
+
+// Charge in nA*s for a number of cycles at a current in uA
+static uint32_t Bench_charge(uint32_t cycles, uint16_t current) {
+	return (uint32_t) (((uint64_t) cycles * current) / (BENCH_MCLK / 1000));
+}
+
+// MagCal_apply's matrix multiply before FixedMath, with the compiler's
+// multiplies
+static void Bench_matVecC(const int16_t m[9], const int16_t v[3], int16_t out[3]) {
+	int32_t sum;
+	uint8_t r;
+	for (r = 0; r < 3; r++, m += 3) {
+		sum = (int32_t) m[0] * v[0] + (int32_t) m[1] * v[1];
+		sum = (sum >> 1) + (((int32_t) m[2] * v[2]) >> 1);
+		out[r] = FixedMath_saturate16((sum + (1L << 13)) >> 14);
+	}
+}
+
+static void Bench_matVecFloat(const float m[9], const float v[3], float out[3]) {
+	uint8_t r;
+	for (r = 0; r < 3; r++, m += 3)
+		out[r] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2];
+}
+
+// Time the FixedMath calls against plain C and float on one vector
+static void Bench_math(int16_t x, int16_t y, int16_t z) {
+	int16_t v[3], out[3];
+	float f[3], outFloat[3];
+	uint32_t start;
+	v[0] = x;
+	v[1] = y;
+	v[2] = z;
+	f[0] = x;
+	f[1] = y;
+	f[2] = z;
+
+	start = Bench_now();
+	FixedMath_matVec3(matrix, v, out);
+	Bench_record(&results[STAGE_MATVEC_MPY32], start);
+	sink = out[0];
+
+	start = Bench_now();
+	Bench_matVecC(matrix, v, out);
+	Bench_record(&results[STAGE_MATVEC_C], start);
+	sink = out[0];
+
+	start = Bench_now();
+	Bench_matVecFloat(matrixFloat, f, outFloat);
+	Bench_record(&results[STAGE_MATVEC_FLOAT], start);
+	sink = (int16_t) outFloat[0];
+
+	start = Bench_now();
+	sink = FixedMath_norm3(v);
+	Bench_record(&results[STAGE_NORM_MPY32], start);
+
+	start = Bench_now();
+	sink = (int16_t) sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	Bench_record(&results[STAGE_NORM_FLOAT], start);
+}
+
+// Seal a binary frame and a full delta frame the way Telemetry does
+static void Bench_seal(uint16_t run) {
+	static const uint8_t sync[2] = { (uint8_t) TELEMETRY_SECURE_SYNC,
+			(uint8_t) (TELEMETRY_SECURE_SYNC >> 8) };
+	uint8_t nonce[SECURELINK_NONCE_SIZE] = { 0 };
+	uint8_t tag[SECURELINK_TAG_SIZE];
+	uint32_t start;
+	nonce[4] = (uint8_t) run;
+	start = Bench_now();
+	Ccm_seal(&key, nonce, SECURELINK_NONCE_SIZE, sync, 2, frame,
+			TELEMETRY_FRAME_SIZE, tag, SECURELINK_TAG_SIZE);
+	Bench_record(&results[STAGE_SEAL_FRAME], start);
+	nonce[0] = 1;
+	start = Bench_now();
+	Ccm_seal(&key, nonce, SECURELINK_NONCE_SIZE, sync, 2, frame,
+			TELEMETRY_DELTA_MAX, tag, SECURELINK_TAG_SIZE);
+	Bench_record(&results[STAGE_SEAL_BLOCK], start);
+}
+
+static uint16_t Bench_format(int16_t x, int16_t y, int16_t z, int16_t heading) {
+	Format_Builder b;
+	Format_begin(&b, line, sizeof line, 0);
+	Format_append(&b, "Reading:\tX=%6d\tY=%6d\tZ=%6d\r\nHeading:  %5.1d",
+			x, y, z, heading);
+	return Format_end(&b);
+}
+
+// UART time for a number of characters, 10 bits each
+static uint16_t Bench_uartTime(uint16_t length) {
+	return (uint16_t) ((uint32_t) length * 10000000UL / BackChannel_BaudRate);
+}
+
+static void Bench_report(const Bench_Result *r) {
+	uint32_t average = r->runs ? r->total / r->runs : 0;
+	BackChannel_Printf("bench,%s,%u,%lu,%lu,%lu,%u,%lu\r\n", r->name, r->runs,
+			r->min, average, r->max, r->busTime,
+			Bench_charge(average, BENCH_ACTIVE_UA));
+}
+
+//public functions
+/** Start TIMER_A2 counting SMCLK and measure the timing overhead. */
+void Bench_init() {
+	TIMER_A_initContinuousModeParam param = { 0 };
+	param.clockSource = TIMER_A_CLOCKSOURCE_SMCLK;
+	param.clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+	param.timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_ENABLE;
+	param.timerClear = TIMER_A_DO_CLEAR;
+	param.startTimer = true;
+	overflows = 0;
+	TIMER_A_initContinuousMode(BENCH_BASE, &param);
+	// Capture on both edges of a software toggled input, synchronised to
+	// the timer clock
+	TA2CCTL0 = CM_3 + CCIS_2 + SCS + CAP;
+	overhead = 0;
+	overhead = Bench_now();
+	overhead = Bench_now() - overhead;
+	lastTime = Timebase_now();
+	lastIdle = Scheduler_idleTicks;
+	lastBusy = Scheduler_busyTicks;
+	lastSamples = 0;
+}
+
+/** MCLK cycles since Bench_init(). */
+uint32_t Bench_now() {
+	uint16_t sr = __get_SR_register();
+	uint16_t high, low;
+	__disable_interrupt();
+	TA2CCTL0 ^= CCIS0;			// Toggle between GND and VCC: capture now
+	__no_operation();
+	low = TA2CCR0;
+	high = overflows;
+	if ((TA2CTL & TAIFG) && low < 0x8000)
+		high++;
+	__bis_SR_register(sr & GIE);
+	return ((uint32_t) high << 16) | low;
+}
+
+/** Time each stage of a sample BENCH_RUNS times and report.
+ * Must run before HMCAcquire_start(), since it reads the sensor directly.
+ */
+void Bench_run() {
+	int16_t x = 0, y = 0, z = 0, heading = 0;
+	uint16_t length = 0;
+	uint32_t start;
+	uint16_t i;
+	DeltaCodec_State codec;
+	HMC_Sample sample = { 0 };
+
+	DeltaCodec_begin(&codec, block, sizeof block);
+	Aes128_setKey(&key, keyBytes);
+
+	for (i = 0; i < BENCH_RUNS; i++) {
+		start = Bench_now();
+		HMC_getHeading(&x, &y, &z);
+		Bench_record(&results[STAGE_I2C_READ], start);
+
+		start = Bench_now();
+		heading = Heading_fromXY(x + i * 97, y - i * 89);	// Vary the octant
+		Bench_record(&results[STAGE_HEADING], start);
+
+		start = Bench_now();
+		sink = (int16_t) (atan2(x + i * 97, y - i * 89) * (1800.0 / 3.14159265));
+		Bench_record(&results[STAGE_HEADING_FLOAT], start);
+
+		start = Bench_now();
+		length = Bench_format(x, y, z, heading);
+		Bench_record(&results[STAGE_FORMAT], start);
+
+		start = Bench_now();
+		BackChannel_WriteLine((unsigned char *) line);
+		Bench_record(&results[STAGE_UART_WRITE], start);
+		bcUartFlush();
+
+		start = Bench_now();
+		HMC_getHeading(&x, &y, &z);
+		heading = Heading_fromXY(x, y);
+		BackChannel_Printf("Reading:\tX=%6d\tY=%6d\tZ=%6d\r\nHeading:  %5.1d\r\n",
+				x, y, z, heading);
+		bcUartFlush();
+		Bench_record(&results[STAGE_SAMPLE], start);
+
+		sample.timestamp += 437;	// 75 Hz
+		sample.x = x;
+		sample.y = y;
+		sample.z = z;
+		start = Bench_now();
+		DeltaCodec_add(&codec, &sample);	// The first is the keyframe
+		Bench_record(&results[STAGE_DELTA], start);
+
+		Bench_math(x + i * 97, y - i * 89, z + i * 31);
+		Bench_seal(i);
+	}
+	results[STAGE_I2C_READ].busTime = HMCAcquire_busTime();
+	results[STAGE_UART_WRITE].busTime = Bench_uartTime(length + 2);
+	results[STAGE_SAMPLE].busTime = HMCAcquire_busTime()
+			+ Bench_uartTime(length + 2);
+	results[STAGE_DELTA].busTime = Bench_uartTime(codec.length) / codec.count;
+	results[STAGE_SEAL_FRAME].busTime = Bench_uartTime(TELEMETRY_FRAME_SIZE
+			+ TELEMETRY_SECURE_OVERHEAD + 2);
+	results[STAGE_SEAL_BLOCK].busTime = Bench_uartTime(TELEMETRY_SECURE_ENCODED_MAX);
+
+	BackChannel_WriteLine("bench,stage,runs,min_cycles,avg_cycles,max_cycles,bus_us,nAs");
+	for (i = 0; i < STAGES; i++)
+		Bench_report(&results[i]);
+	bcUartFlush();
+}
+
+/** Report charge per sample from the scheduler's sleep and task time since
+ * the last call.  Call periodically from a task.
+ * @param samples Samples processed since start up
+ */
+void Bench_residency(uint32_t samples) {
+	uint32_t now = Timebase_now();
+	uint32_t elapsed = now - lastTime;
+	uint32_t idle = Scheduler_idleTicks - lastIdle;
+	uint32_t busy = Scheduler_busyTicks - lastBusy;
+	uint32_t count = samples - lastSamples;
+	uint64_t charge;
+	uint32_t awake;
+	lastTime = now;
+	lastIdle = Scheduler_idleTicks;
+	lastBusy = Scheduler_busyTicks;
+	lastSamples = samples;
+	if (count == 0 || idle > elapsed)
+		return;
+	// Everything not asleep, ISRs and scheduler included, counts as active
+	awake = elapsed - idle;
+	charge = ((uint64_t) awake * BENCH_ACTIVE_UA + (uint64_t) idle * BENCH_LPM0_UA)
+			* 1000 / TIMEBASE_TICKS_PER_SEC;
+	BackChannel_Printf("bench,system,%lu,%lu,%lu,%lu,0,%lu\r\n", count,
+			(uint32_t) ((uint64_t) busy * (BENCH_MCLK / TIMEBASE_TICKS_PER_SEC) / count),
+			(uint32_t) ((uint64_t) awake * (BENCH_MCLK / TIMEBASE_TICKS_PER_SEC) / count),
+			(uint32_t) ((uint64_t) elapsed * (BENCH_MCLK / TIMEBASE_TICKS_PER_SEC) / count),
+			(uint32_t) (charge / count));
+}
+
+#pragma vector = TIMER2_A1_VECTOR
+__interrupt void Bench_TIMER2_A1_ISR(void) {
+	switch (__even_in_range(TA2IV, 14)) {
+	case TAxIV_TAIFG:
+		overflows++;
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * Bench.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Benchmarks for the acquisition path, built in with BENCHMARK defined.
+ * Bench_run() times each stage of a sample on its own and end to end in
+ * MCLK cycles, using a software triggered capture on TIMER_A2 clocked from
+ * SMCLK (= MCLK).  Bench_residency() turns the scheduler's LPM residency
+ * into charge per sample while the application runs normally.
+ *
+ * Results go out on the back channel as CSV lines starting with "bench,":
+ *     bench,stage,runs,min_cycles,avg_cycles,max_cycles,bus_us,nAs
+ * bus_us is the I2C or UART time the stage keeps a peripheral busy, for
+ * delta_encode the UART time of the compressed sample.  heading_float is
+ * the libm atan2() that Heading_fromXY() replaced, on the same vector.  The
+ * matvec and norm stages time FixedMath against plain C and float on the
+ * same vector.
+ * seal_frame and seal_block encrypt a binary and a full delta frame; their
+ * bus_us is the UART time of the encrypted frame, which sealing has to beat
+ * for encryption to cost no throughput.  nAs
+ * is charge in nA*s: for single stages every cycle is counted at the
+ * active current, an upper bound where the stage sleeps while it waits;
+ * the "system" line uses measured sleep time.  On that line the cycle
+ * columns are per sample: task time, time awake and wall time.
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+
+#define BENCH_BASE			(TIMER_A2_BASE)
+#define BENCH_RUNS			16
+#define BENCH_MCLK			16000000UL	// initClocks(16000000)
+// Typical supply currents at 3 V (MSP430F5529 datasheet); replace with
+// measured values for the board in use.
+#define BENCH_ACTIVE_UA		4600		// Active, 16 MHz, running from flash
+#define BENCH_LPM0_UA		210			// LPM0 with DCO and FLL at 16 MHz
+
+void Bench_init();
+uint32_t Bench_now();
+void Bench_run();
+void Bench_residency(uint32_t samples);
+
+#endif /* BENCH_H_ */
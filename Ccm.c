@@ -0,0 +1,147 @@
+/*
+ * Ccm.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include "Ccm.h"
+
+#define AAD_MAX			0xFEFF		// Longest with a two byte length
+
+typedef struct Ccm_Mac {
+	uint8_t x[AES128_BLOCK_SIZE];		// CBC-MAC chaining value
+	uint8_t fill;						// Bytes XORed into x since the last block
+} Ccm_Mac;
+
+//private functions
+static void Ccm_xor(uint8_t *to, const uint8_t *from, uint8_t length) {
+	while (length--)
+		*to++ ^= *from++;
+}
+
+// Flags byte, nonce, then value big-endian in what is left
+static void Ccm_block(uint8_t b[AES128_BLOCK_SIZE], uint8_t flags,
+		const uint8_t nonce[], uint8_t nonceLength, uint16_t value) {
+	uint8_t i;
+	b[0] = flags;
+	for (i = 0; i < nonceLength; i++)
+		b[1 + i] = nonce[i];
+	for (i = 1 + nonceLength; i < AES128_BLOCK_SIZE - 2; i++)
+		b[i] = 0;
+	b[AES128_BLOCK_SIZE - 2] = (uint8_t) (value >> 8);
+	b[AES128_BLOCK_SIZE - 1] = (uint8_t) value;
+}
+
+// Feed bytes to the CBC-MAC, running the cipher on each full block
+static void Ccm_absorb(const Aes128_Key *k, Ccm_Mac *mac, const uint8_t *data,
+		uint16_t length) {
+	while (length--) {
+		mac->x[mac->fill++] ^= *data++;
+		if (mac->fill == AES128_BLOCK_SIZE) {
+			Aes128_encrypt(k, mac->x, mac->x);
+			mac->fill = 0;
+		}
+	}
+}
+
+// Zero pad the block in progress, which XORs nothing
+static void Ccm_pad(const Aes128_Key *k, Ccm_Mac *mac) {
+	if (mac->fill)
+		Aes128_encrypt(k, mac->x, mac->x);
+	mac->fill = 0;
+}
+
+// Both directions: the MAC is over the plaintext, so sealing absorbs data
+// before encrypting it and opening after decrypting it.  Each AES block
+// runs while the XORs that don't depend on it are done.  Leaves the
+// unencrypted tag in mac.
+static bool Ccm_run(const Aes128_Key *k, const uint8_t nonce[],
+		uint8_t nonceLength, const uint8_t aad[], uint16_t aadLength,
+		uint8_t data[], uint16_t length, uint8_t tagLength, bool sealing,
+		uint8_t mac[AES128_BLOCK_SIZE], uint8_t s0[AES128_BLOCK_SIZE]) {
+	uint8_t counterFlags = AES128_BLOCK_SIZE - 2 - nonceLength;	// L - 1
+	uint8_t a[AES128_BLOCK_SIZE], s[AES128_BLOCK_SIZE], header[2];
+	Ccm_Mac m;
+	uint16_t block = 1;
+	uint8_t n;
+
+	if (nonceLength < CCM_NONCE_MIN || nonceLength > CCM_NONCE_MAX
+			|| tagLength < 4 || tagLength > CCM_TAG_MAX || (tagLength & 1)
+			|| aadLength > AAD_MAX)
+		return false;
+
+	Ccm_block(m.x, (uint8_t) ((aadLength ? 0x40 : 0) | ((tagLength - 2) / 2) << 3
+			| counterFlags), nonce, nonceLength, length);
+	Aes128_encrypt(k, m.x, m.x);
+	m.fill = 0;
+	if (aadLength) {
+		header[0] = (uint8_t) (aadLength >> 8);
+		header[1] = (uint8_t) aadLength;
+		Ccm_absorb(k, &m, header, 2);
+		Ccm_absorb(k, &m, aad, aadLength);
+		Ccm_pad(k, &m);
+	}
+
+	for (; length; length -= n, data += n, block++) {
+		n = (length < AES128_BLOCK_SIZE) ? (uint8_t) length : AES128_BLOCK_SIZE;
+		Ccm_block(a, counterFlags, nonce, nonceLength, block);
+		Aes128_start(k, a);
+		if (sealing)
+			Ccm_xor(m.x, data, n);
+		Aes128_finish(s);
+		if (!sealing) {
+			Ccm_xor(data, s, n);
+			Ccm_xor(m.x, data, n);
+		}
+		Aes128_start(k, m.x);
+		if (sealing)
+			Ccm_xor(data, s, n);
+		Aes128_finish(m.x);
+	}
+
+	Ccm_block(a, counterFlags, nonce, nonceLength, 0);
+	Aes128_encrypt(k, a, s0);
+	for (n = 0; n < AES128_BLOCK_SIZE; n++)
+		mac[n] = m.x[n];
+	return true;
+}
+
+//public functions
+/** Encrypt data in place and compute its tag.
+ * @param aad Authenticated with data, not encrypted; may be 0 if aadLength is
+ * @return false if a length is out of range, with nothing done
+ */
+bool Ccm_seal(const Aes128_Key *k, const uint8_t nonce[], uint8_t nonceLength,
+		const uint8_t aad[], uint16_t aadLength, uint8_t data[], uint16_t length,
+		uint8_t tag[], uint8_t tagLength) {
+	uint8_t mac[AES128_BLOCK_SIZE], s0[AES128_BLOCK_SIZE];
+	uint8_t i;
+	if (!Ccm_run(k, nonce, nonceLength, aad, aadLength, data, length, tagLength,
+			true, mac, s0))
+		return false;
+	for (i = 0; i < tagLength; i++)
+		tag[i] = mac[i] ^ s0[i];
+	return true;
+}
+
+/** Decrypt data in place and check its tag.  Every byte of the tag is
+ * compared, however early it differs.
+ * @return false if the tag doesn't match, with data zeroed, or a length is
+ *         out of range
+ */
+bool Ccm_open(const Aes128_Key *k, const uint8_t nonce[], uint8_t nonceLength,
+		const uint8_t aad[], uint16_t aadLength, uint8_t data[], uint16_t length,
+		const uint8_t tag[], uint8_t tagLength) {
+	uint8_t mac[AES128_BLOCK_SIZE], s0[AES128_BLOCK_SIZE];
+	uint8_t i, differ = 0;
+	if (!Ccm_run(k, nonce, nonceLength, aad, aadLength, data, length, tagLength,
+			false, mac, s0))
+		return false;
+	for (i = 0; i < tagLength; i++)
+		differ |= tag[i] ^ mac[i] ^ s0[i];
+	if (!differ)
+		return true;
+	while (length--)
+		data[length] = 0;		// Unauthenticated plaintext is never handed out
+	return false;
+}
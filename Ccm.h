@@ -0,0 +1,41 @@
+/*
+ * Ccm.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Authenticated encryption with AES-128 in CCM mode (NIST SP 800-38C,
+ * RFC 3610): a CBC-MAC over the nonce, lengths, associated data and
+ * plaintext gives the tag, then CTR mode encrypts the plaintext and the
+ * tag under the same key.  The counter blocks carry the nonce, so a key
+ * and nonce pair must never be used twice; the associated data is
+ * authenticated but sent as it is.
+ *
+ * The nonce is 7 to 13 bytes.  What it leaves of the 15 byte counter field
+ * bounds the message length; the 2 byte associated data length limits that
+ * to 65279 bytes.  Tags are 4 to 16 bytes, even.
+ *
+ * Each block costs two AES operations, overlapped with the XORs around
+ * them when there is an AES module.  This is plain C on top of Aes128, so
+ * the host tools build it as is.
+ */
+
+#ifndef CCM_H_
+#define CCM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Aes128.h"
+
+#define CCM_NONCE_MIN		7
+#define CCM_NONCE_MAX		13
+#define CCM_TAG_MAX			16
+
+bool Ccm_seal(const Aes128_Key *k, const uint8_t nonce[], uint8_t nonceLength,
+		const uint8_t aad[], uint16_t aadLength, uint8_t data[], uint16_t length,
+		uint8_t tag[], uint8_t tagLength);
+bool Ccm_open(const Aes128_Key *k, const uint8_t nonce[], uint8_t nonceLength,
+		const uint8_t aad[], uint16_t aadLength, uint8_t data[], uint16_t length,
+		const uint8_t tag[], uint8_t tagLength);
+
+#endif /* CCM_H_ */
@@ -0,0 +1,320 @@
+/*
+ * Command.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "ADCAcquire.h"
+#include "BCUart.h"
+#include "BaudRate.h"
+#include "BackChannel.h"
+#include "Command.h"
+#include "FlashLog.h"
+#include "HMC5883L.h"
+#include "HMCAcquire.h"
+#include "I2CEngine.h"
+#include "MagCal.h"
+#include "SecureLink.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+
+static char words[2][COMMAND_WORD_MAX];	// Command and argument
+static uint8_t wordLength[2];
+static uint8_t wordCount;				// Words started on this line
+static bool inWord;
+static bool tooLong;					// Extra words or an oversized word
+static bool calibrating = false;
+static uint32_t newBaudRate = 0;		// Switched to once the reply is out
+
+//private functions
+static bool Command_is(uint8_t index, const char *keyword) {
+	uint8_t i;
+	for (i = 0; i < wordLength[index]; i++)
+		if (keyword[i] == '\0' || words[index][i] != keyword[i])
+			return false;	// A received NUL mustn't match the end
+	return keyword[i] == '\0';
+}
+
+// Decimal argument no greater than max, or -1
+static int32_t Command_number(uint8_t index, int32_t max) {
+	int32_t value = 0;
+	uint8_t i;
+	if (wordLength[index] == 0 || wordLength[index] > COMMAND_DIGITS_MAX)
+		return -1;
+	for (i = 0; i < wordLength[index]; i++) {
+		if (words[index][i] < '0' || words[index][i] > '9')
+			return -1;
+		value = value * 10 + (words[index][i] - '0');
+	}
+	return (value <= max) ? value : -1;
+}
+
+static bool Command_calibration() {
+	if (Command_is(1, "start")) {
+		MagCal_beginCollect();
+		calibrating = true;
+		return STATUS_SUCCESS;
+	}
+	if (Command_is(1, "stop")) {
+		if (!calibrating)
+			return STATUS_FAIL;
+		calibrating = false;
+		return MagCal_finishCollect();
+	}
+	if (Command_is(1, "save"))
+		return MagCal_save();
+	if (Command_is(1, "load"))
+		return MagCal_load();
+	if (Command_is(1, "reset")) {
+		calibrating = false;
+		MagCal_clear();
+		return STATUS_SUCCESS;
+	}
+	return STATUS_FAIL;
+}
+
+// Bus time per sample against the configured and the bus limited rates
+static bool Command_budget() {
+	// HMC_getDataRate() codes in tenths of a Hz
+	static const uint16_t rateTenths[7] = { 7, 15, 30, 75, 150, 300, 750 };
+	uint16_t time = HMCAcquire_busTime();
+	uint8_t rate = HMC_getDataRate();
+	if (rate > HMC5883L_RATE_75)
+		return STATUS_FAIL;
+	BackChannel_Printf("I2C %lu kHz, %u us/sample, bus max %lu Hz\r\n",
+			I2CEngine_speed(&HMC_device) / 1000, time, 1000000UL / time);
+	BackChannel_Printf("Load %.1d%% at %.1d Hz\r\n",
+			(int16_t) (((uint32_t) time * rateTenths[rate] + 5000) / 10000),
+			rateTenths[rate]);
+	return STATUS_SUCCESS;
+}
+
+static bool Command_i2cStats() {
+	const I2CEngine_Stats *stats = I2CEngine_getStats(HMCI2C_BASE);
+	BackChannel_Printf("Timeouts %u, recovered %u, failed %u\r\n",
+			stats->timeouts, stats->recoveries, stats->failures);
+	BackChannel_Printf("Recovery last %lu ms, max %lu ms\r\n",
+			(uint32_t) stats->lastRecovery * 1000 / TIMEBASE_TICKS_PER_SEC,
+			(uint32_t) stats->maxRecovery * 1000 / TIMEBASE_TICKS_PER_SEC);
+	return STATUS_SUCCESS;
+}
+
+static bool Command_log() {
+	const FlashLog_Stats *stats = FlashLog_getStats();
+	if (Command_is(1, "start"))
+		FlashLog_start();
+	else if (Command_is(1, "stop"))
+		FlashLog_stop();
+	else if (Command_is(1, "dump"))
+		FlashLog_dump();
+	else if (Command_is(1, "erase"))
+		FlashLog_erase();
+	else if (Command_is(1, "stats")) {
+		BackChannel_Printf("Log %u samples, %u erases, %u forced, %u corrupt\r\n",
+				stats->samples, stats->erases, stats->forced, stats->corrupt);
+		BackChannel_Printf("Erase last %lu ms, max %lu ms\r\n",
+				(uint32_t) stats->lastErase * 1000 / TIMEBASE_TICKS_PER_SEC,
+				(uint32_t) stats->maxErase * 1000 / TIMEBASE_TICKS_PER_SEC);
+		if (FlashLog_isFull())
+			BackChannel_WriteLine("Log full, unattended logging stopped");
+	} else
+		return STATUS_FAIL;
+	return STATUS_SUCCESS;
+}
+
+static bool Command_adc() {
+	ADC_Reading reading;
+	if (!Command_is(1, "read") || !ADCAcquire_latest(&reading))
+		return STATUS_FAIL;
+	BackChannel_Printf("Supply %u mV, temperature %.1d C, A0 %u mV\r\n",
+			reading.supply, reading.temperature, reading.analog);
+	BackChannel_Printf("Overruns %u\r\n", ADCAcquire_overruns);
+	return STATUS_SUCCESS;
+}
+
+// Exactly length bytes in hex, in order
+static bool Command_hex(uint8_t index, uint8_t bytes[], uint8_t length) {
+	uint8_t i, nibble;
+	char c;
+	if (wordLength[index] != 2 * length)
+		return STATUS_FAIL;
+	for (i = 0; i < 2 * length; i++) {
+		c = words[index][i];
+		if (c >= '0' && c <= '9')
+			nibble = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			nibble = c - 'a' + 10;
+		else
+			return STATUS_FAIL;
+		bytes[i / 2] = (i & 1) ? (bytes[i / 2] << 4) | nibble : nibble;
+	}
+	return STATUS_SUCCESS;
+}
+
+// AES128_KEY_SIZE bytes, as in the FIPS-197 vectors
+static bool Command_key() {
+	uint8_t key[AES128_KEY_SIZE];
+	uint8_t i;
+	bool result = Command_hex(1, key, AES128_KEY_SIZE);
+	if (result == STATUS_SUCCESS)
+		result = SecureLink_setKey(key);
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		key[i] = 0;
+	for (i = 0; i < COMMAND_WORD_MAX; i++)
+		words[1][i] = 0;
+	return result;
+}
+
+// Offset and matrix in MagCal_Params order, 16 bits each, high byte first
+static bool Command_calset() {
+	uint8_t bytes[2 * (3 + 9)];
+	MagCal_Params params;
+	uint8_t i;
+	if (Command_hex(1, bytes, sizeof bytes) == STATUS_FAIL)
+		return STATUS_FAIL;
+	params.magic = MAGCAL_MAGIC;
+	for (i = 0; i < 3; i++)
+		params.offset[i] = (int16_t) ((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+	for (i = 0; i < 9; i++)
+		params.matrix[i] = (int16_t) ((bytes[6 + 2 * i] << 8)
+				| bytes[6 + 2 * i + 1]);
+	calibrating = false;
+	return MagCal_setParams(&params);
+}
+
+static bool Command_execute() {
+	int32_t value;
+	BaudRate_Setting baud;
+	if (wordCount != 2)
+		return STATUS_FAIL;
+	if (Command_is(0, "rate")) {
+		value = Command_number(1, HMC5883L_RATE_75);
+		return (value < 0) ? STATUS_FAIL : HMC_setDataRate((uint8_t) value);
+	}
+	if (Command_is(0, "gain")) {
+		value = Command_number(1, HMC5883L_GAIN_220);
+		return (value < 0) ? STATUS_FAIL : HMC_setGain((uint8_t) value);
+	}
+	if (Command_is(0, "format")) {
+		if (Command_is(1, "ascii")) {
+			if (Telemetry_isEncrypted())
+				return STATUS_FAIL;		// Would be plain text
+			Telemetry_setFormat(TELEMETRY_FORMAT_ASCII);
+		} else if (Command_is(1, "binary"))
+			Telemetry_setFormat(TELEMETRY_FORMAT_BINARY);
+		else if (Command_is(1, "delta"))
+			Telemetry_setFormat(TELEMETRY_FORMAT_DELTA);
+		else
+			return STATUS_FAIL;
+		return STATUS_SUCCESS;
+	}
+	if (Command_is(0, "crypt")) {
+		if (Command_is(1, "on"))
+			return (Telemetry_getFormat() == TELEMETRY_FORMAT_ASCII) ? STATUS_FAIL
+					: Telemetry_setEncryption(true);
+		if (Command_is(1, "off"))
+			return Telemetry_setEncryption(false);
+		return STATUS_FAIL;
+	}
+	if (Command_is(0, "key"))
+		return Command_key();
+	if (Command_is(0, "cal"))
+		return Command_calibration();
+	if (Command_is(0, "calset"))
+		return Command_calset();
+	if (Command_is(0, "i2c")) {
+		if (Command_is(1, "budget"))
+			return Command_budget();
+		if (Command_is(1, "stats"))
+			return Command_i2cStats();
+		return STATUS_FAIL;
+	}
+	if (Command_is(0, "log"))
+		return Command_log();
+	if (Command_is(0, "adc"))
+		return Command_adc();
+	if (Command_is(0, "baud")) {
+		value = Command_number(1, 921600);
+		if (value <= 0 || !BaudRate_solve(UCS_getSMCLK(), value, &baud))
+			return STATUS_FAIL;
+		newBaudRate = value;
+		return STATUS_SUCCESS;
+	}
+	return STATUS_FAIL;
+}
+
+static void Command_endLine() {
+	bool result;
+	if (wordCount == 0 && !tooLong)
+		return;		// Blank line, or the LF of a CR LF
+	result = !tooLong && Command_execute() == STATUS_SUCCESS;
+	BackChannel_WriteLine(result ? "OK" : "ERR");
+	if (Telemetry_getFormat() != TELEMETRY_FORMAT_ASCII)
+		BackChannel_WriteBytes("", 1);	// Keep the reply out of the next frame
+	if (newBaudRate) {
+		BackChannel_SetBaudRate(newBaudRate);	// Waits for the reply to go
+		newBaudRate = 0;
+	}
+	Command_reset();
+}
+
+//public functions
+/** Throw away any partly received line. */
+void Command_reset() {
+	wordCount = 0;
+	wordLength[0] = 0;
+	wordLength[1] = 0;
+	inWord = false;
+	tooLong = false;
+}
+
+/** Feed received bytes to the parser, running each command as its line
+ * ends.  The bytes are only read, never kept.
+ */
+void Command_parse(const uint8_t data[], uint16_t length) {
+	uint16_t i;
+	char c;
+	for (i = 0; i < length; i++) {
+		c = (char) data[i];
+		if (c == '\r' || c == '\n') {
+			Command_endLine();
+			continue;
+		}
+		if (c == ' ' || c == '\t') {
+			inWord = false;
+			continue;
+		}
+		if (!inWord) {
+			inWord = true;
+			if (wordCount++ >= 2)
+				tooLong = true;
+		}
+		if (tooLong)
+			continue;
+		if (wordLength[wordCount - 1] == COMMAND_WORD_MAX) {
+			tooLong = true;
+			continue;
+		}
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		words[wordCount - 1][wordLength[wordCount - 1]++] = c;
+	}
+}
+
+/** Parse whatever the back channel has received, in place in the ring. */
+void Command_poll() {
+	uint8_t *data;
+	uint16_t length;
+	while ((length = bcUartRxPeek(&data)) != 0) {
+		Command_parse(data, length);
+		bcUartRxConsume(length);
+	}
+}
+
+/** True between "cal start" and "cal stop"; feed raw samples to
+ * MagCal_collect() meanwhile.
+ */
+bool Command_isCalibrating() {
+	return calibrating;
+}
@@ -0,0 +1,45 @@
+/*
+ * Command.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Line commands on the back channel, parsed a byte at a time straight out
+ * of the BCUart receive ring, so a command can be half received when the
+ * main loop goes back to sampling.  Only the current word is buffered.
+ *
+ *     rate <0-6>              HMC_setDataRate() code, 6 = 75 Hz
+ *     gain <0-7>              HMC_setGain() code; auto-ranging may move it
+ *     format <format>         Telemetry output: ascii, binary or delta
+ *     crypt on|off            Encrypt binary and delta frames, see Telemetry.h
+ *     key <32 hex digits>     Store the AES-128 key for crypt, see SecureLink.h
+ *     cal start|stop|save|load|reset
+ *     calset <48 hex digits>  Load an off-line fit: offset X, Y, Z then the
+ *                             Q15 matrix row major, each a 16-bit word most
+ *                             significant digit first; tools/magcal_fit
+ *                             prints the line.  Save with cal save.
+ *     baud <rate>             Back channel rate, up to 921600, after the reply
+ *     i2c budget              Magnetometer bus time per sample and bus load
+ *     i2c stats               Bus hang and recovery counters
+ *     log start|stop          Record samples to flash, as when disconnected
+ *     log dump|erase|stats    Send the flash log as telemetry frames, empty it
+ *     adc read                Latest supply, temperature and A0, see ADCAcquire.h
+ *
+ * Each line is answered with "OK" or "ERR".
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define COMMAND_WORD_MAX	49		// Longest word, a calset argument, plus one
+#define COMMAND_DIGITS_MAX	9		// Longest number, well inside an int32_t
+
+void Command_reset();
+void Command_parse(const uint8_t data[], uint16_t length);
+void Command_poll();
+bool Command_isCalibrating();
+
+#endif /* COMMAND_H_ */
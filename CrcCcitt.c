@@ -0,0 +1,54 @@
+/*
+ * CrcCcitt.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#include "CrcCcitt.h"
+
+//private functions
+// Feed the module, which is already seeded.  Words are assembled from bytes
+// so data needn't be aligned; the registers are written directly because
+// the driverlib calls would double the time per word.
+static void CrcCcitt_feed(const uint8_t *data, uint16_t length) {
+	for (; length >= 2; length -= 2, data += 2)
+		HWREG16(CRC_BASE + OFS_CRCDIRB) = ((uint16_t) data[0] << 8) | data[1];
+	if (length)
+		HWREG8(CRC_BASE + OFS_CRCDIRB_L) = *data;
+}
+
+//public functions
+void CrcCcitt_begin(CrcCcitt_State *s) {
+	s->crc = CRCCCITT_SEED;
+}
+
+/** Add a fragment to a running CRC.  Safe to call from an ISR. */
+void CrcCcitt_update(CrcCcitt_State *s, const uint8_t data[], uint16_t length) {
+	uint16_t sr;
+	uint16_t n;
+	while (length) {
+		n = (length < CRCCCITT_CHUNK) ? length : CRCCCITT_CHUNK;
+		sr = __get_SR_register();
+		__disable_interrupt();
+		CRC_setSeed(CRC_BASE, s->crc);
+		CrcCcitt_feed(data, n);
+		s->crc = CRC_getResult(CRC_BASE);
+		__bis_SR_register(sr & GIE);
+		data += n;
+		length -= n;
+	}
+}
+
+uint16_t CrcCcitt_result(const CrcCcitt_State *s) {
+	return s->crc;
+}
+
+/** CRC of one buffer. */
+uint16_t CrcCcitt_block(const uint8_t data[], uint16_t length) {
+	CrcCcitt_State s;
+	CrcCcitt_begin(&s);
+	CrcCcitt_update(&s, data, length);
+	return CrcCcitt_result(&s);
+}
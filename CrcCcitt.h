@@ -0,0 +1,40 @@
+/*
+ * CrcCcitt.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * CRC16-CCITT over buffers on the CRC module: poly 0x1021, seed 0xFFFF,
+ * MSB first, no final XOR, so "123456789" -> 0x29B1.  This is the check on
+ * telemetry and trace frames, the stored calibration and flash log entries,
+ * and what tools/telemetry_decode.c computes in software.
+ *
+ * Bytes go in through CRCDIRB, whose bit reversal makes the module shift
+ * them MSB first; whole words are written byte swapped, two bytes a write.
+ * The CPU does the writing: all three DMA channels are taken (DMAService.h).
+ *
+ * A computation can be spread over any number of fragments: CrcCcitt_State
+ * carries the running value, and each CRCCCITT_CHUNK bytes are fed with
+ * interrupts off, the module seeded from the state first and read back
+ * after.  So an ISR may use the module between chunks, or run a CRC of its
+ * own, without either result being disturbed.
+ */
+
+#ifndef CRCCCITT_H_
+#define CRCCCITT_H_
+
+#include <stdint.h>
+
+#define CRCCCITT_SEED		0xFFFF
+#define CRCCCITT_CHUNK		64		// Bytes per interrupts-off run, about 12 us
+
+typedef struct CrcCcitt_State {
+	uint16_t crc;
+} CrcCcitt_State;
+
+void CrcCcitt_begin(CrcCcitt_State *s);
+void CrcCcitt_update(CrcCcitt_State *s, const uint8_t data[], uint16_t length);
+uint16_t CrcCcitt_result(const CrcCcitt_State *s);
+uint16_t CrcCcitt_block(const uint8_t data[], uint16_t length);
+
+#endif /* CRCCCITT_H_ */
@@ -0,0 +1,28 @@
+/*
+ * DMAService.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "DMAService.h"
+
+static DMAService_Handler handlers[DMASERVICE_CHANNELS];
+
+/** Install the completion handler for a channel.
+ * @param channelSelect DMA_CHANNEL_0 .. DMA_CHANNEL_2
+ * @param handler Function to run from the ISR, or 0 to ignore the channel
+ */
+void DMAService_setHandler(uint8_t channelSelect, DMAService_Handler handler) {
+	handlers[channelSelect >> 4] = handler;
+}
+
+#pragma vector = DMA_VECTOR
+__interrupt void DMAService_ISR(void) {
+	uint16_t channel = __even_in_range(DMAIV, 16) >> 1;
+	// Reading DMAIV cleared the flag; 0 means nothing was pending
+	if (channel == 0 || channel > DMASERVICE_CHANNELS)
+		return;
+	if (handlers[channel - 1] && handlers[channel - 1]())
+		__bic_SR_register_on_exit(LPM3_bits);
+}
@@ -0,0 +1,40 @@
+/*
+ * DMAService.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Owner of the shared DMA_VECTOR.  Each driver that uses a DMA channel
+ * registers a completion handler here instead of defining its own ISR.
+ */
+
+#ifndef DMASERVICE_H_
+#define DMASERVICE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DMASERVICE_CHANNELS			3		// DMA0-DMA2 on the F5529
+
+// Channel assignments, highest priority first.  ADCAcquire keeps its
+// channel armed, so CrcCcitt feeds the CRC module with the CPU.
+#define DMASERVICE_I2C_RX_CHANNEL	(DMA_CHANNEL_0)
+#define DMASERVICE_ADC_CHANNEL		(DMA_CHANNEL_1)
+#define DMASERVICE_UART_TX_CHANNEL	(DMA_CHANNEL_2)
+
+// Trigger sources (MSP430F5529 datasheet, DMA trigger assignments)
+#define DMASERVICE_TRIGGER_DMAREQ		(DMA_TRIGGERSOURCE_0)	// Software
+#define DMASERVICE_TRIGGER_UCA1RXIFG	(DMA_TRIGGERSOURCE_20)
+#define DMASERVICE_TRIGGER_UCA1TXIFG	(DMA_TRIGGERSOURCE_21)
+#define DMASERVICE_TRIGGER_UCB1RXIFG	(DMA_TRIGGERSOURCE_22)
+#define DMASERVICE_TRIGGER_UCB1TXIFG	(DMA_TRIGGERSOURCE_23)
+#define DMASERVICE_TRIGGER_ADC12IFG		(DMA_TRIGGERSOURCE_24)	// End of sequence
+
+/** Called from the DMA ISR when the channel's transfer completes.
+ * @return true to wake the main loop from low power mode
+ */
+typedef bool (*DMAService_Handler)(void);
+
+void DMAService_setHandler(uint8_t channelSelect, DMAService_Handler handler);
+
+#endif /* DMASERVICE_H_ */
@@ -0,0 +1,206 @@
+/*
+ * DeltaCodec.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include "DeltaCodec.h"
+
+#define CLASS_ZERO		0
+#define CLASS_NIBBLE	1
+#define CLASS_BYTE		2
+#define CLASS_VARINT	3
+#define VALUES			4		// x, y, z, timestamp step
+
+//private functions
+static uint32_t DeltaCodec_zigzag(int32_t v) {
+	return ((uint32_t) v << 1) ^ (uint32_t) (v >> 31);
+}
+
+static int32_t DeltaCodec_unzigzag(uint32_t v) {
+	return (int32_t) (v >> 1) ^ -(int32_t) (v & 1);
+}
+
+static uint8_t DeltaCodec_class(uint32_t v) {
+	if (v == 0)
+		return CLASS_ZERO;
+	if (v < 16)
+		return CLASS_NIBBLE;
+	if (v < 256)
+		return CLASS_BYTE;
+	return CLASS_VARINT;
+}
+
+static void DeltaCodec_put16(uint8_t *p, uint16_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+static uint16_t DeltaCodec_get16(const uint8_t *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+// Next byte of the block being decoded, false past the end
+static bool DeltaCodec_read(DeltaCodec_State *s, uint8_t *byte) {
+	if (s->length >= s->size)
+		return false;
+	*byte = s->block[s->length++];
+	return true;
+}
+
+//public functions
+/** Start a block in a caller's buffer.
+ * @param size Buffer capacity, at least DELTACODEC_KEY_SIZE
+ */
+void DeltaCodec_begin(DeltaCodec_State *s, uint8_t block[], uint16_t size) {
+	s->block = block;
+	s->size = size;
+	s->length = 0;
+	s->count = 0;
+	s->period = 0;
+}
+
+/** Encode a sample onto the block.
+ * @return false if it belongs in a new block: the block is full, has
+ * reached the keyframe interval or the gain has changed
+ */
+bool DeltaCodec_add(DeltaCodec_State *s, const HMC_Sample *sample) {
+	uint32_t v[VALUES];
+	uint8_t classes[VALUES];
+	uint8_t *p = &s->block[s->length];
+	uint8_t *tag;
+	bool half = false;
+	uint32_t step;
+	uint8_t i;
+
+	if (s->count == 0) {
+		if (s->size - s->length < DELTACODEC_KEY_SIZE)
+			return false;
+		DeltaCodec_put16(p, (uint16_t) sample->timestamp);
+		DeltaCodec_put16(p + 2, (uint16_t) (sample->timestamp >> 16));
+		DeltaCodec_put16(p + 4, sample->x);
+		DeltaCodec_put16(p + 6, sample->y);
+		DeltaCodec_put16(p + 8, sample->z);
+		p[10] = sample->gain;
+		s->length += DELTACODEC_KEY_SIZE;
+		s->count = 1;
+		s->last = *sample;
+		return true;
+	}
+	if (s->count == DELTACODEC_KEYFRAME_INTERVAL || sample->gain != s->last.gain
+			|| s->size - s->length < DELTACODEC_DELTA_MAX)
+		return false;
+
+	step = sample->timestamp - s->last.timestamp;
+	v[0] = DeltaCodec_zigzag((int32_t) sample->x - s->last.x);
+	v[1] = DeltaCodec_zigzag((int32_t) sample->y - s->last.y);
+	v[2] = DeltaCodec_zigzag((int32_t) sample->z - s->last.z);
+	v[3] = DeltaCodec_zigzag((int32_t) (step - s->period));
+	tag = p++;
+	*tag = 0;
+	for (i = 0; i < VALUES; i++) {
+		classes[i] = DeltaCodec_class(v[i]);
+		*tag = (*tag << 2) | classes[i];
+	}
+	for (i = 0; i < VALUES; i++) {
+		if (classes[i] != CLASS_NIBBLE)
+			continue;
+		if (half)
+			*p++ |= (uint8_t) v[i];
+		else
+			*p = (uint8_t) (v[i] << 4);
+		half = !half;
+	}
+	if (half)
+		p++;
+	for (i = 0; i < VALUES; i++)
+		if (classes[i] == CLASS_BYTE)
+			*p++ = (uint8_t) v[i];
+	for (i = 0; i < VALUES; i++) {
+		if (classes[i] != CLASS_VARINT)
+			continue;
+		while (v[i] >= 0x80) {
+			*p++ = (uint8_t) v[i] | 0x80;
+			v[i] >>= 7;
+		}
+		*p++ = (uint8_t) v[i];
+	}
+	s->length = p - s->block;
+	s->count++;
+	s->last = *sample;
+	s->period = step;
+	return true;
+}
+
+/** Start decoding a complete block. */
+void DeltaCodec_open(DeltaCodec_State *s, const uint8_t block[], uint16_t length) {
+	DeltaCodec_begin(s, (uint8_t *) block, length);
+}
+
+/** Decode the next sample.
+ * @return false at the end of the block, or if it is corrupt
+ */
+bool DeltaCodec_next(DeltaCodec_State *s, HMC_Sample *sample) {
+	const uint8_t *p = &s->block[s->length];
+	uint32_t v[VALUES];
+	uint8_t classes[VALUES];
+	uint8_t tag, byte = 0, shift;
+	bool half = false;
+	uint8_t i;
+
+	if (s->count == 0) {
+		if (s->size - s->length < DELTACODEC_KEY_SIZE)
+			return false;
+		s->last.timestamp = DeltaCodec_get16(p)
+				| ((uint32_t) DeltaCodec_get16(p + 2) << 16);
+		s->last.x = (int16_t) DeltaCodec_get16(p + 4);
+		s->last.y = (int16_t) DeltaCodec_get16(p + 6);
+		s->last.z = (int16_t) DeltaCodec_get16(p + 8);
+		s->last.gain = p[10];
+		s->length += DELTACODEC_KEY_SIZE;
+		s->count = 1;
+		*sample = s->last;
+		return true;
+	}
+	if (!DeltaCodec_read(s, &tag))
+		return false;
+	for (i = VALUES; i > 0; i--) {
+		classes[i - 1] = tag & 3;
+		tag >>= 2;
+		v[i - 1] = 0;
+	}
+	for (i = 0; i < VALUES; i++) {
+		if (classes[i] != CLASS_NIBBLE)
+			continue;
+		if (!half && !DeltaCodec_read(s, &byte))
+			return false;
+		v[i] = half ? byte & 0x0F : byte >> 4;
+		half = !half;
+	}
+	for (i = 0; i < VALUES; i++) {
+		if (classes[i] != CLASS_BYTE)
+			continue;
+		if (!DeltaCodec_read(s, &byte))
+			return false;
+		v[i] = byte;
+	}
+	for (i = 0; i < VALUES; i++) {
+		if (classes[i] != CLASS_VARINT)
+			continue;
+		shift = 0;
+		do {
+			if (shift > 28 || !DeltaCodec_read(s, &byte))
+				return false;
+			v[i] |= (uint32_t) (byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+	}
+	s->period += DeltaCodec_unzigzag(v[3]);
+	s->last.timestamp += s->period;
+	s->last.x += (int16_t) DeltaCodec_unzigzag(v[0]);
+	s->last.y += (int16_t) DeltaCodec_unzigzag(v[1]);
+	s->last.z += (int16_t) DeltaCodec_unzigzag(v[2]);
+	s->count++;
+	*sample = s->last;
+	return true;
+}
@@ -0,0 +1,60 @@
+/*
+ * DeltaCodec.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Streaming compression for magnetometer samples.  At our data rates
+ * consecutive readings differ by a few counts, so instead of six bytes of
+ * X, Y and Z each sample is sent as its difference from the one before.
+ * Samples are grouped in blocks that decode on their own: a block opens
+ * with a keyframe,
+ *
+ *     timestamp u32, x i16, y i16, z i16, gain u8       (little-endian)
+ *
+ * and every later sample is a tag byte and the zig-zag coded differences
+ * of x, y, z and of the timestamp step (so a steady data rate costs
+ * nothing).  The tag holds two bits per value, x in bits 7-6 down to time
+ * in bits 1-0:
+ *
+ *     0  unchanged, no bytes
+ *     1  below 16, a nibble; nibbles are packed two to a byte, high first
+ *     2  below 256, one byte, after the nibbles
+ *     3  LEB128 varint, after the bytes
+ *
+ * A sample that doesn't change by more than 7 counts on any axis takes two
+ * or three bytes.  A block ends, and the next keyframe starts, every
+ * DELTACODEC_KEYFRAME_INTERVAL samples, when the gain changes or when the
+ * block buffer is full, which bounds how much a lost block costs.  The
+ * block length is carried by whatever frames or stores the block.
+ *
+ * This is plain C with no driverlib, so the host tools build it as is.
+ */
+
+#ifndef DELTACODEC_H_
+#define DELTACODEC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "HMCAcquire.h"
+
+#define DELTACODEC_KEY_SIZE				11		// Keyframe bytes
+#define DELTACODEC_DELTA_MAX			15		// Tag, 3 x 3 byte and a 5 byte varint
+#define DELTACODEC_KEYFRAME_INTERVAL	32		// Samples per block, at most
+
+/** Encoder or decoder position in one block. */
+typedef struct DeltaCodec_State {
+	uint8_t *block;
+	uint16_t size;					// Encoder: capacity, decoder: length
+	uint16_t length;				// Bytes written or read so far
+	uint8_t count;					// Samples in the block so far
+	HMC_Sample last;
+	uint32_t period;				// Last timestamp step
+} DeltaCodec_State;
+
+void DeltaCodec_begin(DeltaCodec_State *s, uint8_t block[], uint16_t size);
+bool DeltaCodec_add(DeltaCodec_State *s, const HMC_Sample *sample);
+void DeltaCodec_open(DeltaCodec_State *s, const uint8_t block[], uint16_t length);
+bool DeltaCodec_next(DeltaCodec_State *s, HMC_Sample *sample);
+
+#endif /* DELTACODEC_H_ */
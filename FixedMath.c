@@ -0,0 +1,266 @@
+/*
+ * FixedMath.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#if (defined(__MSP430__) || defined(DRIVERLIB_HOST_SIM)) && !defined(FIXEDMATH_PORTABLE)
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#define FIXEDMATH_MPY32
+#define MPY32(reg)		HWREG16(MPY32_BASE + OFS_##reg)
+#endif
+#include "FixedMath.h"
+
+#define Q31_MIN			(-FIXEDMATH_Q31_ONE - 1)
+
+#ifdef FIXEDMATH_MPY32
+// Writes wait for the last 64-bit result, so a MAC can follow a MAC
+#define MODE_INTEGER	(MPYDLYWRTEN | MPYDLY32)
+#define MODE_FRACTION	(MPYDLYWRTEN | MPYDLY32 | MPYFRAC | MPYSAT)
+#define MODE_MASK		(MPYDLYWRTEN | MPYDLY32 | MPYFRAC | MPYSAT)
+
+typedef struct FixedMath_Hold {
+	uint16_t sr;
+	uint16_t control;
+} FixedMath_Hold;
+#endif
+
+//private functions
+#ifdef FIXEDMATH_MPY32
+static void FixedMath_enter(FixedMath_Hold *hold, uint16_t mode) {
+	hold->sr = __get_SR_register();
+	__disable_interrupt();
+	hold->control = MPY32(MPY32CTL0);
+	MPY32(MPY32CTL0) = (hold->control & ~MODE_MASK) | mode;
+}
+
+static void FixedMath_leave(const FixedMath_Hold *hold) {
+	MPY32(MPY32CTL0) = hold->control;
+	__bis_SR_register(hold->sr & GIE);
+}
+
+static void FixedMath_preload(int64_t value) {
+	MPY32(RES0) = (uint16_t) value;
+	MPY32(RES1) = (uint16_t) (value >> 16);
+	MPY32(RES2) = (uint16_t) (value >> 32);
+	MPY32(RES3) = (uint16_t) (value >> 48);
+}
+
+// The whole accumulator.  SLAU208 has the top word of a 32-bit product
+// seven cycles after the OP2 write, two more than the write and the first
+// read take.
+static int64_t FixedMath_result() {
+	__delay_cycles(2);
+	return (int64_t) ((uint64_t) MPY32(RES0)
+			| ((uint64_t) MPY32(RES1) << 16)
+			| ((uint64_t) MPY32(RES2) << 32)
+			| ((uint64_t) MPY32(RES3) << 48));
+}
+
+// a * b added to all 64 bits of the accumulator: a goes in as 32 bits so
+// the sum is kept 64 bits wide
+static void FixedMath_mac(int32_t a, int16_t b) {
+	MPY32(MACS32L) = (uint16_t) a;
+	MPY32(MACS32H) = (uint16_t) (a >> 16);
+	MPY32(OP2) = (uint16_t) b;
+}
+#endif
+
+// Integer square root, rounded down
+static uint16_t FixedMath_sqrt32(uint32_t value) {
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+	while (bit > value)
+		bit >>= 2;
+	while (bit) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return (uint16_t) root;
+}
+
+//public functions
+int16_t FixedMath_saturate16(int32_t value) {
+	if (value > 32767)
+		return 32767;
+	if (value < -32768)
+		return -32768;
+	return (int16_t) value;
+}
+
+int32_t FixedMath_saturate32(int64_t value) {
+	if (value > FIXEDMATH_Q31_ONE)
+		return FIXEDMATH_Q31_ONE;
+	if (value < Q31_MIN)
+		return Q31_MIN;
+	return (int32_t) value;
+}
+
+int16_t FixedMath_add15(int16_t a, int16_t b) {
+	return FixedMath_saturate16((int32_t) a + b);
+}
+
+int16_t FixedMath_sub15(int16_t a, int16_t b) {
+	return FixedMath_saturate16((int32_t) a - b);
+}
+
+int32_t FixedMath_add31(int32_t a, int32_t b) {
+	return FixedMath_saturate32((int64_t) a + b);
+}
+
+int32_t FixedMath_sub31(int32_t a, int32_t b) {
+	return FixedMath_saturate32((int64_t) a - b);
+}
+
+/** Q15 product, rounded to nearest, -1 * -1 saturating to FIXEDMATH_Q15_ONE. */
+int16_t FixedMath_mul15(int16_t a, int16_t b) {
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	int16_t result;
+	FixedMath_enter(&hold, MODE_FRACTION);
+	MPY32(RESLO) = 0x8000;			// Half an LSB of RESHI
+	MPY32(RESHI) = 0;
+	MPY32(MACS) = (uint16_t) a;
+	MPY32(OP2) = (uint16_t) b;
+	result = (int16_t) MPY32(RESHI);	// Saturated as it is read
+	FixedMath_leave(&hold);
+	return result;
+#else
+	return (int16_t) (FixedMath_saturate32(2 * (int64_t) a * b + 0x8000L) >> 16);
+#endif
+}
+
+/** Q31 product, rounded to nearest, -1 * -1 saturating to FIXEDMATH_Q31_ONE. */
+int32_t FixedMath_mul31(int32_t a, int32_t b) {
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	int32_t result;
+	FixedMath_enter(&hold, MODE_FRACTION);
+	FixedMath_preload(0x80000000LL);
+	MPY32(MACS32L) = (uint16_t) a;
+	MPY32(MACS32H) = (uint16_t) (a >> 16);
+	MPY32(OP2L) = (uint16_t) b;
+	MPY32(OP2H) = (uint16_t) (b >> 16);
+	__delay_cycles(2);
+	result = (int32_t) ((uint32_t) MPY32(RES2) | ((uint32_t) MPY32(RES3) << 16));
+	FixedMath_leave(&hold);
+	return result;
+#else
+	if (a == Q31_MIN && b == Q31_MIN)
+		return FIXEDMATH_Q31_ONE;
+	return (int32_t) (((int64_t) a * b * 2 + 0x80000000LL) >> 32);
+#endif
+}
+
+/** acc + a * b, for Q15 a and b and a Q31 acc, saturated. */
+int32_t FixedMath_mac15(int32_t acc, int16_t a, int16_t b) {
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	int64_t sum;
+	FixedMath_enter(&hold, MODE_FRACTION);
+	FixedMath_preload(acc);
+	FixedMath_mac(a, b);
+	sum = FixedMath_result();
+	FixedMath_leave(&hold);
+	return FixedMath_saturate32(sum);
+#else
+	return FixedMath_saturate32(acc + 2 * (int64_t) a * b);
+#endif
+}
+
+/** Sum of a[i] * b[i], Q15 in, Q31 out, saturated once at the end. */
+int32_t FixedMath_dot15(const int16_t a[], const int16_t b[], uint16_t n) {
+	int64_t sum = 0;
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	uint16_t i, end;
+	for (i = 0; i < n; i = end) {
+		end = (n - i > FIXEDMATH_CHUNK) ? i + FIXEDMATH_CHUNK : n;
+		FixedMath_enter(&hold, MODE_FRACTION);
+		FixedMath_preload(sum);
+		for (; i < end; i++)
+			FixedMath_mac(a[i], b[i]);
+		sum = FixedMath_result();
+		FixedMath_leave(&hold);
+	}
+#else
+	uint16_t i;
+	for (i = 0; i < n; i++)
+		sum += 2 * (int64_t) a[i] * b[i];
+#endif
+	return FixedMath_saturate32(sum);
+}
+
+/** out = m v for a Q15 row-major matrix and a vector in any units,
+ * rounded to nearest and saturated.  out may be v.
+ */
+void FixedMath_matVec3(const int16_t m[9], const int16_t v[3], int16_t out[3]) {
+	int64_t sum[3];
+	uint8_t r;
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	FixedMath_enter(&hold, MODE_FRACTION);
+	for (r = 0; r < 3; r++, m += 3) {
+		FixedMath_preload(0x8000);	// Half an LSB of RES1
+		FixedMath_mac(m[0], v[0]);
+		FixedMath_mac(m[1], v[1]);
+		FixedMath_mac(m[2], v[2]);
+		sum[r] = FixedMath_result();
+	}
+	FixedMath_leave(&hold);
+#else
+	for (r = 0; r < 3; r++, m += 3)
+		sum[r] = 0x8000 + 2 * ((int64_t) m[0] * v[0] + (int32_t) m[1] * v[1]
+				+ (int32_t) m[2] * v[2]);
+#endif
+	for (r = 0; r < 3; r++)
+		out[r] = FixedMath_saturate16((int32_t) (sum[r] >> 16));
+}
+
+/** Length of a vector, in its own units, rounded down. */
+uint16_t FixedMath_norm3(const int16_t v[3]) {
+	uint32_t squares;
+#ifdef FIXEDMATH_MPY32
+	FixedMath_Hold hold;
+	FixedMath_enter(&hold, MODE_INTEGER);
+	FixedMath_preload(0);
+	FixedMath_mac(v[0], v[0]);
+	FixedMath_mac(v[1], v[1]);
+	FixedMath_mac(v[2], v[2]);
+	squares = (uint32_t) FixedMath_result();
+	FixedMath_leave(&hold);
+#else
+	squares = (uint32_t) ((int32_t) v[0] * v[0]) + (uint32_t) ((int32_t) v[1] * v[1])
+			+ (uint32_t) ((int32_t) v[2] * v[2]);
+#endif
+	return FixedMath_sqrt32(squares);
+}
+
+/** Keep the multiplier state of the code an ISR interrupted.  Call with
+ * interrupts off, as in the ISR, before its first multiply.
+ */
+void FixedMath_save(FixedMath_Context *context) {
+#ifdef FIXEDMATH_MPY32
+	context->control = MPY32(MPY32CTL0);
+	context->result[0] = MPY32(RES0);
+	context->result[1] = MPY32(RES1);
+	context->result[2] = MPY32(RES2);
+	context->result[3] = MPY32(RES3);
+#endif
+}
+
+/** Put back what FixedMath_save() kept, after the ISR's last multiply. */
+void FixedMath_restore(const FixedMath_Context *context) {
+#ifdef FIXEDMATH_MPY32
+	MPY32(RES0) = context->result[0];
+	MPY32(RES1) = context->result[1];
+	MPY32(RES2) = context->result[2];
+	MPY32(RES3) = context->result[3];
+	MPY32(MPY32CTL0) = context->control;
+#endif
+}
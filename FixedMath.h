@@ -0,0 +1,65 @@
+/*
+ * FixedMath.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Q15 and Q31 arithmetic for the sensor path on the 32-bit hardware
+ * multiplier.  Q15 is an int16_t holding value * 32768, Q31 an int32_t
+ * holding value * 2^31; both run from -1 up to just under 1.
+ *
+ * On the target each call drives MPY32 directly:
+ *   - a single product uses fractional mode, which shifts the product left
+ *     one place so the result is already Q15 (RESHI) or Q31 (RES3:RES2),
+ *     and saturation mode, which reads -1 * -1 back as the largest positive
+ *     value rather than -1;
+ *   - sums of products accumulate in all 64 bits of RES0-RES3 with the
+ *     operands written 32 bits wide, so no intermediate can overflow.
+ *     Saturation mode only changes how the result registers read, so it
+ *     can't help there; the sum is saturated once, at the end.
+ * Rounding is done by preloading the result registers with half an LSB.
+ * Built without the multiplier (host tools, or FIXEDMATH_PORTABLE) the
+ * same calls run in plain C and give bit-identical results.
+ *
+ * Each call runs with interrupts off and puts MPY32CTL0 back the way it
+ * found it, so ISRs may use this too, and the compiler's own multiplies,
+ * which expect fractional and saturation mode off, are undisturbed.  Long
+ * dot products are done FIXEDMATH_CHUNK terms at a time.  Code that drives
+ * MPY32 itself with interrupts on, across several operations, and an ISR
+ * that does the same, should bracket the ISR's use with FixedMath_save()
+ * and FixedMath_restore().
+ */
+
+#ifndef FIXEDMATH_H_
+#define FIXEDMATH_H_
+
+#include <stdint.h>
+
+#define FIXEDMATH_Q15_ONE		32767			// Nearest to 1.0
+#define FIXEDMATH_Q31_ONE		0x7FFFFFFFL
+#define FIXEDMATH_CHUNK			16				// Terms per interrupts-off run
+
+/** What an ISR has to put back: mode, and the accumulator it clobbers.
+ * SUMEXT is read-only and isn't restored.
+ */
+typedef struct FixedMath_Context {
+	uint16_t control;				// MPY32CTL0
+	uint16_t result[4];				// RES0-RES3
+} FixedMath_Context;
+
+int16_t FixedMath_saturate16(int32_t value);
+int32_t FixedMath_saturate32(int64_t value);
+int16_t FixedMath_add15(int16_t a, int16_t b);
+int16_t FixedMath_sub15(int16_t a, int16_t b);
+int32_t FixedMath_add31(int32_t a, int32_t b);
+int32_t FixedMath_sub31(int32_t a, int32_t b);
+int16_t FixedMath_mul15(int16_t a, int16_t b);
+int32_t FixedMath_mul31(int32_t a, int32_t b);
+int32_t FixedMath_mac15(int32_t acc, int16_t a, int16_t b);
+int32_t FixedMath_dot15(const int16_t a[], const int16_t b[], uint16_t n);
+void FixedMath_matVec3(const int16_t m[9], const int16_t v[3], int16_t out[3]);
+uint16_t FixedMath_norm3(const int16_t v[3]);
+void FixedMath_save(FixedMath_Context *context);
+void FixedMath_restore(const FixedMath_Context *context);
+
+#endif /* FIXEDMATH_H_ */
@@ -0,0 +1,283 @@
+/*
+ * FlashLog.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "BCUart.h"
+#include "BackChannel.h"
+#include "CrcCcitt.h"
+#include "DeltaCodec.h"
+#include "FlashLog.h"
+#include "Heading.h"
+#include "Telemetry.h"
+#include "Timebase.h"
+
+#define SEGMENT(n)		((FlashLog_Segment *) (FLASHLOG_START + (n) * FLASHLOG_SEGMENT_SIZE))
+#define NEXT(n)			(((n) + 1) % FLASHLOG_SEGMENTS)
+#define PADDED(n)		(((n) + 3) & ~3)	// Entries are written a long-word at a time
+#define OFFSET_SAMPLES	1
+#define OFFSET_BLOCK	2
+#define OVERHEAD		(OFFSET_BLOCK + 2)	// Prefix and CRC
+
+static uint8_t head;				// Segment being written
+static uint16_t used;				// Data bytes in it, FLASHLOG_DATA_SIZE when full
+static bool spareReady;				// Segment after the head is erased
+static uint16_t sequence;			// Of the head segment
+static bool recording = false;
+static FlashLog_Stats stats;
+static uint32_t entry[FLASHLOG_ENTRY_MAX / 4];	// Built in RAM, long-word aligned
+static DeltaCodec_State codec;
+static uint32_t blockTime;			// First sample in the RAM block
+
+//private functions
+static bool FlashLog_isValid(uint8_t n) {
+	return SEGMENT(n)->header.magic == FLASHLOG_MAGIC;
+}
+
+// Whether the entry at offset in a segment's data fits and passes its CRC
+static bool FlashLog_isIntact(const uint8_t *data, uint16_t offset) {
+	const uint8_t *entry = &data[offset];
+	const uint8_t *crc = &entry[OFFSET_BLOCK + entry[0]];
+	if (offset + OVERHEAD + entry[0] > FLASHLOG_DATA_SIZE)
+		return false;
+	return CrcCcitt_block(entry, OFFSET_BLOCK + entry[0])
+			== (uint16_t) (crc[0] | (crc[1] << 8));
+}
+
+// Walk a segment's entries, adding up the samples in the intact ones
+static uint16_t FlashLog_used(uint8_t n, uint16_t *samples, uint16_t *corrupt) {
+	const uint8_t *data = SEGMENT(n)->data;
+	uint16_t offset = 0;
+	*samples = 0;
+	*corrupt = 0;
+	while (offset + OVERHEAD < FLASHLOG_DATA_SIZE
+			&& data[offset] != FLASHLOG_END) {
+		if (!FlashLog_isIntact(data, offset))
+			(*corrupt)++;
+		else
+			*samples += data[offset + OFFSET_SAMPLES];
+		offset += PADDED(OVERHEAD + data[offset]);
+	}
+	return (offset < FLASHLOG_DATA_SIZE) ? offset : FLASHLOG_DATA_SIZE;
+}
+
+// Erase a segment, taking what it held out of the counts
+static void FlashLog_eraseSegment(uint8_t n) {
+	uint32_t start;
+	uint16_t time;
+	uint16_t samples, corrupt;
+	if (FlashLog_isValid(n)) {
+		stats.bytes -= FlashLog_used(n, &samples, &corrupt);
+		stats.samples -= samples;
+		stats.corrupt -= corrupt;
+	}
+	start = Timebase_now();
+	FLASH_segmentErase((uint8_t *) SEGMENT(n));
+	time = (uint16_t) (Timebase_now() - start);
+	stats.erases++;
+	stats.lastErase = time;
+	if (time > stats.maxErase)
+		stats.maxErase = time;
+}
+
+// Move the head on and start the segment with a header for time
+static void FlashLog_startSegment(uint32_t time) {
+	FlashLog_Header h;
+	head = NEXT(head);
+	if (!spareReady) {
+		stats.forced++;
+		FlashLog_eraseSegment(head);
+	}
+	spareReady = false;
+	sequence++;
+	h.magic = FLASHLOG_MAGIC;
+	h.sequence = sequence;
+	h.timestamp = time;
+	FLASH_write32((uint32_t *) &h, (uint32_t *) &SEGMENT(head)->header,
+			sizeof h / 4);
+	used = 0;
+}
+
+// Start a block sized to what is left of the head segment, or to a new
+// segment if too little is left
+static void FlashLog_open() {
+	uint16_t space = FLASHLOG_DATA_SIZE - used;
+	if (space < FLASHLOG_ENTRY_MIN)
+		space = FLASHLOG_DATA_SIZE;
+	if (space > FLASHLOG_ENTRY_MAX)
+		space = FLASHLOG_ENTRY_MAX;
+	DeltaCodec_begin(&codec, (uint8_t *) entry + OFFSET_BLOCK,
+			space - OVERHEAD);
+}
+
+//public functions
+/** Find the write head left by the last run. */
+void FlashLog_init() {
+	uint8_t n;
+	uint16_t samples, corrupt;
+	bool found = false;
+	stats.samples = 0;
+	stats.bytes = 0;
+	stats.corrupt = 0;
+	for (n = 0; n < FLASHLOG_SEGMENTS; n++) {
+		if (!FlashLog_isValid(n))
+			continue;
+		stats.bytes += FlashLog_used(n, &samples, &corrupt);
+		stats.samples += samples;
+		stats.corrupt += corrupt;
+		// The head is the valid segment its successor doesn't follow on from
+		if (!found && (!FlashLog_isValid(NEXT(n))
+				|| SEGMENT(NEXT(n))->header.sequence
+						!= (uint16_t) (SEGMENT(n)->header.sequence + 1))) {
+			head = n;
+			found = true;
+		}
+	}
+	if (found) {
+		sequence = SEGMENT(head)->header.sequence;
+		used = FlashLog_used(head, &samples, &corrupt);
+	} else {
+		head = FLASHLOG_SEGMENTS - 1;	// The first block starts segment 0
+		sequence = 0;
+		used = FLASHLOG_DATA_SIZE;
+	}
+	spareReady = FLASH_eraseCheck((uint8_t *) SEGMENT(NEXT(head)),
+			FLASHLOG_SEGMENT_SIZE) == STATUS_SUCCESS;
+	FlashLog_open();
+}
+
+void FlashLog_start() {
+	recording = true;
+}
+
+/** Stop recording and program what has been collected. */
+void FlashLog_stop() {
+	recording = false;
+	FlashLog_flush();
+}
+
+bool FlashLog_isRecording() {
+	return recording;
+}
+
+/** Whether the next segment the head moves to means erasing logged data.
+ * The spare after the head is already erased, so that is the segment after
+ * it; the last entry or two of the lap go unused.
+ */
+bool FlashLog_isFull() {
+	return FlashLog_isValid(NEXT(NEXT(head)));
+}
+
+/** Add a calibrated sample.  Usually that only encodes it into the RAM
+ * block; once per block the previous block is programmed, at 85 us a
+ * long-word with the CPU held, plus an erase when FlashLog_service()
+ * hasn't kept up.
+ */
+void FlashLog_append(const HMC_Sample *sample) {
+	if (!DeltaCodec_add(&codec, sample)) {
+		FlashLog_flush();
+		DeltaCodec_add(&codec, sample);
+	}
+	if (codec.count == 1)
+		blockTime = sample->timestamp;
+}
+
+/** Program the block being built, then start another. */
+void FlashLog_flush() {
+	uint8_t *bytes = (uint8_t *) entry;
+	uint16_t length = PADDED(OVERHEAD + codec.length);
+	uint16_t crc;
+	uint16_t i = OFFSET_BLOCK + codec.length;
+	if (codec.count) {
+		if (FLASHLOG_DATA_SIZE - used < length)
+			FlashLog_startSegment(blockTime);
+		bytes[0] = (uint8_t) codec.length;
+		bytes[OFFSET_SAMPLES] = codec.count;
+		crc = CrcCcitt_block(bytes, i);
+		bytes[i++] = (uint8_t) crc;
+		bytes[i++] = (uint8_t) (crc >> 8);
+		for (; i < length; i++)
+			bytes[i] = 0xFF;
+		FLASH_write32(entry, (uint32_t *) &SEGMENT(head)->data[used], length / 4);
+		used += length;
+		stats.bytes += length;
+		stats.samples += codec.count;
+	}
+	FlashLog_open();
+}
+
+/** Erase the segment ahead of the head if it isn't already.
+ * Call straight after a batch has been taken out of HMCAcquire, which gives
+ * the erase the longest run before the acquisition ring fills.
+ */
+void FlashLog_service() {
+	if (spareReady)
+		return;
+	FlashLog_eraseSegment(NEXT(head));
+	spareReady = true;
+}
+
+/** Send the log, oldest first, for tools/telemetry_decode.  In the delta
+ * telemetry format the stored blocks go out as they are, one frame each;
+ * otherwise each sample is sent as an ordinary binary frame.  Sends block
+ * rather than drop, so the dump runs at whatever the back channel baud
+ * rate allows; raise it first.  Sampling carries on meanwhile but nothing
+ * is logged and the acquisition ring will overrun.
+ * @return Samples sent
+ */
+uint16_t FlashLog_dump() {
+	const uint8_t *data;
+	DeltaCodec_State decoder;
+	HMC_Sample sample;
+	uint16_t sent = 0;
+	uint16_t offset, end, samples, corrupt;
+	uint8_t n = head;
+
+	FlashLog_flush();
+	bcUartSetTxPolicy(BC_TX_BLOCK);
+	BackChannel_WriteBytes((const uint8_t *) "", 1);	// Frame boundary after any ASCII output
+	do {
+		n = NEXT(n);
+		if (!FlashLog_isValid(n))
+			continue;
+		data = SEGMENT(n)->data;
+		end = FlashLog_used(n, &samples, &corrupt);
+		for (offset = 0; offset < end;
+				offset += PADDED(OVERHEAD + data[offset])) {
+			if (!FlashLog_isIntact(data, offset))
+				continue;
+			if (Telemetry_getFormat() == TELEMETRY_FORMAT_DELTA) {
+				Telemetry_sendBlock(&data[offset + OFFSET_BLOCK], data[offset]);
+				sent += data[offset + OFFSET_SAMPLES];
+				continue;
+			}
+			DeltaCodec_open(&decoder, &data[offset + OFFSET_BLOCK], data[offset]);
+			while (DeltaCodec_next(&decoder, &sample)) {
+				Telemetry_sendFrame(&sample, Heading_fromXY(sample.x, sample.y));
+				sent++;
+			}
+		}
+	} while (n != head);
+	bcUartSetTxPolicy(BC_TX_POLICY);
+	return sent;
+}
+
+/** Empty the log.  Holds the CPU for about 2 s. */
+void FlashLog_erase() {
+	uint8_t n;
+	for (n = 0; n < FLASHLOG_SEGMENTS; n++)
+		FlashLog_eraseSegment(n);
+	head = FLASHLOG_SEGMENTS - 1;
+	used = FLASHLOG_DATA_SIZE;
+	spareReady = true;
+	stats.samples = 0;
+	stats.bytes = 0;
+	stats.corrupt = 0;
+	FlashLog_open();
+}
+
+const FlashLog_Stats *FlashLog_getStats() {
+	return &stats;
+}
@@ -0,0 +1,93 @@
+/*
+ * FlashLog.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Circular sample log in main flash, for capture with nobody listening on
+ * the back channel.  The FLASHLOG region at the top of FLASH2 (bank D, see
+ * lnk_msp430f5529.cmd) is a ring of 512 byte segments.  Each segment starts
+ * with a header carrying a sequence number and the timestamp of its first
+ * sample, followed by DeltaCodec blocks, each in an entry of
+ *
+ *     length u8, samples u8, block, CRC16-CCITT u16, 0xFF padding to a long-word
+ *
+ * with the CRC over the bytes before it.  A length of 0xFF, erased flash,
+ * ends the segment.  An entry whose CRC fails, one cut short by a reset
+ * while it was being programmed, is skipped.  Samples are collected
+ * into a block in RAM and the block is programmed when DeltaCodec starts
+ * the next one, so a steady sample costs about 3 bytes of flash, and the
+ * flash is written in one burst per block.  The block being built
+ * is lost on a reset; FlashLog_flush() writes it out early.
+ *
+ * The write head moves round the ring, so every segment is erased once per
+ * lap.  The segment ahead of the head is kept erased: erasing stalls the
+ * CPU for up to 32 ms, so FlashLog_service() does it between sample batches
+ * rather than an append doing it when the head segment fills.  The oldest
+ * segment is lost to that erase once the ring has filled.  Only explicit
+ * recording goes round more than once: samples logged because nobody is
+ * listening stop at FlashLog_isFull(), so a board left on a passive
+ * terminal erases each segment once rather than once every few hours.
+ *
+ * On start-up the head is found again from the sequence numbers, so a reset
+ * or power loss costs only the samples not yet programmed.
+ */
+
+#ifndef FLASHLOG_H_
+#define FLASHLOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "HMCAcquire.h"
+
+#ifdef DRIVERLIB_HOST_SIM
+extern uint8_t Sim_flash[];				// tools/sim/sim_flash.c
+#define FLASHLOG_START			Sim_flash
+#else
+#define FLASHLOG_START			((uint8_t *) 0x1C400)	// FLASHLOG in the linker command file
+#endif
+#define FLASHLOG_SEGMENT_SIZE	512
+#define FLASHLOG_SEGMENTS		64
+#define FLASHLOG_DATA_SIZE		((uint16_t) (FLASHLOG_SEGMENT_SIZE - sizeof(FlashLog_Header)))
+#define FLASHLOG_ENTRY_MAX		128		// Entry bytes, block with its prefix and CRC
+#define FLASHLOG_ENTRY_MIN		16		// Smallest space worth starting a block in
+#define FLASHLOG_MAGIC			0x474C	// "LG"
+#define FLASHLOG_END			0xFF	// Entry length in erased flash
+
+typedef struct FlashLog_Header {
+	uint16_t magic;
+	uint16_t sequence;				// +1 per segment written
+	uint32_t timestamp;				// Of the first sample
+} FlashLog_Header;
+
+typedef struct FlashLog_Segment {
+	FlashLog_Header header;
+	uint8_t data[FLASHLOG_DATA_SIZE];
+} FlashLog_Segment;
+
+/** Log counters.  Erase times are in Timebase ticks, and are how long the
+ * CPU, and with it every interrupt, was held.
+ */
+typedef struct FlashLog_Stats {
+	uint16_t samples;				// In the log now, not counting the RAM block
+	uint16_t bytes;					// Flash they take
+	uint16_t corrupt;				// Entries skipped for a bad CRC
+	uint16_t erases;				// Since reset
+	uint16_t forced;				// Erases an append had to wait for
+	uint16_t lastErase;
+	uint16_t maxErase;
+} FlashLog_Stats;
+
+void FlashLog_init();
+void FlashLog_start();
+void FlashLog_stop();
+bool FlashLog_isRecording();
+bool FlashLog_isFull();
+void FlashLog_append(const HMC_Sample *sample);
+void FlashLog_flush();
+void FlashLog_service();
+uint16_t FlashLog_dump();
+void FlashLog_erase();
+const FlashLog_Stats *FlashLog_getStats();
+
+#endif /* FLASHLOG_H_ */
@@ -0,0 +1,256 @@
+/*
+ * Format.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <msp430.h>
+#include "Format.h"
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+//private functions
+// Writes the digits of value backwards, ending just before end.
+// Returns the first digit.
+static char *Format_digits16(char *end, uint16_t value) {
+	uint16_t quotient;
+	do {
+		// value / 10 for every 16-bit value: 0xCCCD / 2^19 is 1/10 to
+		// within 4e-7, so the product never crosses into the next integer
+		quotient = (uint16_t) (((uint32_t) value * 0xCCCDu) >> 19);
+		*--end = '0' + (char) (value - ((quotient << 3) + (quotient << 1)));
+		value = quotient;
+	} while (value);
+	return end;
+}
+
+static char *Format_digits32(char *end, uint32_t value) {
+	uint32_t low = 0;		// Eight BCD digits
+	uint16_t high = 0;		// The two above them
+	uint16_t carry;
+	uint8_t i;
+	if (value <= 0xFFFF)
+		return Format_digits16(end, (uint16_t) value);
+
+	// Double dabble: shift the binary value in from the top, doubling the
+	// BCD total with DADD each time
+	for (i = 32; !(value & 0x80000000UL); i--)
+		value <<= 1;
+	while (i--) {
+		carry = (low >= 0x50000000UL);	// Doubling overflows eight digits
+		high = __bcd_add_short(high, high) | carry;
+		low = __bcd_add_long(low, low) | (uint16_t) (value >> 31);
+		value <<= 1;
+	}
+	if (high) {
+		for (i = 0; i < 8; i++) {
+			*--end = '0' + (char) (low & 0x0F);
+			low >>= 4;
+		}
+		do {
+			*--end = '0' + (char) (high & 0x0F);
+			high >>= 4;
+		} while (high);
+		return end;
+	}
+	do {
+		*--end = '0' + (char) (low & 0x0F);
+		low >>= 4;
+	} while (low);
+	return end;
+}
+
+// Lays out sign, digits and decimal point; out must hold FORMAT_INT32_SIZE.
+static uint8_t Format_number(char out[], uint32_t magnitude, bool negative,
+		uint8_t decimals) {
+	char digits[FORMAT_INT32_SIZE];
+	char *end = &digits[sizeof digits];
+	char *start = Format_digits32(end, magnitude);
+	uint8_t n = 0;
+	uint8_t count = (uint8_t) (end - start);
+	if (negative)
+		out[n++] = '-';
+	if (decimals > 0 && decimals < 10) {
+		while (count <= decimals) {		// 5 with one decimal is "0.5"
+			*--start = '0';
+			count++;
+		}
+		while (count-- > decimals)
+			out[n++] = *start++;
+		out[n++] = '.';
+		count = decimals;
+	}
+	while (count--)
+		out[n++] = *start++;
+	out[n] = '\0';
+	return n;
+}
+
+static void Format_put(Format_Builder *b, char c) {
+	b->total++;
+	if (b->length + 1 >= b->size) {		// Keep room for the terminator
+		if (!b->flush || b->size < 2) {
+			b->truncated = true;
+			return;
+		}
+		b->flush(b->buffer, b->length);
+		b->length = 0;
+	}
+	b->buffer[b->length++] = c;
+}
+
+static void Format_putPadded(Format_Builder *b, const char *text, uint8_t length,
+		uint8_t width, char pad) {
+	if (pad == '0' && *text == '-' && length) {
+		Format_put(b, *text++);		// Zeros go after the sign
+		length--;
+		if (width)
+			width--;
+	}
+	while (width > length) {
+		Format_put(b, pad);
+		width--;
+	}
+	while (length--)
+		Format_put(b, *text++);
+}
+
+//public functions
+/** Write a value as decimal text followed by a terminator.
+ * @param out Room for FORMAT_INT16_SIZE characters
+ * @return Characters written, not counting the terminator
+ */
+uint8_t Format_uint16(char out[], uint16_t value) {
+	return Format_number(out, value, false, 0);
+}
+
+uint8_t Format_int16(char out[], int16_t value) {
+	// 0u - value gets 32768 right for -32768
+	return (value < 0) ? Format_number(out, (uint16_t) (0u - (uint16_t) value), true, 0)
+			: Format_number(out, (uint16_t) value, false, 0);
+}
+
+/** @param out Room for FORMAT_INT32_SIZE characters */
+uint8_t Format_uint32(char out[], uint32_t value) {
+	return Format_number(out, value, false, 0);
+}
+
+uint8_t Format_int32(char out[], int32_t value) {
+	return (value < 0) ? Format_number(out, 0UL - (uint32_t) value, true, 0)
+			: Format_number(out, (uint32_t) value, false, 0);
+}
+
+/** Write a fixed-point value, e.g. tenths of a degree with decimals = 1.
+ * @param out Room for FORMAT_INT32_SIZE characters
+ */
+uint8_t Format_fixed(char out[], int32_t value, uint8_t decimals) {
+	return (value < 0) ? Format_number(out, 0UL - (uint32_t) value, true, decimals)
+			: Format_number(out, (uint32_t) value, false, decimals);
+}
+
+/** Start building text in buffer.
+ * @param flush Called with the buffer contents each time it fills and from
+ * Format_end(), or 0 to keep everything in buffer and drop what won't fit
+ */
+void Format_begin(Format_Builder *builder, char buffer[], uint16_t size,
+		Format_Flush flush) {
+	builder->buffer = buffer;
+	builder->size = size;
+	builder->length = 0;
+	builder->total = 0;
+	builder->flush = flush;
+	builder->truncated = false;
+}
+
+void Format_append(Format_Builder *builder, const char *format, ...) {
+	va_list args;
+	va_start(args, format);
+	Format_vappend(builder, format, args);
+	va_end(args);
+}
+
+void Format_vappend(Format_Builder *builder, const char *format, va_list args) {
+	char number[FORMAT_INT32_SIZE];
+	const char *text;
+	uint8_t width, decimals, length;
+	bool isLong;
+	char pad;
+	uint16_t u;
+	int32_t value;
+
+	for (; *format; format++) {
+		if (*format != '%') {
+			Format_put(builder, *format);
+			continue;
+		}
+		format++;
+		pad = ' ';
+		if (*format == '0') {
+			pad = '0';
+			format++;
+		}
+		for (width = 0; *format >= '0' && *format <= '9'; format++)
+			width = width * 10 + (*format - '0');
+		decimals = 0;
+		if (*format == '.')
+			for (format++; *format >= '0' && *format <= '9'; format++)
+				decimals = decimals * 10 + (*format - '0');
+		isLong = (*format == 'l');
+		if (isLong)
+			format++;
+
+		switch (*format) {
+		case 'd':
+			value = isLong ? va_arg(args, long) : (int16_t) va_arg(args, int);
+			length = Format_fixed(number, value, decimals);
+			Format_putPadded(builder, number, length, width, pad);
+			break;
+		case 'u':
+			if (isLong)
+				length = Format_uint32(number, va_arg(args, unsigned long));
+			else
+				length = Format_uint16(number, (uint16_t) va_arg(args, unsigned int));
+			Format_putPadded(builder, number, length, width, pad);
+			break;
+		case 'x':
+			u = (uint16_t) va_arg(args, unsigned int);
+			length = 0;
+			do {
+				number[sizeof number - 1 - ++length] = hexDigits[u & 0x0F];
+				u >>= 4;
+			} while (u);
+			Format_putPadded(builder, &number[sizeof number - 1 - length], length,
+					width, pad);
+			break;
+		case 's':
+			text = va_arg(args, const char *);
+			for (length = 0; text[length] && length < 255; length++)
+				;
+			Format_putPadded(builder, text, length, width, ' ');
+			break;
+		case 'c':
+			Format_put(builder, (char) va_arg(args, int));
+			break;
+		case '%':
+			Format_put(builder, '%');
+			break;
+		case '\0':
+			return;			// Stray % at the end
+		default:
+			break;			// Unknown conversion, print nothing
+		}
+	}
+}
+
+/** Terminate the text and hand any remainder to the flush function.
+ * @return Characters produced in total; more than were kept if truncated
+ */
+uint16_t Format_end(Format_Builder *builder) {
+	if (builder->flush && builder->length) {
+		builder->flush(builder->buffer, builder->length);
+		builder->length = 0;
+	}
+	if (builder->size)
+		builder->buffer[builder->length] = '\0';
+	return builder->total;
+}
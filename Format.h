@@ -0,0 +1,57 @@
+/*
+ * Format.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Integer to text without division.  16-bit values are split into digits
+ * by multiplying with a reciprocal of ten (MPY32 does that in a few
+ * cycles); 32-bit values are converted to BCD with the DADD instruction.
+ * Everything writes into caller supplied buffers, nothing is allocated.
+ *
+ * Format_Builder adds a small printf on top, writing into a buffer or, when
+ * given a flush function, into a chunk that is handed on each time it fills
+ * (BackChannel_Printf() sends chunks straight to the TX ring).  Conversions:
+ *
+ *     %d %u    int16_t / uint16_t      %ld %lu  int32_t / uint32_t
+ *     %x       uint16_t in hex         %s %c %%
+ *
+ * An optional width pads on the left with spaces, or with zeros after a
+ * '0' flag.  A precision on %d or %ld prints a fixed-point value: %.1d of
+ * 1234 is "123.4".
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FORMAT_INT16_SIZE		7		// "-32768" and the terminator
+#define FORMAT_INT32_SIZE		13		// "-2147483648", a point, terminator
+
+typedef void (*Format_Flush)(const char data[], uint16_t length);
+
+typedef struct Format_Builder {
+	char *buffer;
+	uint16_t size;
+	uint16_t length;		// Characters in buffer
+	uint16_t total;			// Characters produced, flushed or not
+	Format_Flush flush;		// 0 to stop at the end of the buffer
+	bool truncated;
+} Format_Builder;
+
+uint8_t Format_uint16(char out[], uint16_t value);
+uint8_t Format_int16(char out[], int16_t value);
+uint8_t Format_uint32(char out[], uint32_t value);
+uint8_t Format_int32(char out[], int32_t value);
+uint8_t Format_fixed(char out[], int32_t value, uint8_t decimals);
+
+void Format_begin(Format_Builder *builder, char buffer[], uint16_t size,
+		Format_Flush flush);
+void Format_append(Format_Builder *builder, const char *format, ...);
+void Format_vappend(Format_Builder *builder, const char *format, va_list args);
+uint16_t Format_end(Format_Builder *builder);
+
+#endif /* FORMAT_H_ */
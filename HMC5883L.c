@@ -7,128 +7,72 @@
 #include <driverlib.h>
 #include "HMC5883L.h"
 #include "BackChannel.h"
+#include "I2CEngine.h"
+#include "HMCAcquire.h"
+#include "Trace.h"
 
 uint8_t R_Data[6];          // Rx data array
 uint8_t ReadTx[2];          // Request read data
 bool dataReady;
 
-//private functions
-bool I2C_masterSendMultiple(uint8_t hmcRegister, uint8_t txData[],
-		uint16_t txLength, uint32_t timeout) {
-	uint8_t byte = 0;
-	bool status = STATUS_SUCCESS;
-	if (txLength < 1)
-		return STATUS_FAIL;
-	USCI_B_I2C_setSlaveAddress(HMCI2C_BASE, HMC5883L_ADDRESS);
-	USCI_B_I2C_setMode(HMCI2C_BASE, USCI_B_I2C_TRANSMIT_MODE);
-	USCI_B_I2C_enableInterrupt(HMCI2C_BASE, USCI_B_I2C_TRANSMIT_INTERRUPT);
-	status &= USCI_B_I2C_masterMultiByteSendStartWithTimeout(HMCI2C_BASE,
-			hmcRegister, timeout);
-
-	while (status == STATUS_SUCCESS && txLength-- > 1)
-		status &= USCI_B_I2C_masterMultiByteSendNextWithTimeout(HMCI2C_BASE,
-				txData[byte++], timeout);
-	if (status == STATUS_SUCCESS)
-		status &= USCI_B_I2C_masterMultiByteSendFinishWithTimeout(HMCI2C_BASE,
-				txData[byte], timeout);
-	return status;
-}
-
-bool I2C_masterSendByte(uint8_t hmcRegister, uint8_t txData, uint32_t timeout) {
-	uint8_t data[1];
-	data[0] = txData;
-	return I2C_masterSendMultiple(hmcRegister, data, 1, timeout);
-}
+const I2CEngine_Device HMC_device = { HMCI2C_BASE, HMC5883L_ADDRESS, 1,
+		HMC5883L_I2C_SPEED };
 
 uint8_t mode;
 
-uint8_t I2C_masterReadMultiple(uint8_t hmcRegister, uint8_t rxData[],
-		uint16_t rxLength, uint32_t timeout) {
-	uint8_t byte = 0;
-	uint16_t passedInLength = rxLength;
-	if (rxLength < 1) {
-		if (BackChannel_Connected())
-			BackChannel_WriteLine("Bad length passed in.");
-		return STATUS_FAIL;
-	}
-
-	USCI_B_I2C_setMode(HMCI2C_BASE, USCI_B_I2C_TRANSMIT_MODE);
-	USCI_B_I2C_disableInterrupt(HMCI2C_BASE, USCI_B_I2C_RECEIVE_INTERRUPT);
-	USCI_B_I2C_enableInterrupt(HMCI2C_BASE, USCI_B_I2C_TRANSMIT_INTERRUPT);
-	if (USCI_B_I2C_masterMultiByteSendStartWithTimeout(HMCI2C_BASE, hmcRegister,
-			timeout) == STATUS_FAIL) {
-		if (BackChannel_Connected())
-			BackChannel_WriteLine("Sending register address to slave failed.");
-		return STATUS_FAIL;
-	}
-
-	USCI_B_I2C_setMode(HMCI2C_BASE, USCI_B_I2C_RECEIVE_MODE);
-	USCI_B_I2C_disableInterrupt(HMCI2C_BASE, USCI_B_I2C_TRANSMIT_INTERRUPT);
-	USCI_B_I2C_enableInterrupt(HMCI2C_BASE, USCI_B_I2C_RECEIVE_INTERRUPT);
-	USCI_B_I2C_masterMultiByteReceiveStart(HMCI2C_BASE);   //Not sure if needed
-	while (rxLength > 1) {
-		rxLength--;
-		while (~USCI_B_I2C_RECEIVE_INTERRUPT & UCRXIFG)
-			;
-		rxData[byte++] = USCI_B_I2C_masterMultiByteReceiveNext(HMCI2C_BASE);
-	}
-	while (~USCI_B_I2C_RECEIVE_INTERRUPT & UCRXIFG)
-		;
-	if (USCI_B_I2C_masterMultiByteReceiveFinishWithTimeout(
-	HMCI2C_BASE, (uint8_t *) (*rxData + byte), timeout) == STATUS_SUCCESS) {
-		rxLength = passedInLength;
-		return rxLength;
-	}
+//private functions
+// DMA moves the bytes; we sleep in LPM0 until the burst is done
+static bool HMC_readRegisters(uint8_t hmcRegister, uint8_t rxData[],
+		uint16_t rxLength) {
+	if (I2CEngine_read(&HMC_device, hmcRegister, rxData, rxLength)
+			== STATUS_SUCCESS)
+		return STATUS_SUCCESS;
 	if (BackChannel_Connected())
-		BackChannel_WriteLine("Final recieve byte failed.");
+		BackChannel_WriteLine("Read from slave failed.");
 	return STATUS_FAIL;
 }
 
-uint8_t I2C_masterReadByte(uint8_t hmcRegister, uint32_t timeout) {
-	uint8_t b;
-	bool ret = I2C_masterReadMultiple(hmcRegister, &b, 1, timeout);
-	if (ret == STATUS_FAIL) {
-		if (BackChannel_Connected())
-			BackChannel_WriteLine("Read byte failed.");
-		return STATUS_FAIL;
-	}
-	return b;
-}
-
-bool I2C_masterWriteBits(uint8_t hmcRegister, uint8_t bitStart, uint8_t length,
-		uint8_t data, uint32_t timeout) {
-	uint8_t b;
-	b = I2C_masterReadByte(hmcRegister, timeout);
+// RAM copy of CONFIG_A, CONFIG_B and MODE, indexed by register address.
+// Every HMC_get* is served from here and HMC_set* only writes, so changing a
+// setting never costs an I2C read.
+static uint8_t shadow[3] = { 0x10, 0x20, 0x01 };	// Power-on defaults
+static uint8_t shadowDirty = 0;		// Bit n set: shadow[n] not yet written
+static bool shadowDeferred = false;	// Between HMC_beginConfig/commitConfig
+
+/** Update a bit field of a shadowed register.
+ * The change is written immediately unless HMC_beginConfig() is in effect,
+ * in which case it waits for HMC_commitConfig().
+ * @param regAddr HMC5883L_RA_CONFIG_A, HMC5883L_RA_CONFIG_B or HMC5883L_RA_MODE
+ * @param bitStart First bit position to write (0-7)
+ * @param length Number of bits to write (not more than 8)
+ * @param data Right-aligned value to write
+ * @return Status of the write (always success while deferred)
+ */
+bool HMC_writeShadowBits(uint8_t regAddr, uint8_t bitStart, uint8_t length,
+		uint8_t data) {
 	uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
 	data <<= (bitStart - length + 1); // shift data into correct position
-	data &= mask; // zero all non-important bits in data
-	b &= ~(mask); // zero all important bits in existing byte
-	b |= data; // combine data with existing byte
-	return I2C_masterSendByte(hmcRegister, b, timeout);
+	shadow[regAddr] = (shadow[regAddr] & ~mask) | (data & mask);
+	shadowDirty |= 1 << regAddr;
+	if (shadowDeferred)
+		return STATUS_SUCCESS;
+	return HMC_commitConfig();
 }
 
-/** Read multiple bits from an 8-bit device register.
- * @param devAddr I2C slave device address
- * @param regAddr Register regAddr to read from
+/** Read a bit field of a shadowed register.
+ * @param regAddr HMC5883L_RA_CONFIG_A, HMC5883L_RA_CONFIG_B or HMC5883L_RA_MODE
  * @param bitStart First bit position to read (0-7)
  * @param length Number of bits to read (not more than 8)
- * @param data Container for right-aligned value (i.e. '101' read from any bitStart position will equal 0x05)
- * @param timeout Optional read timeout in milliseconds (0 to disable, leave off to use default class value in I2Cdev::readTimeout)
- * @return Status of read operation (true = success)
+ * @return Right-aligned value (i.e. '101' read from any bitStart position will equal 0x05)
  */
-int8_t I2C_masterReadBits(uint8_t regAddr, uint8_t bitStart, uint8_t length,
-		uint8_t *data, uint16_t timeout) {
+uint8_t HMC_readShadowBits(uint8_t regAddr, uint8_t bitStart, uint8_t length) {
 	// 01101001 read byte
 	// 76543210 bit numbers
 	//    xxx   args: bitStart=4, length=3
 	//    010   masked
 	//   -> 010 shifted
-	uint8_t b = I2C_masterReadByte(regAddr, 100000);
 	uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
-	b &= mask;
-	b >>= (bitStart - length + 1);
-	*data = b;
-	return STATUS_SUCCESS;
+	return (shadow[regAddr] & mask) >> (bitStart - length + 1);
 }
 
 typedef bool (*configFunctionType)(uint8_t);
@@ -138,7 +82,7 @@ bool HMC_ConfigureAndCheck(configFunctionType * configFunctions, uint8_t * args,
 	bool status = STATUS_SUCCESS;
 	uint8_t i;
 	for (i = 0; i < length; i++) {
-		status &= (*configFunctions)(*args++);
+		status &= configFunctions[i](*args++);
 		if (status)
 			continue;
 		else {
@@ -161,7 +105,7 @@ bool HMC_initialize() {
 //	if (HMCI2C_BASE == USCI_B1_BASE) {
 //		P4DIR |= BIT1 + BIT2;         // Assign I2C pins to USCI_B1
 //		P4OUT = (BIT1 + BIT2);
-		P4SEL |= BIT1 + BIT2;         // Assign I2C pins to USCI_B1
+	//		P4SEL |= BIT1 + BIT2;         // Assign I2C pins to USCI_B1
 //	}
 //	if (HMCI2C_BASE == USCI_B0_BASE) {
 //		P3DIR = 0xFF;         // |= BIT1 + BIT2;
@@ -172,10 +116,8 @@ bool HMC_initialize() {
 	P2IE |= BIT6;
 	P2IES |= BIT6;
 
-	//Initialize I2C to 100khz master mode
-	USCI_B_I2C_masterInit(HMCI2C_BASE, USCI_B_I2C_CLOCKSOURCE_SMCLK,
-			UCS_getSMCLK(), USCI_B_I2C_SET_DATA_RATE_100KBPS);
-	USCI_B_I2C_enable(HMCI2C_BASE);
+	// HMCI2C_BASE is shared, main brings it up with I2CEngine_initBus()
+	I2CEngine_onRecovery(HMCI2C_BASE, HMC_replayConfig);
 
 	//Initialize the settings of the HMC5883
 	ReadTx[0] = 0x02;
@@ -187,16 +129,15 @@ bool HMC_initialize() {
 	R_Data[4] = 0;
 	R_Data[5] = 0; //define array for data receive
 
-	//Send configuration data
-//	HMC_setSampleAveraging(2);
-//	HMC_setDataRate(75);
-//	HMC_setMeasurementBias(0);
-//	HMC_setGain(5);
-	//I2C_masterSendMultiple(HMC5883L_RA_CONFIG_A, powerOn, 4, 10000);
+	//Send configuration data as one write of CONFIG_A, CONFIG_B and MODE
 	configFunctionType initFunctions[] = { *HMC_setSampleAveraging,
-			*HMC_setDataRate, *HMC_setMeasurementBias, *HMC_setGain };
-	uint8_t funcArgs[] = { 2, 75, 0, 5 };
-	if (HMC_ConfigureAndCheck(initFunctions, funcArgs, 4) == STATUS_SUCCESS) {
+			*HMC_setDataRate, *HMC_setMeasurementBias, *HMC_setGain,
+			*HMC_setMode };
+	uint8_t funcArgs[] = { HMC5883L_AVERAGING_4, HMC5883L_RATE_75,
+			HMC5883L_BIAS_NORMAL, HMC5883L_GAIN_390, HMC5883L_MODE_CONTINUOUS };
+	HMC_beginConfig();
+	if (HMC_ConfigureAndCheck(initFunctions, funcArgs, 5) == STATUS_SUCCESS
+			&& HMC_commitConfig() == STATUS_SUCCESS) {
 		while (!dataReady)
 			LPM0; //Wait for dataReady
 		return STATUS_SUCCESS;
@@ -207,15 +148,80 @@ bool HMC_initialize() {
 
 }
 
+/** Hold back configuration writes.
+ * HMC_set* calls after this only update the shadow registers. The pending
+ * changes go out together in HMC_commitConfig().
+ */
+void HMC_beginConfig() {
+	shadowDeferred = true;
+}
+
+/** Write all pending configuration changes in one I2C transaction.
+ * The write starts at the lowest changed register and relies on the
+ * HMC5883L address pointer auto-incrementing through CONFIG_A..MODE.
+ * @return Status of the write; changes stay pending if it fails
+ */
+bool HMC_commitConfig() {
+	uint8_t first = HMC5883L_RA_CONFIG_A;
+	uint8_t last = HMC5883L_RA_MODE;
+	shadowDeferred = false;
+	if (!shadowDirty)
+		return STATUS_SUCCESS;
+	while (!(shadowDirty & (1 << first)))
+		first++;
+	while (!(shadowDirty & (1 << last)))
+		last--;
+	if (I2CEngine_write(&HMC_device, first, &shadow[first], last - first + 1)
+			== STATUS_FAIL) {
+		if (BackChannel_Connected())
+			BackChannel_WriteLine("HMC_commitConfig Failed.");
+		return STATUS_FAIL;
+	}
+	shadowDirty = 0;
+	return STATUS_SUCCESS;
+}
+
+/** Reload the shadow registers from the device.
+ * Use when the device may have been reset behind our back (brown-out,
+ * hot-plug). Discards any uncommitted changes.
+ * @return Status of the read
+ */
+bool HMC_resyncConfig() {
+	uint8_t regs[3];
+	if (HMC_readRegisters(HMC5883L_RA_CONFIG_A, regs, 3) == STATUS_FAIL)
+		return STATUS_FAIL;
+	shadow[HMC5883L_RA_CONFIG_A] = regs[0];
+	shadow[HMC5883L_RA_CONFIG_B] = regs[1];
+	shadow[HMC5883L_RA_MODE] = regs[2] & 0x03;	// Bits 7-2 must be written as zero
+	mode = shadow[HMC5883L_RA_MODE];
+	shadowDirty = 0;
+	return STATUS_SUCCESS;
+}
+
+/** Write the whole shadow back to the device and restart acquisition.
+ * Registered as the I2C recovery hook, since a device that held the bus
+ * may also have been reset to its power-on configuration.
+ * @return Status of the write
+ */
+bool HMC_replayConfig() {
+	shadowDeferred = false;
+	shadowDirty = (1 << HMC5883L_RA_CONFIG_A) | (1 << HMC5883L_RA_CONFIG_B)
+			| (1 << HMC5883L_RA_MODE);
+	if (HMC_commitConfig() == STATUS_FAIL)
+		return STATUS_FAIL;
+	HMCAcquire_resume();
+	return STATUS_SUCCESS;
+}
+
 bool HMC_testConnection() {
 	if (BackChannel_Connected())
 		BackChannel_WriteLine("Testing HMC connection.");
 
-	int test = I2C_masterReadMultiple(HMC5883L_RA_ID_A, R_Data, 3, 100000);
+	bool test = HMC_readRegisters(HMC5883L_RA_ID_A, R_Data, 3);
 	if (BackChannel_Connected())
-		BackChannel_WriteLine(itoa(test));
+		BackChannel_Printf("%d\r\n", test);
 
-	if (test == 3) {
+	if (test == STATUS_SUCCESS) {
 		if (BackChannel_Connected()) {
 			BackChannel_Write("ID returned: ");
 			BackChannel_WriteLine((uint8_t *) R_Data);
@@ -238,7 +244,8 @@ bool HMC_testConnection() {
  * @see HMC5883L_CRA_AVERAGE_LENGTH
  */
 uint8_t HMC_getSampleAveraging() {
-	return I2C_masterReadByte(HMC5883L_RA_CONFIG_A, 10000);
+	return HMC_readShadowBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_AVERAGE_BIT,
+	HMC5883L_CRA_AVERAGE_LENGTH);
 }
 /** Set number of samples averaged per measurement.
  * @param averaging New samples averaged per measurement setting(0-3 for 1/2/4/8 respectively)
@@ -247,9 +254,9 @@ uint8_t HMC_getSampleAveraging() {
  * @see HMC5883L_CRA_AVERAGE_LENGTH
  */
 bool HMC_setSampleAveraging(uint8_t averaging) {
-	bool ret = I2C_masterWriteBits(HMC5883L_RA_CONFIG_A,
+	bool ret = HMC_writeShadowBits(HMC5883L_RA_CONFIG_A,
 	HMC5883L_CRA_AVERAGE_BIT,
-	HMC5883L_CRA_AVERAGE_LENGTH, averaging, 100000);
+	HMC5883L_CRA_AVERAGE_LENGTH, averaging);
 	if (ret == STATUS_FAIL) {
 		if (BackChannel_Connected())
 			BackChannel_WriteLine("HMC_setSampleAveraging Failed.");
@@ -281,13 +288,8 @@ bool HMC_setSampleAveraging(uint8_t averaging) {
  * @see HMC5883L_CRA_RATE_LENGTH
  */
 uint8_t HMC_getDataRate() {
-	uint8_t b;
-	if (I2C_masterReadBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_RATE_BIT,
-	HMC5883L_CRA_RATE_LENGTH, &b, 10000) == STATUS_SUCCESS)
-		return b;
-	if (BackChannel_Connected())
-		BackChannel_WriteLine("HMC_getDataRate Failed.");
-	return STATUS_FAIL;
+	return HMC_readShadowBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_RATE_BIT,
+	HMC5883L_CRA_RATE_LENGTH);
 }
 /** Set data output rate value.
  * @param rate Rate of data output to registers
@@ -298,8 +300,8 @@ uint8_t HMC_getDataRate() {
  * @see HMC5883L_CRA_RATE_LENGTH
  */
 bool HMC_setDataRate(uint8_t rate) {
-	if (I2C_masterWriteBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_RATE_BIT,
-	HMC5883L_CRA_RATE_LENGTH, rate, 10000) == STATUS_SUCCESS)
+	if (HMC_writeShadowBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_RATE_BIT,
+	HMC5883L_CRA_RATE_LENGTH, rate) == STATUS_SUCCESS)
 		return STATUS_SUCCESS;
 	if (BackChannel_Connected())
 		BackChannel_WriteLine("HMC_setDataRate Failed.");
@@ -313,10 +315,8 @@ bool HMC_setDataRate(uint8_t rate) {
  * @see HMC5883L_CRA_BIAS_LENGTH
  */
 uint8_t HMC_getMeasurementBias() {
-	uint8_t b;
-	I2C_masterReadBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_BIAS_BIT,
-	HMC5883L_CRA_BIAS_LENGTH, &b, 10000);
-	return b;
+	return HMC_readShadowBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_BIAS_BIT,
+	HMC5883L_CRA_BIAS_LENGTH);
 }
 /** Set measurement bias value.
  * @param bias New bias value (0-2 for normal/positive/negative respectively)
@@ -326,8 +326,8 @@ uint8_t HMC_getMeasurementBias() {
  * @see HMC5883L_CRA_BIAS_LENGTH
  */
 bool HMC_setMeasurementBias(uint8_t bias) {
-	if (I2C_masterWriteBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_BIAS_BIT,
-	HMC5883L_CRA_BIAS_LENGTH, bias, 10000) == STATUS_SUCCESS)
+	if (HMC_writeShadowBits(HMC5883L_RA_CONFIG_A, HMC5883L_CRA_BIAS_BIT,
+	HMC5883L_CRA_BIAS_LENGTH, bias) == STATUS_SUCCESS)
 		return STATUS_SUCCESS;
 	if (BackChannel_Connected())
 		BackChannel_WriteLine("HMC_setMeasurementBias Failed.");
@@ -360,10 +360,8 @@ bool HMC_setMeasurementBias(uint8_t bias) {
  * @see HMC5883L_CRB_GAIN_LENGTH
  */
 uint8_t HMC_getGain() {
-	uint8_t b;
-	I2C_masterReadBits(HMC5883L_RA_CONFIG_B, HMC5883L_CRB_GAIN_BIT,
-	HMC5883L_CRB_GAIN_LENGTH, &b, 10000);
-	return b;
+	return HMC_readShadowBits(HMC5883L_RA_CONFIG_B, HMC5883L_CRB_GAIN_BIT,
+	HMC5883L_CRB_GAIN_LENGTH);
 }
 /** Set magnetic field gain value.
  * @param gain New magnetic field gain value
@@ -373,8 +371,8 @@ uint8_t HMC_getGain() {
  * @see HMC5883L_CRB_GAIN_LENGTH
  */
 bool HMC_setGain(uint8_t gain) {
-	if (I2C_masterWriteBits(HMC5883L_RA_CONFIG_B, HMC5883L_CRB_GAIN_BIT,
-	HMC5883L_CRB_GAIN_LENGTH, gain, 10000) == STATUS_SUCCESS)
+	if (HMC_writeShadowBits(HMC5883L_RA_CONFIG_B, HMC5883L_CRB_GAIN_BIT,
+	HMC5883L_CRB_GAIN_LENGTH, gain) == STATUS_SUCCESS)
 		return STATUS_SUCCESS;
 	if (BackChannel_Connected())
 		BackChannel_WriteLine("HMC_setGain Failed.");
@@ -406,10 +404,8 @@ bool HMC_setGain(uint8_t gain) {
  * @see HMC5883L_MODEREG_LENGTH
  */
 uint8_t HMC_getMode() {
-	uint8_t b;
-	I2C_masterReadBits(HMC5883L_RA_MODE, HMC5883L_MODEREG_BIT,
-	HMC5883L_MODEREG_LENGTH, &b, 10000);
-	return b;
+	return HMC_readShadowBits(HMC5883L_RA_MODE, HMC5883L_MODEREG_BIT,
+	HMC5883L_MODEREG_LENGTH);
 }
 /** Set measurement mode.
  * @param newMode New measurement mode
@@ -422,15 +418,13 @@ uint8_t HMC_getMode() {
  * @see HMC5883L_MODEREG_LENGTH
  */
 bool HMC_setMode(uint8_t newMode) {
-	// use this method to guarantee that bits 7-2 are set to zero, which is a
-	// requirement specified in the datasheet; it's actually more efficient than
-	// using the I2Cdev.writeBits method
-	if (I2C_masterSendByte(HMC5883L_RA_MODE,
-			mode << (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1),
-			10000)==STATUS_SUCCESS) {
-		mode = newMode; // track to tell if we have to clear bit 7 after a read
+	// replace the whole register to guarantee that bits 7-2 are set to zero,
+	// which is a requirement specified in the datasheet
+	shadow[HMC5883L_RA_MODE] = 0;
+	mode = newMode; // track to tell if we have to clear bit 7 after a read
+	if (HMC_writeShadowBits(HMC5883L_RA_MODE, HMC5883L_MODEREG_BIT,
+			HMC5883L_MODEREG_LENGTH, newMode) == STATUS_SUCCESS)
 		return STATUS_SUCCESS;
-	}
 	if (BackChannel_Connected())
 		BackChannel_WriteLine("HMC_setMode Failed.");
 	return STATUS_FAIL;
@@ -438,12 +432,11 @@ bool HMC_setMode(uint8_t newMode) {
 
 // DATA* registers
 void HMC_getHeading(int16_t *x, int16_t *y, int16_t *z) {
-	I2C_masterReadMultiple(3, R_Data, 6, 10000);
+	uint8_t single = HMC5883L_MODE_SINGLE
+			<< (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1);
+	HMC_readRegisters(HMC5883L_RA_DATAX_H, R_Data, 6);
 	if (mode == HMC5883L_MODE_SINGLE)
-		I2C_masterSendByte(HMC5883L_RA_MODE,
-				HMC5883L_MODE_SINGLE
-						<< (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1),
-				10000);
+		I2CEngine_write(&HMC_device, HMC5883L_RA_MODE, &single, 1);
 	*x = (((int16_t) R_Data[0]) << 8) | R_Data[1];
 	*y = (((int16_t) R_Data[4]) << 8) | R_Data[5];
 	*z = (((int16_t) R_Data[2]) << 8) | R_Data[3];
@@ -464,6 +457,167 @@ int16_t HMC_getHeadingZ() {
 	return *z;
 }
 
+// Self-test and auto-ranging
+
+// Nominal LSB/Gauss for each gain setting, see HMC_getGain()
+static const uint16_t gainLSB[8] = { 1370, 1090, 820, 660, 440, 390, 330,
+		230 };
+static uint8_t autoRangeSettle = 0;
+static int16_t correction[3] = { 16384, 16384, 16384 };	// Q14, from HMC_selfTest()
+
+/** Take one single-measurement reading and wait for it via DRDY.
+ * Must not be used while HMCAcquire is running.
+ */
+static bool HMC_measure(int16_t v[3]) {
+	uint8_t raw[6];
+	dataReady = false;
+	if (HMC_setMode(HMC5883L_MODE_SINGLE) == STATUS_FAIL)
+		return STATUS_FAIL;
+	__disable_interrupt();
+	while (!dataReady) {
+		__bis_SR_register(LPM0_bits + GIE);
+		__disable_interrupt();
+	}
+	__enable_interrupt();
+	if (HMC_readRegisters(HMC5883L_RA_DATAX_H, raw, 6) == STATUS_FAIL)
+		return STATUS_FAIL;
+	v[0] = (((int16_t) raw[0]) << 8) | raw[1];
+	v[1] = (((int16_t) raw[4]) << 8) | raw[5];
+	v[2] = (((int16_t) raw[2]) << 8) | raw[3];
+	return STATUS_SUCCESS;
+}
+
+/** Measure with the given bias, discarding the first reading after the change. */
+static bool HMC_measureBiased(uint8_t bias, int16_t v[3]) {
+	if (HMC_setMeasurementBias(bias) == STATUS_FAIL)
+		return STATUS_FAIL;
+	if (HMC_measure(v) == STATUS_FAIL)
+		return STATUS_FAIL;
+	return HMC_measure(v);
+}
+
+/** Run the datasheet self-test and derive per-axis gain corrections.
+ * The internal bias strap applies about 1.16 Ga to X and Y and 1.08 Ga to
+ * Z.  Measuring with positive and then negative bias and halving the
+ * difference cancels the ambient field, which leaves the sensor's response
+ * to a known field.  At gain 5 (390 LSB/Ga) that must lie within 243..575
+ * counts on every axis.  The configuration is restored afterwards.  Must not
+ * be used while HMCAcquire is running.
+ * @param gainCorrection Receives expected/measured for X, Y, Z in Q14
+ * (16384 = 1.0); multiply raw counts by it to get nominal counts
+ * @return STATUS_SUCCESS if every axis is within the datasheet limits
+ */
+bool HMC_selfTest(int16_t gainCorrection[3]) {
+	static const int16_t expected[3] = { 452, 452, 421 };	// X, Y, Z counts
+	uint8_t saved[3];
+	int16_t positive[3], negative[3];
+	int16_t response;
+	bool status;
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+		saved[i] = shadow[i];
+	HMC_beginConfig();
+	HMC_setSampleAveraging(HMC5883L_AVERAGING_8);
+	HMC_setDataRate(HMC5883L_RATE_15);
+	HMC_setGain(HMC5883L_GAIN_390);
+	status = HMC_commitConfig();
+	if (status == STATUS_SUCCESS)
+		status = HMC_measureBiased(HMC5883L_BIAS_POSITIVE, positive);
+	if (status == STATUS_SUCCESS)
+		status = HMC_measureBiased(HMC5883L_BIAS_NEGATIVE, negative);
+
+	for (i = 0; i < 3; i++)
+		shadow[i] = saved[i];
+	mode = shadow[HMC5883L_RA_MODE];
+	shadowDirty = 0x07;
+	if (HMC_commitConfig() == STATUS_FAIL || status == STATUS_FAIL)
+		return STATUS_FAIL;
+
+	for (i = 0; i < 3; i++) {
+		response = (positive[i] - negative[i]) / 2;
+		if (response < 243 || response > 575) {
+			gainCorrection[i] = 0;
+			status = STATUS_FAIL;
+		} else
+			gainCorrection[i] = (int16_t) (((int32_t) expected[i] << 14)
+					/ response);
+	}
+	return status;
+}
+
+/** Adjust the gain to the field strength, one step at a time.
+ * Call with every sample.  Overflowed (-4096) or nearly full scale readings
+ * move to the next less sensitive setting.  Readings that would still sit
+ * comfortably below full scale at the next more sensitive setting move
+ * back.  The gap between the two thresholds gives hysteresis.  Only CONFIG_B
+ * is rewritten; nothing else is re-initialised.
+ * @param gain The gain setting the sample was taken with
+ * @return true if the sample is valid, false to discard it (overflow, stale
+ * gain or the measurement right after a gain change)
+ */
+bool HMC_autoRange(int16_t x, int16_t y, int16_t z, uint8_t gain) {
+	uint8_t current = HMC_getGain();
+	int16_t largest;
+	bool overflow = (x == HMC5883L_OVERFLOW || y == HMC5883L_OVERFLOW
+			|| z == HMC5883L_OVERFLOW);
+
+	if (gain != current)
+		return false;
+	if (autoRangeSettle) {
+		autoRangeSettle--;	// Measured before the new gain took effect
+		return false;
+	}
+	if (x < 0)
+		x = -x;
+	if (y < 0)
+		y = -y;
+	if (z < 0)
+		z = -z;
+	largest = (x > y) ? x : y;
+	if (z > largest)
+		largest = z;
+
+	if (overflow || largest > HMC5883L_AUTORANGE_HIGH) {
+		if (current < HMC5883L_GAIN_220
+				&& HMC_setGain(current + 1) == STATUS_SUCCESS)
+			autoRangeSettle = 1;
+		return !overflow;
+	}
+	if (current > HMC5883L_GAIN_1370
+			&& (int32_t) largest * gainLSB[current - 1]
+					< (int32_t) HMC5883L_AUTORANGE_LOW * gainLSB[current]
+			&& HMC_setGain(current - 1) == STATUS_SUCCESS)
+		autoRangeSettle = 1;
+	return true;
+}
+
+/** Apply per-axis corrections from HMC_selfTest() in HMC_normalize(). */
+void HMC_setGainCorrection(const int16_t gainCorrection[3]) {
+	uint8_t i;
+	for (i = 0; i < 3; i++)
+		correction[i] = gainCorrection[i];
+}
+
+// Counts at the reference gain, then corrected; two steps keep it in 32 bits
+static int16_t HMC_scale(int16_t v, uint8_t gain, int16_t q14) {
+	int32_t n = (int32_t) v * gainLSB[HMC5883L_GAIN_REFERENCE] / gainLSB[gain];
+	return (int16_t) (n * q14 / 16384);
+}
+
+/** Rescale a sample HMC_autoRange() let through to counts at
+ * HMC5883L_GAIN_REFERENCE, with the self-test corrections applied.  Hard
+ * iron offsets and headings then mean the same whichever gain the sample
+ * was taken at.  Full scale at the least sensitive gain comes to about
+ * 9700 counts.
+ * @param gain The gain setting the sample was taken with
+ */
+void HMC_normalize(int16_t *x, int16_t *y, int16_t *z, uint8_t gain) {
+	*x = HMC_scale(*x, gain, correction[0]);
+	*y = HMC_scale(*y, gain, correction[1]);
+	*z = HMC_scale(*z, gain, correction[2]);
+}
+
 // STATUS register
 
 /** Get data output register lock status.
@@ -478,7 +632,8 @@ int16_t HMC_getHeadingZ() {
  * @see HMC5883L_STATUS_LOCK_BIT
  */
 bool HMC_getLockStatus() {
-	uint8_t b = I2C_masterReadByte(HMC5883L_RA_STATUS, 10000);
+	uint8_t b = 0;
+	HMC_readRegisters(HMC5883L_RA_STATUS, &b, 1);
 	return (b & (1 << HMC5883L_STATUS_LOCK_BIT)) ? true : false;
 }
 /** Get data ready status.
@@ -492,7 +647,8 @@ bool HMC_getLockStatus() {
  * @see HMC5883L_STATUS_READY_BIT
  */
 bool HMC_getReadyStatus() {
-	uint8_t b = I2C_masterReadByte(HMC5883L_RA_STATUS, 10000);
+	uint8_t b = 0;
+	HMC_readRegisters(HMC5883L_RA_STATUS, &b, 1);
 	return (b & (1 << HMC5883L_STATUS_READY_BIT)) ? true : false;
 }
 
@@ -505,8 +661,13 @@ uint8_t HMC_devAddr;
 
 #pragma vector = PORT2_VECTOR
 __interrupt void HMC_PORT2_ISR(void) {
-	if (P2IFG & BIT6)
+	bool wake = true;
+	if (P2IFG & BIT6) {
+		TRACE(TRACE_DRDY);
 		dataReady = true;
+		wake = HMCAcquire_onDataReady();
+	}
 	P2IFG &= ~BIT6;
-	LPM0_EXIT;
+	if (wake)
+		LPM0_EXIT;
 }
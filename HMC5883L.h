@@ -37,7 +37,9 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "I2CEngine.h"
 #define HMCI2C_BASE					(USCI_B1_BASE)
+#define HMC5883L_I2C_SPEED			400000		// Hz, fast mode
 
 #define HMC5883L_ADDRESS            0x1E // this device only has one address#define HMC5883L_DEFAULT_ADDRESS    0x1E
 
@@ -98,12 +100,26 @@
 #define HMC5883L_MODE_SINGLE        0x01
 #define HMC5883L_MODE_IDLE          0x02
 
+#define HMC5883L_OVERFLOW           (-4096) // data register value on ADC overflow
+
+#define HMC5883L_AUTORANGE_HIGH     1843    // 90% of the 2047 full scale
+#define HMC5883L_AUTORANGE_LOW      1434    // 70%, predicted at the next gain
+#define HMC5883L_GAIN_REFERENCE     HMC5883L_GAIN_1090  // Scale after HMC_normalize()
+
 #define HMC5883L_STATUS_LOCK_BIT    1
 #define HMC5883L_STATUS_READY_BIT   0
 
+extern const I2CEngine_Device HMC_device;
+
 bool HMC_initialize();
 bool HMC_testConnection();
 
+// Shadowed configuration (CONFIG_A, CONFIG_B, MODE)
+void HMC_beginConfig();
+bool HMC_commitConfig();
+bool HMC_resyncConfig();
+bool HMC_replayConfig();
+
 // CONFIG_A register
 uint8_t HMC_getSampleAveraging();
 bool HMC_setSampleAveraging(uint8_t averaging);
@@ -126,6 +142,12 @@ int16_t HMC_getHeadingX();
 int16_t HMC_getHeadingY();
 int16_t HMC_getHeadingZ();
 
+// Self-test and auto-ranging
+bool HMC_selfTest(int16_t gainCorrection[3]);
+bool HMC_autoRange(int16_t x, int16_t y, int16_t z, uint8_t gain);
+void HMC_setGainCorrection(const int16_t gainCorrection[3]);
+void HMC_normalize(int16_t *x, int16_t *y, int16_t *z, uint8_t gain);
+
 // STATUS register
 bool HMC_getLockStatus();
 bool HMC_getReadyStatus();
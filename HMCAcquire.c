@@ -0,0 +1,181 @@
+/*
+ * HMCAcquire.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "HMC5883L.h"
+#include "HMCAcquire.h"
+#include "I2CEngine.h"
+#include "Timebase.h"
+#include "Trace.h"
+
+#define RING_MASK	(HMCACQUIRE_RING_SIZE - 1)
+
+static HMC_Sample ring[HMCACQUIRE_RING_SIZE];
+static volatile uint8_t ringHead = 0;	// Written by the I2C completion ISR
+static volatile uint8_t ringTail = 0;	// Written by the main loop
+static uint8_t batch = 1;
+static Scheduler_Task *batchTask = 0;
+static volatile bool running = false;
+static bool singleMode;
+static uint32_t edgeTime;
+static uint8_t raw[6];
+static const uint8_t singleMeasurement = HMC5883L_MODE_SINGLE
+		<< (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1);
+static I2CEngine_Transaction readData;
+static I2CEngine_Transaction triggerMeasurement;
+
+volatile uint16_t HMCAcquire_overruns = 0;
+volatile uint16_t HMCAcquire_readErrors = 0;
+
+//private functions
+static bool HMCAcquire_triggerDone(I2CEngine_Transaction *t) {
+	return false;
+}
+
+static bool HMCAcquire_readDone(I2CEngine_Transaction *t) {
+	HMC_Sample *s;
+	uint8_t head = ringHead;
+	if (t->status != I2CENGINE_DONE) {
+		HMCAcquire_readErrors++;
+	} else if (((head + 1) & RING_MASK) == ringTail) {
+		HMCAcquire_overruns++;	// Main loop has fallen behind, keep the old data
+	} else {
+		// Data registers are ordered X, Z, Y
+		s = &ring[head];
+		s->timestamp = edgeTime;
+		s->x = (((int16_t) raw[0]) << 8) | raw[1];
+		s->z = (((int16_t) raw[2]) << 8) | raw[3];
+		s->y = (((int16_t) raw[4]) << 8) | raw[5];
+		s->gain = HMC_getGain();
+		ringHead = (head + 1) & RING_MASK;
+		TRACE(TRACE_SAMPLE_READY);
+	}
+	// After a failed read too: no DRDY edge comes until the next trigger
+	if (singleMode && running)
+		I2CEngine_submit(&triggerMeasurement);
+	if (HMCAcquire_available() < batch)
+		return false;
+	if (batchTask)
+		Scheduler_post(batchTask);
+	return true;
+}
+
+//public functions
+/** Start DRDY driven acquisition.
+ * @param batchSize Number of samples to collect before waking the main loop
+ */
+void HMCAcquire_start(uint8_t batchSize) {
+	if (batchSize < 1)
+		batchSize = 1;
+	if (batchSize >= HMCACQUIRE_RING_SIZE)
+		batchSize = HMCACQUIRE_RING_SIZE - 1;
+	batch = batchSize;
+	singleMode = (HMC_getMode() == HMC5883L_MODE_SINGLE);
+
+	readData.device = &HMC_device;
+	readData.reg = HMC5883L_RA_DATAX_H;
+	readData.flags = I2CENGINE_FLAG_DMA;
+	readData.txData = 0;
+	readData.txLength = 0;
+	readData.rxData = raw;
+	readData.rxLength = sizeof raw;
+	readData.callback = HMCAcquire_readDone;
+
+	triggerMeasurement.device = &HMC_device;
+	triggerMeasurement.reg = HMC5883L_RA_MODE;
+	triggerMeasurement.flags = 0;
+	triggerMeasurement.txData = &singleMeasurement;
+	triggerMeasurement.txLength = 1;
+	triggerMeasurement.rxData = 0;
+	triggerMeasurement.rxLength = 0;
+	triggerMeasurement.callback = HMCAcquire_triggerDone;
+
+	ringHead = 0;
+	ringTail = 0;
+	HMCAcquire_overruns = 0;
+	HMCAcquire_readErrors = 0;
+	running = true;
+	P2IFG &= ~BIT6;
+	if (singleMode)
+		I2CEngine_submit(&triggerMeasurement);
+}
+
+void HMCAcquire_stop() {
+	running = false;
+}
+
+uint8_t HMCAcquire_available() {
+	return (ringHead - ringTail) & RING_MASK;
+}
+
+/** Take the oldest sample out of the ring.
+ * @return false if the ring is empty
+ */
+bool HMCAcquire_read(HMC_Sample *sample) {
+	uint8_t tail = ringTail;
+	if (tail == ringHead)
+		return false;
+	*sample = ring[tail];
+	ringTail = (tail + 1) & RING_MASK;
+	return true;
+}
+
+/** Sleep in LPM0 until a full batch of samples is in the ring. */
+void HMCAcquire_waitBatch() {
+	__disable_interrupt();
+	while (HMCAcquire_available() < batch) {
+		__bis_SR_register(LPM0_bits + GIE);
+		__disable_interrupt();
+	}
+	__enable_interrupt();
+}
+
+/** Post a scheduler task whenever a full batch is in the ring, as an
+ * alternative to HMCAcquire_waitBatch().
+ * @param task Task to post, or 0 for none
+ */
+void HMCAcquire_notify(Scheduler_Task *task) {
+	batchTask = task;
+}
+
+/** Restart the read cycle after an I2C bus recovery.
+ * A read lost to the hang leaves DRDY low with no further edge to start the
+ * next one, so read straight away.
+ */
+void HMCAcquire_resume() {
+	if (!running || readData.status == I2CENGINE_QUEUED
+			|| readData.status == I2CENGINE_ACTIVE)
+		return;
+	edgeTime = Timebase_now();
+	I2CEngine_submit(&readData);
+}
+
+/** I2C bus time spent on each sample.
+ * The data read, plus the trigger write in single measurement mode.
+ * @return Microseconds per sample
+ */
+uint16_t HMCAcquire_busTime() {
+	uint16_t time = I2CEngine_busTime(&HMC_device, 0, sizeof raw);
+	if (HMC_getMode() == HMC5883L_MODE_SINGLE)
+		time += I2CEngine_busTime(&HMC_device, 1, 0);
+	return time;
+}
+
+/** DRDY edge hook, called from the PORT2 ISR.
+ * @return true if the main loop should be woken
+ */
+bool HMCAcquire_onDataReady() {
+	if (!running)
+		return true;
+	if (readData.status == I2CENGINE_QUEUED
+			|| readData.status == I2CENGINE_ACTIVE) {
+		HMCAcquire_overruns++;	// Previous read still on the bus
+		return false;
+	}
+	edgeTime = Timebase_now();
+	I2CEngine_submit(&readData);
+	return false;
+}
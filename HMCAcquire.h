@@ -0,0 +1,45 @@
+/*
+ * HMCAcquire.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * DRDY driven acquisition for the HMC5883L.  Each falling edge on P2.6
+ * starts an asynchronous DMA burst read of the data registers; the result
+ * is stamped and pushed into a ring the main loop drains a batch at a time.
+ * In continuous mode the sample rate is the HMC_setDataRate() setting.  In
+ * single-measurement mode the next measurement is triggered as soon as the
+ * previous one has been read, which runs the sensor at up to 160 Hz.
+ */
+
+#ifndef HMCACQUIRE_H_
+#define HMCACQUIRE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Scheduler.h"
+
+#define HMCACQUIRE_RING_SIZE	16	// Samples, must be a power of two
+
+typedef struct HMC_Sample {
+	uint32_t timestamp;		// Timebase ticks at the DRDY edge
+	int16_t x;
+	int16_t y;
+	int16_t z;
+	uint8_t gain;			// HMC_getGain() setting when read
+} HMC_Sample;
+
+void HMCAcquire_start(uint8_t batchSize);
+void HMCAcquire_stop();
+uint8_t HMCAcquire_available();
+bool HMCAcquire_read(HMC_Sample *sample);
+void HMCAcquire_waitBatch();
+void HMCAcquire_notify(Scheduler_Task *task);
+bool HMCAcquire_onDataReady();
+void HMCAcquire_resume();
+uint16_t HMCAcquire_busTime();
+
+extern volatile uint16_t HMCAcquire_overruns;	// Samples lost to a full ring or busy bus
+extern volatile uint16_t HMCAcquire_readErrors;	// Data reads that failed on the bus
+
+#endif /* HMCACQUIRE_H_ */
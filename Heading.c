@@ -0,0 +1,58 @@
+/*
+ * Heading.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * CORDIC in vectoring mode: the vector is rotated towards the positive axis
+ * by +/-atan(2^-i) using only shifts and adds, and the rotations are summed.
+ * Vectoring mode needs no gain correction, so there are no multiplies at all
+ * (the hardware multiplier is not needed).  Angles are kept in 1/64 of a
+ * tenth of a degree so the table fits in 16 bits and rounding stays well
+ * under the 0.1 degree output resolution.
+ */
+#include "Heading.h"
+
+#define ITERATIONS		16
+#define ANGLE_SHIFT		6			// Table units per tenth of a degree = 2^6
+#define INPUT_SHIFT		14			// Headroom: 2^15 * 2^14 * 1.65 * 1.42 < 2^31
+#define HALF_TURN		(1800L << ANGLE_SHIFT)
+
+// atan(2^-i) in 1/64 tenths of a degree
+static const uint16_t atanTable[ITERATIONS] = { 28800, 17002, 8983, 4560,
+		2289, 1146, 573, 286, 143, 72, 36, 18, 9, 4, 2, 1 };
+
+/** Angle of the magnetometer reading, same convention as atan2(x, y).
+ * @param x X axis counts
+ * @param y Y axis counts
+ * @return Heading in tenths of a degree, -1800 to 1800
+ */
+int16_t Heading_fromXY(int16_t x, int16_t y) {
+	int32_t a = (int32_t) y * (1L << INPUT_SHIFT);	// Real part
+	int32_t b = (int32_t) x * (1L << INPUT_SHIFT);	// Imaginary part
+	int32_t angle = 0;
+	int32_t t;
+	uint8_t i;
+
+	if (x == 0 && y == 0)
+		return 0;
+	// CORDIC converges for +/-99 degrees, so fold the left half plane over
+	if (a < 0) {
+		angle = (b >= 0) ? HALF_TURN : -HALF_TURN;
+		a = -a;
+		b = -b;
+	}
+	for (i = 0; i < ITERATIONS; i++) {
+		t = a;
+		if (b > 0) {
+			a += b >> i;
+			b -= t >> i;
+			angle += atanTable[i];
+		} else {
+			a -= b >> i;
+			b += t >> i;
+			angle -= atanTable[i];
+		}
+	}
+	return (int16_t) ((angle + (1 << (ANGLE_SHIFT - 1))) >> ANGLE_SHIFT);
+}
@@ -0,0 +1,18 @@
+/*
+ * Heading.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Integer heading computation.  Replaces atan2() and the float math
+ * library, which the FPU-less MSP430 runs in software.
+ */
+
+#ifndef HEADING_H_
+#define HEADING_H_
+
+#include <stdint.h>
+
+int16_t Heading_fromXY(int16_t x, int16_t y);
+
+#endif /* HEADING_H_ */
@@ -0,0 +1,563 @@
+/*
+ * I2CEngine.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#include "I2CEngine.h"
+#include "DMAService.h"
+#include "Timebase.h"
+#include "Trace.h"
+
+#define PHASE_REGISTER_HIGH	0
+#define PHASE_REGISTER		1
+#define PHASE_TX			2
+#define PHASE_RX			3
+
+#define TIMEOUT_TICKS		((uint32_t) I2CENGINE_TIMEOUT_MS * TIMEBASE_TICKS_PER_SEC / 1000)
+#define POLL_TICKS			((uint32_t) I2CENGINE_POLL_MS * TIMEBASE_TICKS_PER_SEC / 1000)
+#define HALF_BIT_CYCLES		80		// 5 us at 16 MHz MCLK, 100 kHz recovery clock
+
+// USCI_Bx registers of a bus
+#define CTL1(bus)	HWREG8((bus)->base + OFS_UCBxCTL1)
+#define IE(bus)		HWREG8((bus)->base + OFS_UCBxIE)
+#define IFG(bus)	HWREG8((bus)->base + OFS_UCBxIFG)
+#define TXBUF(bus)	HWREG8((bus)->base + OFS_UCBxTXBUF)
+#define RXBUF(bus)	HWREG8((bus)->base + OFS_UCBxRXBUF)
+#define I2CSA(bus)	HWREG16((bus)->base + OFS_UCBxI2CSA)
+#define IV(bus)		HWREG16((bus)->base + OFS_UCBxIV)
+#define BRW(bus)	HWREG16((bus)->base + OFS_UCBxBRW)
+
+#ifdef DRIVERLIB_HOST_SIM
+// Where the DMA model can reach it, see tools/sim/sim.h.  The bytes are
+// copied out to the transaction when the DMA is done.
+#include <string.h>
+#define DMA_RX_ADDRESS(t)	SIM_RAM_I2C_RX
+#else
+#define DMA_RX_ADDRESS(t)	((uint32_t) (uintptr_t) (t)->rxData)
+#endif
+
+typedef struct I2CEngine_Bus {
+	uint16_t base;
+	bool dma;								// Has DMASERVICE_I2C_RX_CHANNEL
+	uint32_t clock;							// SMCLK when the bus was set up
+	uint32_t maxSpeed;						// Limit for the wiring, Hz
+	uint32_t speed;							// Current SCL, Hz
+	uint8_t port;							// GPIO_PORT_Px with SDA and SCL
+	uint8_t sda;
+	uint8_t scl;
+	bool recovering;						// Don't start anything
+	uint32_t started;						// Timebase ticks at start of active
+	uint32_t deadline;						// Recover if active is still going
+	I2CEngine_Stats stats;
+	I2CEngine_RecoveryHook hooks[I2CENGINE_HOOKS];
+	I2CEngine_Transaction *queueHead;		// Next transaction to start
+	I2CEngine_Transaction *queueTail;
+	I2CEngine_Transaction * volatile active;	// Transaction on the bus
+	uint16_t byteIndex;
+	uint8_t phase;
+} I2CEngine_Bus;
+
+static I2CEngine_Bus buses[I2CENGINE_BUSES] = {
+		{ .base = USCI_B0_BASE, .dma = false, .port = GPIO_PORT_P3,
+				.sda = GPIO_PIN0, .scl = GPIO_PIN1 },
+		{ .base = USCI_B1_BASE, .dma = true, .port = GPIO_PORT_P4,
+				.sda = GPIO_PIN1, .scl = GPIO_PIN2 } };
+static bool replaying = false;			// Running recovery hooks
+
+volatile uint16_t I2CEngine_transactions = 0;
+volatile uint16_t I2CEngine_repeatedStarts = 0;
+volatile uint16_t I2CEngine_speedChanges = 0;
+
+//private functions
+static I2CEngine_Bus *I2CEngine_bus(uint16_t base) {
+	return (base == USCI_B0_BASE) ? &buses[0] : &buses[1];
+}
+
+// Effective SCL for a device on its bus
+static uint32_t I2CEngine_busSpeed(I2CEngine_Bus *bus,
+		const I2CEngine_Device *device) {
+	return (device->speed < bus->maxSpeed) ? device->speed : bus->maxSpeed;
+}
+
+// Spin until bits clear in UCBxCTL1, or the active transaction's deadline.
+static bool I2CEngine_spin(I2CEngine_Bus *bus, uint8_t bits) {
+	while (CTL1(bus) & bits)
+		if ((int32_t) (Timebase_now() - bus->deadline) >= 0)
+			return false;
+	return true;
+}
+
+// Put the USCI back to its state after I2CEngine_initBus(), dropping
+// whatever it was doing.  Releasing UCSWRST clears UCBxIE.
+static void I2CEngine_resetUsci(I2CEngine_Bus *bus) {
+	bus->speed = (bus->maxSpeed < I2CENGINE_STANDARD_MODE) ? bus->maxSpeed
+			: I2CENGINE_STANDARD_MODE;
+	USCI_B_I2C_masterInit(bus->base, USCI_B_I2C_CLOCKSOURCE_SMCLK, bus->clock,
+			bus->speed);
+	USCI_B_I2C_enable(bus->base);
+	IFG(bus) &= ~(UCTXIFG + UCRXIFG + UCNACKIFG);
+	IE(bus) |= UCNACKIE;
+}
+
+// Free a slave that is holding SDA low part way through a byte (typically
+// after we reset mid-read or it browned out) by clocking it until it lets
+// go of SDA, then signal START and STOP with SCL high, which resets every
+// slave's state machine.  The pins are driven open drain:
+// low as outputs, released as inputs to the pull-ups.
+// Returns true if both lines are high afterwards.
+static bool I2CEngine_clearBus(I2CEngine_Bus *bus) {
+	uint8_t pulses;
+	bool released;
+	GPIO_setOutputLowOnPin(bus->port, bus->sda + bus->scl);
+	GPIO_setAsInputPin(bus->port, bus->sda + bus->scl);
+	__delay_cycles(HALF_BIT_CYCLES);
+	for (pulses = 0; pulses < 9; pulses++) {
+		if (GPIO_getInputPinValue(bus->port, bus->sda) == GPIO_INPUT_PIN_HIGH)
+			break;
+		GPIO_setAsOutputPin(bus->port, bus->scl);
+		__delay_cycles(HALF_BIT_CYCLES);
+		GPIO_setAsInputPin(bus->port, bus->scl);
+		__delay_cycles(HALF_BIT_CYCLES);
+	}
+	// SDA falls then rises while SCL is high.  Clocking SCL again here could
+	// let a slave that is still mid-byte drive the next bit low.
+	GPIO_setAsOutputPin(bus->port, bus->sda);
+	__delay_cycles(HALF_BIT_CYCLES);
+	GPIO_setAsInputPin(bus->port, bus->sda);
+	__delay_cycles(HALF_BIT_CYCLES);
+	released = GPIO_getInputPinValue(bus->port, bus->sda) == GPIO_INPUT_PIN_HIGH
+			&& GPIO_getInputPinValue(bus->port, bus->scl) == GPIO_INPUT_PIN_HIGH;
+	GPIO_setAsPeripheralModuleFunctionInputPin(bus->port, bus->sda + bus->scl);
+	return released;
+}
+
+// Reprogram the divider for the next device.  Only called from
+// I2CEngine_startNext() once the previous STOP is out, so the bus is idle.
+// Holding the USCI in reset clears UCBxIE, so the NACK interrupt is re-armed.
+static void I2CEngine_setSpeed(I2CEngine_Bus *bus, uint32_t speed) {
+	if (speed == bus->speed)
+		return;
+	CTL1(bus) |= UCSWRST;
+	BRW(bus) = (uint16_t) (bus->clock / speed);
+	CTL1(bus) &= ~UCSWRST;
+	IE(bus) = UCNACKIE;
+	bus->speed = speed;
+	I2CEngine_speedChanges++;
+}
+
+static void I2CEngine_startReceive(I2CEngine_Bus *bus, I2CEngine_Transaction *t) {
+	bus->phase = PHASE_RX;
+	bus->byteIndex = 0;
+	IE(bus) &= ~(UCTXIE + UCRXIE);
+	if (bus->dma && (t->flags & I2CENGINE_FLAG_DMA) && t->rxLength > 1) {
+		DMA_setTransferSize(DMASERVICE_I2C_RX_CHANNEL, t->rxLength - 1);
+		DMA_setDstAddress(DMASERVICE_I2C_RX_CHANNEL,
+				DMA_RX_ADDRESS(t), DMA_DIRECTION_INCREMENT);
+		DMA_enableTransfers(DMASERVICE_I2C_RX_CHANNEL);
+	} else
+		IE(bus) |= UCRXIE;
+	CTL1(bus) &= ~UCTR;
+	CTL1(bus) |= UCTXSTT;
+	if (t->rxLength == 1) {
+		// A single byte read needs the stop queued while the address is still
+		// going out, so this is the one place we have to poll (one byte time).
+		// A stuck bus is left to I2CEngine_poll().
+		if (I2CEngine_spin(bus, UCTXSTT))
+			CTL1(bus) |= UCTXSTP;
+	}
+}
+
+// Must be called with interrupts disabled or from the ISR.
+static void I2CEngine_startNext(I2CEngine_Bus *bus) {
+	I2CEngine_Transaction *t = bus->queueHead;
+	if (bus->active || bus->recovering || !t)
+		return;
+	bus->queueHead = t->next;
+	if (!bus->queueHead)
+		bus->queueTail = 0;
+	bus->active = t;
+	t->status = I2CENGINE_ACTIVE;
+	TRACE(TRACE_I2C_START);
+	bus->started = Timebase_now();
+	bus->deadline = bus->started + TIMEOUT_TICKS;
+
+	// The stop from the previous transaction may still be on the bus
+	if (!I2CEngine_spin(bus, UCTXSTP))
+		return;
+	I2CEngine_setSpeed(bus, I2CEngine_busSpeed(bus, t->device));
+	I2CSA(bus) = t->device->address;
+	if (t->device->registerWidth == 0 || (t->flags & I2CENGINE_FLAG_NO_REGISTER)) {
+		if (t->txLength == 0) {
+			I2CEngine_startReceive(bus, t);
+			return;
+		}
+		bus->phase = PHASE_TX;
+	} else
+		bus->phase = (t->device->registerWidth == 2) ? PHASE_REGISTER_HIGH
+				: PHASE_REGISTER;
+	bus->byteIndex = 0;
+	IE(bus) &= ~UCRXIE;
+	IE(bus) |= UCTXIE;
+	CTL1(bus) |= UCTR + UCTXSTT;
+}
+
+// Returns true if the main loop should be woken.
+static bool I2CEngine_finish(I2CEngine_Bus *bus, uint8_t status) {
+	I2CEngine_Transaction *t = bus->active;
+	bool wake = true;
+	IE(bus) &= ~(UCTXIE + UCRXIE);
+	if (bus->dma)
+		DMA_disableTransfers(DMASERVICE_I2C_RX_CHANNEL);
+	bus->active = 0;
+	I2CEngine_transactions++;
+	TRACE(TRACE_I2C_DONE);
+	t->status = status;
+	if (t->callback)
+		wake = t->callback(t);	// May submit the next transaction itself
+	I2CEngine_startNext(bus);
+	return wake;
+}
+
+// DMA has moved all but the last byte of a burst on USCI_B1.
+static bool I2CEngine_dmaComplete() {
+	I2CEngine_Bus *bus = &buses[1];
+	CTL1(bus) |= UCTXSTP;	// Stop after the byte now being received
+	bus->byteIndex = bus->active->rxLength - 1;
+#ifdef DRIVERLIB_HOST_SIM
+	memcpy(bus->active->rxData, &Sim_memory[SIM_RAM_I2C_RX], bus->byteIndex);
+#endif
+	IE(bus) |= UCRXIE;
+	return false;
+}
+
+static bool I2CEngine_service(I2CEngine_Bus *bus) {
+	I2CEngine_Transaction *t = bus->active;
+	I2CEngine_Transaction *next;
+	switch (__even_in_range(IV(bus), 12)) {
+	case USCI_I2C_UCNACKIFG:
+		CTL1(bus) |= UCTXSTP;
+		IFG(bus) &= ~UCTXIFG;
+		if (t)
+			return I2CEngine_finish(bus, I2CENGINE_NACK);
+		return false;
+	case USCI_I2C_UCRXIFG:
+		if (bus->byteIndex + 2 == t->rxLength)
+			CTL1(bus) |= UCTXSTP;	// Stop after the byte now being received
+		t->rxData[bus->byteIndex++] = RXBUF(bus);
+		if (bus->byteIndex < t->rxLength)
+			return false;
+		return I2CEngine_finish(bus, I2CENGINE_DONE);
+	case USCI_I2C_UCTXIFG:
+		if (bus->phase == PHASE_REGISTER_HIGH) {
+			TXBUF(bus) = (uint8_t) (t->reg >> 8);
+			bus->phase = PHASE_REGISTER;
+			return false;
+		}
+		if (bus->phase == PHASE_REGISTER) {
+			TXBUF(bus) = (uint8_t) t->reg;
+			bus->phase = PHASE_TX;
+			return false;
+		}
+		if (bus->byteIndex < t->txLength) {
+			TXBUF(bus) = t->txData[bus->byteIndex++];
+			return false;
+		}
+		if (t->rxLength) {
+			I2CEngine_startReceive(bus, t);	// Repeated start
+			return false;
+		}
+		// Write done.  Another transaction for the same device goes straight
+		// out with a repeated start from I2CEngine_startNext().  The divider
+		// can't change with the bus held, so it must want the same speed.
+		next = bus->queueHead;
+		if (next && next->device->address == t->device->address
+				&& I2CEngine_busSpeed(bus, next->device) == bus->speed)
+			I2CEngine_repeatedStarts++;
+		else
+			CTL1(bus) |= UCTXSTP;
+		IFG(bus) &= ~UCTXIFG;
+		return I2CEngine_finish(bus, I2CENGINE_DONE);
+	default:
+		return false;
+	}
+}
+
+//public functions
+/** Set up a USCI_B module as the I2C master for its devices.
+ * Selects the module's pins, initialises the USCI from SMCLK and resets its
+ * transaction queue.  USCI_B1 also gets the DMA receive channel.  Each
+ * transaction then runs at its device's speed, capped at maxSpeed.
+ * @param base USCI_B0_BASE (P3.0 SDA, P3.1 SCL) or USCI_B1_BASE (P4.1, P4.2)
+ * @param maxSpeed SCL limit in Hz for the bus wiring and pull-ups
+ */
+void I2CEngine_initBus(uint16_t base, uint32_t maxSpeed) {
+	I2CEngine_Bus *bus = I2CEngine_bus(base);
+	DMA_initializeParam dma = { 0 };
+
+	GPIO_setAsPeripheralModuleFunctionInputPin(bus->port, bus->sda + bus->scl);
+	bus->clock = UCS_getSMCLK();
+	bus->maxSpeed = maxSpeed;
+
+	if (bus->dma) {
+		dma.channelSelect = DMASERVICE_I2C_RX_CHANNEL;
+		dma.transferModeSelect = DMA_TRANSFER_SINGLE;
+		dma.triggerSourceSelect = DMASERVICE_TRIGGER_UCB1RXIFG;
+		dma.transferUnitSelect = DMA_SIZE_SRCBYTE_DSTBYTE;
+		dma.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+		DMA_initialize(&dma);
+		DMA_setSrcAddress(DMASERVICE_I2C_RX_CHANNEL,
+				USCI_B_I2C_getReceiveBufferAddressForDMA(base),
+				DMA_DIRECTION_UNCHANGED);
+		DMAService_setHandler(DMASERVICE_I2C_RX_CHANNEL, I2CEngine_dmaComplete);
+		DMA_enableInterrupt(DMASERVICE_I2C_RX_CHANNEL);
+	}
+
+	bus->queueHead = 0;
+	bus->queueTail = 0;
+	bus->active = 0;
+	bus->recovering = false;
+	I2CEngine_resetUsci(bus);
+}
+
+/** Queue a transaction and start it if its bus is free.
+ * Safe to call from an ISR or from a completion callback.
+ * @param transaction Descriptor to queue, owned by the engine until completion
+ * @return STATUS_FAIL if the descriptor describes an empty transfer
+ */
+bool I2CEngine_submit(I2CEngine_Transaction *transaction) {
+	I2CEngine_Bus *bus = I2CEngine_bus(transaction->device->base);
+	uint16_t sr;
+	if ((transaction->device->registerWidth == 0
+			|| (transaction->flags & I2CENGINE_FLAG_NO_REGISTER))
+			&& transaction->txLength == 0 && transaction->rxLength == 0)
+		return STATUS_FAIL;
+	transaction->next = 0;
+	transaction->status = I2CENGINE_QUEUED;
+
+	sr = __get_SR_register();
+	__disable_interrupt();
+	if (bus->queueTail)
+		bus->queueTail->next = transaction;
+	else
+		bus->queueHead = transaction;
+	bus->queueTail = transaction;
+	I2CEngine_startNext(bus);
+	__bis_SR_register(sr & GIE);
+	return STATUS_SUCCESS;
+}
+
+/** Sleep in LPM0 until a submitted transaction completes.
+ * Wakes every I2CENGINE_POLL_MS to run I2CEngine_poll(), so a hung bus
+ * ends in recovery and I2CENGINE_TIMEOUT rather than sleeping forever.
+ * @return STATUS_SUCCESS if every byte was acknowledged
+ */
+bool I2CEngine_wait(I2CEngine_Transaction *transaction) {
+	__disable_interrupt();
+	while (transaction->status == I2CENGINE_QUEUED
+			|| transaction->status == I2CENGINE_ACTIVE) {
+		Timebase_setAlarm(Timebase_now() + POLL_TICKS);
+		__bis_SR_register(LPM0_bits + GIE);
+		I2CEngine_poll();
+		__disable_interrupt();
+	}
+	__enable_interrupt();
+	return (transaction->status == I2CENGINE_DONE) ? STATUS_SUCCESS : STATUS_FAIL;
+}
+
+/** Blocking register transfer built on submit() and wait().
+ * @return STATUS_SUCCESS if every byte was acknowledged
+ */
+bool I2CEngine_transfer(const I2CEngine_Device *device, uint16_t reg,
+		const uint8_t txData[], uint16_t txLength, uint8_t rxData[],
+		uint16_t rxLength, uint8_t flags) {
+	I2CEngine_Transaction t;
+	t.device = device;
+	t.reg = reg;
+	t.flags = flags;
+	t.txData = txData;
+	t.txLength = txLength;
+	t.rxData = rxData;
+	t.rxLength = rxLength;
+	t.callback = 0;
+	t.context = 0;
+	if (I2CEngine_submit(&t) == STATUS_FAIL)
+		return STATUS_FAIL;
+	return I2CEngine_wait(&t);
+}
+
+/** Blocking write of length bytes starting at register reg. */
+bool I2CEngine_write(const I2CEngine_Device *device, uint16_t reg,
+		const uint8_t data[], uint16_t length) {
+	if (length < 1)
+		return STATUS_FAIL;
+	return I2CEngine_transfer(device, reg, data, length, 0, 0, 0);
+}
+
+/** Blocking read of length bytes starting at register reg, by DMA where
+ * the bus has it.
+ */
+bool I2CEngine_read(const I2CEngine_Device *device, uint16_t reg,
+		uint8_t data[], uint16_t length) {
+	if (length < 1)
+		return STATUS_FAIL;
+	return I2CEngine_transfer(device, reg, 0, 0, data, length,
+			I2CENGINE_FLAG_DMA);
+}
+
+/** SCL frequency a device's transactions run at. */
+uint32_t I2CEngine_speed(const I2CEngine_Device *device) {
+	I2CEngine_Bus *bus = I2CEngine_bus(device->base);
+	return bus->clock / (bus->clock / I2CEngine_busSpeed(bus, device));
+}
+
+/** Bus time of one transaction, for budgeting sample rates.
+ * Counts nine SCL periods per byte (address, register, data) and one each
+ * for START, repeated START and STOP, at the divider the engine would
+ * program.  The USCI double buffers and receive DMA keeps up, so SCL is
+ * not stretched; ISR entry for transmitted bytes hides behind the byte
+ * already shifting out.
+ * @return Microseconds the transaction holds the bus, saturating at 65535
+ */
+uint16_t I2CEngine_busTime(const I2CEngine_Device *device, uint16_t txLength,
+		uint16_t rxLength) {
+	I2CEngine_Bus *bus = I2CEngine_bus(device->base);
+	uint32_t divider = bus->clock / I2CEngine_busSpeed(bus, device);
+	uint32_t periods = 2;						// START and STOP
+	uint32_t time;
+	if (device->registerWidth || txLength)
+		periods += 9 * (1 + device->registerWidth + (uint32_t) txLength);
+	if (rxLength)
+		periods += 9 * (1 + (uint32_t) rxLength) + (periods > 2 ? 1 : 0);
+	time = (periods * divider + bus->clock / 1000000 - 1) / (bus->clock / 1000000);
+	return (time > 0xFFFF) ? 0xFFFF : (uint16_t) time;
+}
+
+/** Recover a bus whose active transaction has passed its deadline.
+ * Call periodically from the main loop; I2CEngine_wait() also calls it.
+ */
+void I2CEngine_poll() {
+	uint8_t i;
+	uint16_t sr;
+	bool expired;
+	for (i = 0; i < I2CENGINE_BUSES; i++) {
+		sr = __get_SR_register();
+		__disable_interrupt();
+		expired = buses[i].active && !buses[i].recovering
+				&& (int32_t) (Timebase_now() - buses[i].deadline) >= 0;
+		__bis_SR_register(sr & GIE);
+		if (expired) {
+			TRACE(TRACE_I2C_TIMEOUT);
+			buses[i].stats.timeouts++;
+			I2CEngine_recover(buses[i].base);
+		}
+	}
+}
+
+/** Get a bus working again after a hang.
+ * Fails the active transaction with I2CENGINE_TIMEOUT, clocks out any
+ * slave still holding SDA, re-initialises the USCI and then lets the
+ * device drivers replay their configuration through their recovery hooks.
+ * Queued transactions wait and then carry on.  Must be called from the
+ * main loop, not an ISR, since the hooks use blocking transfers.
+ * @param base USCI_B0_BASE or USCI_B1_BASE
+ * @return STATUS_SUCCESS if the bus lines were released and every hook
+ * succeeded
+ */
+bool I2CEngine_recover(uint16_t base) {
+	I2CEngine_Bus *bus = I2CEngine_bus(base);
+	I2CEngine_Transaction *t;
+	uint32_t started;
+	uint32_t elapsed;
+	bool status;
+	uint8_t i;
+	uint16_t sr = __get_SR_register();
+
+	__disable_interrupt();
+	started = bus->active ? bus->started : Timebase_now();
+	bus->recovering = true;
+	CTL1(bus) |= UCSWRST;
+	IE(bus) = 0;
+	if (bus->dma)
+		DMA_disableTransfers(DMASERVICE_I2C_RX_CHANNEL);
+	t = bus->active;
+	bus->active = 0;
+	__bis_SR_register(sr & GIE);
+	if (t) {
+		t->status = I2CENGINE_TIMEOUT;
+		if (t->callback)
+			t->callback(t);
+	}
+
+	status = I2CEngine_clearBus(bus);
+	I2CEngine_resetUsci(bus);
+	__disable_interrupt();
+	bus->recovering = false;
+	I2CEngine_startNext(bus);
+	__bis_SR_register(sr & GIE);
+
+	// A hook's own transfer may hang too.  That is recovered without
+	// running the hooks again, and this pass reports failure.
+	if (status == STATUS_SUCCESS && !replaying) {
+		replaying = true;
+		for (i = 0; i < I2CENGINE_HOOKS; i++)
+			if (bus->hooks[i] && bus->hooks[i]() == STATUS_FAIL)
+				status = STATUS_FAIL;
+		replaying = false;
+	}
+
+	elapsed = Timebase_now() - started;
+	if (elapsed > 0xFFFF)
+		elapsed = 0xFFFF;
+	bus->stats.lastRecovery = (uint16_t) elapsed;
+	if (elapsed > bus->stats.maxRecovery)
+		bus->stats.maxRecovery = (uint16_t) elapsed;
+	if (status == STATUS_SUCCESS)
+		bus->stats.recoveries++;
+	else
+		bus->stats.failures++;
+	return status;
+}
+
+/** Have a function run after every recovery of a bus, to put a device's
+ * configuration back.  It runs from the main loop and may use blocking
+ * transfers.
+ * @return STATUS_FAIL if all I2CENGINE_HOOKS slots are taken
+ */
+bool I2CEngine_onRecovery(uint16_t base, I2CEngine_RecoveryHook hook) {
+	I2CEngine_Bus *bus = I2CEngine_bus(base);
+	uint8_t i;
+	for (i = 0; i < I2CENGINE_HOOKS; i++) {
+		if (bus->hooks[i] == 0 || bus->hooks[i] == hook) {
+			bus->hooks[i] = hook;
+			return STATUS_SUCCESS;
+		}
+	}
+	return STATUS_FAIL;
+}
+
+const I2CEngine_Stats *I2CEngine_getStats(uint16_t base) {
+	return &I2CEngine_bus(base)->stats;
+}
+
+bool I2CEngine_isIdle() {
+	uint8_t i;
+	for (i = 0; i < I2CENGINE_BUSES; i++)
+		if (buses[i].active || buses[i].queueHead)
+			return false;
+	return true;
+}
+
+#pragma vector = USCI_B0_VECTOR
+__interrupt void I2CEngine_USCI_B0_ISR(void) {
+	if (I2CEngine_service(&buses[0]))
+		__bic_SR_register_on_exit(LPM3_bits);	// Wake anyone in I2CEngine_wait()
+}
+
+#pragma vector = USCI_B1_VECTOR
+__interrupt void I2CEngine_USCI_B1_ISR(void) {
+	if (I2CEngine_service(&buses[1]))
+		__bic_SR_register_on_exit(LPM3_bits);	// Wake anyone in I2CEngine_wait()
+}
@@ -0,0 +1,138 @@
+/*
+ * I2CEngine.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Queued, interrupt driven I2C master transactions shared by every device
+ * on USCI_B0 and USCI_B1.  Each device is described once by an
+ * I2CEngine_Device; a caller fills in an I2CEngine_Transaction for it,
+ * submits it and either sleeps in LPM0 with I2CEngine_wait() or gets told
+ * through the completion callback, which runs from the USCI ISR.  The CPU
+ * does no polling while bytes move.
+ *
+ * Each bus serves its queue in submission order, which is all the
+ * arbitration the magnetometer, the LCD backpack and later devices need.
+ * When the next queued transaction is for the device that has just
+ * finished a write, it follows with a repeated start instead of a STOP and
+ * a fresh START.
+ *
+ * Devices on one bus may run at different speeds.  The bit-rate divider is
+ * reprogrammed between transactions, and only when the next device's speed
+ * differs from the last, so a 400 kHz sensor is not held to the pace of a
+ * 100 kHz peripheral sharing its wires.
+ *
+ * A transaction that is still on the bus I2CENGINE_TIMEOUT_MS after it
+ * started, measured on the Timebase rather than by counting loops, is taken
+ * as a hung bus.  I2CEngine_poll() then fails it, clocks SCL from GPIO
+ * until the slave lets go of SDA, re-initialises the USCI and runs the
+ * drivers' recovery hooks to replay device configuration.
+ */
+
+#ifndef I2CENGINE_H_
+#define I2CENGINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define I2CENGINE_BUSES				2		// USCI_B0 and USCI_B1
+#define I2CENGINE_STANDARD_MODE		100000	// SCL, Hz
+#define I2CENGINE_FAST_MODE			400000
+#define I2CENGINE_TIMEOUT_MS		20		// Longer than any transaction, LCD rows take 6
+#define I2CENGINE_POLL_MS			10		// Deadline checks while in I2CEngine_wait()
+#define I2CENGINE_HOOKS				4		// Recovery hooks per bus
+
+// Transaction status values
+#define I2CENGINE_IDLE				0x00	// Not queued
+#define I2CENGINE_QUEUED			0x01	// Waiting behind another transaction
+#define I2CENGINE_ACTIVE			0x02	// On the bus
+#define I2CENGINE_DONE				0x03	// Completed, all bytes acknowledged
+#define I2CENGINE_NACK				0x04	// Slave did not acknowledge
+#define I2CENGINE_TIMEOUT			0x05	// Deadline passed, bus was recovered
+
+// Transaction flags
+#define I2CENGINE_FLAG_NO_REGISTER	0x01	// Don't send reg before tx/rx data
+#define I2CENGINE_FLAG_DMA			0x02	// Receive by DMA, no per-byte ISR
+
+/** One slave on one bus.  Usually a const owned by the device's driver. */
+typedef struct I2CEngine_Device {
+	uint16_t base;					// USCI_B0_BASE or USCI_B1_BASE
+	uint8_t address;				// 7-bit slave address
+	uint8_t registerWidth;			// Register address bytes, 0-2, MSB first
+	uint32_t speed;					// Fastest SCL the device allows, Hz
+} I2CEngine_Device;
+
+struct I2CEngine_Transaction;
+/** Completion callback, run from the USCI or DMA ISR.
+ * @return true to wake the main loop from low power mode
+ */
+typedef bool (*I2CEngine_Callback)(struct I2CEngine_Transaction *transaction);
+
+/** One register level I2C transfer.
+ * The engine sends the device's registerWidth bytes of reg followed by
+ * txLength bytes of txData, then, when rxLength is non-zero, issues a
+ * repeated start and reads rxLength bytes into rxData.  The descriptor and
+ * its buffers belong to the engine from I2CEngine_submit() until status
+ * reaches I2CENGINE_DONE, I2CENGINE_NACK or I2CENGINE_TIMEOUT.
+ *
+ * With I2CENGINE_FLAG_DMA set on USCI_B1, all but the last received byte
+ * are moved by DMASERVICE_I2C_RX_CHANNEL straight from UCB1RXBUF into
+ * rxData.  The DMA completion interrupt queues the stop and the final byte
+ * comes through the USCI ISR, so a burst costs two interrupts whatever its
+ * length.  USCI_B0 has no DMA channel and ignores the flag.
+ */
+typedef struct I2CEngine_Transaction {
+	const I2CEngine_Device *device;
+	uint16_t reg;					// Register address sent first
+	uint8_t flags;
+	const uint8_t *txData;
+	uint16_t txLength;
+	uint8_t *rxData;
+	uint16_t rxLength;
+	I2CEngine_Callback callback;	// May be 0, which always wakes main
+	void *context;					// Free for the owner of the descriptor
+	volatile uint8_t status;
+	struct I2CEngine_Transaction *next;
+} I2CEngine_Transaction;
+
+/** Run after a bus recovery to put a device back in its configured state.
+ * @return STATUS_SUCCESS if the device took its configuration
+ */
+typedef bool (*I2CEngine_RecoveryHook)(void);
+
+/** Hang recovery counters for one bus.  Times are Timebase ticks from the
+ * start of the hung transaction to the end of the configuration replay,
+ * which is the gap the application sees.
+ */
+typedef struct I2CEngine_Stats {
+	uint16_t timeouts;				// Transactions that passed their deadline
+	uint16_t recoveries;			// Bus released and devices reconfigured
+	uint16_t failures;				// A line stayed low, or a hook failed
+	uint16_t lastRecovery;
+	uint16_t maxRecovery;
+} I2CEngine_Stats;
+
+void I2CEngine_initBus(uint16_t base, uint32_t maxSpeed);
+uint32_t I2CEngine_speed(const I2CEngine_Device *device);
+uint16_t I2CEngine_busTime(const I2CEngine_Device *device, uint16_t txLength,
+		uint16_t rxLength);
+bool I2CEngine_submit(I2CEngine_Transaction *transaction);
+bool I2CEngine_wait(I2CEngine_Transaction *transaction);
+bool I2CEngine_transfer(const I2CEngine_Device *device, uint16_t reg,
+		const uint8_t txData[], uint16_t txLength, uint8_t rxData[],
+		uint16_t rxLength, uint8_t flags);
+bool I2CEngine_write(const I2CEngine_Device *device, uint16_t reg,
+		const uint8_t data[], uint16_t length);
+bool I2CEngine_read(const I2CEngine_Device *device, uint16_t reg,
+		uint8_t data[], uint16_t length);
+void I2CEngine_poll();
+bool I2CEngine_recover(uint16_t base);
+bool I2CEngine_onRecovery(uint16_t base, I2CEngine_RecoveryHook hook);
+const I2CEngine_Stats *I2CEngine_getStats(uint16_t base);
+bool I2CEngine_isIdle();
+
+extern volatile uint16_t I2CEngine_transactions;	// Completed, for bus load measurements
+extern volatile uint16_t I2CEngine_repeatedStarts;	// Transactions chained without a STOP
+extern volatile uint16_t I2CEngine_speedChanges;	// Divider reprogrammed for a device
+
+#endif /* I2CENGINE_H_ */
@@ -6,3 +6,109 @@
  */
 #include <driverlib.h>
 #include "LCD.h"
+#include "Timebase.h"
+
+// PCF8574 port bits
+#define PIN_RS			0x01
+#define PIN_EN			0x04
+#define PIN_BACKLIGHT	0x08
+
+// HD44780 instructions
+#define LCD_CLEAR			0x01
+#define LCD_ENTRY_MODE		0x06	// Increment, no shift
+#define LCD_DISPLAY_ON		0x0C	// Display on, cursor off
+#define LCD_FUNCTION_SET	0x28	// 4-bit, 2 lines, 5x8
+#define LCD_SET_DDRAM		0x80
+
+const I2CEngine_Device LCD_device = { LCD_BASE, LCD_ADDRESS, 0, LCD_I2C_SPEED };
+
+static uint8_t backlight = PIN_BACKLIGHT;
+static uint8_t frame[4 * LCD_COLUMNS];	// Four port writes per character
+
+//private functions
+static void LCD_delay(uint16_t ticks) {
+	uint32_t end = Timebase_now() + ticks;
+	while ((int32_t) (Timebase_now() - end) < 0)
+		;
+}
+
+// Each nibble is latched on the falling edge of EN.  The I2C byte time
+// (90 us at 100 kHz) covers the enable pulse width and the 37 us execution
+// time of everything except clear and home.
+static uint8_t LCD_pack(uint8_t *out, uint8_t value, uint8_t rs) {
+	uint8_t high = (value & 0xF0) | backlight | rs;
+	uint8_t low = (value << 4) | backlight | rs;
+	out[0] = high | PIN_EN;
+	out[1] = high;
+	out[2] = low | PIN_EN;
+	out[3] = low;
+	return 4;
+}
+
+static bool LCD_command(uint8_t command) {
+	LCD_pack(frame, command, 0);
+	return I2CEngine_write(&LCD_device, 0, frame, 4);
+}
+
+static bool LCD_nibble(uint8_t nibble) {
+	frame[0] = (nibble << 4) | backlight | PIN_EN;
+	frame[1] = (nibble << 4) | backlight;
+	return I2CEngine_write(&LCD_device, 0, frame, 2);
+}
+
+//public functions
+/** Reset the controller into 4-bit mode and clear the display.
+ * The bus must already be up, see I2CEngine_initBus().
+ * @return STATUS_FAIL if the backpack does not acknowledge
+ */
+bool LCD_init() {
+	LCD_delay(TIMEBASE_TICKS_PER_SEC / 20);	// 40 ms after power up
+	// Three 8-bit function sets get the controller into a known state from
+	// any mode, then one nibble switches it to 4-bit.
+	if (LCD_nibble(0x03) == STATUS_FAIL)
+		return STATUS_FAIL;
+	LCD_delay(TIMEBASE_TICKS_PER_SEC / 200);	// > 4.1 ms
+	LCD_nibble(0x03);
+	LCD_delay(5);								// > 100 us
+	LCD_nibble(0x03);
+	LCD_nibble(0x02);
+	LCD_command(LCD_FUNCTION_SET);
+	LCD_command(LCD_DISPLAY_ON);
+	LCD_command(LCD_ENTRY_MODE);
+	return LCD_clear();
+}
+
+bool LCD_clear() {
+	bool status = LCD_command(LCD_CLEAR);
+	LCD_delay(TIMEBASE_TICKS_PER_SEC / 500);	// 1.52 ms
+	return status;
+}
+
+bool LCD_setCursor(uint8_t row, uint8_t column) {
+	static const uint8_t rowStart[4] = { 0x00, 0x40, LCD_COLUMNS,
+			0x40 + LCD_COLUMNS };
+	if (row >= LCD_ROWS || column >= LCD_COLUMNS)
+		return STATUS_FAIL;
+	return LCD_command(LCD_SET_DDRAM | (rowStart[row] + column));
+}
+
+/** Write text at the cursor.
+ * Up to a full row goes out as one I2C transaction.
+ */
+bool LCD_print(const char *text) {
+	uint16_t length;
+	while (*text) {
+		length = 0;
+		while (*text && length < sizeof frame)
+			length += LCD_pack(&frame[length], *text++, PIN_RS);
+		if (I2CEngine_write(&LCD_device, 0, frame, length) == STATUS_FAIL)
+			return STATUS_FAIL;
+	}
+	return STATUS_SUCCESS;
+}
+
+bool LCD_setBacklight(bool on) {
+	backlight = on ? PIN_BACKLIGHT : 0;
+	frame[0] = backlight;
+	return I2CEngine_write(&LCD_device, 0, frame, 1);
+}
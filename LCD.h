@@ -3,12 +3,30 @@
  *
  *  Created on: Oct 6, 2014
  *      Author: gwilson
+ *
+ * HD44780 character LCD behind a PCF8574 I2C backpack, driven 4 bits at a
+ * time.  The backpack shares a bus with the magnetometer through I2CEngine.
  */
 
 #ifndef LCD_H_
 #define LCD_H_
 
-#define LCD_Address=0x3F
+#include <stdbool.h>
+#include <stdint.h>
+#include "I2CEngine.h"
+
+#define LCD_BASE			(USCI_B1_BASE)
+#define LCD_ADDRESS			0x3F
+#define LCD_I2C_SPEED		100000		// PCF8574 is standard mode only
+#define LCD_COLUMNS			16
+#define LCD_ROWS			2
+
+extern const I2CEngine_Device LCD_device;
 
+bool LCD_init();
+bool LCD_clear();
+bool LCD_setCursor(uint8_t row, uint8_t column);
+bool LCD_print(const char *text);
+bool LCD_setBacklight(bool on);
 
 #endif /* LCD_H_ */
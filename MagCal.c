@@ -0,0 +1,143 @@
+/*
+ * MagCal.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "CrcCcitt.h"
+#include "FixedMath.h"
+#include "MagCal.h"
+
+static MagCal_Params params;
+static int16_t minimum[3];
+static int16_t maximum[3];
+
+//private functions
+static uint16_t MagCal_check(const MagCal_Params *p) {
+	return CrcCcitt_block((const uint8_t *) p,
+			sizeof(MagCal_Params) - sizeof p->check);
+}
+
+static void MagCal_setIdentity() {
+	uint8_t i;
+	for (i = 0; i < 3; i++)
+		params.offset[i] = 0;
+	for (i = 0; i < 9; i++)
+		params.matrix[i] = (i % 4 == 0) ? MAGCAL_Q15_ONE : 0;
+	params.magic = MAGCAL_MAGIC;
+	params.check = MagCal_check(&params);
+}
+
+//public functions
+/** Load the stored calibration, or fall back to no correction. */
+void MagCal_init() {
+	if (MagCal_load() == STATUS_FAIL)
+		MagCal_setIdentity();
+}
+
+/** Drop the active correction in favour of none at all. */
+void MagCal_clear() {
+	MagCal_setIdentity();
+}
+
+/** Start a calibration run; follow with MagCal_collect() per sample. */
+void MagCal_beginCollect() {
+	uint8_t i;
+	for (i = 0; i < 3; i++) {
+		minimum[i] = 32767;
+		maximum[i] = -32768;
+	}
+}
+
+void MagCal_collect(int16_t x, int16_t y, int16_t z) {
+	if (x < minimum[0])
+		minimum[0] = x;
+	if (x > maximum[0])
+		maximum[0] = x;
+	if (y < minimum[1])
+		minimum[1] = y;
+	if (y > maximum[1])
+		maximum[1] = y;
+	if (z < minimum[2])
+		minimum[2] = z;
+	if (z > maximum[2])
+		maximum[2] = z;
+}
+
+/** Turn the collected extremes into the active correction.
+ * Each axis is scaled down to the smallest axis radius so every matrix
+ * entry stays within Q15.  The result is not persisted; call MagCal_save().
+ * @return STATUS_FAIL if an axis didn't see enough of the field
+ */
+bool MagCal_finishCollect() {
+	int16_t radius[3];
+	int16_t smallest = 32767;
+	uint8_t i;
+	for (i = 0; i < 3; i++) {
+		radius[i] = (int16_t) (((int32_t) maximum[i] - minimum[i]) / 2);
+		if (radius[i] < MAGCAL_MIN_RADIUS)
+			return STATUS_FAIL;
+		if (radius[i] < smallest)
+			smallest = radius[i];
+	}
+	for (i = 0; i < 9; i++)
+		params.matrix[i] = 0;
+	for (i = 0; i < 3; i++) {
+		params.offset[i] = (int16_t) (((int32_t) maximum[i] + minimum[i]) / 2);
+		params.matrix[i * 4] = (radius[i] == smallest) ? MAGCAL_Q15_ONE :
+				(int16_t) (((int32_t) smallest << 15) / radius[i]);
+	}
+	params.magic = MAGCAL_MAGIC;
+	params.check = MagCal_check(&params);
+	return STATUS_SUCCESS;
+}
+
+/** Correct one sample in place, on the hardware multiplier. */
+void MagCal_apply(int16_t *x, int16_t *y, int16_t *z) {
+	int16_t v[3];
+	v[0] = FixedMath_sub15(*x, params.offset[0]);
+	v[1] = FixedMath_sub15(*y, params.offset[1]);
+	v[2] = FixedMath_sub15(*z, params.offset[2]);
+	FixedMath_matVec3(params.matrix, v, v);
+	*x = v[0];
+	*y = v[1];
+	*z = v[2];
+}
+
+const MagCal_Params *MagCal_getParams() {
+	return &params;
+}
+
+/** Replace the active correction, e.g. with an off-line ellipsoid fit.
+ * The check field is recomputed; magic must be MAGCAL_MAGIC.
+ */
+bool MagCal_setParams(const MagCal_Params *p) {
+	if (p->magic != MAGCAL_MAGIC)
+		return STATUS_FAIL;
+	params = *p;
+	params.check = MagCal_check(&params);
+	return STATUS_SUCCESS;
+}
+
+/** Write the active correction to info flash segment D. */
+bool MagCal_save() {
+	uint16_t sr = __get_SR_register();
+	__disable_interrupt();	// Nothing may run between erase and write
+	FLASH_segmentErase(MAGCAL_INFO_SEGMENT);
+	FLASH_write16((uint16_t *) &params, (uint16_t *) MAGCAL_INFO_SEGMENT,
+			sizeof(MagCal_Params) / 2);
+	__bis_SR_register(sr & GIE);
+	return MagCal_load();
+}
+
+/** Make the stored correction active.
+ * @return STATUS_FAIL if the segment is blank or corrupt
+ */
+bool MagCal_load() {
+	const MagCal_Params *stored = (const MagCal_Params *) MAGCAL_INFO_SEGMENT;
+	if (stored->magic != MAGCAL_MAGIC || stored->check != MagCal_check(stored))
+		return STATUS_FAIL;
+	params = *stored;
+	return STATUS_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/*
+ * MagCal.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Hard and soft iron correction for the magnetometer.  A calibration run
+ * tracks the per-axis extremes while the unit is turned through all
+ * orientations; from those we get an offset (hard iron) and a scale that
+ * makes the three axes equal (soft iron).  The correction is
+ *
+ *     corrected = M * (raw - offset)
+ *
+ * with M a 3x3 Q15 matrix, so a full matrix from an off-line ellipsoid fit
+ * can be loaded with MagCal_setParams() and applied the same way; the
+ * calset command takes the line tools/magcal_fit prints.  The parameters
+ * are kept in info flash segment D.
+ */
+
+#ifndef MAGCAL_H_
+#define MAGCAL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAGCAL_INFO_SEGMENT		((uint8_t *) 0x1800)	// INFOD
+#define MAGCAL_MAGIC			0x4D43					// "MC"
+#define MAGCAL_Q15_ONE			32767
+#define MAGCAL_MIN_RADIUS		50		// Counts; less means the unit wasn't rotated
+
+typedef struct MagCal_Params {
+	uint16_t magic;
+	int16_t offset[3];		// X, Y, Z hard iron offset, counts after HMC_normalize()
+	int16_t matrix[9];		// Soft iron correction, Q15, row major
+	uint16_t check;			// CRC16-CCITT of everything above
+} MagCal_Params;
+
+void MagCal_init();
+void MagCal_clear();
+void MagCal_beginCollect();
+void MagCal_collect(int16_t x, int16_t y, int16_t z);
+bool MagCal_finishCollect();
+void MagCal_apply(int16_t *x, int16_t *y, int16_t *z);
+const MagCal_Params *MagCal_getParams();
+bool MagCal_setParams(const MagCal_Params *params);
+bool MagCal_save();
+bool MagCal_load();
+
+#endif /* MAGCAL_H_ */
@@ -0,0 +1,160 @@
+/*
+ * Scheduler.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "Scheduler.h"
+#include "Trace.h"
+
+static Scheduler_Task *tasks = 0;
+static volatile uint8_t lpm0Holds = 0;
+
+uint32_t Scheduler_idleTicks = 0;
+uint32_t Scheduler_busyTicks = 0;
+
+//private functions
+static void Scheduler_execute(Scheduler_Task *task, uint32_t now) {
+	uint32_t finish;
+	TRACE(TRACE_TASK_START);
+	task->function(task);
+	TRACE(TRACE_TASK_END);
+	finish = Timebase_now();
+	task->runs++;
+	if (task->deadline && finish - task->released > task->deadline)
+		task->misses++;
+	Scheduler_busyTicks += finish - now;
+}
+
+// Run the first released task in list order.
+// Returns false if nothing was ready, leaving the next release in *wake.
+static bool Scheduler_dispatch(uint32_t *wake, bool *timed) {
+	Scheduler_Task *task;
+	uint32_t now = Timebase_now();
+	*timed = false;
+	for (task = tasks; task; task = task->next) {
+		if (task->posted) {
+			task->posted = false;	// Posts while it runs release it again
+			Scheduler_execute(task, now);
+			return true;
+		}
+		if (!task->timed)
+			continue;
+		if ((int32_t) (now - task->due) >= 0) {
+			task->released = task->due;
+			if (task->period) {
+				task->due += task->period;
+				if ((int32_t) (now - task->due) >= 0)
+					task->due = now + task->period;	// Fell behind, don't burst
+			} else
+				task->timed = false;
+			Scheduler_execute(task, now);
+			return true;
+		}
+		if (!*timed || (int32_t) (task->due - *wake) < 0) {
+			*wake = task->due;
+			*timed = true;
+		}
+	}
+	return false;
+}
+
+static bool Scheduler_anyPosted() {
+	Scheduler_Task *task;
+	for (task = tasks; task; task = task->next)
+		if (task->posted)
+			return true;
+	return false;
+}
+
+//public functions
+void Scheduler_init() {
+	tasks = 0;
+	lpm0Holds = 0;
+	Scheduler_idleTicks = 0;
+	Scheduler_busyTicks = 0;
+}
+
+/** Append a task to the list; tasks added earlier run first. */
+void Scheduler_add(Scheduler_Task *task) {
+	Scheduler_Task **link = &tasks;
+	task->timed = false;
+	task->posted = false;
+	task->runs = 0;
+	task->misses = 0;
+	task->next = 0;
+	while (*link)
+		link = &(*link)->next;
+	*link = task;
+}
+
+/** Release a task every period ticks, the first time after delay. */
+void Scheduler_startPeriodic(Scheduler_Task *task, uint32_t delay, uint32_t period) {
+	task->period = period;
+	task->due = Timebase_now() + delay;
+	task->timed = true;
+}
+
+/** Release a task once, delay ticks from now. */
+void Scheduler_startOnce(Scheduler_Task *task, uint32_t delay) {
+	Scheduler_startPeriodic(task, delay, 0);
+}
+
+/** Cancel timed releases; an event already posted still runs. */
+void Scheduler_stop(Scheduler_Task *task) {
+	task->timed = false;
+}
+
+/** Release a task as soon as the scheduler gets to it.  Safe from ISRs.
+ * @return true, so an ISR can pass it on to wake the main loop
+ */
+bool Scheduler_post(Scheduler_Task *task) {
+	if (!task->posted)
+		task->released = Timebase_now();
+	task->posted = true;
+	return true;
+}
+
+/** Keep idle sleep at LPM0 until the matching release, for a peripheral
+ * that needs SMCLK to keep running.  Holds nest.
+ */
+void Scheduler_holdLpm0() {
+	uint16_t sr = __get_SR_register();
+	__disable_interrupt();
+	lpm0Holds++;
+	__bis_SR_register(sr & GIE);
+}
+
+void Scheduler_releaseLpm0() {
+	uint16_t sr = __get_SR_register();
+	__disable_interrupt();
+	if (lpm0Holds)
+		lpm0Holds--;
+	__bis_SR_register(sr & GIE);
+}
+
+/** Run tasks for ever, sleeping whenever none is released. */
+void Scheduler_run() {
+	uint32_t wake = 0, slept;
+	bool timed;
+	for (;;) {
+		if (Scheduler_dispatch(&wake, &timed))
+			continue;
+		__disable_interrupt();
+		if (Scheduler_anyPosted()
+				|| (timed && !Timebase_setAlarm(wake))) {
+			__enable_interrupt();
+			continue;
+		}
+		if (!timed)
+			Timebase_cancelAlarm();
+		slept = Timebase_now();
+		if (lpm0Holds)
+			__bis_SR_register(LPM0_bits + GIE);
+		else
+			__bis_SR_register(LPM3_bits + GIE);
+		TRACE(TRACE_WAKE);
+		Scheduler_idleTicks += Timebase_now() - slept;
+	}
+}
@@ -0,0 +1,57 @@
+/*
+ * Scheduler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Run to completion cooperative scheduler on the Timebase clock.  A task is
+ * released by time (periodic or one-shot) or by an event posted from an
+ * ISR, and runs from Scheduler_run() in list order, so tasks added first
+ * take priority.  Between tasks the CPU sleeps with a Timebase alarm set
+ * for the next release, in LPM3 unless something holds it in LPM0.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Timebase.h"
+
+#define SCHEDULER_MS(ms)	((uint32_t) (ms) * TIMEBASE_TICKS_PER_SEC / 1000)
+
+struct Scheduler_Task;
+typedef void (*Scheduler_Function)(struct Scheduler_Task *task);
+
+/** One task.  Fill in function, context and deadline, then start it with
+ * Scheduler_startPeriodic(), Scheduler_startOnce() or Scheduler_post().
+ * The descriptor belongs to the scheduler from Scheduler_add() onwards.
+ */
+typedef struct Scheduler_Task {
+	Scheduler_Function function;
+	void *context;					// Free for the owner of the descriptor
+	uint32_t deadline;				// Ticks from release to finish, 0 for none
+	uint32_t period;				// Ticks, 0 for one-shot
+	uint32_t due;					// Next timed release
+	uint32_t released;				// When the current run became due
+	bool timed;						// due is valid
+	volatile bool posted;			// Event waiting
+	uint16_t runs;
+	uint16_t misses;				// Runs that finished after their deadline
+	struct Scheduler_Task *next;
+} Scheduler_Task;
+
+void Scheduler_init();
+void Scheduler_add(Scheduler_Task *task);
+void Scheduler_startPeriodic(Scheduler_Task *task, uint32_t delay, uint32_t period);
+void Scheduler_startOnce(Scheduler_Task *task, uint32_t delay);
+void Scheduler_stop(Scheduler_Task *task);
+bool Scheduler_post(Scheduler_Task *task);
+void Scheduler_holdLpm0();
+void Scheduler_releaseLpm0();
+void Scheduler_run();
+
+extern uint32_t Scheduler_idleTicks;	// Time asleep, for the idle ratio
+extern uint32_t Scheduler_busyTicks;	// Time in tasks
+
+#endif /* SCHEDULER_H_ */
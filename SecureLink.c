@@ -0,0 +1,139 @@
+/*
+ * SecureLink.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "Ccm.h"
+#include "CrcCcitt.h"
+#include "SecureLink.h"
+
+#define EPOCH_BLANK		0xFFFFFFFFUL		// An erased long word
+
+typedef struct EpochSlot {
+	uint32_t epoch;
+	uint32_t inverse;		// ~epoch, written after it
+} EpochSlot;
+
+static Aes128_Key key;
+static bool haveKey = false;
+static uint32_t epoch = 0;
+static uint32_t frames = 0;				// Sealed in this epoch
+static EpochSlot * const epochSegment[SECURELINK_EPOCH_SEGMENTS] = {
+		(EpochSlot *) SECURELINK_EPOCH_SEGMENT_C,
+		(EpochSlot *) SECURELINK_EPOCH_SEGMENT_A };
+
+//private functions
+static uint16_t SecureLink_check(const SecureLink_Record *r) {
+	return CrcCcitt_block((const uint8_t *) r, sizeof(SecureLink_Record) - 2);
+}
+
+// Move to the epoch after the newest one tallied in flash.  Slots fill in
+// order after the newest; when there is no blank slot after it, the other
+// segment is erased and started instead.  So only a segment without the
+// newest epoch is ever erased, and a slot left part written or part erased
+// by a reset fails its inverse and is passed over.
+static void SecureLink_nextEpoch() {
+	EpochSlot *slot;
+	EpochSlot next;
+	uint32_t last = 0;
+	uint8_t active = 0;
+	uint8_t blank = 0;			// Slot after the newest
+	uint16_t sr;
+	uint8_t n, i;
+	for (n = 0; n < SECURELINK_EPOCH_SEGMENTS; n++) {
+		slot = epochSegment[n];
+		for (i = 0; i < SECURELINK_EPOCH_SLOTS; i++) {
+			if (slot[i].epoch == ~slot[i].inverse && slot[i].epoch > last) {
+				last = slot[i].epoch;
+				active = n;
+				blank = i + 1;
+			}
+		}
+	}
+	epoch = last + 1;
+	frames = 0;
+	next.epoch = epoch;
+	next.inverse = ~epoch;
+	slot = epochSegment[active];
+	sr = __get_SR_register();
+	__disable_interrupt();
+	FLASH_unlockInfoA();
+	if (blank == SECURELINK_EPOCH_SLOTS || slot[blank].epoch != EPOCH_BLANK
+			|| slot[blank].inverse != EPOCH_BLANK) {
+		slot = epochSegment[active ^ 1];
+		FLASH_segmentErase((uint8_t *) slot);
+		blank = 0;
+	}
+	FLASH_write32((uint32_t *) &next, (uint32_t *) &slot[blank],
+			sizeof(EpochSlot) / 4);
+	FLASH_lockInfoA();
+	__bis_SR_register(sr & GIE);
+}
+
+// Make the stored key current, if there is a good one
+static bool SecureLink_load() {
+	const SecureLink_Record *stored = (const SecureLink_Record *) SECURELINK_KEY_SEGMENT;
+	haveKey = stored->magic == SECURELINK_MAGIC
+			&& stored->check == SecureLink_check(stored);
+	if (haveKey)
+		Aes128_setKey(&key, stored->key);
+	return haveKey ? STATUS_SUCCESS : STATUS_FAIL;
+}
+
+//public functions
+/** Load the key and start a new epoch.  Call once at boot. */
+void SecureLink_init() {
+	SecureLink_load();
+	SecureLink_nextEpoch();
+}
+
+/** Store a new key in info flash segment B and use it from the next frame. */
+bool SecureLink_setKey(const uint8_t newKey[AES128_KEY_SIZE]) {
+	SecureLink_Record record;
+	uint16_t sr;
+	uint8_t i;
+	record.magic = SECURELINK_MAGIC;
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		record.key[i] = newKey[i];
+	record.check = SecureLink_check(&record);
+	sr = __get_SR_register();
+	__disable_interrupt();
+	FLASH_segmentErase(SECURELINK_KEY_SEGMENT);
+	FLASH_write16((uint16_t *) &record, (uint16_t *) SECURELINK_KEY_SEGMENT,
+			sizeof(SecureLink_Record) / 2);
+	__bis_SR_register(sr & GIE);
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		record.key[i] = 0;		// Only flash and the key schedule keep it
+	return SecureLink_load();
+}
+
+bool SecureLink_hasKey() {
+	return haveKey;
+}
+
+uint32_t SecureLink_epoch() {
+	return epoch;
+}
+
+/** Encrypt data in place under the next nonce and authenticate it along with
+ * aad.
+ * @param nonce Receives the nonce used, to send with the frame
+ * @return STATUS_FAIL with nothing done if there is no key
+ */
+bool SecureLink_seal(const uint8_t aad[], uint16_t aadLength, uint8_t data[],
+		uint16_t length, uint8_t nonce[SECURELINK_NONCE_SIZE],
+		uint8_t tag[SECURELINK_TAG_SIZE]) {
+	uint8_t i;
+	if (!haveKey)
+		return STATUS_FAIL;
+	for (i = 0; i < 4; i++) {
+		nonce[i] = (uint8_t) (epoch >> (8 * i));
+		nonce[4 + i] = (uint8_t) (frames >> (8 * i));
+	}
+	if (++frames == 0)
+		SecureLink_nextEpoch();	// Years at 75 Hz, but never repeat
+	return Ccm_seal(&key, nonce, SECURELINK_NONCE_SIZE, aad, aadLength, data,
+			length, tag, SECURELINK_TAG_SIZE) ? STATUS_SUCCESS : STATUS_FAIL;
+}
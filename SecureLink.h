@@ -0,0 +1,54 @@
+/*
+ * SecureLink.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Key and nonces for encrypted telemetry.  Frames are sealed with Ccm
+ * under one AES-128 key, provisioned with the "key" command and kept in
+ * info flash segment B with a CRC16-CCITT; it is never sent back out.
+ * Provision it over a cable you trust: the command itself is plain text.
+ *
+ * CTR mode falls apart if a nonce repeats under the same key, so the
+ * nonce is an epoch and a frame count, both little-endian u32.  The epoch
+ * goes up by one each boot, and whenever the frame count wraps, and is
+ * kept as a tally in info segments C and A: each epoch is written, with its
+ * inverse, to the next blank slot of one segment, and when that is full
+ * the other segment is erased and written from the start.  The newest epoch
+ * is always in flash, so a reset at any point can't bring an old epoch
+ * back, and each segment wears one erase per 2 * SECURELINK_EPOCH_SLOTS
+ * boots.
+ */
+
+#ifndef SECURELINK_H_
+#define SECURELINK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Aes128.h"
+
+#define SECURELINK_KEY_SEGMENT		((uint8_t *) 0x1900)	// INFOB
+#define SECURELINK_EPOCH_SEGMENT_C	((uint32_t *) 0x1880)	// INFOC
+#define SECURELINK_EPOCH_SEGMENT_A	((uint32_t *) 0x1980)	// INFOA, unlocked to write
+#define SECURELINK_EPOCH_SEGMENTS	2
+#define SECURELINK_EPOCH_SLOTS		16						// Epoch and inverse pairs in a segment
+#define SECURELINK_MAGIC			0x4B45					// "EK"
+#define SECURELINK_NONCE_SIZE		8
+#define SECURELINK_TAG_SIZE			8
+
+/** The stored form of the key. */
+typedef struct SecureLink_Record {
+	uint16_t magic;					// SECURELINK_MAGIC when provisioned
+	uint8_t key[AES128_KEY_SIZE];
+	uint16_t check;					// CRC16-CCITT of magic and key
+} SecureLink_Record;
+
+void SecureLink_init();
+bool SecureLink_setKey(const uint8_t key[AES128_KEY_SIZE]);
+bool SecureLink_hasKey();
+uint32_t SecureLink_epoch();
+bool SecureLink_seal(const uint8_t aad[], uint16_t aadLength, uint8_t data[],
+		uint16_t length, uint8_t nonce[SECURELINK_NONCE_SIZE],
+		uint8_t tag[SECURELINK_TAG_SIZE]);
+
+#endif /* SECURELINK_H_ */
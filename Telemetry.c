@@ -0,0 +1,150 @@
+/*
+ * Telemetry.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "BackChannel.h"
+#include "CrcCcitt.h"
+#include "DeltaCodec.h"
+#include "SecureLink.h"
+#include "Telemetry.h"
+
+static uint8_t format = TELEMETRY_FORMAT_ASCII;
+static bool encrypted = false;
+static uint16_t sequence = 0;
+static uint8_t block[TELEMETRY_BLOCK_MAX];
+static DeltaCodec_State codec = { .block = block, .size = TELEMETRY_BLOCK_MAX };
+// Tasks run to completion, so every frame is built in these rather than
+// on the stack.  Plain frames go at the ciphertext offset so they can be
+// sealed where they are.
+static uint8_t sealed[TELEMETRY_SECURE_MAX];
+static uint8_t encoded[TELEMETRY_SECURE_ENCODED_MAX];
+static uint8_t *const frame = &sealed[TELEMETRY_OFFSET_CIPHERTEXT];
+
+//private functions
+static void Telemetry_put16(uint8_t *p, uint16_t value) {
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+// Queue the length bytes at frame, encrypted first if that is on
+static void Telemetry_send(uint16_t length) {
+	if (!encrypted) {
+		BackChannel_WriteBytes(encoded, Telemetry_cobsEncode(frame, length, encoded));
+		return;
+	}
+	Telemetry_put16(&sealed[TELEMETRY_OFFSET_SYNC], TELEMETRY_SECURE_SYNC);
+	if (SecureLink_seal(sealed, 2, frame, length, &sealed[TELEMETRY_OFFSET_NONCE],
+			&frame[length]) != STATUS_SUCCESS)
+		return;		// Never sent in the clear
+	BackChannel_WriteBytes(encoded, Telemetry_cobsEncode(sealed,
+			length + TELEMETRY_SECURE_OVERHEAD, encoded));
+}
+
+//public functions
+void Telemetry_setFormat(uint8_t newFormat) {
+	Telemetry_flush();
+	format = newFormat;
+}
+
+uint8_t Telemetry_getFormat() {
+	return format;
+}
+
+/** Seal binary and delta frames from the next one on, or stop.
+ * @return STATUS_FAIL if turning on with no key provisioned
+ */
+bool Telemetry_setEncryption(bool on) {
+	if (on && !SecureLink_hasKey())
+		return STATUS_FAIL;
+	Telemetry_flush();
+	encrypted = on;
+	return STATUS_SUCCESS;
+}
+
+bool Telemetry_isEncrypted() {
+	return encrypted;
+}
+
+/** COBS encode a block so that it contains no zero bytes, then append the
+ * zero delimiter.
+ * @param out Room for length + length / 254 + 2 bytes
+ * @return Bytes written to out, including the delimiter
+ */
+uint16_t Telemetry_cobsEncode(const uint8_t in[], uint16_t length, uint8_t out[]) {
+	uint16_t code = 0;		// Where the current run's length byte goes
+	uint16_t o = 1;
+	uint8_t run = 1;
+	uint16_t i;
+	for (i = 0; i < length; i++) {
+		if (in[i] == 0) {
+			out[code] = run;
+			code = o++;
+			run = 1;
+			continue;
+		}
+		out[o++] = in[i];
+		if (++run == 0xFF) {		// Longest run a code byte can describe
+			out[code] = run;
+			code = o++;
+			run = 1;
+		}
+	}
+	out[code] = run;
+	out[o++] = 0;
+	return o;
+}
+
+/** Queue one binary frame for a calibrated sample on the back channel.
+ * @param heading Tenths of a degree, as returned by Heading_fromXY()
+ */
+void Telemetry_sendFrame(const HMC_Sample *sample, int16_t heading) {
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_SYNC], TELEMETRY_SYNC);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_SEQUENCE], sequence++);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_TIMESTAMP], (uint16_t) sample->timestamp);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_TIMESTAMP + 2],
+			(uint16_t) (sample->timestamp >> 16));
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_X], sample->x);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_Y], sample->y);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_Z], sample->z);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_HEADING], heading);
+	frame[TELEMETRY_OFFSET_GAIN] = sample->gain;
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_CRC],
+			CrcCcitt_block(frame, TELEMETRY_OFFSET_CRC));
+	Telemetry_send(TELEMETRY_FRAME_SIZE);
+}
+
+/** Add a calibrated sample to the delta frame being built, sending the
+ * frame first if the sample starts a new block.
+ */
+void Telemetry_sendDelta(const HMC_Sample *sample) {
+	if (DeltaCodec_add(&codec, sample))
+		return;
+	Telemetry_flush();
+	DeltaCodec_add(&codec, sample);
+}
+
+/** Send one DeltaCodec block as a delta frame.
+ * @param length No more than TELEMETRY_BLOCK_MAX
+ */
+void Telemetry_sendBlock(const uint8_t data[], uint16_t length) {
+	uint8_t *p = &frame[TELEMETRY_OFFSET_BLOCK];
+	uint16_t i;
+
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_SYNC], TELEMETRY_DELTA_SYNC);
+	Telemetry_put16(&frame[TELEMETRY_OFFSET_SEQUENCE], sequence++);
+	for (i = 0; i < length; i++)
+		*p++ = data[i];
+	Telemetry_put16(p, CrcCcitt_block(frame, p - frame));
+	p += 2;
+	Telemetry_send(p - frame);
+}
+
+/** Send the part built delta frame, if there is one. */
+void Telemetry_flush() {
+	if (codec.length)
+		Telemetry_sendBlock(block, codec.length);
+	DeltaCodec_begin(&codec, block, sizeof block);
+}
@@ -0,0 +1,86 @@
+/*
+ * Telemetry.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Binary back channel sample frames, the alternative to the ASCII reading
+ * lines when bandwidth matters.  A binary frame is the little-endian layout below, CRC'd
+ * with CRC16-CCITT (poly 0x1021, seed 0xFFFF, MSB first, "123456789" ->
+ * 0x29B1, see CrcCcitt.h), then COBS encoded and terminated with a zero
+ * byte so the host can resynchronise on any 0x00.  This header is plain C
+ * so tools/telemetry_decode.c shares the layout.
+ *
+ * The delta format sends the same samples compressed by DeltaCodec, a
+ * block of up to DELTACODEC_KEYFRAME_INTERVAL samples per frame:
+ *
+ *     sync u16, sequence u16, DeltaCodec block, CRC16-CCITT u16
+ *
+ * A frame goes out when its block is full, so samples arrive in bursts.
+ *
+ * With encryption on, each binary or delta frame, CRC and all, is sealed
+ * by SecureLink and sent as the ciphertext of an encrypted frame:
+ *
+ *     sync u16, nonce (epoch u32, frame count u32), ciphertext, tag
+ *
+ * AES-128 CCM with the sync word as associated data: CTR mode under the
+ * per-frame nonce, and an 8 byte CBC-MAC tag.  Sealing runs on the CPU
+ * while the DMA sends the frames before it, so it adds no wire time as
+ * long as it takes less time than the UART does to send the frame; Bench
+ * measures both.  ASCII lines and command replies are never encrypted.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TELEMETRY_FORMAT_ASCII		0
+#define TELEMETRY_FORMAT_BINARY		1
+#define TELEMETRY_FORMAT_DELTA		2
+
+// Binary frame layout, byte offsets before COBS encoding
+#define TELEMETRY_SYNC				0xA55A	// Also identifies the layout version
+#define TELEMETRY_OFFSET_SYNC		0		// uint16_t
+#define TELEMETRY_OFFSET_SEQUENCE	2		// uint16_t, +1 per frame
+#define TELEMETRY_OFFSET_TIMESTAMP	4		// uint32_t Timebase ticks
+#define TELEMETRY_OFFSET_X			8		// int16_t counts after calibration
+#define TELEMETRY_OFFSET_Y			10
+#define TELEMETRY_OFFSET_Z			12
+#define TELEMETRY_OFFSET_HEADING	14		// int16_t tenths of a degree
+#define TELEMETRY_OFFSET_GAIN		16		// uint8_t HMC5883L gain setting
+#define TELEMETRY_OFFSET_CRC		17		// uint16_t over bytes 0..16
+#define TELEMETRY_FRAME_SIZE		19
+// COBS adds one byte per 254 plus the trailing delimiter
+#define TELEMETRY_ENCODED_MAX		(TELEMETRY_FRAME_SIZE + 2)
+
+// Delta frame layout
+#define TELEMETRY_DELTA_SYNC		0xA55D
+#define TELEMETRY_OFFSET_BLOCK		4		// After sync and sequence
+#define TELEMETRY_BLOCK_MAX			128		// DeltaCodec block bytes
+#define TELEMETRY_DELTA_MAX			(TELEMETRY_OFFSET_BLOCK + TELEMETRY_BLOCK_MAX + 2)
+#define TELEMETRY_DELTA_ENCODED_MAX	(TELEMETRY_DELTA_MAX + 2)
+
+// Encrypted frame layout
+#define TELEMETRY_SECURE_SYNC		0xA55E
+#define TELEMETRY_OFFSET_NONCE		2
+#define TELEMETRY_OFFSET_CIPHERTEXT	(TELEMETRY_OFFSET_NONCE + SECURELINK_NONCE_SIZE)
+#define TELEMETRY_SECURE_OVERHEAD	(TELEMETRY_OFFSET_CIPHERTEXT + SECURELINK_TAG_SIZE)
+#define TELEMETRY_SECURE_MAX		(TELEMETRY_DELTA_MAX + TELEMETRY_SECURE_OVERHEAD)
+#define TELEMETRY_SECURE_ENCODED_MAX	(TELEMETRY_SECURE_MAX + 2)
+
+#include "HMCAcquire.h"
+#include "SecureLink.h"
+
+void Telemetry_setFormat(uint8_t format);
+uint8_t Telemetry_getFormat();
+bool Telemetry_setEncryption(bool on);
+bool Telemetry_isEncrypted();
+void Telemetry_sendFrame(const HMC_Sample *sample, int16_t heading);
+void Telemetry_sendDelta(const HMC_Sample *sample);
+void Telemetry_sendBlock(const uint8_t block[], uint16_t length);
+void Telemetry_flush();
+uint16_t Telemetry_cobsEncode(const uint8_t in[], uint16_t length, uint8_t out[]);
+
+#endif /* TELEMETRY_H_ */
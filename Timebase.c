@@ -0,0 +1,109 @@
+/*
+ * Timebase.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "Timebase.h"
+
+static volatile uint16_t overflows = 0;	// Upper 16 bits of the tick count
+static volatile bool alarmArmed = false;
+static uint32_t alarmTime;
+
+//private functions
+// Enable the compare once the alarm is within one timer period.  Must be
+// called with interrupts disabled or from the ISR.
+// Returns true if the alarm is already due.
+static bool Timebase_armCompare() {
+	int32_t remaining = (int32_t) (alarmTime - Timebase_now());
+	if (remaining <= 1) {
+		// Too close to be sure of catching the compare
+		alarmArmed = false;
+		TA1CCTL1 &= ~CCIE;
+		return true;
+	}
+	if (remaining < 0x10000 && !(TA1CCTL1 & CCIE)) {
+		TA1CCTL1 &= ~CCIFG;
+		TA1CCTL1 |= CCIE;
+	}
+	return false;
+}
+
+//public functions
+void Timebase_init() {
+	TIMER_A_initContinuousModeParam param = { 0 };
+	param.clockSource = TIMER_A_CLOCKSOURCE_ACLK;
+	param.clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+	param.timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_ENABLE;
+	param.timerClear = TIMER_A_DO_CLEAR;
+	param.startTimer = true;
+	overflows = 0;
+	TIMER_A_initContinuousMode(TIMEBASE_BASE, &param);
+	alarmArmed = false;
+	TA1CCTL1 = 0;	// Compare mode, interrupt off until an alarm is set
+}
+
+/** Current time in ACLK ticks.
+ * Safe from ISRs.  An overflow that has happened but not yet been serviced
+ * (we may be running with interrupts off) is accounted for via TAIFG.
+ */
+uint32_t Timebase_now() {
+	uint16_t sr = __get_SR_register();
+	uint16_t high, low;
+	__disable_interrupt();
+	high = overflows;
+	do {
+		low = TA1R;	// TA1 runs from ACLK, so read until two reads agree
+	} while (low != TA1R);
+	if ((TA1CTL & TAIFG) && low < 0x8000)
+		high++;
+	__bis_SR_register(sr & GIE);
+	return ((uint32_t) high << 16) | low;
+}
+
+/** Wake the main loop from low power mode at a given time.
+ * The alarm reaches more than one timer period ahead: the compare is only
+ * enabled by the overflow that brings it within range.  Setting an alarm
+ * replaces any earlier one.
+ * @param when Timebase_now() ticks
+ * @return false if when is already due, in which case don't sleep for it
+ */
+bool Timebase_setAlarm(uint32_t when) {
+	uint16_t sr = __get_SR_register();
+	bool due;
+	__disable_interrupt();
+	TA1CCTL1 &= ~CCIE;
+	TA1CCR1 = (uint16_t) when;
+	alarmTime = when;
+	alarmArmed = true;
+	due = Timebase_armCompare();
+	__bis_SR_register(sr & GIE);
+	return !due;
+}
+
+void Timebase_cancelAlarm() {
+	uint16_t sr = __get_SR_register();
+	__disable_interrupt();
+	alarmArmed = false;
+	TA1CCTL1 &= ~CCIE;
+	__bis_SR_register(sr & GIE);
+}
+
+#pragma vector = TIMER1_A1_VECTOR
+__interrupt void Timebase_TIMER1_A1_ISR(void) {
+	switch (__even_in_range(TA1IV, 14)) {
+	case TAxIV_TACCR1:
+		TA1CCTL1 &= ~CCIE;
+		alarmArmed = false;
+		__bic_SR_register_on_exit(LPM3_bits);
+		break;
+	case TAxIV_TAIFG:
+		overflows++;
+		if (alarmArmed && Timebase_armCompare())
+			__bic_SR_register_on_exit(LPM3_bits);
+		break;
+	default:
+		break;
+	}
+}
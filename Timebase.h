@@ -0,0 +1,26 @@
+/*
+ * Timebase.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Free running 32-bit tick count from TIMER_A1 clocked by ACLK.  It keeps
+ * counting in LPM3, so it is the common timestamp for samples and events.
+ * Capture/compare 1 provides a single alarm that wakes the main loop.
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIMEBASE_BASE			(TIMER_A1_BASE)
+#define TIMEBASE_TICKS_PER_SEC	32768		// ACLK from REFO, see initClocks()
+
+void Timebase_init();
+uint32_t Timebase_now();
+bool Timebase_setAlarm(uint32_t when);
+void Timebase_cancelAlarm();
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Trace.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <driverlib.h>
+#include "Trace.h"
+#include "BackChannel.h"
+#include "BCUart.h"
+#include "CrcCcitt.h"
+#include "Telemetry.h"
+
+#define RING_MASK		(TRACE_RING_SIZE - 1)
+#define TX_HEADROOM		(TRACE_FRAME_MAX + TRACE_FRAME_MAX / 254 + 2)
+
+static volatile uint32_t ring[TRACE_RING_SIZE];
+static volatile uint8_t ringHead = 0;	// Written by whoever records
+static volatile uint8_t ringTail = 0;	// Written by Trace_drain()
+static volatile uint8_t overflows = 0;	// Timestamp bits 16-23
+static volatile uint16_t dropped = 0;
+
+//private functions
+static uint32_t Trace_now() {
+	uint16_t low = TB0R;
+	uint8_t high = overflows;
+	if ((TB0CTL & TBIFG) && low < 0x8000)
+		high++;
+	return ((uint32_t) high << 16) | low;
+}
+
+//public functions
+/** Start the 1 MHz timestamp clock on TIMER_B0 from SMCLK. */
+void Trace_init() {
+	TIMER_B_initContinuousModeParam param = { 0 };
+	param.clockSource = TIMER_B_CLOCKSOURCE_SMCLK;
+	param.clockSourceDivider = TIMER_B_CLOCKSOURCE_DIVIDER_16;
+	param.timerInterruptEnable_TBIE = TIMER_B_TBIE_INTERRUPT_ENABLE;
+	param.timerClear = TIMER_B_DO_CLEAR;
+	param.startTimer = true;
+	overflows = 0;
+	ringHead = 0;
+	ringTail = 0;
+	dropped = 0;
+	TIMER_B_initContinuousMode(TIMER_B0_BASE, &param);
+}
+
+/** Record an event.  Safe from any ISR; costs one 32-bit store. */
+void Trace_record(uint8_t id) {
+	uint16_t sr = __get_SR_register();
+	uint8_t head;
+	__disable_interrupt();
+	head = ringHead;
+	if (((head + 1) & RING_MASK) == ringTail) {
+		dropped++;
+	} else {
+		ring[head] = (Trace_now() << 8) | id;
+		ringHead = (head + 1) & RING_MASK;
+	}
+	__bis_SR_register(sr & GIE);
+}
+
+/** Send recorded events while the back channel transmitter has room.
+ * Call from a low priority task; frames never make the transmitter block.
+ */
+void Trace_drain() {
+	uint8_t frame[TRACE_FRAME_MAX];
+	uint8_t encoded[TX_HEADROOM];
+	uint8_t count;
+	uint8_t tail;
+	uint8_t *p;
+	uint32_t event;
+	uint16_t sr;
+	uint16_t crc;
+
+	while (ringTail != ringHead
+			&& BC_TXBUF_SIZE - bcUartTxPending() > TX_HEADROOM) {
+		sr = __get_SR_register();
+		__disable_interrupt();
+		frame[TRACE_OFFSET_SYNC] = (uint8_t) TRACE_SYNC;
+		frame[TRACE_OFFSET_SYNC + 1] = (uint8_t) (TRACE_SYNC >> 8);
+		frame[TRACE_OFFSET_DROPPED] = (uint8_t) dropped;
+		frame[TRACE_OFFSET_DROPPED + 1] = (uint8_t) (dropped >> 8);
+		dropped = 0;
+		__bis_SR_register(sr & GIE);
+
+		p = &frame[TRACE_OFFSET_EVENTS];
+		tail = ringTail;
+		for (count = 0; count < TRACE_FRAME_EVENTS && tail != ringHead;
+				count++) {
+			event = ring[tail];
+			*p++ = (uint8_t) event;
+			*p++ = (uint8_t) (event >> 8);
+			*p++ = (uint8_t) (event >> 16);
+			*p++ = (uint8_t) (event >> 24);
+			tail = (tail + 1) & RING_MASK;
+		}
+		ringTail = tail;
+		frame[TRACE_OFFSET_COUNT] = count;
+		crc = CrcCcitt_block(frame, p - frame);
+		*p++ = (uint8_t) crc;
+		*p++ = (uint8_t) (crc >> 8);
+		BackChannel_WriteBytes(encoded,
+				Telemetry_cobsEncode(frame, p - frame, encoded));
+	}
+}
+
+#pragma vector = TIMER0_B1_VECTOR
+__interrupt void Trace_TIMER0_B1_ISR(void) {
+	switch (__even_in_range(TB0IV, 14)) {
+	case TBxIV_TBIFG:
+		overflows++;
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,59 @@
+/*
+ * Trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Event tracing for timing work in ISRs and drivers, built in with
+ * TRACE_ENABLE defined and compiled out to nothing otherwise.  TRACE(id)
+ * stores one 32-bit word in a RAM ring: the event id in the low byte and a
+ * 24-bit microsecond timestamp from TIMER_B0 above it.  Trace_drain() sends
+ * what has collected over the back channel when the transmitter has room,
+ * as COBS frames like Telemetry's:
+ *
+ *     sync u16, dropped u16, count u8, count events u32, CRC16-CCITT u16
+ *
+ * This header is plain C so tools/trace_decode.c shares the ids and layout.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_RING_SIZE			64		// Events, must be a power of two
+#define TRACE_TICKS_PER_SEC		1000000	// SMCLK / 16
+#define TRACE_TIME_BITS			24		// Wraps after 16.7 s
+
+// Event ids
+#define TRACE_DRDY				0x01	// HMC5883L DRDY edge, PORT2 ISR
+#define TRACE_I2C_START			0x02	// Transaction put on the bus
+#define TRACE_I2C_DONE			0x03	// Transaction finished, USCI/DMA ISR
+#define TRACE_I2C_TIMEOUT		0x04	// Hung bus found, recovery starts
+#define TRACE_SAMPLE_READY		0x05	// Sample in the HMCAcquire ring
+#define TRACE_TASK_START		0x06	// Scheduler runs a task
+#define TRACE_TASK_END			0x07
+#define TRACE_WAKE				0x08	// Scheduler woke from low power mode
+#define TRACE_UART_RX			0x09	// Back channel byte received
+#define TRACE_UART_TX_DONE		0x0A	// Back channel DMA block sent
+
+// Frame layout, byte offsets before COBS encoding
+#define TRACE_SYNC				0xA57E
+#define TRACE_OFFSET_SYNC		0		// uint16_t
+#define TRACE_OFFSET_DROPPED	2		// uint16_t, events lost to a full ring
+#define TRACE_OFFSET_COUNT		4		// uint8_t
+#define TRACE_OFFSET_EVENTS		5		// count x uint32_t
+#define TRACE_FRAME_EVENTS		16		// Most events per frame
+#define TRACE_FRAME_MAX			(TRACE_OFFSET_EVENTS + 4 * TRACE_FRAME_EVENTS + 2)
+
+#ifdef TRACE_ENABLE
+#define TRACE(id)				Trace_record(id)
+#else
+#define TRACE(id)				((void) 0)
+#endif
+
+void Trace_init();
+void Trace_record(uint8_t id);
+void Trace_drain();
+
+#endif /* TRACE_H_ */
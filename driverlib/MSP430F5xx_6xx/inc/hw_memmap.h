@@ -358,4 +358,15 @@
                                                                         #define WDT_A_BASE                      __MSP430_BASEADDRESS_WDT_A__
 #endif
 
+//*****************************************************************************
+//
+// DRIVERLIB_HOST_SIM also routes the registers named in msp430.h, see
+// tools/sim/sim_regs.h.  They have to be declared first.
+//
+//*****************************************************************************
+#ifdef DRIVERLIB_HOST_SIM
+#include "hw_regaccess.h"
+#include "../../../tools/sim/sim_regs.h"
+#endif
+
 #endif // #ifndef __HW_MEMMAP__
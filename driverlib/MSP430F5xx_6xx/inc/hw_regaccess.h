@@ -45,13 +45,25 @@
 //
 // Macros for hardware access
 //
+// DRIVERLIB_HOST_SIM routes them into the host simulator in tools/sim.
+//
 //*****************************************************************************
+#ifdef DRIVERLIB_HOST_SIM
+#include "../../../tools/sim/sim.h"
+#define HWREG32(x)                                                              \
+        (*Sim_reg32((uint16_t)(x)))
+#define HWREG16(x)                                                             \
+        (*Sim_reg16((uint16_t)(x)))
+#define HWREG8(x)                                                             \
+        (*Sim_reg8((uint16_t)(x)))
+#else
 #define HWREG32(x)                                                              \
         (*((volatile uint32_t*)((uint16_t)x)))
 #define HWREG16(x)                                                             \
         (*((volatile uint16_t*)((uint16_t)x)))
 #define HWREG8(x)                                                             \
         (*((volatile uint8_t*)((uint16_t)x)))
+#endif
 
 //*****************************************************************************
 //
@@ -63,7 +63,8 @@ MEMORY
     INFOC                   : origin = 0x1880, length = 0x0080
     INFOD                   : origin = 0x1800, length = 0x0080
     FLASH                   : origin = 0x4400, length = 0xBB80
-    FLASH2                  : origin = 0x10000,length = 0x14400
+    FLASH2                  : origin = 0x10000,length = 0xC400
+    FLASHLOG                : origin = 0x1C400,length = 0x8000  /* Bank D, FlashLog.c */
     INT00                   : origin = 0xFF80, length = 0x0002
     INT01                   : origin = 0xFF82, length = 0x0002
     INT02                   : origin = 0xFF84, length = 0x0002
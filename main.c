@@ -2,12 +2,50 @@
 #include "HMC5883L.h"
 #include <driverlib.h>
 #include "BackChannel.h"
+#include "HMCAcquire.h"
+#include "ADCAcquire.h"
+#include "Timebase.h"
+#include "Heading.h"
+#include "MagCal.h"
+#include "SecureLink.h"
+#include "Telemetry.h"
+#include "Command.h"
+#include "Scheduler.h"
+#include "I2CEngine.h"
+#include "LCD.h"
+#include "FlashLog.h"
+#include "Trace.h"
+#ifdef BENCHMARK
+#include "Bench.h"
+#endif
 #include <stdio.h>
-#include <math.h>
 
 void initClocks(uint32_t mclkFreq);
-void AddValueToStringAt(char * text[], int16_t val, uint8_t position);
-char * itoa(uint16_t val);
+void processSamples(Scheduler_Task *task);
+void processReadings(Scheduler_Task *task);
+void pollCommands(Scheduler_Task *task);
+void watchI2C(Scheduler_Task *task);
+
+#define SAMPLE_BATCH_SIZE	4	// Samples per run of sampleTask
+#define COMMAND_POLL_MS		50
+#define I2C_WATCH_MS		I2CENGINE_POLL_MS
+#define CONNECT_ATTEMPTS	3	// Bus recoveries before giving up on the sensor
+#define BENCH_REPORT_MS		10000
+#define TRACE_DRAIN_MS		100
+
+Scheduler_Task sampleTask;
+Scheduler_Task adcTask;
+Scheduler_Task commandTask;
+Scheduler_Task i2cTask;
+#ifdef TRACE_ENABLE
+void drainTrace(Scheduler_Task *task);
+Scheduler_Task traceTask;
+#endif
+#ifdef BENCHMARK
+void reportBench(Scheduler_Task *task);
+Scheduler_Task benchTask;
+static uint32_t samplesProcessed = 0;
+#endif
 /*
  * main.c
  */
@@ -15,73 +53,154 @@ int main(void) {
     WDTCTL = WDTPW | WDTHOLD;	// Stop watchdog timer
     initClocks(16000000);
     UCS_setExternalClockSource(32768, 4194304);
+    Timebase_init();
+#ifdef TRACE_ENABLE
+    Trace_init();
+#endif
 
-    BackChannel_Open(38400);
+    BackChannel_Open(57600);
     BackChannel_WriteLine("Back channel active.");
+    I2CEngine_initBus(HMCI2C_BASE, I2CENGINE_FAST_MODE);  // Shared with the LCD
     HMC_initialize();
-    if (HMC_testConnection() != STATUS_SUCCESS)
+    uint8_t attempt = 1;
+    while (HMC_testConnection() != STATUS_SUCCESS)
     {
-        BackChannel_WriteLine("Magnometer connection failed.");
-        for(;;)
-        	LPM0;//Die to low power mode
+        if (attempt++ == CONNECT_ATTEMPTS)
+        {
+            BackChannel_WriteLine("Magnometer connection failed.");
+            for(;;)
+            	LPM0;//Die to low power mode
+        }
+        // A sensor that browned out mid-read can hold SDA low until clocked.
+        // Recovery replays its configuration too.
+        BackChannel_WriteLine("Recovering I2C bus.");
+        I2CEngine_recover(HMCI2C_BASE);
     }
     BackChannel_WriteLine("Magnometer initialized.");
-    int16_t x, y, z;
-    float headingFactor, heading;
-    headingFactor = 180.0 / 3.14159265;//M_PI;
-    unsigned char * readingText = "Reading:\tX=#####\tY=#####\tZ=#####";
-    while(1)
+    int16_t gainCorrection[3];
+    if (HMC_selfTest(gainCorrection) != STATUS_SUCCESS)
+        BackChannel_WriteLine("Magnometer self-test failed.");
+    else
+        HMC_setGainCorrection(gainCorrection);
+    MagCal_init();
+    SecureLink_init();  // A new nonce epoch every boot
+    FlashLog_init();
+    if (LCD_init() == STATUS_SUCCESS)
+        LCD_print("Compass");
+#ifdef BENCHMARK
+    Bench_init();
+    Bench_run();
+#endif
+
+    Scheduler_init();
+    Scheduler_holdLpm0();  // USCI_A1 and USCI_B1 run from SMCLK
+    sampleTask.function = processSamples;
+    sampleTask.deadline = SCHEDULER_MS(50);  // Before the next batch at 75 Hz
+    Scheduler_add(&sampleTask);
+    adcTask.function = processReadings;
+    adcTask.deadline = SCHEDULER_MS(400);  // Before the next block, 500 ms on
+    Scheduler_add(&adcTask);
+    commandTask.function = pollCommands;
+    commandTask.deadline = 0;
+    Scheduler_add(&commandTask);
+    Scheduler_startPeriodic(&commandTask, 0, SCHEDULER_MS(COMMAND_POLL_MS));
+    i2cTask.function = watchI2C;
+    i2cTask.deadline = 0;
+    Scheduler_add(&i2cTask);
+    Scheduler_startPeriodic(&i2cTask, 0, SCHEDULER_MS(I2C_WATCH_MS));
+#ifdef BENCHMARK
+    benchTask.function = reportBench;
+    benchTask.deadline = 0;
+    Scheduler_add(&benchTask);
+    Scheduler_startPeriodic(&benchTask, SCHEDULER_MS(BENCH_REPORT_MS),
+            SCHEDULER_MS(BENCH_REPORT_MS));
+#endif
+#ifdef TRACE_ENABLE
+    traceTask.function = drainTrace;  // Last added, so runs after the rest
+    traceTask.deadline = 0;
+    Scheduler_add(&traceTask);
+    Scheduler_startPeriodic(&traceTask, 0, SCHEDULER_MS(TRACE_DRAIN_MS));
+#endif
+    HMCAcquire_notify(&sampleTask);
+    HMCAcquire_start(SAMPLE_BATCH_SIZE);
+    ADCAcquire_notify(&adcTask);
+    ADCAcquire_start();
+    Scheduler_run();
+}
+
+// Posted by HMCAcquire each time a batch is in the ring.  The sample rate
+// follows HMC_setDataRate().
+void processSamples(Scheduler_Task *task)
+{
+    HMC_Sample sample;
+    int16_t heading;
+    while (HMCAcquire_read(&sample))
     {
-    	HMC_getHeading(&x,&y,&z);
-    	AddValueToStringAt(&readingText, x, 11);
-    	AddValueToStringAt(&readingText, y, 19);
-    	AddValueToStringAt(&readingText, z, 27);
-    	BackChannel_WriteLine(readingText);
-    	heading = atan2(x,y) * headingFactor;
-    	BackChannel_Write("Heading:  ");
-    	BackChannel_WriteLine(itoa((int)heading));
-    	__delay_cycles(100000);  // sample rate ~100 samples/sec
+    	if (!HMC_autoRange(sample.x, sample.y, sample.z, sample.gain))
+    		continue;
+    	// Calibration holds at any gain once every sample is on one scale
+    	HMC_normalize(&sample.x, &sample.y, &sample.z, sample.gain);
+    	sample.gain = HMC5883L_GAIN_REFERENCE;
+    	if (Command_isCalibrating())
+    		MagCal_collect(sample.x, sample.y, sample.z);
+    	MagCal_apply(&sample.x, &sample.y, &sample.z);
+    	heading = Heading_fromXY(sample.x, sample.y);  // tenths of a degree
+#ifdef BENCHMARK
+    	samplesProcessed++;
+#endif
+    	if (FlashLog_isRecording()
+    			|| (!BackChannel_HostPresent() && !FlashLog_isFull()))
+    		FlashLog_append(&sample);  // Kept rather than lost, one lap
+    	if (Telemetry_getFormat() == TELEMETRY_FORMAT_BINARY)
+    	{
+    		Telemetry_sendFrame(&sample, heading);
+    		continue;
+    	}
+    	if (Telemetry_getFormat() == TELEMETRY_FORMAT_DELTA)
+    	{
+    		Telemetry_sendDelta(&sample);  // Host works out the heading
+    		continue;
+    	}
+    	BackChannel_Printf("Reading:\tX=%6d\tY=%6d\tZ=%6d\r\nHeading:  %5.1d\r\n",
+    			sample.x, sample.y, sample.z, heading);
     }
+    FlashLog_service();  // The ring is empty, the longest gap before it fills
+}
+
+// Posted by ADCAcquire with each block.  Taking it frees the half of the
+// buffer the DMA fills next; the "adc read" command shows the latest set.
+void processReadings(Scheduler_Task *task)
+{
+    ADC_Reading readings[ADCACQUIRE_SETS];
+    ADCAcquire_read(readings);
 }
 
-void AddValueToStringAt(char * text[], int16_t val, uint8_t position)
+// Settings change between batches, sampling carries on
+void pollCommands(Scheduler_Task *task)
 {
-	//Add the 5 digit value into str at position
-	char * str = *text;
-	str += position + 5;
-	uint8_t len = 5;
-	   do
-	   {
-	      *str = val%10 + 48;
-	      val /= 10;
-	      str--;
-	      len--;
-	   } while (val);
-	   do {
-		   *str = 32;
-	   } while (len--);
+    Command_poll();
 }
 
-char * itoa(uint16_t val)
+#ifdef BENCHMARK
+void reportBench(Scheduler_Task *task)
 {
-	   char res[5];
-	   int len = 0;
-	   do
-	   {
-	      res[len] = val%10+48;
-	      val/=10;
-	      ++len;
-	   } while (val > 0);
-	   while(len++ < 5)
-		   res[len] = 32; //Pa
-	   res[len] = 0; //null-terminating
+    Bench_residency(samplesProcessed);
+}
+#endif
 
-	   //now we need to reverse res
-	   for(len = 0; len < 2; ++len)
-	   {
-	       char c = res[len]; res[len] = res[5-len-1]; res[5-len-1] = c;
-	   }
-	   return res;
+#ifdef TRACE_ENABLE
+// Binary frames between samples, decode with tools/trace_decode
+void drainTrace(Scheduler_Task *task)
+{
+    Trace_drain();
+}
+#endif
+
+// Recovers a hung bus while acquisition runs on callbacks, with nothing
+// sitting in I2CEngine_wait() to notice
+void watchI2C(Scheduler_Task *task)
+{
+    I2CEngine_poll();
 }
 
 void initClocks(uint32_t mclkFreq)
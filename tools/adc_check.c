@@ -0,0 +1,199 @@
+/*
+ * adc_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs ADCAcquire.c against the Timer_A, ADC12_A and DMA models in
+ * tools/sim: TA0.1 paces the conversions, the end of each sequence moves
+ * the block into the double buffer and the DMA interrupt wakes the loop
+ * here.  Every input the ADC model is asked for is recorded, so each
+ * reading can be checked against the conversion it came from: the channel
+ * order, the calibration arithmetic and the timestamp.  Then that the CPU
+ * woke once per block, that a main loop falling behind loses whole blocks,
+ * counted in ADCAcquire_overruns, with the block it held intact, and that
+ * ADCAcquire_stop() stops the conversions.
+ *
+ * DMAService.c reads DMAIV by name, which the sim can't see, so the DMA
+ * ISR here stands in for it; TLV_getInfo() gives a made-up calibration.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o adc_check tools/adc_check.c ADCAcquire.c tools/sim/sim.c
+ *        tools/sim/sim_models.c driverlib/MSP430F5xx_6xx/adc12_a.c
+ *        driverlib/MSP430F5xx_6xx/dma.c driverlib/MSP430F5xx_6xx/ref.c
+ *        driverlib/MSP430F5xx_6xx/timer_a.c driverlib/MSP430F5xx_6xx/gpio.c
+ * Usage:      adc_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#include "ADCAcquire.h"
+#include "DMAService.h"
+#include "tools/sim/sim.h"
+
+#define TICKS_PER_SEC	32768		// TIMEBASE_TICKS_PER_SEC
+#define ADC_VECTOR_SIM	40			// Any vectors nothing else uses
+#define DMA_VECTOR_SIM	41
+#define TA0_VECTOR_SIM	42
+#define TA0_CCR0_SIM	43
+#define BLOCKS			40			// Read as they come, before and after the stall
+#define STALL_BLOCKS	4			// Block times the loop stops reading for
+#define CONVERSIONS_MAX	((2 * BLOCKS + STALL_BLOCKS + 2) * ADCACQUIRE_BLOCK)
+#define BLOCK_CYCLES	((uint64_t) ADCACQUIRE_SETS * ADCACQUIRE_SET_TICKS * SIM_MCLK / TICKS_PER_SEC)
+
+typedef struct Conversion {
+	uint8_t channel;
+	uint16_t raw;
+	uint64_t cycles;
+} Conversion;
+
+static const uint8_t channels[ADCACQUIRE_CHANNELS] = { 11, 10, 0 };	// INCHx
+static const struct s_TLV_ADC_Cal_Data adcCal = { 0x8123, -3, 0, 0, 0, 0, 1205,
+		1441 };
+static const struct s_TLV_REF_Cal_Data refCal = { 0x8000, 0x8000, 0x7F60 };
+
+static Conversion conversions[CONVERSIONS_MAX];
+static uint32_t converted;
+static Scheduler_Task task;
+static DMAService_Handler handlers[DMASERVICE_CHANNELS];
+static uint32_t wakes;
+
+// What ADCAcquire.c calls outside the models
+uint32_t Timebase_now() {
+	return (uint32_t) (Sim_cycles * TICKS_PER_SEC / SIM_MCLK);
+}
+
+bool Scheduler_post(Scheduler_Task *t) {
+	t->posted = true;
+	return true;
+}
+
+void TLV_getInfo(uint8_t tag, uint8_t instance, uint8_t *length,
+		uint16_t **data_address) {
+	*length = 0;
+	*data_address = 0;
+	if (tag == TLV_TAG_ADC12CAL) {
+		*length = sizeof adcCal;
+		*data_address = (uint16_t *) &adcCal;
+	} else if (tag == TLV_TAG_REFCAL) {
+		*length = sizeof refCal;
+		*data_address = (uint16_t *) &refCal;
+	}
+}
+
+void DMAService_setHandler(uint8_t channelSelect, DMAService_Handler handler) {
+	handlers[channelSelect >> 4] = handler;
+}
+
+static void dmaIsr(void) {
+	uint16_t channel = HWREG16(DMA_BASE + OFS_DMAIV) >> 1;
+	if (channel && handlers[channel - 1] && handlers[channel - 1]())
+		__bic_SR_register_on_exit(LPM3_bits);
+}
+
+static uint16_t input(uint8_t channel) {
+	uint16_t raw = (uint16_t) (rand() & 0x0FFF);
+	if (converted < CONVERSIONS_MAX) {
+		conversions[converted].channel = channel;
+		conversions[converted].raw = raw;
+		conversions[converted].cycles = Sim_cycles;
+	}
+	converted++;
+	return raw;
+}
+
+// The TLV corrections as SLAU208 gives them, then to millivolts
+static double millivolts(uint16_t raw) {
+	int32_t code = (int32_t) (((uint32_t) raw * refCal.ref_ref25) >> 15);
+	code = (int32_t) (((uint32_t) code * adcCal.adc_gain_factor) >> 15)
+			+ adcCal.adc_offset;
+	code = code < 0 ? 0 : (code > 4095 ? 4095 : code);
+	return code * 2500.0 / 4096;
+}
+
+// Readings of a block against the conversions that made it.  Returns
+// mismatches.
+static uint32_t check(const ADC_Reading readings[], uint32_t block) {
+	const Conversion *c;
+	uint32_t bad = 0;
+	uint32_t ticks;
+	double temperature;
+	uint8_t s, k;
+	for (s = 0; s < ADCACQUIRE_SETS; s++) {
+		c = &conversions[(block * ADCACQUIRE_SETS + s) * ADCACQUIRE_CHANNELS];
+		for (k = 0; k < ADCACQUIRE_CHANNELS; k++)
+			bad += c[k].channel != channels[k];
+		temperature = (c[1].raw - adcCal.adc_ref25_30_temp) * 550.0
+				/ (adcCal.adc_ref25_85_temp - adcCal.adc_ref25_30_temp) + 300;
+		ticks = (uint32_t) (c[2].cycles * TICKS_PER_SEC / SIM_MCLK);
+		bad += fabs(readings[s].supply - 2 * millivolts(c[0].raw)) > 2
+				|| fabs(readings[s].temperature - temperature) > 1
+				|| fabs(readings[s].analog - millivolts(c[2].raw)) > 1
+				|| labs((long) (readings[s].timestamp - ticks)) > 2;
+	}
+	return bad;
+}
+
+// Sleep in LPM3 until the next block, then check it.  expected is the block
+// it should be, by count from the start.
+static uint32_t readBlock(uint32_t expected) {
+	ADC_Reading readings[ADCACQUIRE_SETS];
+	while (!task.posted) {
+		__bis_SR_register(LPM3_bits + GIE);
+		wakes++;
+	}
+	task.posted = false;
+	if (!ADCAcquire_read(readings))
+		return 1;
+	return check(readings, expected);
+}
+
+// Time passing with the loop busy elsewhere, interrupts on
+static void busy(uint64_t cycles) {
+	uint64_t end = Sim_cycles + cycles;
+	while (Sim_cycles < end)
+		__delay_cycles(SIM_IDLE_STEP);
+}
+
+int main(int argc, char *argv[]) {
+	Sim_Model *timer;
+	uint32_t block, bad = 0, stallBad, stopped;
+	uint16_t dropped;
+
+	Sim_reset();
+	timer = Sim_timerA(TIMER_A0_BASE, TICKS_PER_SEC, TA0_CCR0_SIM, TA0_VECTOR_SIM);
+	Sim_adc12(ADC12_A_BASE, timer, ADC_VECTOR_SIM, input);
+	Sim_dma(DMA_BASE, DMA_VECTOR_SIM);
+	Sim_attach(DMA_VECTOR_SIM, dmaIsr);
+
+	ADCAcquire_notify(&task);
+	ADCAcquire_start();
+	for (block = 0; block < BLOCKS; block++)
+		bad += readBlock(block);
+	printf("steady,%lu blocks,%lu wakes,%lu overruns,%lu mismatched\n",
+			(unsigned long) BLOCKS, (unsigned long) wakes,
+			(unsigned long) ADCAcquire_overruns, (unsigned long) bad);
+	bad += wakes != BLOCKS || ADCAcquire_overruns != 0;
+
+	// The next block is held; the ones after it are dropped
+	busy(STALL_BLOCKS * BLOCK_CYCLES + BLOCK_CYCLES / 2);
+	dropped = ADCAcquire_overruns;
+	stallBad = readBlock(block++);
+	block += dropped;
+	for (; block < 2 * BLOCKS + STALL_BLOCKS; block++)
+		stallBad += readBlock(block);
+	printf("stalled,%u block times,%u dropped,%lu mismatched\n", STALL_BLOCKS,
+			dropped, (unsigned long) stallBad);
+	bad += stallBad + (dropped != STALL_BLOCKS - 1);
+
+	ADCAcquire_stop();
+	stopped = converted;
+	busy(2 * BLOCK_CYCLES);
+	printf("stopped,%lu conversions after\n", (unsigned long) (converted - stopped));
+	bad += converted != stopped;
+	return bad ? 1 : 0;
+}
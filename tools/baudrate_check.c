@@ -0,0 +1,168 @@
+/*
+ * baudrate_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * BaudRate_solveMode() against the commonly used baud rate tables in the
+ * USCI UART chapter of the F5xx family user's guide (SLAU208), each row
+ * solved in its own mode, low frequency or oversampling.  TI picked each
+ * row for the least error over transmit and receive together, and the
+ * solver for the least transmit error, so a row passes if the solver gives
+ * TI's setting or one whose transmit error is no worse.  The transmit error
+ * of both is worked out here in floating point from the user's guide bit
+ * timing, which also checks the error the solver reports, and a setting
+ * over BAUDRATE_MAX_ERROR has to be refused.  Then BaudRate_solve() has to
+ * pick oversampling from 16 clocks a bit and low frequency mode below.
+ *
+ * Build on Linux:  cc -O2 -o baudrate_check baudrate_check.c ../BaudRate.c
+ * Usage:           baudrate_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include "../BaudRate.h"
+
+typedef struct Row {
+	uint32_t clock;
+	uint32_t baudrate;
+	uint16_t ucbr;
+	uint8_t ucbrs;
+	uint8_t ucbrf;
+	bool ucos16;
+} Row;
+
+// BITCLK modulation pattern, user's guide: bit i of the frame gets an extra
+// clock if bit i of the UCBRSx entry is set
+static const uint8_t pattern[8] = { 0x00, 0x02, 0x22, 0x2A, 0xAA, 0xAE, 0xEE,
+		0xFE };
+
+static const Row rows[] = {
+	// UCOS16 = 0
+	{ 32768, 1200, 27, 2, 0, false }, { 32768, 2400, 13, 6, 0, false },
+	{ 32768, 4800, 6, 7, 0, false }, { 32768, 9600, 3, 3, 0, false },
+	{ 1048576, 9600, 109, 2, 0, false }, { 1048576, 19200, 54, 5, 0, false },
+	{ 1048576, 38400, 27, 2, 0, false }, { 1048576, 56000, 18, 6, 0, false },
+	{ 1048576, 115200, 9, 1, 0, false }, { 1048576, 128000, 8, 1, 0, false },
+	{ 1048576, 256000, 4, 1, 0, false },
+	{ 1000000, 9600, 104, 1, 0, false }, { 1000000, 19200, 52, 0, 0, false },
+	{ 1000000, 38400, 26, 0, 0, false }, { 1000000, 56000, 17, 7, 0, false },
+	{ 1000000, 115200, 8, 6, 0, false }, { 1000000, 128000, 7, 7, 0, false },
+	{ 1000000, 256000, 3, 7, 0, false },
+	{ 4000000, 9600, 416, 6, 0, false }, { 4000000, 19200, 208, 3, 0, false },
+	{ 4000000, 38400, 104, 1, 0, false }, { 4000000, 56000, 71, 4, 0, false },
+	{ 4000000, 115200, 34, 6, 0, false }, { 4000000, 128000, 31, 2, 0, false },
+	{ 4000000, 256000, 15, 5, 0, false },
+	{ 8000000, 9600, 833, 2, 0, false }, { 8000000, 19200, 416, 6, 0, false },
+	{ 8000000, 38400, 208, 3, 0, false }, { 8000000, 56000, 142, 7, 0, false },
+	{ 8000000, 115200, 69, 4, 0, false }, { 8000000, 128000, 62, 4, 0, false },
+	{ 8000000, 256000, 31, 2, 0, false },
+	{ 16000000, 9600, 1666, 6, 0, false }, { 16000000, 19200, 833, 2, 0, false },
+	{ 16000000, 38400, 416, 6, 0, false }, { 16000000, 56000, 285, 6, 0, false },
+	{ 16000000, 115200, 138, 7, 0, false }, { 16000000, 128000, 125, 0, 0, false },
+	{ 16000000, 256000, 62, 4, 0, false },
+	// UCOS16 = 1
+	{ 1048576, 9600, 6, 0, 13, true }, { 1048576, 19200, 3, 1, 6, true },
+	{ 1048576, 57600, 1, 6, 0, true },
+	{ 1000000, 9600, 6, 0, 8, true }, { 1000000, 19200, 3, 0, 4, true },
+	{ 1000000, 57600, 1, 7, 0, true },
+	{ 4000000, 9600, 26, 0, 1, true }, { 4000000, 19200, 13, 0, 0, true },
+	{ 4000000, 38400, 6, 0, 8, true }, { 4000000, 57600, 4, 5, 3, true },
+	{ 4000000, 115200, 2, 3, 2, true }, { 4000000, 230400, 1, 7, 0, true },
+	{ 8000000, 9600, 52, 0, 1, true }, { 8000000, 19200, 26, 0, 1, true },
+	{ 8000000, 38400, 13, 0, 0, true }, { 8000000, 57600, 8, 0, 11, true },
+	{ 8000000, 115200, 4, 5, 3, true }, { 8000000, 230400, 2, 3, 2, true },
+	{ 8000000, 460800, 1, 7, 0, true },
+	{ 12000000, 9600, 78, 0, 2, true }, { 12000000, 19200, 39, 0, 1, true },
+	{ 12000000, 38400, 19, 0, 8, true }, { 12000000, 57600, 13, 0, 0, true },
+	{ 12000000, 115200, 6, 0, 8, true }, { 12000000, 230400, 3, 0, 4, true },
+	{ 16000000, 9600, 104, 0, 3, true }, { 16000000, 19200, 52, 0, 1, true },
+	{ 16000000, 38400, 26, 0, 1, true }, { 16000000, 57600, 17, 0, 6, true },
+	{ 16000000, 115200, 8, 0, 11, true }, { 16000000, 230400, 4, 5, 3, true },
+	{ 16000000, 460800, 2, 3, 2, true },
+	{ 20000000, 9600, 130, 0, 3, true }, { 20000000, 19200, 65, 0, 2, true },
+	{ 20000000, 38400, 32, 0, 9, true }, { 20000000, 57600, 21, 0, 12, true },
+	{ 20000000, 115200, 10, 0, 14, true }, { 20000000, 230400, 5, 0, 7, true },
+	{ 20000000, 460800, 2, 0, 11, true },
+};
+#define ROWS	(sizeof rows / sizeof rows[0])
+
+// Worst transmit bit edge error over an 8N1 frame, % of a bit.  Bit i lasts
+// (16 + m[i]) * UCBRx + UCBRFx clocks oversampling, UCBRx + m[i] not.
+static double txError(uint32_t clock, uint32_t baudrate, uint16_t ucbr,
+		uint8_t ucbrs, uint8_t ucbrf, bool ucos16) {
+	double end = 0, worst = 0, error;
+	int i, m;
+	for (i = 0; i < BAUDRATE_FRAME_BITS; i++) {
+		m = (pattern[ucbrs] >> (i & 7)) & 1;
+		end += ucos16 ? (16.0 + m) * ucbr + ucbrf : (double) ucbr + m;
+		error = fabs((end / clock - (i + 1.0) / baudrate) * baudrate * 100);
+		if (error > worst)
+			worst = error;
+	}
+	return worst;
+}
+
+int main(int argc, char *argv[]) {
+	BaudRate_Setting s;
+	const Row *r;
+	double tiError, error;
+	unsigned same = 0, better = 0, bad = 0;
+	bool solved;
+	unsigned i;
+
+	for (i = 0; i < ROWS; i++) {
+		r = &rows[i];
+		solved = BaudRate_solveMode(r->clock, r->baudrate, r->ucos16, &s);
+		tiError = txError(r->clock, r->baudrate, r->ucbr, r->ucbrs, r->ucbrf,
+				r->ucos16);
+		error = txError(r->clock, r->baudrate, s.ucbr, s.ucbrs, s.ucbrf, s.ucos16);
+		if (s.ucbr == r->ucbr && s.ucbrs == r->ucbrs && s.ucbrf == r->ucbrf
+				&& s.ucos16 == r->ucos16) {
+			same++;
+		} else if (error <= tiError + 0.005) {
+			better++;
+		} else {
+			bad++;
+			printf("worse,%lu Hz,%lu baud,TI %u/%u/%u/%d %.2f%%,"
+					"solved %u/%u/%u/%d %.2f%%\n", (unsigned long) r->clock,
+					(unsigned long) r->baudrate, r->ucbr, r->ucbrs, r->ucbrf,
+					r->ucos16, tiError, s.ucbr, s.ucbrs, s.ucbrf, s.ucos16, error);
+		}
+		if (fabs(error - s.error / 100.0) > 0.011
+				|| solved != (s.error <= BAUDRATE_MAX_ERROR)) {
+			bad++;
+			printf("reported,%lu Hz,%lu baud,%.2f%% reported %d,%s\n",
+					(unsigned long) r->clock, (unsigned long) r->baudrate,
+					error, s.error, solved ? "solved" : "refused");
+		}
+	}
+	printf("tables,%u rows,%u as TI,%u with less TX error,%u bad\n",
+			(unsigned) ROWS, same, better, bad);
+
+	for (i = 0; i < ROWS; i++) {
+		r = &rows[i];
+		BaudRate_solve(r->clock, r->baudrate, &s);
+		if (s.ucos16 != (r->clock / r->baudrate >= 16)) {
+			bad++;
+			printf("mode,%lu Hz,%lu baud,UCOS16 %d\n", (unsigned long) r->clock,
+					(unsigned long) r->baudrate, s.ucos16);
+		}
+	}
+
+	// The back channel's rates from 16 MHz SMCLK, and the modes at the edges
+	for (i = 0; i < 4; i++) {
+		static const uint32_t fast[4] = { 57600, 230400, 460800, 921600 };
+		solved = BaudRate_solve(16000000, fast[i], &s);
+		printf("smclk,16000000 Hz,%lu baud,%u/%u/%u/%d,%.2f%%\n",
+				(unsigned long) fast[i], s.ucbr, s.ucbrs, s.ucbrf, s.ucos16,
+				s.error / 100.0);
+		bad += !solved || s.error > 500;
+	}
+	bad += BaudRate_solve(16000000, 0, &s);
+	bad += BaudRate_solve(16000000, 8000000, &s);	// 2 clocks a bit
+	bad += !BaudRate_solve(16000000, 200, &s) || !s.ucos16;	// Only oversampled
+	bad += BaudRate_solveMode(16000000, 200, false, &s);	// UCBRx over 16 bits
+	bad += !BaudRate_solve(48000, 16000, &s);		// 3 clocks a bit, exact
+	printf("limits,%s\n", bad ? "bad" : "ok");
+	return bad ? 1 : 0;
+}
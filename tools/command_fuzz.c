@@ -0,0 +1,716 @@
+/*
+ * command_fuzz.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Random and oversized lines through Command_parse(), checked against a
+ * model of the command grammar written out here.  The modules the commands
+ * drive are stubs that log what they are asked to do, as are the back
+ * channel replies, and each line has to give the log the model expects.
+ * Lines are commands from the grammar with mixed case, odd spacing and
+ * arguments in and out of range, random words, random bytes (NULs and
+ * bytes over 0x7F among them), words either side of COMMAND_WORD_MAX and
+ * lines of thousands of bytes, ended by CR, LF or both.
+ *
+ * parse   Each line straight into Command_parse(), cut at random points.
+ * uart    Lines sent to the USCI_A1 model in tools/sim and parsed by
+ *         Command_poll() in place in BCUart's receive ring.  The main
+ *         loop either sleeps until a byte comes in or is busy for up to
+ *         BUSY_FRAMES frames at a time, so runs wrap the ring at any point
+ *         of a line.  No more than the ring holds is sent ahead of the
+ *         parser, so nothing may be lost.  A baud command ends a batch,
+ *         as the host has to wait for the reply before it changes rate.
+ * burst   BURST bytes with nothing polling: the ring keeps the first
+ *         BC_RXBUF_SIZE and counts the rest in bcUartRxOverruns, the lines
+ *         run together give only ERR, and the next command works.
+ *
+ * Build on Linux, from the project directory, best with
+ * -fsanitize=address,undefined added:
+ *     cc -O2 -g -fcommon -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o command_fuzz tools/command_fuzz.c Command.c BCUart.c BaudRate.c
+ *        DMAService.c tools/sim/sim.c tools/sim/sim_models.c
+ *        driverlib/MSP430F5xx_6xx/dma.c
+ *        driverlib/MSP430F5xx_6xx/usci_a_uart.c
+ * Usage:      command_fuzz [seed [lines]]
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "ADCAcquire.h"
+#include "BCUart.h"
+#include "BaudRate.h"
+#include "Command.h"
+#include "FlashLog.h"
+#include "HMC5883L.h"
+#include "I2CEngine.h"
+#include "MagCal.h"
+#include "SecureLink.h"
+#include "Telemetry.h"
+#include "tools/sim/sim.h"
+
+// MSP430F5529 vector numbers, so the priorities are the device's
+#define USCI_A1_VECTOR_SIM	46
+#define DMA_VECTOR_SIM		50
+
+#define LINES				100000		// Through Command_parse(), by default
+#define UART_SHARE			20			// One line in this many over the UART too
+#define LINE_MAX			4096
+#define LOG_MAX				8192
+#define BATCH_MAX			1024		// Bytes in a batch, short of a long line
+#define BUSY_FRAMES			8
+#define BURST				1000		// Fits SIM_UART_QUEUE
+#define WORD_LIMIT			(COMMAND_WORD_MAX + 1)	// Enough to tell too long
+
+typedef struct Log {
+	char text[LOG_MAX];
+	uint16_t length;
+	bool full;
+} Log;
+
+typedef struct Word {
+	char text[WORD_LIMIT];
+	uint16_t length;
+} Word;
+
+typedef struct Result {
+	const char *name;
+	uint32_t lines, bytes, ok, err, bad;
+} Result;
+
+// The drivers' ISRs, declared in their .c files only
+void bcUartISR(void);
+void DMAService_ISR(void);
+
+const I2CEngine_Device HMC_device = { HMCI2C_BASE, HMC5883L_ADDRESS, 1,
+		HMC5883L_I2C_SPEED };
+volatile uint16_t ADCAcquire_overruns = 0;
+
+static Sim_Model *uart;
+static Log expected, actual;
+static uint64_t seed = 1;
+static uint8_t rate = HMC5883L_RATE_75;
+static uint8_t format = TELEMETRY_FORMAT_ASCII;
+static bool encrypted = false;
+static FlashLog_Stats logStats;
+static I2CEngine_Stats i2cStats;
+
+// What the model of the grammar keeps track of
+static bool modelEncrypted = false;
+static bool modelCalibrating = false;
+static uint8_t modelFormat = TELEMETRY_FORMAT_ASCII;
+
+static void record(Log *log, const char *format, ...) {
+	va_list args;
+	int n;
+	va_start(args, format);
+	n = vsnprintf(&log->text[log->length], LOG_MAX - log->length, format, args);
+	va_end(args);
+	if (n < 0 || n + 1 >= LOG_MAX - log->length) {
+		log->full = true;
+		return;
+	}
+	log->length += n;
+	log->text[log->length++] = '\n';
+	log->text[log->length] = '\0';
+}
+
+static void clearLog(Log *log) {
+	log->length = 0;
+	log->text[0] = '\0';
+	log->full = false;
+}
+
+// The stubs, logging what the commands do
+uint32_t UCS_getSMCLK() {
+	return SIM_MCLK;
+}
+
+bool HMC_setDataRate(uint8_t value) {
+	rate = value;
+	record(&actual, "rate %u", value);
+	return STATUS_SUCCESS;
+}
+
+uint8_t HMC_getDataRate() {
+	return rate;
+}
+
+bool HMC_setGain(uint8_t gain) {
+	record(&actual, "gain %u", gain);
+	return STATUS_SUCCESS;
+}
+
+void Telemetry_setFormat(uint8_t value) {
+	format = value;
+	record(&actual, "format %u", value);
+}
+
+uint8_t Telemetry_getFormat() {
+	return format;
+}
+
+bool Telemetry_setEncryption(bool on) {
+	encrypted = on;
+	record(&actual, "crypt %u", on);
+	return STATUS_SUCCESS;
+}
+
+bool Telemetry_isEncrypted() {
+	return encrypted;
+}
+
+bool SecureLink_setKey(const uint8_t key[AES128_KEY_SIZE]) {
+	char hex[2 * AES128_KEY_SIZE + 1];
+	uint8_t i;
+	for (i = 0; i < AES128_KEY_SIZE; i++)
+		sprintf(&hex[2 * i], "%02x", key[i]);
+	record(&actual, "key %s", hex);
+	return STATUS_SUCCESS;
+}
+
+void MagCal_beginCollect() {
+	record(&actual, "cal start");
+}
+
+bool MagCal_finishCollect() {
+	record(&actual, "cal stop");
+	return STATUS_SUCCESS;
+}
+
+bool MagCal_save() {
+	record(&actual, "cal save");
+	return STATUS_SUCCESS;
+}
+
+bool MagCal_load() {
+	record(&actual, "cal load");
+	return STATUS_SUCCESS;
+}
+
+void MagCal_clear() {
+	record(&actual, "cal reset");
+}
+
+bool MagCal_setParams(const MagCal_Params *params) {
+	const int16_t *v = params->offset;	// The matrix follows on
+	record(&actual, "calset %04x %d %d %d %d %d %d %d %d %d %d %d %d",
+			params->magic, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7],
+			v[8], v[9], v[10], v[11]);
+	return STATUS_SUCCESS;
+}
+
+uint16_t HMCAcquire_busTime() {
+	record(&actual, "i2c budget");
+	return 850;
+}
+
+uint32_t I2CEngine_speed(const I2CEngine_Device *device) {
+	return device->speed;
+}
+
+const I2CEngine_Stats *I2CEngine_getStats(uint16_t base) {
+	record(&actual, "i2c stats");
+	return &i2cStats;
+}
+
+const FlashLog_Stats *FlashLog_getStats() {
+	return &logStats;
+}
+
+void FlashLog_start() {
+	record(&actual, "log start");
+}
+
+void FlashLog_stop() {
+	record(&actual, "log stop");
+}
+
+uint16_t FlashLog_dump() {
+	record(&actual, "log dump");
+	return 0;
+}
+
+void FlashLog_erase() {
+	record(&actual, "log erase");
+}
+
+bool FlashLog_isFull() {
+	return false;
+}
+
+bool ADCAcquire_latest(ADC_Reading *reading) {
+	memset(reading, 0, sizeof *reading);
+	record(&actual, "adc read");
+	return true;
+}
+
+void BackChannel_WriteLine(unsigned char text[]) {
+	record(&actual, "%s", text);
+}
+
+void BackChannel_WriteBytes(const uint8_t data[], uint16_t length) {
+}
+
+void BackChannel_Printf(const char *format, ...) {
+}
+
+bool BackChannel_SetBaudRate(uint32_t baudrate) {
+	record(&actual, "baud %lu", (unsigned long) baudrate);
+	return bcUartSetBaudRate(baudrate, 0);
+}
+
+static uint32_t random32() {
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return (uint32_t) (seed >> 16);
+}
+
+static uint32_t pick(uint32_t n) {
+	return random32() % n;
+}
+
+// The grammar in Command.h, over words as Command_parse() leaves them
+static bool is(const Word *word, const char *keyword) {
+	return word->length == strlen(keyword)
+			&& memcmp(word->text, keyword, word->length) == 0;
+}
+
+static int32_t number(const Word *word, int32_t max) {
+	int32_t value = 0;
+	uint16_t i;
+	if (word->length == 0 || word->length > COMMAND_DIGITS_MAX)
+		return -1;
+	for (i = 0; i < word->length; i++) {
+		if (word->text[i] < '0' || word->text[i] > '9')
+			return -1;
+		value = value * 10 + (word->text[i] - '0');
+	}
+	return (value <= max) ? value : -1;
+}
+
+static bool modelKey(const Word *key) {
+	uint16_t i;
+	if (key->length != 2 * AES128_KEY_SIZE)
+		return false;
+	for (i = 0; i < key->length; i++)
+		if (!((key->text[i] >= '0' && key->text[i] <= '9')
+				|| (key->text[i] >= 'a' && key->text[i] <= 'f')))
+			return false;
+	record(&expected, "key %.*s", key->length, key->text);
+	return true;
+}
+
+// Twelve signed 16-bit words, four hex digits each
+static bool modelCalset(const Word *argument) {
+	char digits[5] = "";
+	int16_t v[12];
+	uint16_t i;
+	if (argument->length != 4 * 12)
+		return false;
+	for (i = 0; i < argument->length; i++)
+		if (!((argument->text[i] >= '0' && argument->text[i] <= '9')
+				|| (argument->text[i] >= 'a' && argument->text[i] <= 'f')))
+			return false;
+	for (i = 0; i < 12; i++) {
+		memcpy(digits, &argument->text[4 * i], 4);
+		v[i] = (int16_t) strtoul(digits, 0, 16);
+	}
+	modelCalibrating = false;
+	record(&expected, "calset %04x %d %d %d %d %d %d %d %d %d %d %d %d",
+			MAGCAL_MAGIC, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
+			v[9], v[10], v[11]);
+	return true;
+}
+
+static bool modelExecute(const Word *command, const Word *argument,
+		uint32_t *baudrate) {
+	static const char * const logs[4] = { "start", "stop", "dump", "erase" };
+	BaudRate_Setting baud;
+	int32_t value;
+	uint8_t i;
+	if (is(command, "rate") || is(command, "gain")) {
+		value = number(argument, is(command, "rate") ? HMC5883L_RATE_75
+				: HMC5883L_GAIN_220);
+		if (value < 0)
+			return false;
+		record(&expected, "%s %ld", command->text, (long) value);
+		return true;
+	}
+	if (is(command, "format")) {
+		if (is(argument, "ascii") && !modelEncrypted)
+			modelFormat = TELEMETRY_FORMAT_ASCII;
+		else if (is(argument, "binary"))
+			modelFormat = TELEMETRY_FORMAT_BINARY;
+		else if (is(argument, "delta"))
+			modelFormat = TELEMETRY_FORMAT_DELTA;
+		else
+			return false;
+		record(&expected, "format %u", modelFormat);
+		return true;
+	}
+	if (is(command, "crypt")) {
+		if (is(argument, "on") && modelFormat != TELEMETRY_FORMAT_ASCII)
+			modelEncrypted = true;
+		else if (is(argument, "off"))
+			modelEncrypted = false;
+		else
+			return false;
+		record(&expected, "crypt %u", modelEncrypted);
+		return true;
+	}
+	if (is(command, "key"))
+		return modelKey(argument);
+	if (is(command, "calset"))
+		return modelCalset(argument);
+	if (is(command, "cal")) {
+		if (is(argument, "stop") && !modelCalibrating)
+			return false;
+		if (is(argument, "start"))
+			modelCalibrating = true;
+		else if (is(argument, "stop") || is(argument, "reset"))
+			modelCalibrating = false;
+		else if (!is(argument, "save") && !is(argument, "load"))
+			return false;
+		record(&expected, "cal %s", argument->text);
+		return true;
+	}
+	if (is(command, "i2c")) {
+		if (!is(argument, "budget") && !is(argument, "stats"))
+			return false;
+		record(&expected, "i2c %s", argument->text);
+		return true;
+	}
+	if (is(command, "log")) {
+		for (i = 0; i < 4; i++) {
+			if (is(argument, logs[i])) {
+				record(&expected, "log %s", logs[i]);
+				return true;
+			}
+		}
+		return is(argument, "stats");
+	}
+	if (is(command, "adc")) {
+		if (!is(argument, "read"))
+			return false;
+		record(&expected, "adc read");
+		return true;
+	}
+	if (is(command, "baud")) {
+		value = number(argument, 921600);
+		if (value <= 0 || !BaudRate_solve(SIM_MCLK, value, &baud))
+			return false;
+		*baudrate = value;
+		return true;
+	}
+	return false;
+}
+
+// What the stubs should log for one line, without its line end.  Returns
+// the baud rate the line switches to, or 0.
+static uint32_t model(const uint8_t line[], uint16_t length) {
+	Word words[2];
+	uint32_t baudrate = 0;
+	uint16_t count = 0, i;
+	bool inWord = false, tooLong = false, result;
+	char c;
+	words[0].length = 0;
+	words[1].length = 0;
+	for (i = 0; i < length; i++) {
+		c = (char) line[i];
+		if (c == ' ' || c == '\t') {
+			inWord = false;
+			continue;
+		}
+		if (!inWord) {
+			inWord = true;
+			count++;
+		}
+		if (count > 2 || words[count - 1].length == COMMAND_WORD_MAX) {
+			tooLong = true;
+			continue;
+		}
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+		words[count - 1].text[words[count - 1].length++] = c;
+	}
+	if (count == 0)
+		return 0;
+	words[0].text[words[0].length] = '\0';
+	words[1].text[words[1].length] = '\0';
+	result = !tooLong && count == 2 && modelExecute(&words[0], &words[1],
+			&baudrate);
+	record(&expected, result ? "OK" : "ERR");
+	if (baudrate)
+		record(&expected, "baud %lu", (unsigned long) baudrate);
+	return baudrate;
+}
+
+static void randomWord(uint8_t *line, uint16_t *length, uint16_t size,
+		const char *charset) {
+	uint16_t n = (uint16_t) strlen(charset);
+	while (size-- && *length < LINE_MAX - 8)
+		line[(*length)++] = (uint8_t) charset[pick(n)];
+}
+
+static void append(uint8_t *line, uint16_t *length, const char *text) {
+	while (*text && *length < LINE_MAX - 8)
+		line[(*length)++] = (uint8_t) *text++;
+}
+
+static void space(uint8_t *line, uint16_t *length) {
+	uint32_t n = 1 + pick(3);
+	while (n--)
+		line[(*length)++] = pick(4) ? ' ' : '\t';
+}
+
+// A command from Command.h, sometimes with a bad argument, in mixed case
+static void grammarLine(uint8_t *line, uint16_t *length) {
+	static const char * const commands[][8] = {
+		{ "rate", "0", "3", "6", "7", "006", "000000001", "1000000000" },
+		{ "gain", "0", "5", "7", "8", "-1", "00000007", "99999999" },
+		{ "format", "ascii", "binary", "delta", "hex", "asci", "deltas", "" },
+		{ "crypt", "on", "off", "of", "onn", "1", "", "" },
+		{ "cal", "start", "stop", "save", "load", "reset", "go", "stopp" },
+		{ "i2c", "budget", "stats", "stat", "", "", "", "" },
+		{ "log", "start", "stop", "dump", "erase", "stats", "clear", "" },
+		{ "adc", "read", "reads", "write", "", "", "", "" },
+		{ "baud", "57600", "115200", "230400", "921600", "921601", "0",
+			"1234567890" },
+		{ "key", "", "", "", "", "", "", "" },
+		{ "calset", "", "", "", "", "", "", "" },
+	};
+	const char * const *command = commands[pick(11)];
+	uint16_t start = *length, i, n;
+	if (pick(4) == 0)
+		space(line, length);
+	append(line, length, command[0]);
+	if (pick(16) == 0) {
+		line[(*length)++] = '\0';		// Matches the keyword up to its end
+		randomWord(line, length, pick(3), "\tx");
+	}
+	if (pick(10)) {
+		space(line, length);
+		if (strcmp(command[0], "key") == 0 || strcmp(command[0], "calset") == 0) {
+			n = (command[0][0] == 'k') ? 2 * AES128_KEY_SIZE : 4 * 12;
+			if (pick(4) == 0)
+				n += pick(5) - 2;		// Either side of the length
+			randomWord(line, length, n, pick(4) ? "0123456789abcdef"
+					: "0123456789ABCDEFabcdefg");
+		} else {
+			for (n = 1; n < 8 && command[n][0] != '\0'; n++)
+				;
+			append(line, length, command[1 + pick(n - 1)]);
+		}
+	}
+	if (pick(8) == 0) {
+		space(line, length);
+		append(line, length, "extra");
+	}
+	if (pick(4) == 0)
+		space(line, length);
+	for (i = start; i < *length; i++)
+		if (pick(3) == 0 && line[i] >= 'a' && line[i] <= 'z')
+			line[i] -= 'a' - 'A';
+}
+
+static uint16_t randomLine(uint8_t *line) {
+	uint16_t length = 0, n;
+	uint32_t kind = pick(100);
+	if (kind < 50) {
+		grammarLine(line, &length);
+	} else if (kind < 70) {			// Words of anything printable
+		for (n = pick(5); n; n--) {
+			randomWord(line, &length, pick(40),
+					"abcdefghijklmnopqrstuvwxyzRATEGAIN0123456789-+.,;:!?#");
+			space(line, &length);
+		}
+	} else if (kind < 85) {			// Any bytes bar line ends
+		for (n = pick(80); n; n--) {
+			line[length] = (uint8_t) pick(256);
+			if (line[length] != '\r' && line[length] != '\n')
+				length++;
+		}
+	} else if (kind < 93) {			// A word either side of the limit
+		append(line, &length, pick(2) ? "rate " : "");
+		randomWord(line, &length, COMMAND_WORD_MAX - 3 + pick(7), "abc0123456789");
+		if (pick(2)) {
+			space(line, &length);
+			randomWord(line, &length, COMMAND_WORD_MAX - 3 + pick(7), "01");
+		}
+	} else {						// A long line
+		for (n = 200 + pick(3000); n && length < LINE_MAX - 8; n--)
+			line[length++] = pick(6) ? (uint8_t) ('a' + pick(26)) : ' ';
+	}
+	return length;
+}
+
+// Line end, which Command_parse() takes as a blank line when doubled
+static uint16_t lineEnd(uint8_t *end, bool single) {
+	static const char * const ends[5] = { "\r\n", "\n", "\r", "\n\r", "\r\r\n\n" };
+	const char *text = ends[single ? 1 + pick(2) : pick(5)];
+	memcpy(end, text, strlen(text));
+	return (uint16_t) strlen(text);
+}
+
+static void escape(const uint8_t *data, uint16_t length) {
+	uint16_t i;
+	for (i = 0; i < length && i < 120; i++)
+		printf((data[i] >= ' ' && data[i] < 0x7F && data[i] != '\\') ? "%c"
+				: "\\x%02X", data[i]);
+	if (i < length)
+		printf("...(%u bytes)", length);
+	printf("\n");
+}
+
+// Logs against each other, then cleared.  Returns 1 for a mismatch.
+static uint32_t compare(Result *result, const uint8_t *line, uint16_t length) {
+	const char *p;
+	uint32_t bad = expected.full || actual.full
+			|| strcmp(expected.text, actual.text) != 0;
+	for (p = expected.text; (p = strstr(p, "OK\n")) != 0; p++)
+		result->ok++;
+	for (p = expected.text; (p = strstr(p, "ERR\n")) != 0; p++)
+		result->err++;
+	if (bad && result->bad == 0) {
+		printf("mismatch,%s,line ", result->name);
+		escape(line, length);
+		printf("expected:\n%sgot:\n%s", expected.text, actual.text);
+	}
+	result->bad += bad;
+	clearLog(&expected);
+	clearLog(&actual);
+	return bad;
+}
+
+static void report(const Result *result) {
+	printf("%s,%lu lines,%lu bytes,%lu OK,%lu ERR,%lu mismatched\n",
+			result->name, (unsigned long) result->lines,
+			(unsigned long) result->bytes, (unsigned long) result->ok,
+			(unsigned long) result->err, (unsigned long) result->bad);
+}
+
+static void busy(uint64_t cycles) {
+	uint64_t end = Sim_cycles + cycles;
+	while (Sim_cycles < end)
+		__delay_cycles(SIM_IDLE_STEP);
+}
+
+// Sends data to the UART, no more than the ring holds, and runs the main
+// loop until all of it is in the ring and parsed
+static void deliver(const uint8_t data[], uint16_t length) {
+	uint16_t start = bcUartRcvBufIndex;
+	uint16_t overruns = bcUartRxOverruns;
+	uint32_t frame = Sim_uartFrameCycles(uart);
+	Sim_uartReceive(uart, data, length);
+	while ((uint16_t) (bcUartRcvBufIndex - start)
+			+ (uint16_t) (bcUartRxOverruns - overruns) < length) {
+		Command_poll();
+		if (pick(4) == 0) {
+			busy(pick(BUSY_FRAMES * frame));	// Sampling, say
+		} else {
+			__disable_interrupt();
+			if (!bcUartRxAvailable())
+				__bis_SR_register(LPM0_bits + GIE);
+			__enable_interrupt();
+		}
+	}
+	Command_poll();
+}
+
+static void sendBatch(const uint8_t batch[], uint16_t length) {
+	uint16_t n, count;
+	for (n = 0; n < length; n += count) {
+		count = 1 + pick(BC_RXBUF_SIZE);
+		if (count > length - n)
+			count = length - n;
+		deliver(&batch[n], count);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	static uint8_t line[LINE_MAX];
+	static uint8_t batch[BATCH_MAX + LINE_MAX];
+	Result parse = { .name = "parse" };
+	Result serial = { .name = "uart" };
+	uint32_t lines = LINES, burstBad, n, baudrate;
+	uint16_t length, batchLength = 0, i, cut, start, received;
+
+	if (argc > 1)
+		seed = strtoull(argv[1], 0, 0) | 1;
+	if (argc > 2)
+		lines = strtoul(argv[2], 0, 0);
+	printf("seed,%llu\n", (unsigned long long) seed);
+
+	Sim_reset();
+	Sim_dma(DMA_BASE, DMA_VECTOR_SIM);
+	uart = Sim_usciUart(USCI_A1_BASE, SIM_MCLK, USCI_A1_VECTOR_SIM,
+			SIM_TRIGGER_UCA1RXIFG, SIM_TRIGGER_UCA1TXIFG, 0);
+	Sim_attach(USCI_A1_VECTOR_SIM, bcUartISR);
+	Sim_attach(DMA_VECTOR_SIM, DMAService_ISR);
+	bcUartInit();
+	__enable_interrupt();
+	Command_reset();
+
+	// Straight into the parser, in random pieces
+	for (n = 0; n < lines; n++) {
+		length = randomLine(line);
+		model(line, length);
+		length += lineEnd(&line[length], false);
+		for (i = 0; i < length; i += cut) {
+			cut = 1 + pick(length - i);
+			Command_parse(&line[i], cut);
+		}
+		parse.lines++;
+		parse.bytes += length;
+		compare(&parse, line, length);
+	}
+	report(&parse);
+
+	// Through the UART and the ring, a batch of lines at a time
+	for (n = 0; n < lines / UART_SHARE; n++) {
+		length = randomLine(line);
+		start = batchLength;
+		memcpy(&batch[start], line, length);
+		baudrate = model(line, length);
+		length += lineEnd(&batch[start + length], baudrate != 0);
+		batchLength += length;
+		serial.lines++;
+		serial.bytes += length;
+		if (baudrate || batchLength >= BATCH_MAX || n + 1 == lines / UART_SHARE) {
+			sendBatch(batch, batchLength);
+			compare(&serial, batch, batchLength);
+			batchLength = 0;
+		}
+	}
+	serial.bad += bcUartRxOverruns != 0;
+	report(&serial);
+
+	// Nobody polling: the ring fills and the rest is dropped.  No letters,
+	// so whatever runs together can only be an error.
+	for (i = 0; i < BURST; i++)
+		batch[i] = (uint8_t) " 0123456789\r\n"[pick(13)];
+	start = bcUartRcvBufIndex;
+	n = bcUartRxOverruns;
+	Sim_uartReceive(uart, batch, BURST);
+	busy((uint64_t) (BURST + 1) * Sim_uartFrameCycles(uart));
+	received = bcUartRcvBufIndex - start;
+	burstBad = received != BC_RXBUF_SIZE
+			|| bcUartRxOverruns - n != BURST - BC_RXBUF_SIZE;
+	Command_poll();
+	deliver((const uint8_t *) "\r\n", 2);
+	for (i = 0; i < actual.length; i += 4)
+		burstBad += strncmp(&actual.text[i], "ERR\n", 4) != 0;
+	clearLog(&actual);
+	deliver((const uint8_t *) "rate 5\r\n", 8);
+	burstBad += strcmp(actual.text, "rate 5\nOK\n") != 0;
+	printf("burst,%u bytes,%u read,%u overruns,%s\n", BURST,
+			received,
+			(unsigned) (bcUartRxOverruns - n), burstBad ? "bad" : "ok");
+
+	return (parse.bad || serial.bad || burstBad) ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * crc_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs CrcCcitt.c against the CRC16 model in tools/sim and checks every
+ * result against a table-driven software CRC: the standard check value,
+ * random buffers of every length up to a few chunks at every alignment,
+ * the same buffers fed as random fragments, and all of it again with an
+ * ISR computing CRCs of its own between the chunks.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o crc_check tools/crc_check.c CrcCcitt.c tools/sim/sim.c
+ *        tools/sim/sim_models.c driverlib/MSP430F5xx_6xx/crc.c
+ * Usage:      crc_check
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <driverlib.h>
+#include "CrcCcitt.h"
+#include "tools/sim/sim.h"
+
+#define BUFFER_SIZE		(3 * CRCCCITT_CHUNK + 7)
+#define TEST_VECTOR		50			// Any vector nothing else uses
+#define ISR_LENGTH		37
+
+static uint16_t table[256];
+static uint8_t buffer[BUFFER_SIZE + 1];
+static uint8_t isrBuffer[ISR_LENGTH];
+static bool inIsr;
+static bool interrupting;
+static uint32_t isrRuns, isrBad;
+
+static void makeTable() {
+	uint16_t crc;
+	int i, bit;
+	for (i = 0; i < 256; i++) {
+		crc = (uint16_t) (i << 8);
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		table[i] = crc;
+	}
+}
+
+static uint16_t reference(const uint8_t *data, size_t length) {
+	uint16_t crc = CRCCCITT_SEED;
+	while (length--)
+		crc = (uint16_t) (crc << 8) ^ table[(crc >> 8) ^ *data++];
+	return crc;
+}
+
+// Raises the ISR on every other step taken outside it, which puts it
+// between CrcCcitt_update()'s chunks as they re-enable interrupts
+static void interruptTick(Sim_Model *model, uint32_t cycles) {
+	static bool toggle;
+	if (interrupting && !inIsr && (toggle = !toggle))
+		Sim_raise(TEST_VECTOR);
+}
+
+static void isr(void) {
+	inIsr = true;
+	isrRuns++;
+	isrBad += CrcCcitt_block(isrBuffer, ISR_LENGTH)
+			!= reference(isrBuffer, ISR_LENGTH);
+	inIsr = false;
+}
+
+// Every length and alignment in one go, then as random fragments
+static uint32_t check() {
+	CrcCcitt_State s;
+	uint16_t length, offset, n, done;
+	uint32_t bad = 0;
+	for (length = 0; length <= BUFFER_SIZE - 1; length++) {
+		for (offset = 0; offset < 2; offset++) {
+			bad += CrcCcitt_block(&buffer[offset], length)
+					!= reference(&buffer[offset], length);
+			CrcCcitt_begin(&s);
+			for (done = 0; done < length; done += n) {
+				n = (uint16_t) (rand() % (length - done) + 1);
+				CrcCcitt_update(&s, &buffer[offset + done], n);
+			}
+			bad += CrcCcitt_result(&s) != reference(&buffer[offset], length);
+		}
+	}
+	return bad;
+}
+
+int main(int argc, char *argv[]) {
+	static Sim_Model interrupter = { "interrupter", 1, 0, 0, interruptTick };	// No registers
+	const uint8_t check9[] = "123456789";
+	uint16_t i;
+	uint32_t bad;
+
+	Sim_reset();
+	Sim_crc16(CRC_BASE);
+	Sim_addModel(&interrupter);
+	Sim_attach(TEST_VECTOR, isr);
+	makeTable();
+	for (i = 0; i < sizeof buffer; i++)
+		buffer[i] = (uint8_t) rand();
+	for (i = 0; i < ISR_LENGTH; i++)
+		isrBuffer[i] = (uint8_t) rand();
+
+	printf("check,\"123456789\",0x%04X,reference 0x%04X\n",
+			CrcCcitt_block(check9, 9), reference(check9, 9));
+	if (CrcCcitt_block(check9, 9) != 0x29B1)
+		return 1;
+
+	bad = check();
+	printf("buffers,0..%u bytes,%lu mismatched\n", BUFFER_SIZE - 1,
+			(unsigned long) bad);
+
+	__enable_interrupt();
+	interrupting = true;
+	bad += check();
+	interrupting = false;
+	printf("interrupted,%lu ISR CRCs,%lu ISR mismatched,%lu mismatched\n",
+			(unsigned long) isrRuns, (unsigned long) isrBad,
+			(unsigned long) bad);
+	return (bad || isrBad || isrRuns == 0) ? 1 : 0;
+}
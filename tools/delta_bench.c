@@ -0,0 +1,196 @@
+/*
+ * delta_bench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Compression figures for DeltaCodec on a recording.  Reads the CSV that
+ * telemetry_decode prints, encodes the samples into blocks the way
+ * Telemetry.c and FlashLog.c do, checks every block decodes back to its
+ * samples, and prints the bytes each sample takes in each of the formats.
+ * The cycles the encoder costs on the device come from the delta_encode
+ * stage of the BENCHMARK build, not from here.
+ *
+ * With -s the recording is made up instead, so the figures can be had
+ * without a board: the given number of seconds at 75 Hz of a level unit
+ * turning once a minute in a 0.5 Ga field with a 0.4 Ga dip, at gain 1090,
+ * with a couple of counts of noise from a fixed seed.
+ *
+ * Build on Linux:  cc -O2 -o delta_bench delta_bench.c ../DeltaCodec.c -lm
+ * Usage:           delta_bench [-s seconds | recording.csv]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../DeltaCodec.h"
+#include "../FlashLog.h"
+#include "../Telemetry.h"
+
+#define TICKS_PER_SEC	32768.0		// TIMEBASE_TICKS_PER_SEC
+#define RAW_SIZE		6			// x, y, z
+#define SYNTHETIC_HZ	75
+#define HORIZONTAL		545.0		// 0.5 Ga at 1090 counts/Ga
+#define VERTICAL		-436.0		// 0.4 Ga, down
+#define TURN_SECONDS	60.0
+#define NOISE			2			// Counts either way
+#define PI				3.14159265358979323846
+
+static HMC_Sample *samples;
+static size_t count;
+
+static bool same(const HMC_Sample *a, const HMC_Sample *b) {
+	return a->timestamp == b->timestamp && a->x == b->x && a->y == b->y
+			&& a->z == b->z && a->gain == b->gain;
+}
+
+static bool load(FILE *in) {
+	char line[128];
+	size_t capacity = 0;
+	unsigned sequence, gain;
+	double seconds, heading;
+	int x, y, z;
+	while (fgets(line, sizeof line, in)) {
+		if (sscanf(line, "%u,%lf,%d,%d,%d,%lf,%u", &sequence, &seconds, &x, &y,
+				&z, &heading, &gain) != 7)
+			continue;				// The header row
+		if (count == capacity) {
+			capacity = capacity ? capacity * 2 : 4096;
+			samples = realloc(samples, capacity * sizeof *samples);
+			if (!samples)
+				return false;
+		}
+		samples[count].timestamp = (uint32_t) (seconds * TICKS_PER_SEC + 0.5);
+		samples[count].x = (int16_t) x;
+		samples[count].y = (int16_t) y;
+		samples[count].z = (int16_t) z;
+		samples[count].gain = (uint8_t) gain;
+		count++;
+	}
+	return true;
+}
+
+static int16_t noise(uint32_t *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return (int16_t) ((*seed >> 16) % (2 * NOISE + 1)) - NOISE;
+}
+
+static bool synthesise(double seconds) {
+	uint32_t seed = 1;
+	double angle;
+	size_t i;
+	count = (size_t) (seconds * SYNTHETIC_HZ);
+	samples = calloc(count ? count : 1, sizeof *samples);
+	if (!samples)
+		return false;
+	for (i = 0; i < count; i++) {
+		angle = 2 * PI * i / (TURN_SECONDS * SYNTHETIC_HZ);
+		samples[i].timestamp = (uint32_t) (i * TICKS_PER_SEC / SYNTHETIC_HZ + 0.5);
+		samples[i].x = (int16_t) lround(HORIZONTAL * cos(angle)) + noise(&seed);
+		samples[i].y = (int16_t) lround(HORIZONTAL * sin(angle)) + noise(&seed);
+		samples[i].z = (int16_t) lround(VERTICAL) + noise(&seed);
+		samples[i].gain = 1;		// HMC5883L_GAIN_1090
+	}
+	return true;
+}
+
+// Decode one block and compare it with the samples it was made from
+static size_t verify(const uint8_t *block, uint16_t length, size_t first) {
+	DeltaCodec_State codec;
+	HMC_Sample s;
+	size_t n = 0;
+	DeltaCodec_open(&codec, block, length);
+	while (DeltaCodec_next(&codec, &s)) {
+		if (first + n >= count || !same(&s, &samples[first + n])) {
+			fprintf(stderr, "block at sample %lu does not decode\n",
+					(unsigned long) first);
+			exit(1);
+		}
+		n++;
+	}
+	return n;
+}
+
+// Encode everything into blocks of size, calling out for each block.
+// Returns the number of blocks.
+static size_t encode(uint16_t size, void (*out)(uint16_t length)) {
+	uint8_t block[256];
+	DeltaCodec_State codec;
+	size_t i, first = 0, blocks = 0;
+	DeltaCodec_begin(&codec, block, size);
+	for (i = 0; i <= count; i++) {
+		if (i < count && DeltaCodec_add(&codec, &samples[i]))
+			continue;
+		if (verify(block, codec.length, first) != codec.count) {
+			fprintf(stderr, "block at sample %lu is short\n", (unsigned long) first);
+			exit(1);
+		}
+		out(codec.length);
+		blocks++;
+		first = i;
+		DeltaCodec_begin(&codec, block, size);
+		if (i < count)
+			DeltaCodec_add(&codec, &samples[i]);
+	}
+	return blocks;
+}
+
+static size_t blockBytes, frameBytes, entryBytes;
+
+// Sync, sequence and CRC round the block, then the COBS code bytes and
+// the zero delimiter
+static void frame(uint16_t length) {
+	size_t n = TELEMETRY_OFFSET_BLOCK + length + 2;
+	blockBytes += length;
+	frameBytes += n + 1 + n / 254 + 1;
+}
+
+// The two byte prefix, padded to a long-word, plus a share of the segment
+// header
+static void entry(uint16_t length) {
+	entryBytes += (2 + length + 3) & ~3;
+}
+
+static void row(const char *name, double bytes) {
+	printf("%s,%.2f bytes/sample,%.1f:1 against raw\n", name, bytes / count,
+			(double) RAW_SIZE * count / bytes);
+}
+
+int main(int argc, char *argv[]) {
+	FILE *in = stdin;
+	char line[80];
+	size_t i, ascii = 0, blocks, entries;
+
+	if (argc > 2 && strcmp(argv[1], "-s") == 0) {
+		if (!synthesise(strtod(argv[2], 0)))
+			return 1;
+	} else if (argc > 1 && !(in = fopen(argv[1], "r"))) {
+		perror(argv[1]);
+		return 1;
+	} else if (!load(in))
+		count = 0;
+	if (count == 0) {
+		fprintf(stderr, "no samples\n");
+		return 1;
+	}
+	for (i = 0; i < count; i++)
+		ascii += snprintf(line, sizeof line,	// As main.c prints them
+				"Reading:\tX=%6d\tY=%6d\tZ=%6d\r\nHeading:  %5.1d\r\n",
+				samples[i].x, samples[i].y, samples[i].z, 0);
+
+	blocks = encode(TELEMETRY_BLOCK_MAX, frame);
+	entries = encode(FLASHLOG_ENTRY_MAX - 2, entry);
+	entryBytes += entryBytes / FLASHLOG_DATA_SIZE * sizeof(FlashLog_Header);
+
+	printf("samples,%lu,%.1f s,%lu telemetry blocks,%lu flash entries\n",
+			(unsigned long) count,
+			(samples[count - 1].timestamp - samples[0].timestamp) / TICKS_PER_SEC,
+			(unsigned long) blocks, (unsigned long) entries);
+	row("raw", (double) RAW_SIZE * count);
+	row("ascii", (double) ascii);
+	row("binary", (double) TELEMETRY_ENCODED_MAX * count);
+	row("delta block", (double) blockBytes);
+	row("delta framed", (double) frameBytes);
+	row("flash", (double) entryBytes);
+	return 0;
+}
@@ -0,0 +1,195 @@
+/*
+ * fixedmath_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs FixedMath.c against the MPY32 model in tools/sim and checks every
+ * result against wide integer arithmetic done here: the full scale corner
+ * cases and random operands for each call, then the same again with an ISR
+ * using the multiplier between and inside the calls, and a raw multiply
+ * the ISR interrupts that FixedMath_save() and FixedMath_restore() must
+ * leave intact.  Build it a second time with -DFIXEDMATH_PORTABLE to check
+ * the plain C path gives the same answers.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o fixedmath_check tools/fixedmath_check.c FixedMath.c
+ *        tools/sim/sim.c tools/sim/sim_models.c -lm
+ * Usage:      fixedmath_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <driverlib.h>
+#include "inc/hw_regaccess.h"
+#include "FixedMath.h"
+#include "tools/sim/sim.h"
+
+#define CASES			20000
+#define DOT_MAX			40			// Terms, a few FIXEDMATH_CHUNKs
+#define TEST_VECTOR		50			// Any vector nothing else uses
+
+static const int32_t corners[] = { -32768, -32767, -16384, -1, 0, 1, 16384,
+		32767 };
+#define CORNERS			(sizeof corners / sizeof corners[0])
+
+static bool inIsr;
+static bool interrupting;
+static uint32_t isrRuns, isrBad;
+
+static int64_t clamp(__int128 value, int bits) {
+	__int128 limit = (__int128) 1 << (bits - 1);
+	if (value >= limit)
+		return (int64_t) (limit - 1);
+	if (value < -limit)
+		return (int64_t) -limit;
+	return (int64_t) value;
+}
+
+// Round half up, value / 2^shift
+static __int128 scale(__int128 value, int shift) {
+	return (value + ((__int128) 1 << (shift - 1))) >> shift;
+}
+
+static int16_t q15(uint32_t i) {
+	return (int16_t) (i < CORNERS * CORNERS ? corners[i % CORNERS] : rand());
+}
+
+static int16_t q15b(uint32_t i) {
+	return (int16_t) (i < CORNERS * CORNERS ? corners[i / CORNERS] : rand());
+}
+
+// A Q15 corner or random value widened to Q31 with random low bits
+static int32_t q31(uint32_t i, int16_t high) {
+	uint16_t low = (i < CORNERS * CORNERS) ? ((i & 1) ? 0xFFFF : 0) : rand();
+	return (int32_t) (((uint32_t) (uint16_t) high << 16) | low);
+}
+
+static uint16_t root(uint32_t value) {
+	uint32_t r = (uint32_t) sqrt((double) value);
+	while ((uint64_t) r * r > value)
+		r--;
+	while ((uint64_t) (r + 1) * (r + 1) <= value)
+		r++;
+	return (uint16_t) r;
+}
+
+static void interruptTick(Sim_Model *model, uint32_t cycles) {
+	static bool toggle;
+	if (interrupting && !inIsr && (toggle = !toggle))
+		Sim_raise(TEST_VECTOR);
+}
+
+static void isr(void) {
+	static const int16_t m[9] = { 32767, 0, 0, 0, -32768, 0, 100, 0, 16384 };
+	int16_t v[3] = { 1000, -2000, 3000 };
+	FixedMath_Context context;
+	inIsr = true;
+	isrRuns++;
+	FixedMath_save(&context);
+	FixedMath_matVec3(m, v, v);
+	isrBad += v[0] != 1000 || v[1] != 2000 || v[2] != 1503;
+	FixedMath_restore(&context);
+	inIsr = false;
+}
+
+// Every call over corners then random operands.  Returns mismatches.
+static uint32_t check(const char *pass) {
+	int16_t a[DOT_MAX], b[DOT_MAX], m[9], v[3], out[3];
+	uint32_t bad[8] = { 0 };
+	__int128 sum;
+	uint32_t i, squares;
+	uint16_t n, k;
+	int32_t x, y;
+
+	for (i = 0; i < CASES; i++) {
+		a[0] = q15(i);
+		b[0] = q15b(i);
+		bad[0] += FixedMath_mul15(a[0], b[0])
+				!= clamp(scale(2 * (__int128) a[0] * b[0], 16), 16);
+		bad[1] += FixedMath_add15(a[0], b[0]) != clamp((__int128) a[0] + b[0], 16)
+				|| FixedMath_sub15(a[0], b[0]) != clamp((__int128) a[0] - b[0], 16);
+		x = q31(i, a[0]);
+		y = q31(i + 1, b[0]);
+		bad[2] += FixedMath_mul31(x, y) != clamp(scale(2 * (__int128) x * y, 32), 32);
+		bad[3] += FixedMath_add31(x, y) != clamp((__int128) x + y, 32)
+				|| FixedMath_sub31(x, y) != clamp((__int128) x - y, 32);
+		bad[4] += FixedMath_mac15(x, a[0], b[0])
+				!= clamp(x + 2 * (__int128) a[0] * b[0], 32);
+
+		n = (uint16_t) (i % (DOT_MAX + 1));
+		sum = 0;
+		for (k = 0; k < n; k++) {
+			a[k] = (i & 1) ? -32768 : q15(i + 100 + k);	// Odd i: overflow
+			b[k] = (i & 1) ? -32768 : (int16_t) rand();
+			sum += 2 * (__int128) a[k] * b[k];
+		}
+		bad[5] += FixedMath_dot15(a, b, n) != clamp(sum, 32);
+
+		for (k = 0; k < 9; k++)
+			m[k] = (i < CORNERS) ? corners[i] : (int16_t) rand();
+		for (k = 0; k < 3; k++)
+			v[k] = (i < CORNERS) ? corners[(i + k) % CORNERS] : (int16_t) rand();
+		FixedMath_matVec3(m, v, out);
+		for (k = 0; k < 3; k++)
+			bad[6] += out[k] != clamp(scale((__int128) m[3 * k] * v[0]
+					+ (__int128) m[3 * k + 1] * v[1] + (__int128) m[3 * k + 2] * v[2],
+					15), 16);
+		squares = (uint32_t) ((int32_t) v[0] * v[0]) + (uint32_t) ((int32_t) v[1] * v[1])
+				+ (uint32_t) ((int32_t) v[2] * v[2]);
+		bad[7] += FixedMath_norm3(v) != root(squares);
+	}
+	printf("%s,%u cases,mul15 %lu,add/sub15 %lu,mul31 %lu,add/sub31 %lu,"
+			"mac15 %lu,dot15 %lu,matVec3 %lu,norm3 %lu mismatched\n", pass, CASES,
+			(unsigned long) bad[0], (unsigned long) bad[1], (unsigned long) bad[2],
+			(unsigned long) bad[3], (unsigned long) bad[4], (unsigned long) bad[5],
+			(unsigned long) bad[6], (unsigned long) bad[7]);
+	for (i = 1; i < 8; i++)
+		bad[0] += bad[i];
+	return bad[0];
+}
+
+#ifndef FIXEDMATH_PORTABLE
+// A multiply driven by hand, as the compiler does, with the ISR let in
+// between starting it and reading it back
+static uint32_t checkRaw() {
+	uint32_t bad = 0;
+	int32_t product;
+	uint16_t i;
+	for (i = 0; i < 1000; i++) {
+		HWREG16(MPY32_BASE + OFS_MPYS) = (uint16_t) (int16_t) (i * 37);
+		HWREG16(MPY32_BASE + OFS_OP2) = (uint16_t) -(int16_t) i;
+		__no_operation();
+		product = (int32_t) ((uint32_t) HWREG16(MPY32_BASE + OFS_RESLO)
+				| ((uint32_t) HWREG16(MPY32_BASE + OFS_RESHI) << 16));
+		bad += product != (int32_t) (int16_t) (i * 37) * -(int16_t) i;
+		bad += HWREG16(MPY32_BASE + OFS_MPY32CTL0) & (MPYFRAC | MPYSAT);
+	}
+	printf("raw,1000 interrupted multiplies,%lu mismatched\n", (unsigned long) bad);
+	return bad;
+}
+#endif
+
+int main(int argc, char *argv[]) {
+	static Sim_Model interrupter = { "interrupter", 1, 0, 0, interruptTick };	// No registers
+	uint32_t bad;
+
+	Sim_reset();
+	Sim_mpy32(MPY32_BASE);
+	Sim_addModel(&interrupter);
+	Sim_attach(TEST_VECTOR, isr);
+
+	bad = check("plain");
+	__enable_interrupt();
+	interrupting = true;
+	bad += check("interrupted");
+#ifndef FIXEDMATH_PORTABLE
+	bad += checkRaw();
+#endif
+	interrupting = false;
+	printf("isr,%lu runs,%lu mismatched\n", (unsigned long) isrRuns,
+			(unsigned long) isrBad);
+	return (bad || isrBad) ? 1 : 0;
+}
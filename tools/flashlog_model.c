@@ -0,0 +1,281 @@
+/*
+ * flashlog_model.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs FlashLog.c against the host flash model in tools/sim to get the
+ * numbers the device can't easily give: how many records a second the log
+ * takes, how long erases hold the CPU and what that costs in samples at
+ * each data rate, how many bytes a sample takes, how evenly the segments
+ * wear, whether a restart and a dump in either binary format give back
+ * what went in, that a damaged entry is caught by its CRC, and that
+ * logging with nobody listening stops after one lap of the ring.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o flashlog_model tools/flashlog_model.c FlashLog.c Telemetry.c
+ *        DeltaCodec.c Heading.c CrcCcitt.c SecureLink.c Aes128.c Ccm.c
+ *        tools/sim/sim.c tools/sim/sim_models.c tools/sim/sim_flash.c
+ *        driverlib/MSP430F5xx_6xx/crc.c
+ * Usage:      flashlog_model
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "DeltaCodec.h"
+#include "FlashLog.h"
+#include "Telemetry.h"
+#include "BCUart.h"
+#include "tools/sim/sim.h"
+
+#define TICKS_PER_SEC	32768		// TIMEBASE_TICKS_PER_SEC
+#define BATCH			4			// SAMPLE_BATCH_SIZE in main.c
+#define CAPACITY		(FLASHLOG_SEGMENTS * FLASHLOG_DATA_SIZE / 8)	// Samples, at least
+#define HISTORY			(CAPACITY * 8)
+#define RUN_SECONDS		60
+#define OFFSET_FIRST_BLOCK	2		// Past the entry length and sample count
+
+static HMC_Sample history[HISTORY];	// Every sample appended, by count
+static uint32_t appended;
+static uint8_t capture[1 << 20];	// Back channel output
+static uint32_t captured;
+
+// What FlashLog.c calls outside the model
+uint32_t Timebase_now() {
+	return (uint32_t) (Sim_cycles * TICKS_PER_SEC / SIM_MCLK);
+}
+
+void BackChannel_WriteBytes(const uint8_t data[], uint16_t length) {
+	if (captured + length > sizeof capture)
+		length = sizeof capture - captured;
+	memcpy(&capture[captured], data, length);
+	captured += length;
+}
+
+void bcUartSetTxPolicy(uint8_t policy) {
+}
+
+// Field-like readings: a slow turn with a couple of counts of noise
+static void append(uint32_t timestamp) {
+	HMC_Sample *s = &history[appended % HISTORY];
+	s->timestamp = timestamp;
+	s->x = (int16_t) (300 + (appended / 16) % 200 + rand() % 5 - 2);
+	s->y = (int16_t) (-150 + (appended / 24) % 100 + rand() % 5 - 2);
+	s->z = (int16_t) (-420 + rand() % 3 - 1);
+	s->gain = 1 + (appended / 5000) % 2;
+	FlashLog_append(s);
+	appended++;
+}
+
+// Every append as fast as the flash takes them
+static void throughput() {
+	uint64_t start = Sim_cycles;
+	uint32_t erases = Sim_flashStats.erases;
+	uint32_t i;
+	for (i = 0; i < CAPACITY; i++) {
+		append(Timebase_now() + 1);	// Never a zero step
+		if (i % BATCH == BATCH - 1)
+			FlashLog_service();
+	}
+	printf("throughput,%lu samples/s,%.0f us/sample,%lu erases\n",
+			(unsigned long) (CAPACITY * (uint64_t) SIM_MCLK / (Sim_cycles - start)),
+			(Sim_cycles - start) * 1e6 / SIM_MCLK / CAPACITY,
+			(unsigned long) (Sim_flashStats.erases - erases));
+}
+
+// DRDY edges at rate; the PORT2 flag holds one edge, so edges that come
+// while the CPU is held by the flash are lost but for the last
+static void atRate(double rate) {
+	uint64_t period = (uint64_t) (SIM_MCLK / rate);
+	uint64_t next = Sim_cycles;
+	uint64_t stop = Sim_cycles + (uint64_t) RUN_SECONDS * SIM_MCLK;
+	uint64_t late, worst = 0;
+	uint32_t taken = 0, lost = 0, held = 0;
+	while (next < stop) {
+		if (Sim_cycles < next)
+			Sim_step((uint32_t) (next - Sim_cycles));
+		late = Sim_cycles - next;
+		if (late > worst)
+			worst = late;
+		if (late >= period) {
+			lost += (uint32_t) (late / period);
+			next += late / period * period;
+		}
+		append((uint32_t) (next * TICKS_PER_SEC / SIM_MCLK));
+		taken++;
+		if (++held == BATCH) {
+			held = 0;
+			FlashLog_service();
+		}
+		next += period;
+	}
+	printf("rate,%.1f Hz,%lu taken,%lu lost,%.2f%% lost,worst latency %.1f ms\n",
+			rate, (unsigned long) taken, (unsigned long) lost,
+			100.0 * lost / (taken + lost), worst * 1e3 / SIM_MCLK);
+}
+
+// Returns the decoded length, or -1 if the block isn't valid COBS
+static int cobsDecode(const uint8_t *in, size_t length, uint8_t *out) {
+	size_t i = 0;
+	int o = 0;
+	uint8_t code, n;
+	while (i < length) {
+		code = in[i++];
+		if (code == 0 || i + code - 1 > length)
+			return -1;
+		for (n = 1; n < code; n++)
+			out[o++] = in[i++];
+		if (code != 0xFF && i < length)
+			out[o++] = 0;
+	}
+	return o;
+}
+
+static uint16_t get16(const uint8_t *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static bool same(const HMC_Sample *a, const HMC_Sample *b) {
+	return a->timestamp == b->timestamp && a->x == b->x && a->y == b->y
+			&& a->z == b->z && a->gain == b->gain;
+}
+
+// Compare the dumped frames, either format, with the newest samples
+// appended.  Returns the number that didn't match.
+static uint32_t checkDump(uint16_t sent) {
+	uint8_t f[TELEMETRY_DELTA_ENCODED_MAX];
+	DeltaCodec_State codec;
+	HMC_Sample s;
+	uint32_t i, start = 0, samples = 0, bad = 0;
+	int length;
+	for (i = 0; i < captured; i++) {
+		if (capture[i] != 0)
+			continue;
+		length = cobsDecode(&capture[start], i - start, f);
+		if (i > start && get16(f) == TELEMETRY_DELTA_SYNC) {
+			DeltaCodec_open(&codec, &f[TELEMETRY_OFFSET_BLOCK],
+					length - TELEMETRY_OFFSET_BLOCK - 2);
+			while (DeltaCodec_next(&codec, &s))
+				bad += !same(&s, &history[(appended - sent + samples++) % HISTORY]);
+		} else if (i > start) {
+			s.timestamp = get16(&f[TELEMETRY_OFFSET_TIMESTAMP])
+					| (uint32_t) get16(&f[TELEMETRY_OFFSET_TIMESTAMP + 2]) << 16;
+			s.x = (int16_t) get16(&f[TELEMETRY_OFFSET_X]);
+			s.y = (int16_t) get16(&f[TELEMETRY_OFFSET_Y]);
+			s.z = (int16_t) get16(&f[TELEMETRY_OFFSET_Z]);
+			s.gain = f[TELEMETRY_OFFSET_GAIN];
+			bad += length != TELEMETRY_FRAME_SIZE
+					|| !same(&s, &history[(appended - sent + samples++) % HISTORY]);
+		}
+		start = i + 1;
+	}
+	return samples == sent ? bad : bad + 1;
+}
+
+// Samples offered for three laps' worth, gated as processSamples() does
+// with no host: every segment is erased at most once and nothing logged
+// is lost
+static bool unattended() {
+	const FlashLog_Stats *stats = FlashLog_getStats();
+	uint32_t before[FLASHLOG_SEGMENTS];
+	uint32_t i, kept = 0, most = 0;
+	uint8_t n;
+	FlashLog_erase();
+	memcpy(before, Sim_flashStats.segmentErases, sizeof before);
+	for (i = 0; i < 3 * CAPACITY * 2; i++) {
+		if (!FlashLog_isFull()) {
+			append(Timebase_now() + 1);
+			kept++;
+		} else
+			Sim_step(SIM_MCLK / 1000);
+		if (i % BATCH == BATCH - 1)
+			FlashLog_service();
+	}
+	FlashLog_flush();
+	for (n = 0; n < FLASHLOG_SEGMENTS; n++)
+		if (Sim_flashStats.segmentErases[n] - before[n] > most)
+			most = Sim_flashStats.segmentErases[n] - before[n];
+	printf("unattended,%lu of %lu samples kept,%u in the log,"
+			"%lu max erases per segment\n", (unsigned long) kept,
+			(unsigned long) i, stats->samples, (unsigned long) most);
+	return FlashLog_isFull() && most <= 1 && stats->samples == kept;
+}
+
+static void dump(uint8_t format, const char *name) {
+	uint16_t sent;
+	uint32_t bad;
+	captured = 0;
+	Telemetry_setFormat(format);
+	sent = FlashLog_dump();
+	bad = checkDump(sent);
+	printf("dump,%s,%u samples,%lu bytes,%lu mismatched,%.1f s at 921600 baud\n",
+			name, sent, (unsigned long) captured, (unsigned long) bad,
+			captured * 10.0 / 921600);
+	if (bad || sent != FlashLog_getStats()->samples)
+		exit(1);
+}
+
+int main(int argc, char *argv[]) {
+	const FlashLog_Stats *stats = FlashLog_getStats();
+	uint32_t least = 0xFFFFFFFF, most = 0;
+	uint16_t samples;
+	uint8_t *byte;
+	uint8_t n;
+
+	Sim_reset();
+	Sim_crc16(CRC_BASE);
+	Sim_flashReset();
+	FlashLog_init();
+
+	throughput();
+	atRate(15);
+	atRate(75);
+	atRate(160);
+	printf("stall,%.1f ms max erase,%u us per long-word,%lu erases,%lu writes,"
+			"%lu forced,%lu bad writes\n",
+			Sim_flashStats.maxStall * 1e3 / SIM_MCLK, SIM_FLASH_WORD_US,
+			(unsigned long) Sim_flashStats.erases,
+			(unsigned long) Sim_flashStats.writes,
+			(unsigned long) stats->forced,
+			(unsigned long) Sim_flashStats.badWrites);
+	for (n = 0; n < FLASHLOG_SEGMENTS; n++) {
+		if (Sim_flashStats.segmentErases[n] < least)
+			least = Sim_flashStats.segmentErases[n];
+		if (Sim_flashStats.segmentErases[n] > most)
+			most = Sim_flashStats.segmentErases[n];
+	}
+	printf("wear,%lu min,%lu max erases per segment\n", (unsigned long) least,
+			(unsigned long) most);
+	printf("size,%u samples in %u bytes,%.2f bytes/sample\n", stats->samples,
+			stats->bytes, (double) stats->bytes / stats->samples);
+
+	// A long pause, then a reset
+	Sim_step(3 * SIM_MCLK);
+	append(Timebase_now());
+	FlashLog_flush();
+	samples = stats->samples;
+	FlashLog_init();
+	printf("restart,%u samples before,%u after\n", samples, stats->samples);
+	if (samples != stats->samples || Sim_flashStats.badWrites)
+		return 1;
+
+	dump(TELEMETRY_FORMAT_BINARY, "binary");
+	dump(TELEMETRY_FORMAT_DELTA, "delta");
+
+	// A bit lost in the first entry of segment 0, as a cut-short write
+	// leaves it: that entry is skipped, the rest still counts
+	samples = stats->samples;
+	byte = &((FlashLog_Segment *) Sim_flash)->data[OFFSET_FIRST_BLOCK];
+	while (*byte == 0)
+		byte++;
+	*byte &= *byte - 1;				// Its lowest 1 bit
+	FlashLog_init();
+	printf("corrupt,%u entries skipped,%u samples lost\n", stats->corrupt,
+			samples - stats->samples);
+	if (stats->corrupt != 1 || samples - stats->samples > DELTACODEC_KEYFRAME_INTERVAL)
+		return 1;
+	return unattended() ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/*
+ * format_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs Format.c on the host, with the DADD intrinsics emulated in
+ * tools/sim, and checks its text against the C library's snprintf(): every
+ * int16_t and uint16_t value, the 32-bit edges and RANDOM random values of
+ * each width, Format_fixed() with one to four decimals, and the builder's
+ * conversions, widths and padding.  Then that a builder with a flush
+ * function hands on the same text in chunks, and that one without stops at
+ * the end of its buffer, counting what it dropped.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I . -include tools/sim/sim.h
+ *        -o format_check tools/format_check.c Format.c tools/sim/sim.c
+ * Usage:      format_check
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Format.h"
+
+#define RANDOM			1000000
+#define CHUNK			8			// Builder buffer for the flush test
+#define TEXT_MAX		256
+
+typedef struct Result {
+	const char *name;
+	unsigned long values, bad;
+} Result;
+
+static uint32_t seed = 0x2545F491UL;
+static char flushed[TEXT_MAX];
+static uint16_t flushedLength;
+static unsigned flushes;
+
+// xorshift32, so every bit of a 32-bit value gets exercised
+static uint32_t random32() {
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static void compare(Result *r, const char *text, uint8_t length,
+		const char *expected) {
+	r->values++;
+	if (strcmp(text, expected) != 0 || length != strlen(expected)) {
+		if (r->bad++ < 5)
+			printf("mismatch,%s,\"%s\" (%u),expected \"%s\"\n", r->name, text,
+					length, expected);
+	}
+}
+
+static void report(const Result *r) {
+	printf("%s,%lu values,%lu bad\n", r->name, r->values, r->bad);
+}
+
+static void check32(Result *u, Result *s, uint32_t value) {
+	char text[FORMAT_INT32_SIZE], expected[32];
+	uint8_t length;
+	length = Format_uint32(text, value);
+	snprintf(expected, sizeof expected, "%lu", (unsigned long) value);
+	compare(u, text, length, expected);
+	length = Format_int32(text, (int32_t) value);
+	snprintf(expected, sizeof expected, "%ld", (long) (int32_t) value);
+	compare(s, text, length, expected);
+}
+
+static void checkFixed(Result *r, int32_t value, uint8_t decimals) {
+	static const uint32_t scale[] = { 1, 10, 100, 1000, 10000 };
+	char text[FORMAT_INT32_SIZE], expected[32];
+	uint32_t magnitude = value < 0 ? 0UL - (uint32_t) value : (uint32_t) value;
+	uint8_t length = Format_fixed(text, value, decimals);
+	snprintf(expected, sizeof expected, "%s%lu.%0*lu", value < 0 ? "-" : "",
+			(unsigned long) (magnitude / scale[decimals]), decimals,
+			(unsigned long) (magnitude % scale[decimals]));
+	compare(r, text, length, expected);
+}
+
+static void flush(const char data[], uint16_t length) {
+	if (flushedLength + length < TEXT_MAX) {
+		memcpy(&flushed[flushedLength], data, length);
+		flushedLength += length;
+	}
+	flushes++;
+}
+
+// The same line built with and without a flush function, and by snprintf()
+static void checkBuilder(Result *r, int16_t d, uint16_t u, int32_t ld,
+		uint32_t lu) {
+	Format_Builder b;
+	char text[TEXT_MAX], chunk[CHUNK], expected[TEXT_MAX];
+	uint16_t total;
+	snprintf(expected, sizeof expected,
+			"d=%d %6d %06d u=%u %5u %05u ld=%ld %12ld lu=%lu %010lu x=%X %04X"
+			" s=%s %8s c=%c %%", d, d, d, u, u, u, (long) ld, (long) ld,
+			(unsigned long) lu, (unsigned long) lu, u, u, "ok", "pad", '!');
+#define LINE	"d=%d %6d %06d u=%u %5u %05u ld=%ld %12ld lu=%lu %010lu x=%x %04x" \
+			" s=%s %8s c=%c %%", d, d, d, u, u, u, (long) ld, (long) ld, \
+			(unsigned long) lu, (unsigned long) lu, u, u, "ok", "pad", '!'
+	Format_begin(&b, text, sizeof text, 0);
+	Format_append(&b, LINE);
+	total = Format_end(&b);
+	compare(r, text, (uint8_t) total, expected);
+	r->bad += b.truncated;
+
+	flushedLength = 0;
+	Format_begin(&b, chunk, sizeof chunk, flush);
+	Format_append(&b, LINE);
+	total = Format_end(&b);
+	flushed[flushedLength] = '\0';
+	compare(r, flushed, (uint8_t) total, expected);
+	r->bad += b.truncated || flushedLength != total;
+#undef LINE
+}
+
+int main(int argc, char *argv[]) {
+	static const uint32_t edges[] = { 0, 1, 9, 10, 99999, 100000, 0xFFFF,
+			0x10000, 9999999, 10000000, 99999999, 100000000, 999999999,
+			1000000000, 0x7FFFFFFF, 0x80000000, 0x80000001, 0xFFFFFFFF };
+	Result u16 = { .name = "uint16" };
+	Result s16 = { .name = "int16" };
+	Result u32 = { .name = "uint32" };
+	Result s32 = { .name = "int32" };
+	Result fixed = { .name = "fixed" };
+	Result builder = { .name = "builder" };
+	Result truncation = { .name = "truncation" };
+	char text[FORMAT_INT32_SIZE], expected[32], small[10];
+	Format_Builder b;
+	uint32_t value, i;
+	uint16_t total;
+	uint8_t length, decimals;
+
+	for (value = 0; value <= 0xFFFF; value++) {
+		length = Format_uint16(text, (uint16_t) value);
+		snprintf(expected, sizeof expected, "%u", (unsigned) value);
+		compare(&u16, text, length, expected);
+		length = Format_int16(text, (int16_t) value);
+		snprintf(expected, sizeof expected, "%d", (int16_t) value);
+		compare(&s16, text, length, expected);
+	}
+	for (i = 0; i < sizeof edges / sizeof edges[0]; i++) {
+		check32(&u32, &s32, edges[i]);
+		check32(&u32, &s32, 0UL - edges[i]);
+		for (decimals = 1; decimals <= 4; decimals++)
+			checkFixed(&fixed, (int32_t) edges[i], decimals);
+	}
+	for (i = 0; i < RANDOM; i++) {
+		value = random32();
+		check32(&u32, &s32, value);
+		check32(&u32, &s32, value >> (value & 31));	// Every length of number
+		checkFixed(&fixed, (int32_t) (value >> (value & 31)), (uint8_t) (i % 4 + 1));
+	}
+	for (i = 0; i < RANDOM / 100; i++) {
+		value = random32();
+		checkBuilder(&builder, (int16_t) value, (uint16_t) (value >> 16),
+				(int32_t) random32(), random32() >> (value & 31));
+	}
+	checkBuilder(&builder, -32768, 0xFFFF, (int32_t) 0x80000000, 0xFFFFFFFF);
+
+	// Nine characters and the terminator fit; the rest is counted
+	Format_begin(&b, small, sizeof small, 0);
+	Format_append(&b, "%ld,%s", -123456789L, "dropped");
+	total = Format_end(&b);
+	compare(&truncation, small, (uint8_t) strlen(small), "-12345678");
+	truncation.bad += !b.truncated || total != 18;
+
+	report(&u16);
+	report(&s16);
+	report(&u32);
+	report(&s32);
+	report(&fixed);
+	report(&builder);
+	report(&truncation);
+	printf("flush,%u chunks of %u\n", flushes, CHUNK);
+	return (u16.bad || s16.bad || u32.bad || s32.bad || fixed.bad || builder.bad
+			|| truncation.bad) ? 1 : 0;
+}
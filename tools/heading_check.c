@@ -0,0 +1,88 @@
+/*
+ * heading_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Accuracy of Heading_fromXY() against double precision atan2 over the
+ * int16 plane: every vector with both components within SMALL of zero,
+ * where the counts are coarsest, every vector along the axes and edges of
+ * the range, and a grid of every STRIDE'th count across the whole plane.
+ * The error is taken against the exact angle in tenths, modulo a full
+ * turn, so the 0.5 of rounding to tenths is part of it.
+ *
+ * Host timings would only compare against a hardware FPU, so the cycle
+ * comparison is on the device: the heading and heading_float stages of the
+ * BENCHMARK build time Heading_fromXY() and the libm atan2() it replaced on
+ * the same vectors.
+ *
+ * Build on Linux:  cc -O2 -o heading_check heading_check.c ../Heading.c -lm
+ * Usage:           heading_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../Heading.h"
+
+#define SMALL		256
+#define STRIDE		7
+#define MAX_ERROR	0.6			// Tenths: 0.5 rounding plus CORDIC residue
+#define TENTHS		(1800.0 / 3.14159265358979323846)
+
+typedef struct Result {
+	const char *name;
+	unsigned long vectors, bad;
+	double maxError;
+	int worstX, worstY;
+} Result;
+
+static void check(Result *r, int x, int y) {
+	double error;
+	int16_t heading = Heading_fromXY((int16_t) x, (int16_t) y);
+	r->vectors++;
+	if (x == 0 && y == 0) {
+		r->bad += heading != 0;
+		return;
+	}
+	error = fabs(heading - atan2(x, y) * TENTHS);
+	if (error > 1800)
+		error = 3600 - error;	// -1800 and 1800 are the same heading
+	if (heading < -1800 || heading > 1800 || error > MAX_ERROR)
+		r->bad++;
+	if (error > r->maxError) {
+		r->maxError = error;
+		r->worstX = x;
+		r->worstY = y;
+	}
+}
+
+static void report(const Result *r) {
+	printf("%s,%lu vectors,max error %.3f tenths at (%d,%d),%lu bad\n",
+			r->name, r->vectors, r->maxError, r->worstX, r->worstY, r->bad);
+}
+
+int main(int argc, char *argv[]) {
+	static const int edges[] = { -32768, -32767, -1, 0, 1, 32766, 32767 };
+	Result small = { .name = "small" };
+	Result axes = { .name = "edges" };
+	Result grid = { .name = "grid" };
+	unsigned e;
+	int x, y;
+
+	for (x = -SMALL; x <= SMALL; x++)
+		for (y = -SMALL; y <= SMALL; y++)
+			check(&small, x, y);
+	for (e = 0; e < sizeof edges / sizeof edges[0]; e++) {
+		for (y = -32768; y <= 32767; y++)
+			check(&axes, edges[e], y);
+		for (x = -32768; x <= 32767; x++)
+			check(&axes, x, edges[e]);
+	}
+	for (x = -32768; x <= 32767; x += STRIDE)
+		for (y = -32768; y <= 32767; y += STRIDE)
+			check(&grid, x, y);
+	report(&small);
+	report(&axes);
+	report(&grid);
+	return (small.bad || axes.bad || grid.bad) ? 1 : 0;
+}
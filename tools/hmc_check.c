@@ -0,0 +1,403 @@
+/*
+ * hmc_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs HMC5883L.c and HMCAcquire.c, with I2CEngine.c, Timebase.c and
+ * DMAService.c under them, against the HMC5883L model in tools/sim on the
+ * USCI_B1 I2C model, its DRDY on P2.6.
+ *
+ * initialize  HMC_initialize() has to leave the part measuring continuously
+ *             at 75 Hz, DRDY coming a period apart, with readings of the
+ *             field at gain 390
+ * overflow    an axis beyond full scale reads -4096, the others as usual
+ * autorange   samples from HMCAcquire through HMC_autoRange(), as the main
+ *             loop takes them, while the field steps weak, strong and in
+ *             between: the gain has to settle where the thresholds put it,
+ *             one step per change, and every sample let through has to be
+ *             the field at the gain it was tagged with, so neither an
+ *             overflow nor one measured before the change took effect
+ * selftest    HMC_selfTest() with the bias straps: a sound part passes with
+ *             unit corrections, a weak axis passes with its correction, and
+ *             a dead axis or a field that saturates the biased reading
+ *             fails.  The configuration has to be put back each time, once
+ *             the last byte of the write that restores it is out: the
+ *             engine reports a write done as the STOP is queued.
+ * calibrated  samples through HMC_normalize() and MagCal.c as the main loop
+ *             takes them, on a part with a weak Y axis: uncalibrated
+ *             headings have to come out right on the self-test corrections
+ *             alone, and after a calibration run at one gain, headings
+ *             taken while auto-ranging walks back from a much less
+ *             sensitive gain have to come out right at every step.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -fcommon -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o hmc_check tools/hmc_check.c HMC5883L.c HMCAcquire.c I2CEngine.c
+ *        Timebase.c DMAService.c MagCal.c FixedMath.c CrcCcitt.c Heading.c
+ *        tools/sim/sim.c tools/sim/sim_models.c tools/sim/sim_devices.c
+ *        tools/sim/sim_flash.c driverlib/MSP430F5xx_6xx/crc.c
+ *        driverlib/MSP430F5xx_6xx/dma.c driverlib/MSP430F5xx_6xx/gpio.c
+ *        driverlib/MSP430F5xx_6xx/timer_a.c
+ *        driverlib/MSP430F5xx_6xx/usci_b_i2c.c
+ * Usage:      hmc_check
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "HMC5883L.h"
+#include "HMCAcquire.h"
+#include "Heading.h"
+#include "I2CEngine.h"
+#include "MagCal.h"
+#include "Timebase.h"
+#include "tools/sim/sim.h"
+
+// MSP430F5529 vector numbers, so the priorities are the device's
+#define PORT2_VECTOR_SIM	42
+#define USCI_B1_VECTOR_SIM	45
+#define TIMER1_A1_SIM		48
+#define TIMER1_A0_SIM		49
+#define DMA_VECTOR_SIM		50
+
+#define DRDY_PIN			0x40		// P2.6
+#define PERIOD_75HZ			(SIM_MCLK / 75)
+#define PHASE_SAMPLES		40			// At 75 Hz
+#define SETTLED				20			// The last samples of a phase, steady
+#define Q14_ONE				16384
+#define CORRECTION_ERROR	(Q14_ONE / 100)
+#define BYTE_BITS			9			// With the acknowledge
+#define STALE_SAMPLES		2			// Measured before a field change
+#define DIRECTION_SAMPLES	12			// Enough for auto-ranging to walk back
+#define MAX_HEADING			10			// Tenths of a degree
+
+typedef struct Phase {
+	int16_t field[3];				// mGa
+	uint8_t gain;					// Where it has to settle
+	uint8_t steps;					// Changes on the way
+} Phase;
+
+typedef struct SelfTest {
+	const char *name;
+	int16_t field[3];
+	int16_t sensitivity[3];			// Per mille
+	bool pass;
+} SelfTest;
+
+// The drivers' ISRs and flags, declared in their .c files only
+void I2CEngine_USCI_B1_ISR(void);
+void HMC_PORT2_ISR(void);
+void Timebase_TIMER1_A1_ISR(void);
+void DMAService_ISR(void);
+extern bool dataReady;
+
+static const uint16_t gainLSB[8] = { 1370, 1090, 820, 660, 440, 390, 330,
+		230 };
+
+static const Phase phases[] = {
+	{ { 1000, 200, -300 }, HMC5883L_GAIN_1370, 5 },
+	{ { 7000, -400, 900 }, HMC5883L_GAIN_220, 7 },
+	{ { 3000, 500, -800 }, HMC5883L_GAIN_440, 3 },
+};
+#define PHASES				(sizeof phases / sizeof phases[0])
+
+static const SelfTest selfTests[] = {
+	{ "sound", { 200, -100, 450 }, { 1000, 1000, 1000 }, true },
+	{ "weak y", { 200, -100, 450 }, { 1000, 800, 1000 }, true },
+	{ "dead z", { 200, -100, 450 }, { 1000, 1000, 300 }, false },
+	{ "saturated", { 5000, 0, 0 }, { 1000, 1000, 1000 }, false },
+};
+#define SELF_TESTS			(sizeof selfTests / sizeof selfTests[0])
+
+// mGa: a 500 mGa field turned through the axes and the diagonals between
+// them for a calibration run, then level headings with a 300 mGa dip
+static const int16_t turns[][3] = {
+	{ 500, 0, 0 }, { -500, 0, 0 }, { 0, 500, 0 }, { 0, -500, 0 },
+	{ 0, 0, 500 }, { 0, 0, -500 }, { 289, 289, 289 }, { -289, -289, -289 },
+};
+#define TURNS				(sizeof turns / sizeof turns[0])
+static const int16_t headings[][3] = {
+	{ 500, 0, -300 }, { 354, 354, -300 }, { 0, 500, -300 },
+	{ -354, 354, -300 }, { -500, 0, -300 }, { -354, -354, -300 },
+	{ 0, -500, -300 }, { 354, -354, -300 },
+};
+#define HEADINGS			(sizeof headings / sizeof headings[0])
+static const int16_t hardIron[3] = { 150, -90, 60 };	// mGa
+
+static Sim_Model *i2c;
+static Sim_I2cDevice *hmc;
+
+// What the drivers call outside the models
+uint32_t UCS_getSMCLK() {
+	return SIM_MCLK;
+}
+
+bool BackChannel_Connected() {
+	return false;
+}
+
+void BackChannel_Write(unsigned char text[]) {
+}
+
+void BackChannel_WriteLine(unsigned char text[]) {
+}
+
+void BackChannel_Printf(const char *format, ...) {
+}
+
+bool Scheduler_post(Scheduler_Task *task) {
+	return false;
+}
+
+// The reading the data sheet gives for a field at a gain
+static int16_t counts(int16_t field, uint8_t gain) {
+	int32_t c = (int32_t) field * gainLSB[gain];
+	c = (c + (c < 0 ? -500 : 500)) / 1000;
+	return (c > 2047 || c < -2048) ? HMC5883L_OVERFLOW : (int16_t) c;
+}
+
+static uint32_t waitDrdy() {
+	dataReady = false;
+	while (!dataReady)
+		__bis_SR_register(LPM0_bits + GIE);
+	return (uint32_t) Sim_cycles;
+}
+
+static uint32_t checkReading(const int16_t field[3], uint8_t gain) {
+	int16_t x, y, z;
+	waitDrdy();
+	HMC_getHeading(&x, &y, &z);
+	return x != counts(field[0], gain) || y != counts(field[1], gain)
+			|| z != counts(field[2], gain);
+}
+
+static uint32_t checkInitialize() {
+	static const int16_t field[3] = { 200, -100, 450 };
+	const uint8_t *r = Sim_hmcRegisters(hmc);
+	uint32_t bad, gap;
+
+	Sim_hmcField(hmc, field[0], field[1], field[2]);
+	bad = HMC_testConnection() != STATUS_SUCCESS;
+	bad += HMC_initialize() != STATUS_SUCCESS;
+	bad += r[HMC5883L_RA_CONFIG_A] != 0x58 || r[HMC5883L_RA_CONFIG_B] != 0xA0
+			|| r[HMC5883L_RA_MODE] != HMC5883L_MODE_CONTINUOUS;
+	gap = waitDrdy();
+	gap = waitDrdy() - gap;
+	bad += labs((long) gap - (long) PERIOD_75HZ) > 2 * SIM_IDLE_STEP;
+	bad += checkReading(field, HMC5883L_GAIN_390);
+	printf("initialize,%02X %02X %02X,DRDY every %lu cycles,%lu at 75 Hz,%s\n",
+			r[0], r[1], r[2], (unsigned long) gap, (unsigned long) PERIOD_75HZ,
+			bad ? "bad" : "ok");
+	return bad;
+}
+
+static uint32_t checkOverflow() {
+	static const int16_t field[3] = { 6000, 300, -500 };
+	uint32_t bad;
+	int16_t x, y, z;
+
+	Sim_hmcField(hmc, field[0], field[1], field[2]);
+	waitDrdy();
+	waitDrdy();
+	HMC_getHeading(&x, &y, &z);
+	bad = x != HMC5883L_OVERFLOW || y != counts(field[1], HMC5883L_GAIN_390)
+			|| z != counts(field[2], HMC5883L_GAIN_390);
+	printf("overflow,%d %d %d,%s\n", x, y, z, bad ? "bad" : "ok");
+	return bad;
+}
+
+static uint32_t checkAutoRange() {
+	const Phase *p;
+	HMC_Sample s;
+	uint32_t bad = 0, stepBad, wrong, kept, steps, lateSteps;
+	uint8_t n, gain;
+	uint16_t i;
+
+	HMCAcquire_start(1);
+	for (n = 0; n < PHASES; n++) {
+		p = &phases[n];
+		Sim_hmcField(hmc, p->field[0], p->field[1], p->field[2]);
+		wrong = kept = steps = lateSteps = 0;
+		for (i = 0; i < PHASE_SAMPLES; i++) {
+			HMCAcquire_waitBatch();
+			HMCAcquire_read(&s);
+			gain = HMC_getGain();
+			if (HMC_autoRange(s.x, s.y, s.z, s.gain)) {
+				kept++;
+				wrong += s.x != counts(p->field[0], s.gain)
+						|| s.y != counts(p->field[1], s.gain)
+						|| s.z != counts(p->field[2], s.gain);
+			}
+			if (HMC_getGain() != gain) {
+				steps += abs(HMC_getGain() - gain) == 1 ? 1 : 100;
+				lateSteps += i >= PHASE_SAMPLES - SETTLED;
+			}
+		}
+		stepBad = HMC_getGain() != p->gain || steps != p->steps || lateSteps
+				|| wrong || !kept;
+		printf("autorange,%d %d %d mGa,gain %u,%lu steps,%lu of %u kept,"
+				"%lu wrong,%s\n", p->field[0], p->field[1], p->field[2],
+				HMC_getGain(), (unsigned long) steps, (unsigned long) kept,
+				PHASE_SAMPLES, (unsigned long) wrong, stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+	HMCAcquire_stop();
+	return bad;
+}
+
+static uint32_t checkSelfTest() {
+	const SelfTest *t;
+	const uint8_t *r = Sim_hmcRegisters(hmc);
+	uint8_t before[3];
+	int16_t correction[3], expected;
+	uint32_t bad = 0, stepBad;
+	bool passed;
+	uint8_t n, i;
+
+	for (n = 0; n < SELF_TESTS; n++) {
+		t = &selfTests[n];
+		Sim_hmcField(hmc, t->field[0], t->field[1], t->field[2]);
+		Sim_hmcSensitivity(hmc, t->sensitivity[0], t->sensitivity[1],
+				t->sensitivity[2]);
+		memcpy(before, r, sizeof before);
+		passed = HMC_selfTest(correction) == STATUS_SUCCESS;
+		__delay_cycles(2 * BYTE_BITS * Sim_i2cBitCycles(i2c));	// The last one out
+		stepBad = passed != t->pass || memcmp(before, r, sizeof before) != 0;
+		for (i = 0; i < 3 && t->pass; i++) {
+			expected = (int16_t) ((int32_t) Q14_ONE * 1000 / t->sensitivity[i]);
+			stepBad += abs(correction[i] - expected) > CORRECTION_ERROR;
+		}
+		for (i = 0; i < 3 && !t->pass && t->sensitivity[i] < 500; i++)
+			stepBad += correction[i] != 0;
+		printf("selftest,%s,%s,corrections %d %d %d,%s\n", t->name,
+				passed ? "passed" : "failed", correction[0], correction[1],
+				correction[2], stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+	Sim_hmcSensitivity(hmc, 1000, 1000, 1000);
+	return bad;
+}
+
+// Field plus hard iron into the model, then past the samples measured before
+static void setField(const int16_t field[3], const int16_t offset[3]) {
+	HMC_Sample s;
+	uint8_t i;
+	Sim_hmcField(hmc, field[0] + offset[0], field[1] + offset[1],
+			field[2] + offset[2]);
+	for (i = 0; i < STALE_SAMPLES; i++) {
+		HMCAcquire_waitBatch();
+		HMCAcquire_read(&s);
+	}
+}
+
+// The next sample as processSamples() takes it; false if it was dropped
+static bool take(HMC_Sample *s) {
+	HMCAcquire_waitBatch();
+	HMCAcquire_read(s);
+	if (!HMC_autoRange(s->x, s->y, s->z, s->gain))
+		return false;
+	HMC_normalize(&s->x, &s->y, &s->z, s->gain);
+	return true;
+}
+
+// Worst heading error, tenths of a degree, over the level headings.  Each
+// starts at startGain, so auto-ranging has to walk back to gain 1370.
+// gains gets a bit per gain a kept sample was taken at.
+static int16_t worstHeading(const int16_t offset[3], uint8_t startGain,
+		uint8_t *gains) {
+	HMC_Sample s;
+	int16_t error, worst = 0;
+	uint8_t n, i;
+	*gains = 0;
+	for (n = 0; n < HEADINGS; n++) {
+		HMC_setGain(startGain);
+		setField(headings[n], offset);
+		for (i = 0; i < DIRECTION_SAMPLES; i++) {
+			if (!take(&s))
+				continue;
+			*gains |= 1 << s.gain;
+			MagCal_apply(&s.x, &s.y, &s.z);
+			error = Heading_fromXY(s.x, s.y)
+					- Heading_fromXY(headings[n][0], headings[n][1]);
+			if (error > 1800)
+				error -= 3600;
+			if (error < -1800)
+				error += 3600;
+			if (abs(error) > worst)
+				worst = (int16_t) abs(error);
+		}
+	}
+	return worst;
+}
+
+static uint32_t checkCalibrated() {
+	static const int16_t none[3] = { 0, 0, 0 };
+	int16_t correction[3], worst;
+	HMC_Sample s;
+	uint32_t bad, stepBad;
+	uint8_t n, i, gains;
+
+	Sim_hmcField(hmc, 0, 0, 0);
+	Sim_hmcSensitivity(hmc, 1000, 880, 1000);
+	bad = HMC_selfTest(correction) != STATUS_SUCCESS;
+	__delay_cycles(2 * BYTE_BITS * Sim_i2cBitCycles(i2c));
+	HMC_setGainCorrection(correction);
+	MagCal_clear();
+	HMCAcquire_start(1);
+
+	worst = worstHeading(none, HMC5883L_GAIN_1370, &gains);
+	bad += worst > MAX_HEADING;
+	printf("calibrated,uncorrected,heading within %d.%d deg,%s\n", worst / 10,
+			worst % 10, worst > MAX_HEADING ? "bad" : "ok");
+
+	MagCal_beginCollect();
+	for (n = 0; n < TURNS; n++) {
+		setField(turns[n], hardIron);
+		for (i = 0; i < DIRECTION_SAMPLES; i++)
+			if (take(&s))
+				MagCal_collect(s.x, s.y, s.z);
+	}
+	stepBad = MagCal_finishCollect() != STATUS_SUCCESS;
+	worst = worstHeading(hardIron, HMC5883L_GAIN_440, &gains);
+	stepBad += worst > MAX_HEADING || gains == 1 << HMC5883L_GAIN_1370;
+	printf("calibrated,offset %d %d %d,gains %02X,heading within %d.%d deg,%s\n",
+			MagCal_getParams()->offset[0], MagCal_getParams()->offset[1],
+			MagCal_getParams()->offset[2], gains, worst / 10, worst % 10,
+			stepBad ? "bad" : "ok");
+	HMCAcquire_stop();
+	Sim_hmcSensitivity(hmc, 1000, 1000, 1000);
+	return bad + stepBad;
+}
+
+int main(int argc, char *argv[]) {
+	Sim_Model *port;
+	uint32_t bad;
+
+	Sim_reset();
+	Sim_mpy32(MPY32_BASE);
+	Sim_crc16(CRC_BASE);
+	Sim_timerA(TIMER_A1_BASE, TIMEBASE_TICKS_PER_SEC, TIMER1_A0_SIM,
+			TIMER1_A1_SIM);
+	Sim_dma(DMA_BASE, DMA_VECTOR_SIM);
+	i2c = Sim_usciI2c(USCI_B1_BASE, SIM_MCLK, USCI_B1_VECTOR_SIM,
+			SIM_TRIGGER_UCB1RXIFG, SIM_TRIGGER_UCB1TXIFG);
+	port = Sim_port(P2_BASE + OFS_P2IN, PORT2_VECTOR_SIM);
+	hmc = Sim_hmc5883l(port, DRDY_PIN);
+	Sim_i2cAttach(i2c, hmc);
+	Sim_attach(USCI_B1_VECTOR_SIM, I2CEngine_USCI_B1_ISR);
+	Sim_attach(PORT2_VECTOR_SIM, HMC_PORT2_ISR);
+	Sim_attach(TIMER1_A1_SIM, Timebase_TIMER1_A1_ISR);
+	Sim_attach(DMA_VECTOR_SIM, DMAService_ISR);
+
+	Timebase_init();
+	I2CEngine_initBus(USCI_B1_BASE, I2CENGINE_FAST_MODE);
+	__enable_interrupt();
+	bad = checkInitialize();
+	bad += checkOverflow();
+	bad += checkAutoRange();
+	bad += checkSelfTest();
+	bad += checkCalibrated();
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * magcal_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * MagCal.c against synthetic magnetometer data.  A field of FIELD counts is
+ * turned through POINTS directions spread evenly over the sphere, then
+ * distorted as a badly mounted sensor would see it,
+ *
+ *     raw = A * field + offset + noise
+ *
+ * with A the soft iron matrix, and rounded to counts.  A calibration run
+ * over the raw samples has to find the offset, and MagCal_apply() on the
+ * MPY32 model has to turn the ellipsoid back into a sphere: the spread of
+ * the corrected magnitudes, and the worst heading in the X-Y plane against
+ * the undistorted field's, are checked for each case.
+ *
+ * sphere    no distortion
+ * hard      offset only
+ * axes      offset and a different gain on each axis, which the per-axis
+ *           extremes can undo
+ * tilted    offset and gains along axes turned away from the sensor's.
+ *           The extremes can't see that, so the calibration run is only
+ *           reported, and the correction has to come from an off-line
+ *           ellipsoid fit: the exact inverse of A, in Q15, through
+ *           MagCal_setParams().
+ * cap       the unit hardly turned, so MagCal_finishCollect() must refuse
+ *           and leave the correction alone
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o magcal_check tools/magcal_check.c MagCal.c FixedMath.c CrcCcitt.c
+ *        tools/sim/sim.c tools/sim/sim_models.c tools/sim/sim_flash.c
+ *        driverlib/MSP430F5xx_6xx/crc.c -lm
+ * Usage:      magcal_check
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "MagCal.h"
+#include "tools/sim/sim.h"
+
+#define POINTS			2000
+#define FIELD			540.0		// 0.5 Ga at gain 1, 1090 counts/Ga
+#define NOISE			2			// Counts either way
+#define MAX_SPREAD		2.0			// % of the mean corrected magnitude
+#define MAX_HEADING		1.0			// Degrees
+#define MAX_OFFSET		(0.01 * FIELD + NOISE)
+#define HORIZONTAL		0.5			// Of FIELD, for a heading to mean much
+#define PI				3.14159265358979323846
+
+typedef struct Case {
+	const char *name;
+	double offset[3];
+	double gain[3];					// Soft iron, along axes turned by...
+	double yaw, pitch;				// ...these, degrees
+} Case;
+
+typedef struct Error {
+	double spread;					// % of the mean magnitude
+	double heading;					// Worst, degrees
+} Error;
+
+static const Case cases[] = {
+	{ "sphere", { 0, 0, 0 }, { 1, 1, 1 }, 0, 0 },
+	{ "hard", { 120, -340, 75 }, { 1, 1, 1 }, 0, 0 },
+	{ "axes", { -210, 95, 160 }, { 1.25, 0.8, 1.1 }, 0, 0 },
+	{ "tilted", { 60, 180, -130 }, { 1.3, 0.75, 1.05 }, 35, 20 },
+};
+#define CASES			(sizeof cases / sizeof cases[0])
+
+static double field[POINTS][3];
+static int16_t raw[POINTS][3];
+static uint32_t seed = 1;
+
+static int16_t noise() {
+	seed = seed * 1103515245 + 12345;
+	return (int16_t) ((seed >> 16) % (2 * NOISE + 1)) - NOISE;
+}
+
+// Fibonacci lattice: POINTS nearly equally spaced directions
+static void makeField() {
+	double z, r, angle;
+	uint16_t i;
+	for (i = 0; i < POINTS; i++) {
+		z = 1 - (2 * i + 1.0) / POINTS;
+		r = sqrt(1 - z * z);
+		angle = i * PI * (3 - sqrt(5.0));
+		field[i][0] = FIELD * r * cos(angle);
+		field[i][1] = FIELD * r * sin(angle);
+		field[i][2] = FIELD * z;
+	}
+}
+
+static void multiply(double out[3][3], const double a[3][3], const double b[3][3]) {
+	uint8_t i, j, k;
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 3; j++) {
+			out[i][j] = 0;
+			for (k = 0; k < 3; k++)
+				out[i][j] += a[i][k] * b[k][j];
+		}
+	}
+}
+
+// A = R * diag(gain) * R', R a yaw then a pitch
+static void softIron(const Case *c, double a[3][3]) {
+	double y = c->yaw * PI / 180, p = c->pitch * PI / 180;
+	double yaw[3][3] = { { cos(y), -sin(y), 0 }, { sin(y), cos(y), 0 },
+			{ 0, 0, 1 } };
+	double pitch[3][3] = { { cos(p), 0, sin(p) }, { 0, 1, 0 },
+			{ -sin(p), 0, cos(p) } };
+	double r[3][3], scaled[3][3], t[3][3];
+	uint8_t i, j;
+	multiply(r, yaw, pitch);
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++) {
+			scaled[i][j] = r[i][j] * c->gain[j];
+			t[i][j] = r[j][i];
+		}
+	multiply(a, scaled, t);
+}
+
+static void distort(const Case *c, uint16_t points) {
+	double a[3][3];
+	uint16_t i;
+	uint8_t j;
+	softIron(c, a);
+	for (i = 0; i < points; i++)
+		for (j = 0; j < 3; j++)
+			raw[i][j] = (int16_t) lround(a[j][0] * field[i][0]
+					+ a[j][1] * field[i][1] + a[j][2] * field[i][2]
+					+ c->offset[j]) + noise();
+}
+
+// The off-line fit's answer: A inverse, scaled into Q15, and the offset
+static void exactParams(const Case *c, MagCal_Params *p) {
+	double a[3][3], inverse[3][3], det, largest = 0;
+	uint8_t i, j;
+	softIron(c, a);
+	det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+			- a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+			+ a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++) {
+			inverse[j][i] = (a[(i + 1) % 3][(j + 1) % 3] * a[(i + 2) % 3][(j + 2) % 3]
+					- a[(i + 1) % 3][(j + 2) % 3] * a[(i + 2) % 3][(j + 1) % 3]) / det;
+			if (fabs(inverse[j][i]) > largest)
+				largest = fabs(inverse[j][i]);
+		}
+	p->magic = MAGCAL_MAGIC;
+	for (i = 0; i < 3; i++)
+		p->offset[i] = (int16_t) lround(c->offset[i]);
+	for (i = 0; i < 9; i++)
+		p->matrix[i] = (int16_t) lround(inverse[i / 3][i % 3] / largest
+				* MAGCAL_Q15_ONE);
+}
+
+// Corrected magnitudes and headings over every point, through MagCal_apply()
+static Error measure(bool correct) {
+	Error e = { 0, 0 };
+	double magnitude, least = 1e9, most = 0, sum = 0, error;
+	int16_t x, y, z;
+	uint16_t i;
+	for (i = 0; i < POINTS; i++) {
+		x = raw[i][0];
+		y = raw[i][1];
+		z = raw[i][2];
+		if (correct)
+			MagCal_apply(&x, &y, &z);
+		magnitude = sqrt((double) x * x + (double) y * y + (double) z * z);
+		sum += magnitude;
+		if (magnitude < least)
+			least = magnitude;
+		if (magnitude > most)
+			most = magnitude;
+		if (hypot(field[i][0], field[i][1]) < HORIZONTAL * FIELD)
+			continue;
+		error = fabs(atan2(y, x) - atan2(field[i][1], field[i][0])) * 180 / PI;
+		if (error > 180)
+			error = 360 - error;
+		if (error > e.heading)
+			e.heading = error;
+	}
+	e.spread = (most - least) / (sum / POINTS) * 100;
+	return e;
+}
+
+static void calibrate(uint16_t points) {
+	uint16_t i;
+	MagCal_beginCollect();
+	for (i = 0; i < points; i++)
+		MagCal_collect(raw[i][0], raw[i][1], raw[i][2]);
+}
+
+int main(int argc, char *argv[]) {
+	MagCal_Params exact, before;
+	const MagCal_Params *p;
+	const Case *c;
+	Error plain, run, fit;
+	double offsetError;
+	uint32_t bad = 0, caseBad;
+	uint8_t n, i;
+
+	Sim_reset();
+	Sim_mpy32(MPY32_BASE);
+	Sim_crc16(CRC_BASE);
+	makeField();
+	MagCal_clear();
+
+	for (n = 0; n < CASES; n++) {
+		c = &cases[n];
+		distort(c, POINTS);
+		plain = measure(false);
+		calibrate(POINTS);
+		caseBad = MagCal_finishCollect() != STATUS_SUCCESS;
+		p = MagCal_getParams();
+		offsetError = 0;
+		for (i = 0; i < 3; i++)
+			offsetError = fmax(offsetError, fabs(p->offset[i] - c->offset[i]));
+		run = measure(true);
+		printf("%s,offset %d %d %d,error %.1f,spread %.1f%% raw %.1f%%,"
+				"heading %.2f deg raw %.2f deg", c->name, p->offset[0],
+				p->offset[1], p->offset[2], offsetError, run.spread, plain.spread,
+				run.heading, plain.heading);
+		if (c->yaw == 0 && c->pitch == 0) {
+			caseBad += offsetError > MAX_OFFSET || run.spread > MAX_SPREAD
+					|| run.heading > MAX_HEADING;
+		} else {
+			exactParams(c, &exact);
+			caseBad += MagCal_setParams(&exact) != STATUS_SUCCESS;
+			fit = measure(true);
+			caseBad += fit.spread > MAX_SPREAD || fit.heading > MAX_HEADING;
+			printf(",fit spread %.1f%% heading %.2f deg", fit.spread, fit.heading);
+		}
+		printf(",%s\n", caseBad ? "bad" : "ok");
+		bad += caseBad;
+	}
+
+	// A cap of the sphere around +Z, where Z hardly changes
+	c = &cases[1];
+	distort(c, POINTS / 50);
+	before = *MagCal_getParams();
+	calibrate(POINTS / 50);
+	caseBad = MagCal_finishCollect() != STATUS_FAIL;
+	caseBad += memcmp(&before, MagCal_getParams(), sizeof before) != 0;
+	printf("cap,%u points,%s\n", POINTS / 50, caseBad ? "bad" : "ok");
+	bad += caseBad;
+	return bad ? 1 : 0;
+}
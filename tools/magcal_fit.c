@@ -0,0 +1,415 @@
+/*
+ * magcal_fit.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Off-line ellipsoid fit for MagCal.c.  Soft iron along axes turned away
+ * from the sensor's skews the sphere of readings into an ellipsoid that the
+ * per-axis extremes of "cal start"/"cal stop" can't undo.  Given samples
+ * taken with the correction cleared ("cal reset", then the unit turned
+ * through every orientation while telemetry_decode records), the general
+ * quadric
+ *
+ *     a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1
+ *
+ * is fitted by least squares.  Its centre is the hard iron offset.  Its
+ * shape, divided through to a unit ellipsoid about the centre, is S, and
+ * the soft iron matrix is the symmetric square root of S scaled so the
+ * shortest semi-axis keeps its length, as MagCal_finishCollect() scales its
+ * diagonal; every entry then fits Q15.  The calset line that loads both is
+ * printed for the back channel, and the fit's numbers go to stderr.
+ *
+ * Samples are telemetry_decode's CSV, x, y and z in the third to fifth
+ * columns, or lines of just x, y and z.  Lines that aren't numbers, the
+ * CSV header among them, are skipped.
+ *
+ * -t fits points on the distorted spheres of magcal_check, turned soft iron
+ * among them, and checks the offset, the spread of the corrected magnitudes
+ * and the headings, with the matrix rounded to Q15 as the device has it.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -o magcal_fit tools/magcal_fit.c -lm
+ * Usage:      magcal_fit [-t] [samples.csv]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define MAX_POINTS		100000
+#define MIN_POINTS		50
+#define TERMS			9
+#define Q15_ONE			32767		// MAGCAL_Q15_ONE
+#define LINE_MAX		256
+#define PI				3.14159265358979323846
+
+// Self-test, the synthetic data of magcal_check
+#define TEST_POINTS		2000
+#define FIELD			540.0		// 0.5 Ga at gain 1090
+#define NOISE			2			// Counts either way
+#define MAX_SPREAD		2.0			// % of the mean corrected magnitude
+#define MAX_HEADING		1.0			// Degrees
+#define MAX_OFFSET		(0.01 * FIELD + NOISE)
+#define HORIZONTAL		0.5			// Of FIELD, for a heading to mean much
+
+typedef struct Fit {
+	double offset[3];
+	double axes[3];					// Semi-axes, counts
+	double matrix[3][3];			// Soft iron, largest eigenvalue 1
+	double residual;				// RMS of corrected magnitude, % of mean
+} Fit;
+
+typedef struct Case {
+	const char *name;
+	double offset[3];
+	double gain[3];					// Soft iron, along axes turned by...
+	double yaw, pitch;				// ...these, degrees
+} Case;
+
+static const Case cases[] = {
+	{ "sphere", { 0, 0, 0 }, { 1, 1, 1 }, 0, 0 },
+	{ "hard", { 120, -340, 75 }, { 1, 1, 1 }, 0, 0 },
+	{ "axes", { -210, 95, 160 }, { 1.25, 0.8, 1.1 }, 0, 0 },
+	{ "tilted", { 60, 180, -130 }, { 1.3, 0.75, 1.05 }, 35, 20 },
+	{ "steep", { -90, 40, 220 }, { 0.7, 1.35, 0.9 }, -60, 45 },
+};
+#define CASES			(sizeof cases / sizeof cases[0])
+
+static double points[MAX_POINTS][3];
+static uint32_t seed = 1;
+
+// Solve n equations in place by Gaussian elimination with partial pivoting.
+// Returns 0 if singular.
+static int solve(double a[TERMS][TERMS], double b[TERMS], int n) {
+	double t, f;
+	int i, j, k, pivot;
+	for (i = 0; i < n; i++) {
+		pivot = i;
+		for (j = i + 1; j < n; j++)
+			if (fabs(a[j][i]) > fabs(a[pivot][i]))
+				pivot = j;
+		if (fabs(a[pivot][i]) < 1e-12)
+			return 0;
+		for (k = 0; k < n; k++) {
+			t = a[i][k];
+			a[i][k] = a[pivot][k];
+			a[pivot][k] = t;
+		}
+		t = b[i];
+		b[i] = b[pivot];
+		b[pivot] = t;
+		for (j = i + 1; j < n; j++) {
+			f = a[j][i] / a[i][i];
+			for (k = i; k < n; k++)
+				a[j][k] -= f * a[i][k];
+			b[j] -= f * b[i];
+		}
+	}
+	for (i = n - 1; i >= 0; i--) {
+		for (k = i + 1; k < n; k++)
+			b[i] -= a[i][k] * b[k];
+		b[i] /= a[i][i];
+	}
+	return 1;
+}
+
+// Cyclic Jacobi: s = v * diag(e) * v', s symmetric, destroyed
+static void eigen(double s[3][3], double e[3], double v[3][3]) {
+	double theta, t, c, sn, a, b;
+	int sweep, p, q, k;
+	for (p = 0; p < 3; p++)
+		for (q = 0; q < 3; q++)
+			v[p][q] = (p == q);
+	for (sweep = 0; sweep < 50; sweep++) {
+		if (fabs(s[0][1]) + fabs(s[0][2]) + fabs(s[1][2]) < 1e-15)
+			break;
+		for (p = 0; p < 2; p++)
+			for (q = p + 1; q < 3; q++) {
+				if (s[p][q] == 0)
+					continue;
+				theta = (s[q][q] - s[p][p]) / (2 * s[p][q]);
+				t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+				c = 1 / sqrt(t * t + 1);
+				sn = t * c;
+				for (k = 0; k < 3; k++) {		// s = s * J
+					a = s[k][p];
+					b = s[k][q];
+					s[k][p] = c * a - sn * b;
+					s[k][q] = sn * a + c * b;
+				}
+				for (k = 0; k < 3; k++) {		// s = J' * s
+					a = s[p][k];
+					b = s[q][k];
+					s[p][k] = c * a - sn * b;
+					s[q][k] = sn * a + c * b;
+				}
+				for (k = 0; k < 3; k++) {		// v = v * J
+					a = v[k][p];
+					b = v[k][q];
+					v[k][p] = c * a - sn * b;
+					v[k][q] = sn * a + c * b;
+				}
+			}
+	}
+	for (k = 0; k < 3; k++)
+		e[k] = s[k][k];
+}
+
+// Least squares quadric through the points, then its centre and shape.
+// Returns 0 if the points don't lie on an ellipsoid.
+static int fit(double p[][3], int n, Fit *f) {
+	double ata[TERMS][TERMS] = { { 0 } }, atb[TERMS] = { 0 }, row[TERMS];
+	double mean[3] = { 0, 0, 0 }, scale = 0, u[3];
+	double s[3][3], inverse[3][3], centre[3], e[3], v[3][3];
+	double k, det, shortest, m, sum = 0, sum2 = 0;
+	int i, j, l;
+
+	// Fitted about the mean and scaled to about 1, for the conditioning
+	for (i = 0; i < n; i++)
+		for (j = 0; j < 3; j++)
+			mean[j] += p[i][j] / n;
+	for (i = 0; i < n; i++)
+		for (j = 0; j < 3; j++)
+			scale += (p[i][j] - mean[j]) * (p[i][j] - mean[j]) / n;
+	scale = sqrt(scale);
+	if (scale == 0)
+		return 0;
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < 3; j++)
+			u[j] = (p[i][j] - mean[j]) / scale;
+		row[0] = u[0] * u[0];
+		row[1] = u[1] * u[1];
+		row[2] = u[2] * u[2];
+		row[3] = 2 * u[0] * u[1];
+		row[4] = 2 * u[0] * u[2];
+		row[5] = 2 * u[1] * u[2];
+		row[6] = 2 * u[0];
+		row[7] = 2 * u[1];
+		row[8] = 2 * u[2];
+		for (j = 0; j < TERMS; j++) {
+			atb[j] += row[j];
+			for (l = 0; l < TERMS; l++)
+				ata[j][l] += row[j] * row[l];
+		}
+	}
+	if (!solve(ata, atb, TERMS))
+		return 0;
+	s[0][0] = atb[0];
+	s[1][1] = atb[1];
+	s[2][2] = atb[2];
+	s[0][1] = s[1][0] = atb[3];
+	s[0][2] = s[2][0] = atb[4];
+	s[1][2] = s[2][1] = atb[5];
+
+	// Centre -S^-1 g, then S over 1 + c'Sc for a unit ellipsoid about it
+	det = s[0][0] * (s[1][1] * s[2][2] - s[1][2] * s[2][1])
+			- s[0][1] * (s[1][0] * s[2][2] - s[1][2] * s[2][0])
+			+ s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+	if (det == 0)
+		return 0;
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			inverse[j][i] = (s[(i + 1) % 3][(j + 1) % 3] * s[(i + 2) % 3][(j + 2) % 3]
+					- s[(i + 1) % 3][(j + 2) % 3] * s[(i + 2) % 3][(j + 1) % 3]) / det;
+	k = 1;
+	for (i = 0; i < 3; i++)
+		centre[i] = -(inverse[i][0] * atb[6] + inverse[i][1] * atb[7]
+				+ inverse[i][2] * atb[8]);
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			k += centre[i] * s[i][j] * centre[j];
+	if (k <= 0)
+		return 0;
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++)
+			s[i][j] /= k;
+
+	// Symmetric square root, the shortest semi-axis left alone
+	eigen(s, e, v);
+	if (e[0] <= 0 || e[1] <= 0 || e[2] <= 0)
+		return 0;
+	shortest = 1e30;
+	for (i = 0; i < 3; i++) {
+		f->offset[i] = mean[i] + scale * centre[i];
+		f->axes[i] = scale / sqrt(e[i]);
+		if (f->axes[i] < shortest)
+			shortest = f->axes[i];
+	}
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++) {
+			f->matrix[i][j] = 0;
+			for (l = 0; l < 3; l++)
+				f->matrix[i][j] += v[i][l] * shortest / f->axes[l] * v[j][l];
+		}
+
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < 3; j++)
+			u[j] = p[i][j] - f->offset[j];
+		m = 0;
+		for (j = 0; j < 3; j++) {
+			k = f->matrix[j][0] * u[0] + f->matrix[j][1] * u[1]
+					+ f->matrix[j][2] * u[2];
+			m += k * k;
+		}
+		m = sqrt(m);
+		sum += m;
+		sum2 += m * m;
+	}
+	f->residual = sqrt(sum2 / n - (sum / n) * (sum / n)) / (sum / n) * 100;
+	return 1;
+}
+
+// The fit as MagCal_Params holds it
+static void quantise(const Fit *f, int16_t offset[3], int16_t matrix[9]) {
+	long q;
+	int i;
+	for (i = 0; i < 3; i++)
+		offset[i] = (int16_t) lround(f->offset[i]);
+	for (i = 0; i < 9; i++) {
+		q = lround(f->matrix[i / 3][i % 3] * Q15_ONE);
+		matrix[i] = (int16_t) (q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+	}
+}
+
+static void printCalset(const Fit *f) {
+	int16_t offset[3], matrix[9];
+	int i;
+	quantise(f, offset, matrix);
+	printf("calset ");
+	for (i = 0; i < 3; i++)
+		printf("%04x", (uint16_t) offset[i]);
+	for (i = 0; i < 9; i++)
+		printf("%04x", (uint16_t) matrix[i]);
+	printf("\n");
+}
+
+// x, y and z of a telemetry_decode CSV row or a bare triple
+static int parse(const char *line, double v[3]) {
+	double c[5];
+	if (sscanf(line, "%lf,%lf,%lf,%lf,%lf", &c[0], &c[1], &c[2], &c[3], &c[4]) == 5) {
+		memcpy(v, &c[2], sizeof c[0] * 3);
+		return 1;
+	}
+	return sscanf(line, "%lf%*[ ,\t]%lf%*[ ,\t]%lf", &v[0], &v[1], &v[2]) == 3;
+}
+
+// Self-test data: a Fibonacci lattice through A = R * diag(gain) * R'
+static int16_t noise() {
+	seed = seed * 1103515245 + 12345;
+	return (int16_t) ((seed >> 16) % (2 * NOISE + 1)) - NOISE;
+}
+
+static void softIron(const Case *c, double a[3][3]) {
+	double y = c->yaw * PI / 180, p = c->pitch * PI / 180;
+	double r[3][3] = {
+		{ cos(y) * cos(p), -sin(y), cos(y) * sin(p) },
+		{ sin(y) * cos(p), cos(y), sin(y) * sin(p) },
+		{ -sin(p), 0, cos(p) } };
+	int i, j, k;
+	for (i = 0; i < 3; i++)
+		for (j = 0; j < 3; j++) {
+			a[i][j] = 0;
+			for (k = 0; k < 3; k++)
+				a[i][j] += r[i][k] * c->gain[k] * r[j][k];
+		}
+}
+
+static void field(int i, double f[3]) {
+	double z = 1 - (2 * i + 1.0) / TEST_POINTS;
+	double r = sqrt(1 - z * z), angle = i * PI * (3 - sqrt(5.0));
+	f[0] = FIELD * r * cos(angle);
+	f[1] = FIELD * r * sin(angle);
+	f[2] = FIELD * z;
+}
+
+static int selfTest() {
+	const Case *c;
+	Fit f;
+	double a[3][3], t[3], u[3], w[3], m, least, most, sum, error, worst, offsetError;
+	int16_t offset[3], matrix[9];
+	int bad = 0, caseBad, n, i, j;
+	for (n = 0; n < (int) CASES; n++) {
+		c = &cases[n];
+		softIron(c, a);
+		for (i = 0; i < TEST_POINTS; i++) {
+			field(i, t);
+			for (j = 0; j < 3; j++)
+				points[i][j] = lround(a[j][0] * t[0] + a[j][1] * t[1]
+						+ a[j][2] * t[2] + c->offset[j]) + noise();
+		}
+		if (!fit(points, TEST_POINTS, &f)) {
+			printf("%s,no ellipsoid,bad\n", c->name);
+			bad++;
+			continue;
+		}
+		quantise(&f, offset, matrix);
+		least = 1e9;
+		most = sum = worst = offsetError = 0;
+		for (j = 0; j < 3; j++)
+			offsetError = fmax(offsetError, fabs(offset[j] - c->offset[j]));
+		for (i = 0; i < TEST_POINTS; i++) {
+			for (j = 0; j < 3; j++)
+				u[j] = points[i][j] - offset[j];
+			for (j = 0; j < 3; j++)
+				w[j] = (matrix[3 * j] * u[0] + matrix[3 * j + 1] * u[1]
+						+ matrix[3 * j + 2] * u[2]) / 32768.0;
+			m = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+			sum += m;
+			least = fmin(least, m);
+			most = fmax(most, m);
+			field(i, t);
+			if (hypot(t[0], t[1]) < HORIZONTAL * FIELD)
+				continue;
+			error = fabs(atan2(w[1], w[0]) - atan2(t[1], t[0])) * 180 / PI;
+			if (error > 180)
+				error = 360 - error;
+			worst = fmax(worst, error);
+		}
+		m = (most - least) / (sum / TEST_POINTS) * 100;
+		caseBad = offsetError > MAX_OFFSET || m > MAX_SPREAD || worst > MAX_HEADING;
+		printf("%s,offset %d %d %d,error %.1f,spread %.1f%%,heading %.2f deg,%s\n",
+				c->name, offset[0], offset[1], offset[2], offsetError, m, worst,
+				caseBad ? "bad" : "ok");
+		bad += caseBad;
+	}
+	return bad;
+}
+
+int main(int argc, char *argv[]) {
+	char line[LINE_MAX];
+	FILE *in = stdin;
+	Fit f;
+	int n = 0, option;
+
+	while ((option = getopt(argc, argv, "t")) != -1) {
+		switch (option) {
+		case 't':
+			return selfTest() ? 1 : 0;
+		default:
+			return 1;
+		}
+	}
+	if (optind < argc && (in = fopen(argv[optind], "r")) == 0) {
+		perror(argv[optind]);
+		return 1;
+	}
+	while (n < MAX_POINTS && fgets(line, sizeof line, in))
+		n += parse(line, points[n]);
+	if (n < MIN_POINTS) {
+		fprintf(stderr, "%d samples, at least %d needed\n", n, MIN_POINTS);
+		return 1;
+	}
+	if (!fit(points, n, &f)) {
+		fprintf(stderr, "%d samples don't lie on an ellipsoid; turn the unit "
+				"through more orientations\n", n);
+		return 1;
+	}
+	fprintf(stderr, "%d samples,offset %.1f %.1f %.1f,semi-axes %.1f %.1f %.1f,"
+			"residual %.2f%%\n", n, f.offset[0], f.offset[1], f.offset[2],
+			f.axes[0], f.axes[1], f.axes[2], f.residual);
+	printCalset(&f);
+	return 0;
+}
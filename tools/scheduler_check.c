@@ -0,0 +1,266 @@
+/*
+ * scheduler_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs Scheduler.c and Timebase.c on the Timer_A model in tools/sim for
+ * RUN_MS of simulated time, with the CPU busy for a set number of cycles in
+ * each task and asleep in between:
+ *
+ * fast, slow   periodic tasks whose releases have to stay exactly a period
+ *              apart, each run starting no later than the other tasks'
+ *              work allows, without missing a deadline
+ * button       an event task posted from a port ISR at random intervals,
+ *              run once per post; it is first in the list, so it waits at
+ *              most for one task already running
+ * once         a one-shot, run once
+ * late         a one-shot that overruns its deadline, which has to count
+ *              as exactly one miss
+ * hold         holds idle sleep at LPM0 from HOLD_FROM to HOLD_TO
+ *
+ * Scheduler_busyTicks has to come to the work put into the tasks, and
+ * Scheduler_idleTicks to the rest of the run.  The CPU has to sleep in
+ * LPM0 only while held and in LPM3 otherwise.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o scheduler_check tools/scheduler_check.c Scheduler.c Timebase.c
+ *        tools/sim/sim.c tools/sim/sim_models.c
+ *        driverlib/MSP430F5xx_6xx/timer_a.c
+ * Usage:      scheduler_check
+ */
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <driverlib.h>
+#include "Scheduler.h"
+#include "Timebase.h"
+#include "tools/sim/sim.h"
+
+// MSP430F5529 vector numbers, so the priorities are the device's
+#define PORT1_VECTOR_SIM	47
+#define TIMER1_A1_SIM		48
+#define TIMER1_A0_SIM		49
+
+#define RUN_MS				5000
+#define HOLD_FROM			2000		// ms
+#define HOLD_TO				3000
+#define CYCLES_PER_MS		(SIM_MCLK / 1000)
+#define WORK_CHUNK			(10 * SIM_IDLE_STEP)	// Interrupts taken between
+#define BUTTON_MIN			(5 * CYCLES_PER_MS)
+#define BUTTON_SPREAD		(20 * CYCLES_PER_MS)
+#define TICKS(cycles)		((uint32_t) ((uint64_t) (cycles) * TIMEBASE_TICKS_PER_SEC \
+								/ SIM_MCLK))
+
+// What a task does and what it saw
+typedef struct Job {
+	const char *name;
+	uint32_t work;					// Cycles per run
+	uint32_t lastRelease;
+	uint32_t periodBad;				// Releases not a period after the last
+	uint32_t maxLate;				// Ticks from release to start
+} Job;
+
+static void fastRun(Scheduler_Task *task);
+static void slowRun(Scheduler_Task *task);
+static void buttonRun(Scheduler_Task *task);
+static void onceRun(Scheduler_Task *task);
+static void holdRun(Scheduler_Task *task);
+static void stopRun(Scheduler_Task *task);
+void Timebase_TIMER1_A1_ISR(void);	// Declared in Timebase.c only
+
+static Job fastJob = { "fast", 1 * CYCLES_PER_MS };
+static Job slowJob = { "slow", 2 * CYCLES_PER_MS };
+static Job buttonJob = { "button", CYCLES_PER_MS / 2 };
+static Job onceJob = { "once", CYCLES_PER_MS / 2 };
+static Job lateJob = { "late", 3 * CYCLES_PER_MS };
+static Job holdJob = { "hold", 0 };
+
+static Scheduler_Task button = { buttonRun, &buttonJob, SCHEDULER_MS(4) };
+static Scheduler_Task fast = { fastRun, &fastJob, SCHEDULER_MS(5) };
+static Scheduler_Task slow = { slowRun, &slowJob, SCHEDULER_MS(10) };
+static Scheduler_Task once = { onceRun, &onceJob, SCHEDULER_MS(5) };
+static Scheduler_Task late = { onceRun, &lateJob, SCHEDULER_MS(1) };
+static Scheduler_Task hold = { holdRun, &holdJob, 0 };
+static Scheduler_Task stop = { stopRun, 0, 0 };
+
+static jmp_buf stopped;
+static uint64_t workCycles;
+static uint32_t posts;
+static bool held;
+static bool asleep;
+static uint32_t sleeps;
+static uint64_t lpm0Held, lpm3Held, lpm0Free, lpm3Free;	// Cycles asleep
+static uint32_t buttonLeft = BUTTON_MIN;
+static uint32_t seed = 1;
+
+static uint32_t random32() {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+// The CPU busy, taking interrupts as it goes
+static void work(uint32_t cycles) {
+	workCycles += cycles;
+	while (cycles > WORK_CHUNK) {
+		__delay_cycles(WORK_CHUNK);
+		cycles -= WORK_CHUNK;
+	}
+	__delay_cycles(cycles);
+}
+
+static void start(Scheduler_Task *task, bool periodic) {
+	Job *job = task->context;
+	uint32_t late = Timebase_now() - task->released;
+	if (periodic && task->runs && task->released - job->lastRelease
+			!= task->period)
+		job->periodBad++;
+	job->lastRelease = task->released;
+	if (late > job->maxLate)
+		job->maxLate = late;
+	work(job->work);
+}
+
+static void fastRun(Scheduler_Task *task) {
+	start(task, true);
+}
+
+static void slowRun(Scheduler_Task *task) {
+	start(task, true);
+}
+
+static void buttonRun(Scheduler_Task *task) {
+	start(task, false);
+}
+
+static void onceRun(Scheduler_Task *task) {
+	start(task, false);
+}
+
+static void holdRun(Scheduler_Task *task) {
+	held = !held;
+	if (held) {
+		Scheduler_holdLpm0();
+		Scheduler_startOnce(task, SCHEDULER_MS(HOLD_TO - HOLD_FROM));
+	} else
+		Scheduler_releaseLpm0();
+}
+
+static void stopRun(Scheduler_Task *task) {
+	longjmp(stopped, 1);
+}
+
+static void buttonIsr(void) {
+	posts++;
+	if (Scheduler_post(&button))
+		__bic_SR_register_on_exit(LPM3_bits);
+}
+
+// Presses at random, and where the CPU sleeps
+static void boardTick(Sim_Model *model, uint32_t cycles) {
+	sleeps += (Sim_sr & CPUOFF) && !asleep;
+	asleep = Sim_sr & CPUOFF;
+	if (asleep) {
+		if ((Sim_sr & (SCG1 + SCG0)) == SCG1 + SCG0)
+			*(held ? &lpm3Held : &lpm3Free) += cycles;
+		else
+			*(held ? &lpm0Held : &lpm0Free) += cycles;
+	}
+	while (cycles >= buttonLeft) {
+		cycles -= buttonLeft;
+		buttonLeft = BUTTON_MIN + random32() % BUTTON_SPREAD;
+		Sim_raise(PORT1_VECTOR_SIM);
+	}
+	buttonLeft -= cycles;
+}
+
+// Longest the task can wait behind the ones that may be running or ahead
+// of it, in ticks, with one more for the tick it was released in
+static uint32_t checkTask(Scheduler_Task *task, uint32_t waitCycles,
+		uint32_t runs) {
+	Job *job = task->context;
+	uint32_t bound = TICKS(waitCycles) + 2;
+	bool bad = job->periodBad || job->maxLate > bound || task->misses
+			|| (runs && (task->runs < runs - 1 || task->runs > runs + 1));
+	printf("%s,%u runs,%u misses,%lu ticks late at most,%lu allowed,%s\n",
+			job->name, task->runs, task->misses, (unsigned long) job->maxLate,
+			(unsigned long) bound, bad ? "bad" : "ok");
+	return bad;
+}
+
+int main(int argc, char *argv[]) {
+	Sim_Model board = { .name = "board", .tick = boardTick };
+	uint32_t bad = 0, stepBad, begin, elapsed, expected, sum;
+	uint32_t period = SCHEDULER_MS(10), slowPeriod = SCHEDULER_MS(40) / 3;
+	uint64_t lpm3;
+
+	Sim_reset();
+	Sim_timerA(TIMER_A1_BASE, TIMEBASE_TICKS_PER_SEC, TIMER1_A0_SIM,
+			TIMER1_A1_SIM);
+	Sim_addModel(&board);
+	Sim_attach(TIMER1_A1_SIM, Timebase_TIMER1_A1_ISR);
+	Sim_attach(PORT1_VECTOR_SIM, buttonIsr);
+	Timebase_init();
+	Scheduler_init();
+	Scheduler_add(&button);
+	Scheduler_add(&fast);
+	Scheduler_add(&slow);
+	Scheduler_add(&once);
+	Scheduler_add(&late);
+	Scheduler_add(&hold);
+	Scheduler_add(&stop);
+	begin = Timebase_now();
+	Scheduler_startPeriodic(&fast, 0, period);
+	Scheduler_startPeriodic(&slow, SCHEDULER_MS(3), slowPeriod);
+	Scheduler_startOnce(&once, SCHEDULER_MS(500));
+	Scheduler_startOnce(&late, SCHEDULER_MS(1500));
+	Scheduler_startOnce(&hold, SCHEDULER_MS(HOLD_FROM));
+	Scheduler_startOnce(&stop, SCHEDULER_MS(RUN_MS));
+	if (!setjmp(stopped))
+		Scheduler_run();
+	elapsed = Timebase_now() - begin;
+
+	// Ahead of each: the button and one task running; the button and
+	// anything ahead of it in the list
+	bad += checkTask(&fast, buttonJob.work + lateJob.work,
+			SCHEDULER_MS(RUN_MS) / period + 1);
+	bad += checkTask(&slow, buttonJob.work + fastJob.work + lateJob.work,
+			(SCHEDULER_MS(RUN_MS) - SCHEDULER_MS(3)) / slowPeriod + 1);
+	bad += checkTask(&once, buttonJob.work + fastJob.work + slowJob.work
+			+ lateJob.work, 1);
+	bad += checkTask(&button, lateJob.work, posts);
+	stepBad = late.runs != 1 || late.misses != 1;
+	printf("late,%u runs,%u misses,%s\n", late.runs, late.misses,
+			stepBad ? "bad" : "ok");
+	bad += stepBad;
+
+	// Each run's busy time is whole ticks, out by one either way.  The rest
+	// is idle, bar the tick or so the loop spins for a release too close to
+	// set an alarm for.
+	expected = TICKS(workCycles);
+	sum = Scheduler_busyTicks + Scheduler_idleTicks;
+	stepBad = labs((long) Scheduler_busyTicks - (long) expected)
+			> (long) (fast.runs + slow.runs + button.runs + 4)
+			|| sum > elapsed || elapsed - sum > elapsed / 1000;
+	printf("idle,%.1f%%,busy %lu ticks,work %lu ticks,busy+idle %lu of %lu,%s\n",
+			100.0 * Scheduler_idleTicks / elapsed,
+			(unsigned long) Scheduler_busyTicks, (unsigned long) expected,
+			(unsigned long) sum, (unsigned long) elapsed, stepBad ? "bad" : "ok");
+	bad += stepBad;
+
+	// Idle time is whole ticks too, out by one a sleep
+	lpm3 = lpm3Held + lpm3Free;
+	stepBad = lpm3Held || lpm0Free || !lpm0Held
+			|| labs((long) TICKS(lpm0Held + lpm3) - (long) Scheduler_idleTicks)
+			> (long) (sleeps + 2);
+	printf("lpm,%lu sleeps,LPM0 %lu ms held,LPM3 %lu ms,LPM0 %lu ms unheld,"
+			"LPM3 %lu ms held,%s\n", (unsigned long) sleeps,
+			(unsigned long) (lpm0Held / CYCLES_PER_MS),
+			(unsigned long) (lpm3 / CYCLES_PER_MS),
+			(unsigned long) (lpm0Free / CYCLES_PER_MS),
+			(unsigned long) (lpm3Held / CYCLES_PER_MS), stepBad ? "bad" : "ok");
+	bad += stepBad;
+	return bad ? 1 : 0;
+}
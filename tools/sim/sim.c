@@ -0,0 +1,240 @@
+/*
+ * sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+uint8_t Sim_memory[SIM_MEMORY_SIZE];
+uint64_t Sim_cycles = 0;
+uint64_t Sim_sleepCycles = 0;
+uint16_t Sim_sr = 0;
+
+static Sim_Model *models = 0;
+static Sim_Isr isrs[SIM_VECTORS];
+static bool pending[SIM_VECTORS];
+static uint16_t exitClear;			// __bic_SR_register_on_exit() in this ISR
+static uint8_t depth = 0;			// ISR nesting
+
+// Access waiting to be handed to its model
+static bool accessPending = false;
+static uint16_t accessAddress;
+static uint8_t accessWidth;
+static uint32_t accessBefore;
+
+//private functions
+static uint32_t Sim_load(uint16_t address, uint8_t width) {
+	uint32_t value = 0;
+	uint8_t i;
+	for (i = width; i > 0; i--)
+		value = (value << 8) | Sim_memory[(uint16_t) (address + i - 1)];
+	return value;
+}
+
+static Sim_Model *Sim_owner(uint16_t address) {
+	Sim_Model *m;
+	for (m = models; m; m = m->next)
+		if (address >= m->first && address <= m->last)
+			return m;
+	return 0;
+}
+
+static void Sim_access(uint16_t address, uint8_t width) {
+	Sim_commit();
+	accessPending = true;
+	accessAddress = address;
+	accessWidth = width;
+	accessBefore = Sim_load(address, width);
+}
+
+// Run the highest pending ISR, as the CPU would between instructions
+static bool Sim_dispatch() {
+	int8_t v;
+	uint16_t saved;
+	if (!(Sim_sr & SIM_GIE))
+		return false;
+	for (v = SIM_VECTORS - 1; v >= 0; v--)
+		if (pending[v] && isrs[v])
+			break;
+	if (v < 0)
+		return false;
+	pending[v] = false;
+	saved = Sim_sr;
+	exitClear = 0;
+	Sim_sr &= ~(SIM_GIE | SIM_LPM_BITS);
+	depth++;
+	Sim_step(SIM_ISR_CYCLES);
+	isrs[v]();
+	Sim_commit();
+	depth--;
+	Sim_sr = saved & ~exitClear;
+	exitClear = 0;
+	return true;
+}
+
+//public functions
+/** Clear the peripheral space, detach every model and ISR, zero time. */
+void Sim_reset() {
+	memset(Sim_memory, 0, sizeof Sim_memory);
+	memset(isrs, 0, sizeof isrs);
+	memset(pending, 0, sizeof pending);
+	models = 0;
+	accessPending = false;
+	Sim_cycles = 0;
+	Sim_sleepCycles = 0;
+	Sim_sr = 0;
+}
+
+void Sim_addModel(Sim_Model *model) {
+	model->next = models;
+	models = model;
+}
+
+void Sim_attach(uint8_t vector, Sim_Isr isr) {
+	isrs[vector % SIM_VECTORS] = isr;
+}
+
+/** Set an interrupt pending.  Runs at the next Sim_step() with GIE set. */
+void Sim_raise(uint8_t vector) {
+	pending[vector % SIM_VECTORS] = true;
+}
+
+void Sim_clear(uint8_t vector) {
+	pending[vector % SIM_VECTORS] = false;
+}
+
+/** Hand the last register access to its model. */
+void Sim_commit() {
+	Sim_Model *m;
+	if (!accessPending)
+		return;
+	accessPending = false;
+	m = Sim_owner(accessAddress);
+	if (m && m->access)
+		m->access(m, accessAddress, accessWidth, accessBefore);
+}
+
+/** Advance time, letting models run and interrupts be taken. */
+void Sim_step(uint32_t cycles) {
+	Sim_Model *m;
+	Sim_commit();
+	Sim_cycles += cycles;
+	for (m = models; m; m = m->next)
+		if (m->tick)
+			m->tick(m, cycles);
+	while (Sim_dispatch())
+		;
+}
+
+/** A model saw the CPU test a flag only time will change, as in
+ * while (UCA1STAT & UCBUSY); let a turn of the loop pass.  Interrupts are
+ * taken meanwhile, as they would be between the loop's instructions.
+ */
+void Sim_poll() {
+	Sim_step(SIM_POLL_CYCLES);
+}
+
+volatile uint8_t *Sim_reg8(uint16_t address) {
+	Sim_access(address, 1);
+	return (volatile uint8_t *) &Sim_memory[address];
+}
+
+volatile uint16_t *Sim_reg16(uint16_t address) {
+	address &= ~1;
+	Sim_access(address, 2);
+	return (volatile uint16_t *) &Sim_memory[address];
+}
+
+volatile Sim_Long *Sim_reg32(uint16_t address) {
+	address &= ~1;
+	Sim_access(address, 4);
+	return (volatile Sim_Long *) &Sim_memory[address];
+}
+
+uint16_t Sim_peek16(uint16_t address) {
+	return (uint16_t) Sim_load(address & ~1, 2);
+}
+
+void Sim_poke16(uint16_t address, uint16_t value) {
+	address &= ~1;
+	Sim_memory[address] = (uint8_t) value;
+	Sim_memory[address + 1] = (uint8_t) (value >> 8);
+}
+
+// Intrinsics
+uint16_t __get_SR_register(void) {
+	return Sim_sr;
+}
+
+/** Setting LPM bits sleeps: time runs until an ISR clears them on exit. */
+void __bis_SR_register(uint16_t bits) {
+	uint64_t start = Sim_cycles;
+	Sim_sr |= bits;
+	Sim_step(0);
+	while (Sim_sr & SIM_LPM_BITS) {
+		if (depth == 0 && Sim_cycles - start > SIM_SLEEP_LIMIT) {
+			fprintf(stderr, "sim: asleep for %lu cycles with nothing to wake\n",
+					(unsigned long) (Sim_cycles - start));
+			exit(2);
+		}
+		Sim_sleepCycles += SIM_IDLE_STEP;
+		Sim_step(SIM_IDLE_STEP);
+	}
+}
+
+void __bic_SR_register(uint16_t bits) {
+	Sim_sr &= ~bits;
+}
+
+void __bic_SR_register_on_exit(uint16_t bits) {
+	exitClear |= bits;
+}
+
+void __enable_interrupt(void) {
+	Sim_sr |= SIM_GIE;
+	Sim_step(0);
+}
+
+void __disable_interrupt(void) {
+	Sim_sr &= ~SIM_GIE;
+}
+
+void __delay_cycles(uint32_t cycles) {
+	Sim_step(cycles);
+}
+
+void __no_operation(void) {
+	Sim_step(1);
+}
+
+/** DADD: decimal add of packed BCD, digit by digit, the carry out dropped. */
+unsigned long __bcd_add_long(unsigned long a, unsigned long b) {
+	unsigned long sum = 0;
+	unsigned digit, carry = 0;
+	uint8_t i;
+	for (i = 0; i < 32; i += 4) {
+		digit = ((a >> i) & 0x0F) + ((b >> i) & 0x0F) + carry;
+		carry = digit > 9;
+		if (carry)
+			digit -= 10;
+		sum |= (unsigned long) digit << i;
+	}
+	return sum & 0xFFFFFFFFUL;
+}
+
+unsigned short __bcd_add_short(unsigned short a, unsigned short b) {
+	return (unsigned short) __bcd_add_long(a, b);
+}
+
+/** 20-bit DMA address registers, which take a 32-bit access. */
+unsigned long __data16_read_addr(unsigned short address) {
+	return *Sim_reg32(address) & 0xFFFFF;
+}
+
+void __data16_write_addr(unsigned short address, unsigned long value) {
+	*Sim_reg32(address) = (uint32_t) value & 0xFFFFF;
+}
@@ -0,0 +1,207 @@
+/*
+ * sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Host simulation of the MSP430 peripheral space for running drivers on a
+ * Linux box.  Register accesses made through HWREG8/16/32 land in a 64 KB
+ * array.  Each access is handed to the model owning that address when the
+ * next access (or Sim_step()) begins, by which time any write through the
+ * returned pointer has happened; a model compares against the value from
+ * before the access to tell a write from a read.  Data registers that are
+ * only ever written or only ever read (TXBUF, RXBUF, CRCDI) treat every
+ * access as a write or a read, so repeated writes of the same value count.
+ *
+ * Time is a count of MCLK cycles advanced by Sim_step(), by __delay_cycles()
+ * and while the CPU sleeps in a low power mode.  Host code between register
+ * accesses takes no simulated time, so cycle counts measure peripheral and
+ * bus time (what the drivers wait for), not instruction timing.  The
+ * exceptions are a busy wait, where a model that sees the CPU read a flag
+ * only time will change calls Sim_poll(), which lets SIM_POLL_CYCLES pass,
+ * and taking an interrupt, which costs SIM_ISR_CYCLES.  Sim_sleepCycles
+ * counts the time spent in a low power mode, so Sim_cycles less that is
+ * the time the CPU was kept busy.
+ *
+ * Models raise interrupts by vector number; Sim_step() runs the attached
+ * ISR for the highest pending vector whenever GIE is set, with the SR
+ * handling of real hardware: GIE and the LPM bits are cleared on entry and
+ * restored on exit less anything __bic_SR_register_on_exit() took away.
+ *
+ * Registers the drivers name directly (UCA1IFG rather than HWREG8 of an
+ * offset) are routed the same way by sim_regs.h, which driverlib's
+ * inc/hw_memmap.h pulls in, with the HWREG macros, in DRIVERLIB_HOST_SIM
+ * builds.
+ *
+ * Main flash lies outside the modelled 64 KB.  sim_flash.c replaces
+ * driverlib's flash.c with the FLASHLOG bank in a host array.  The DMA
+ * model moves data with 16-bit addresses, so a buffer it fills or empties
+ * has to be put in Sim_memory, in the driver's SIM_RAM_x area, in
+ * DRIVERLIB_HOST_SIM builds (see ADCAcquire.c).
+ *
+ * Devices outside the MCU hang off the bus models: an I2C slave is a
+ * Sim_I2cDevice attached to a USCI_B model, and a UART's far end is the
+ * Sim_UartOutput function of its USCI_A model plus Sim_uartReceive().
+ *
+ * Build with DRIVERLIB_HOST_SIM defined, which switches the HWREG macros
+ * in driverlib's inc/hw_regaccess.h over to Sim_reg8/16/32 (msp430.h comes
+ * from a CCS install):
+ *     cc -DDRIVERLIB_HOST_SIM -D__MSP430F5529__ -I <ccs>/ccs_base/msp430/include
+ *        -I driverlib/MSP430F5xx_6xx tools/sim/sim.c tools/sim/sim_models.c
+ *        driverlib/MSP430F5xx_6xx/crc.c ... your_harness.c
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SIM_MEMORY_SIZE		0x10000
+#define SIM_VECTORS			64
+#define SIM_MCLK			16000000UL	// initClocks(16000000)
+#define SIM_IDLE_STEP		16			// Cycles per step while asleep
+#define SIM_SLEEP_LIMIT		(SIM_MCLK * 10)	// A sleep nothing wakes from
+#define SIM_FLASH_SIZE		0x8000		// The FLASHLOG bank
+#define SIM_FLASH_SEGMENT	512
+#define SIM_FLASH_ERASE_US	32000		// tSEG_ERASE, data sheet maximum
+#define SIM_FLASH_WORD_US	85			// tWORD, word or long-word write
+#define SIM_RAM				0x2400		// F5529 RAM, in Sim_memory
+#define SIM_RAM_ADC			SIM_RAM				// ADCAcquire's double buffer
+#define SIM_RAM_UART_TX		(SIM_RAM + 0x0100)	// BCUart's transmit ring
+#define SIM_RAM_I2C_RX		(SIM_RAM + 0x0200)	// I2CEngine's DMA receive bytes
+#define SIM_RAM_I2C_SIZE	0x0100
+#define SIM_DMA_CHANNELS	3
+#define SIM_POLL_CYCLES		6			// A turn of a flag testing loop
+#define SIM_ISR_CYCLES		11			// Interrupt entry 6, RETI 5 (CPUX)
+#define SIM_UART_QUEUE		1024		// Bytes waiting to be received
+
+// DMA trigger sources, MSP430F5529 data sheet
+#define SIM_TRIGGER_UCA1RXIFG	20
+#define SIM_TRIGGER_UCA1TXIFG	21
+#define SIM_TRIGGER_UCB1RXIFG	22
+#define SIM_TRIGGER_UCB1TXIFG	23
+#define SIM_TRIGGER_ADC12IFG	24
+#define SIM_TRIGGER_NONE		0xFF	// A USCI without DMA
+
+// Status register bits
+#define SIM_GIE				0x0008
+#define SIM_LPM_BITS		0x00F0
+
+typedef struct Sim_Model Sim_Model;
+typedef uint32_t Sim_Long __attribute__((aligned(2)));	// Registers are word aligned
+
+/** One peripheral.  The core calls access for every HWREG access inside
+ * [first, last] and tick as time passes.
+ */
+struct Sim_Model {
+	const char *name;
+	uint16_t first;					// Register window
+	uint16_t last;
+	void (*access)(Sim_Model *model, uint16_t address, uint8_t width,
+			uint32_t before);
+	void (*tick)(Sim_Model *model, uint32_t cycles);
+	void *state;
+	Sim_Model *next;
+};
+
+typedef void (*Sim_Isr)(void);
+typedef uint16_t (*Sim_AdcInput)(uint8_t channel);	// INCHx to a 12-bit result
+typedef void (*Sim_UartOutput)(uint8_t data);		// Each byte as its stop bit ends
+
+typedef struct Sim_I2cDevice Sim_I2cDevice;
+
+/** A slave on a modelled I2C bus, called by the bus as each byte ends.
+ * start and write return the acknowledge the slave gives.
+ */
+struct Sim_I2cDevice {
+	uint8_t address;				// 7 bits
+	bool (*start)(Sim_I2cDevice *device, bool read);
+	bool (*write)(Sim_I2cDevice *device, uint8_t data);
+	uint8_t (*read)(Sim_I2cDevice *device);
+	void (*stop)(Sim_I2cDevice *device);
+	void *state;
+	Sim_I2cDevice *next;
+};
+
+typedef struct Sim_FlashStats {
+	uint32_t writes;				// Long-words programmed
+	uint32_t erases;
+	uint32_t badWrites;				// Long-words that needed an erase first
+	uint64_t stallCycles;			// CPU held, in all
+	uint32_t maxStall;
+	uint32_t segmentErases[SIM_FLASH_SIZE / SIM_FLASH_SEGMENT];
+} Sim_FlashStats;
+
+extern uint8_t Sim_memory[SIM_MEMORY_SIZE];
+extern uint64_t Sim_cycles;
+extern uint64_t Sim_sleepCycles;
+extern uint16_t Sim_sr;
+
+void Sim_reset();
+void Sim_addModel(Sim_Model *model);
+void Sim_attach(uint8_t vector, Sim_Isr isr);
+void Sim_raise(uint8_t vector);
+void Sim_clear(uint8_t vector);
+void Sim_step(uint32_t cycles);
+void Sim_commit();
+void Sim_poll();
+
+volatile uint8_t *Sim_reg8(uint16_t address);
+volatile uint16_t *Sim_reg16(uint16_t address);
+volatile Sim_Long *Sim_reg32(uint16_t address);
+
+// Register access for models, bypassing the access hooks
+uint16_t Sim_peek16(uint16_t address);
+void Sim_poke16(uint16_t address, uint16_t value);
+
+// MSP430 compiler intrinsics
+uint16_t __get_SR_register(void);
+void __bis_SR_register(uint16_t bits);
+void __bic_SR_register(uint16_t bits);
+void __bic_SR_register_on_exit(uint16_t bits);
+void __enable_interrupt(void);
+void __disable_interrupt(void);
+void __delay_cycles(uint32_t cycles);
+void __no_operation(void);
+unsigned long __data16_read_addr(unsigned short address);
+void __data16_write_addr(unsigned short address, unsigned long value);
+unsigned short __bcd_add_short(unsigned short a, unsigned short b);
+unsigned long __bcd_add_long(unsigned long a, unsigned long b);
+#define __even_in_range(value, range)	(value)
+#define __interrupt
+
+// Models in sim_models.c
+Sim_Model *Sim_timerA(uint16_t base, uint32_t clockHz, uint8_t ccr0Vector,
+		uint8_t vector);
+Sim_Model *Sim_crc16(uint16_t base);
+Sim_Model *Sim_mpy32(uint16_t base);
+Sim_Model *Sim_adc12(uint16_t base, Sim_Model *timer, uint8_t vector,
+		Sim_AdcInput input);
+Sim_Model *Sim_dma(uint16_t base, uint8_t vector);
+Sim_Model *Sim_usciUart(uint16_t base, uint32_t clockHz, uint8_t vector,
+		uint8_t rxTrigger, uint8_t txTrigger, Sim_UartOutput output);
+Sim_Model *Sim_usciI2c(uint16_t base, uint32_t clockHz, uint8_t vector,
+		uint8_t rxTrigger, uint8_t txTrigger);
+Sim_Model *Sim_port(uint16_t in, uint8_t vector);
+uint32_t Sim_timerEdges(Sim_Model *timer, uint8_t ccr);
+void Sim_dmaRequest(uint8_t trigger);
+void Sim_uartReceive(Sim_Model *uart, const uint8_t data[], uint16_t length);
+uint32_t Sim_uartFrameCycles(Sim_Model *uart);
+void Sim_i2cAttach(Sim_Model *i2c, Sim_I2cDevice *device);
+uint32_t Sim_i2cBitCycles(Sim_Model *i2c);
+void Sim_portInput(Sim_Model *port, uint8_t pins, bool high);
+
+// Devices in sim_devices.c
+Sim_I2cDevice *Sim_i2cMemory(uint8_t address, uint8_t registers[], uint16_t size);
+Sim_I2cDevice *Sim_hmc5883l(Sim_Model *port, uint8_t drdyPin);
+void Sim_hmcField(Sim_I2cDevice *hmc, int16_t x, int16_t y, int16_t z);
+void Sim_hmcSensitivity(Sim_I2cDevice *hmc, int16_t x, int16_t y, int16_t z);
+const uint8_t *Sim_hmcRegisters(Sim_I2cDevice *hmc);
+
+// Main flash in sim_flash.c, with driverlib's FLASH_ calls
+extern uint8_t Sim_flash[SIM_FLASH_SIZE];
+extern Sim_FlashStats Sim_flashStats;
+void Sim_flashReset();
+
+#endif /* SIM_H_ */
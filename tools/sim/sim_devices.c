@@ -0,0 +1,295 @@
+/*
+ * sim_devices.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Devices outside the MCU for the bus models in sim_models.c.
+ */
+#include <stdlib.h>
+#include "sim.h"
+
+// HMC5883L registers and fields, data sheet
+#define HMC_CONFIG_A		0x00
+#define HMC_CONFIG_B		0x01
+#define HMC_MODE			0x02
+#define HMC_DATA			0x03		// X, Z, Y, high byte first
+#define HMC_DATA_LAST		0x08
+#define HMC_STATUS			0x09
+#define HMC_REGISTERS		13			// To ID_C
+#define HMC_WRITABLE		HMC_MODE	// The rest are read only
+#define HMC_CONTINUOUS		0x00
+#define HMC_SINGLE			0x01
+#define HMC_IDLE			0x02
+#define HMC_LOCK			0x02		// STATUS bits
+#define HMC_READY			0x01
+#define HMC_OVERFLOW		(-4096)		// An axis out of range
+#define HMC_FULL_SCALE		2047
+#define HMC_SINGLE_US		6000		// A single measurement
+#define HMC_DRDY_US			250			// DRDY low for
+#define HMC_CYCLES(us)		((uint32_t) ((uint64_t) (us) * SIM_MCLK / 1000000))
+
+typedef struct Hmc5883l {
+	uint8_t registers[HMC_REGISTERS];
+	uint8_t pointer;
+	bool pointed;					// This write's first byte, the pointer, is in
+	uint8_t gain;					// Measuring with, CONFIG_B's a measurement late
+	uint8_t dataRead;				// Bit n: data register HMC_DATA + n read
+	uint32_t measureLeft;			// Cycles to the next data, 0 idle
+	uint32_t drdyLeft;				// Cycles DRDY stays low
+	int16_t field[3];				// X, Y, Z, milligauss
+	int16_t sensitivity[3];			// Per mille of nominal
+	Sim_Model *port;
+	uint8_t drdyPin;
+} Hmc5883l;
+
+// LSB/Ga for each CONFIG_B gain setting, and the self-test bias field in mGa
+static const uint16_t hmcGain[8] = { 1370, 1090, 820, 660, 440, 390, 330, 230 };
+static const int16_t hmcBias[3] = { 1160, 1160, 1080 };
+// Continuous measurement rates for CONFIG_A's DO bits, in hundredths of a Hz;
+// 7 is reserved, taken here as 75 Hz
+static const uint16_t hmcRate[8] = { 75, 150, 300, 750, 1500, 3000, 7500, 7500 };
+
+typedef struct I2cMemory {
+	uint8_t *registers;
+	uint16_t size;
+	uint16_t pointer;
+	bool pointed;					// This write's first byte, the pointer, is in
+} I2cMemory;
+
+//private functions
+static bool Sim_memoryStart(Sim_I2cDevice *device, bool read) {
+	I2cMemory *m = device->state;
+	m->pointed = read;
+	return true;
+}
+
+static bool Sim_memoryWrite(Sim_I2cDevice *device, uint8_t data) {
+	I2cMemory *m = device->state;
+	if (!m->pointed) {
+		m->pointer = data % m->size;
+		m->pointed = true;
+	} else {
+		m->registers[m->pointer] = data;
+		m->pointer = (m->pointer + 1) % m->size;
+	}
+	return true;
+}
+
+static uint8_t Sim_memoryRead(Sim_I2cDevice *device) {
+	I2cMemory *m = device->state;
+	uint8_t data = m->registers[m->pointer];
+	m->pointer = (m->pointer + 1) % m->size;
+	return data;
+}
+
+static uint32_t Sim_hmcPeriod(Hmc5883l *h) {
+	return (uint32_t) ((uint64_t) SIM_MCLK * 100
+			/ hmcRate[(h->registers[HMC_CONFIG_A] >> 2) & 0x07]);
+}
+
+// Counts for one axis: the field, plus the bias strap's, through the axis'
+// sensitivity and the gain, rounded
+static int16_t Sim_hmcAxis(Hmc5883l *h, uint8_t axis) {
+	uint8_t bias = h->registers[HMC_CONFIG_A] & 0x03;
+	int64_t field = h->field[axis];
+	int64_t counts;
+	if (bias == 1)
+		field += hmcBias[axis];
+	else if (bias == 2)
+		field -= hmcBias[axis];
+	counts = field * h->sensitivity[axis] * hmcGain[h->gain];
+	counts = (counts + (counts < 0 ? -500000 : 500000)) / 1000000;
+	if (counts > HMC_FULL_SCALE || counts < -HMC_FULL_SCALE - 1)
+		return HMC_OVERFLOW;
+	return (int16_t) counts;
+}
+
+// A measurement ends: new data unless the data registers are locked, and a
+// DRDY pulse with it
+static void Sim_hmcMeasure(Hmc5883l *h) {
+	static const uint8_t order[3] = { 0, 2, 1 };	// X, Z, Y
+	int16_t counts;
+	uint8_t i;
+	if (!h->dataRead) {
+		for (i = 0; i < 3; i++) {
+			counts = Sim_hmcAxis(h, order[i]);
+			h->registers[HMC_DATA + 2 * i] = (uint8_t) (counts >> 8);
+			h->registers[HMC_DATA + 2 * i + 1] = (uint8_t) counts;
+		}
+		h->registers[HMC_STATUS] |= HMC_READY;
+		h->drdyLeft = HMC_CYCLES(HMC_DRDY_US);
+		Sim_portInput(h->port, h->drdyPin, false);
+	}
+	h->gain = h->registers[HMC_CONFIG_B] >> 5;
+	if ((h->registers[HMC_MODE] & 0x03) == HMC_CONTINUOUS) {
+		h->measureLeft = Sim_hmcPeriod(h);
+	} else {
+		h->registers[HMC_MODE] = HMC_IDLE;
+		h->measureLeft = 0;
+	}
+}
+
+// Writing the configuration or the mode unlocks the data registers, and
+// writing the mode starts measuring: after HMC_SINGLE_US for one, or two
+// periods for the first of a continuous run
+static void Sim_hmcConfigure(Hmc5883l *h, uint8_t reg) {
+	h->dataRead = 0;
+	h->registers[HMC_STATUS] &= ~HMC_LOCK;
+	if (reg != HMC_MODE)
+		return;
+	h->registers[HMC_MODE] &= 0x03;		// Bits 7-2 read as zero
+	if (h->registers[HMC_MODE] == HMC_CONTINUOUS)
+		h->measureLeft = 2 * Sim_hmcPeriod(h);
+	else if (h->registers[HMC_MODE] == HMC_SINGLE)
+		h->measureLeft = HMC_CYCLES(HMC_SINGLE_US);
+	else
+		h->measureLeft = 0;
+}
+
+// Past DATAY_L the pointer goes back to DATAX_H, so the data can be read
+// over and over; elsewhere it wraps after ID_C
+static void Sim_hmcNext(Hmc5883l *h) {
+	if (h->pointer == HMC_DATA_LAST)
+		h->pointer = HMC_DATA;
+	else
+		h->pointer = (h->pointer + 1) % HMC_REGISTERS;
+}
+
+static bool Sim_hmcStart(Sim_I2cDevice *device, bool read) {
+	Hmc5883l *h = device->state;
+	h->pointed = read;
+	return true;
+}
+
+static bool Sim_hmcWrite(Sim_I2cDevice *device, uint8_t data) {
+	Hmc5883l *h = device->state;
+	if (!h->pointed) {
+		h->pointer = data % HMC_REGISTERS;
+		h->pointed = true;
+		return true;
+	}
+	if (h->pointer <= HMC_WRITABLE) {
+		h->registers[h->pointer] = data;
+		Sim_hmcConfigure(h, h->pointer);
+	}
+	Sim_hmcNext(h);
+	return true;
+}
+
+// Reading some but not all of the data registers locks them until the
+// rest are read
+static uint8_t Sim_hmcRead(Sim_I2cDevice *device) {
+	Hmc5883l *h = device->state;
+	uint8_t data = h->registers[h->pointer];
+	if (h->pointer >= HMC_DATA && h->pointer <= HMC_DATA_LAST) {
+		h->dataRead |= 1 << (h->pointer - HMC_DATA);
+		h->registers[HMC_STATUS] |= HMC_LOCK;
+		if (h->dataRead == 0x3F) {
+			h->dataRead = 0;
+			h->registers[HMC_STATUS] &= ~(HMC_LOCK | HMC_READY);
+		}
+	}
+	Sim_hmcNext(h);
+	return data;
+}
+
+static void Sim_hmcTick(Sim_Model *model, uint32_t cycles) {
+	Hmc5883l *h = model->state;
+	if (h->drdyLeft && cycles >= h->drdyLeft) {
+		h->drdyLeft = 0;
+		Sim_portInput(h->port, h->drdyPin, true);
+	} else if (h->drdyLeft) {
+		h->drdyLeft -= cycles;
+	}
+	while (h->measureLeft && cycles >= h->measureLeft) {
+		cycles -= h->measureLeft;
+		Sim_hmcMeasure(h);
+	}
+	if (h->measureLeft)
+		h->measureLeft -= cycles;
+}
+
+//public functions
+/** A slave of size byte registers, the common register pointer scheme: the
+ * first byte of a write sets the pointer, and each byte written or read
+ * after that moves it on, wrapping at size.  The registers are the
+ * caller's, to set up and check.
+ */
+Sim_I2cDevice *Sim_i2cMemory(uint8_t address, uint8_t registers[], uint16_t size) {
+	Sim_I2cDevice *device = calloc(1, sizeof(Sim_I2cDevice));
+	I2cMemory *m = calloc(1, sizeof(I2cMemory));
+	m->registers = registers;
+	m->size = size;
+	device->address = address;
+	device->start = Sim_memoryStart;
+	device->write = Sim_memoryWrite;
+	device->read = Sim_memoryRead;
+	device->state = m;
+	return device;
+}
+
+/** An HMC5883L magnetometer at 0x1E, from its data sheet.  Its DRDY output
+ * drives drdyPin of port, going low for 250 us each time new data is put in
+ * the data registers.
+ *
+ * A write to MODE starts measuring: a single measurement ends 6 ms later and
+ * the mode goes back to idle, continuous ones come at CONFIG_A's rate, the
+ * first after two periods.  Each axis reads the field given by
+ * Sim_hmcField(), plus the bias strap's 1.16 Ga on X and Y and 1.08 Ga on Z
+ * when CONFIG_A selects positive or negative bias, times the axis'
+ * sensitivity and CONFIG_B's gain, rounded.  Beyond -2048..2047 it reads
+ * -4096.  A new gain applies from the second measurement after it is
+ * written, as on the part.  Reading some but not all six data registers
+ * sets LOCK in STATUS and holds new data out until the rest are read or
+ * the configuration is written.  Averaging is accepted but, with no noise
+ * modelled, changes nothing.
+ */
+Sim_I2cDevice *Sim_hmc5883l(Sim_Model *port, uint8_t drdyPin) {
+	static const uint8_t powerOn[HMC_REGISTERS] = { 0x10, 0x20, 0x01, 0, 0, 0,
+			0, 0, 0, 0, 'H', '4', '3' };
+	Sim_I2cDevice *device = calloc(1, sizeof(Sim_I2cDevice));
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Hmc5883l *h = calloc(1, sizeof(Hmc5883l));
+	uint8_t i;
+	for (i = 0; i < HMC_REGISTERS; i++)
+		h->registers[i] = powerOn[i];
+	for (i = 0; i < 3; i++)
+		h->sensitivity[i] = 1000;
+	h->gain = h->registers[HMC_CONFIG_B] >> 5;
+	h->port = port;
+	h->drdyPin = drdyPin;
+	Sim_portInput(port, drdyPin, true);
+	device->address = 0x1E;
+	device->start = Sim_hmcStart;
+	device->write = Sim_hmcWrite;
+	device->read = Sim_hmcRead;
+	device->state = h;
+	model->name = "HMC5883L";
+	model->tick = Sim_hmcTick;
+	model->state = h;
+	Sim_addModel(model);
+	return device;
+}
+
+/** Set the field the magnetometer sits in, in milligauss along its axes. */
+void Sim_hmcField(Sim_I2cDevice *hmc, int16_t x, int16_t y, int16_t z) {
+	Hmc5883l *h = hmc->state;
+	h->field[0] = x;
+	h->field[1] = y;
+	h->field[2] = z;
+}
+
+/** Set each axis' response, per mille of nominal, 1000 from power-on. */
+void Sim_hmcSensitivity(Sim_I2cDevice *hmc, int16_t x, int16_t y, int16_t z) {
+	Hmc5883l *h = hmc->state;
+	h->sensitivity[0] = x;
+	h->sensitivity[1] = y;
+	h->sensitivity[2] = z;
+}
+
+/** The register file, CONFIG_A to ID_C, to check. */
+const uint8_t *Sim_hmcRegisters(Sim_I2cDevice *hmc) {
+	Hmc5883l *h = hmc->state;
+	return h->registers;
+}
@@ -0,0 +1,103 @@
+/*
+ * sim_flash.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Stand-in for driverlib's flash.c on the host.  Main flash lies above the
+ * 64 KB the register models cover, so the FLASHLOG bank is a host array,
+ * Sim_flash, that FlashLog.h points at in DRIVERLIB_HOST_SIM builds.  Link
+ * this instead of flash.c.
+ *
+ * Programming behaves like NOR flash: bits only go from 1 to 0, and only an
+ * erase brings them back, a segment at a time.  Each operation holds the
+ * CPU for the worst case time in the F5529 data sheet, with interrupts
+ * left pending until it finishes as they are on the device.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define CYCLES(us)		((uint32_t) ((uint64_t) (us) * SIM_MCLK / 1000000))
+
+uint8_t Sim_flash[SIM_FLASH_SIZE];
+Sim_FlashStats Sim_flashStats;
+
+//private functions
+static uint32_t Sim_flashOffset(const void *p) {
+	uint32_t offset = (uint32_t) ((const uint8_t *) p - Sim_flash);
+	if (offset >= SIM_FLASH_SIZE) {
+		fprintf(stderr, "sim: flash access outside Sim_flash\n");
+		exit(2);
+	}
+	return offset;
+}
+
+// Hold the CPU; ISRs raised meanwhile run once it lets go
+static void Sim_flashHold(uint32_t cycles) {
+	uint16_t sr = Sim_sr;
+	Sim_sr &= ~SIM_GIE;
+	Sim_step(cycles);
+	Sim_sr = sr;
+	Sim_flashStats.stallCycles += cycles;
+	if (cycles > Sim_flashStats.maxStall)
+		Sim_flashStats.maxStall = cycles;
+	Sim_step(0);
+}
+
+static void Sim_flashProgram(uint32_t offset, const uint8_t *data, uint8_t length) {
+	uint8_t i;
+	for (i = 0; i < length; i++) {
+		if (data[i] & ~Sim_flash[offset + i])
+			Sim_flashStats.badWrites++;	// A 0 bit asked to become 1
+		Sim_flash[offset + i] &= data[i];
+	}
+}
+
+//public functions
+/** Erase all of Sim_flash and clear the counters. */
+void Sim_flashReset() {
+	memset(Sim_flash, 0xFF, sizeof Sim_flash);
+	memset(&Sim_flashStats, 0, sizeof Sim_flashStats);
+}
+
+void FLASH_segmentErase(uint8_t *flash_ptr) {
+	uint32_t offset = Sim_flashOffset(flash_ptr) & ~(SIM_FLASH_SEGMENT - 1);
+	memset(&Sim_flash[offset], 0xFF, SIM_FLASH_SEGMENT);
+	Sim_flashStats.erases++;
+	Sim_flashStats.segmentErases[offset / SIM_FLASH_SEGMENT]++;
+	Sim_flashHold(CYCLES(SIM_FLASH_ERASE_US));
+}
+
+bool FLASH_eraseCheck(uint8_t *flash_ptr, uint16_t numberOfBytes) {
+	uint16_t i;
+	Sim_flashOffset(flash_ptr + numberOfBytes - 1);
+	for (i = 0; i < numberOfBytes; i++)
+		if (flash_ptr[i] != 0xFF)
+			return false;
+	return true;
+}
+
+void FLASH_write16(uint16_t *data_ptr, uint16_t *flash_ptr, uint16_t count) {
+	while (count--) {
+		Sim_flashProgram(Sim_flashOffset(flash_ptr++), (uint8_t *) data_ptr++, 2);
+		Sim_flashStats.writes++;
+		Sim_flashHold(CYCLES(SIM_FLASH_WORD_US));
+	}
+}
+
+void FLASH_write32(uint32_t *data_ptr, uint32_t *flash_ptr, uint16_t count) {
+	while (count--) {
+		Sim_flashProgram(Sim_flashOffset(flash_ptr++), (uint8_t *) data_ptr++, 4);
+		Sim_flashStats.writes++;
+		Sim_flashHold(CYCLES(SIM_FLASH_WORD_US));
+	}
+}
+
+// Info flash isn't modelled, so there is no LOCKA to toggle
+void FLASH_unlockInfoA(void) {
+}
+
+void FLASH_lockInfoA(void) {
+}
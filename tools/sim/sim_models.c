@@ -0,0 +1,1363 @@
+/*
+ * sim_models.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Peripheral models for sim.c.  Register layouts and bit positions follow
+ * the F5xx family user's guide (SLAU208).
+ */
+#include <stdlib.h>
+#include "sim.h"
+
+// Timer_A registers and bits
+#define TA_CTL			0x00
+#define TA_CCTL0		0x02
+#define TA_R			0x10
+#define TA_CCR0			0x12
+#define TA_IV			0x2E
+#define TA_CCRS			7
+#define TAIFG			0x0001
+#define TAIE			0x0002
+#define TACLR			0x0004
+#define MC_MASK			0x0030
+#define MC_UP			0x0010
+#define MC_CONTINUOUS	0x0020
+#define CCIFG			0x0001
+#define TA_OUT			0x0004
+#define CCIE			0x0010
+#define OUTMOD_MASK		0x00E0
+#define CAP				0x0100
+
+// CRC16 registers
+#define CRC_DI			0x00
+#define CRC_DIRB		0x02
+#define CRC_INIRES		0x04
+#define CRC_RESR		0x06
+
+// MPY32 registers and bits
+#define MPY_OP1			0x00	// MPY, MPYS, MAC, MACS
+#define MPY_OP2			0x08
+#define MPY_RESLO		0x0A
+#define MPY_RESHI		0x0C
+#define MPY_SUMEXT		0x0E
+#define MPY_OP1_32		0x10	// MPY32L/H .. MACS32L/H
+#define MPY_OP2L		0x20
+#define MPY_OP2H		0x22
+#define MPY_RES0		0x24
+#define MPY_CTL0		0x2C
+#define MPY_FRAC		0x0004
+#define MPY_SAT			0x0008
+#define MPY_MODE		0x0030	// MPYM0-1: MPY, MPYS, MAC, MACS
+#define MPY_OP1WIDE		0x0040
+#define MPY_OP2WIDE		0x0080
+
+// ADC12_A registers and bits
+#define ADC_CTL0		0x00
+#define ADC_CTL1		0x02
+#define ADC_IFG			0x0A
+#define ADC_IE			0x0C
+#define ADC_IV			0x0E
+#define ADC_MCTL0		0x10	// A byte each
+#define ADC_MEM0		0x20
+#define ADC_MEMS		16
+#define ADC12SC			0x0001
+#define ADC12ENC		0x0002
+#define ADC12ON			0x0010
+#define ADC12MSC		0x0080
+#define ADC_CONSEQ		0x0006
+#define ADC_SHS			0x0C00
+#define ADC_SHS_1		0x0400	// Timer output, TA0.1 on the F5xx
+#define ADC_INCH		0x0F
+#define ADC_EOS			0x80
+
+// DMA registers and bits
+#define DMA_TSEL0		0x00	// DMACTL0-DMACTL3, a trigger select byte per channel
+#define DMA_IV			0x0E
+#define DMA_CH0			0x10	// DMAxCTL, then from there:
+#define DMA_SA			0x02
+#define DMA_DA			0x06
+#define DMA_SZ			0x0A
+#define DMA_STRIDE		0x10
+#define DMAREQ			0x0001
+#define DMAIE			0x0004
+#define DMAIFG			0x0008
+#define DMAEN			0x0010
+#define DMASRCBYTE		0x0040
+#define DMADSTBYTE		0x0080
+#define DMADT_BLOCKS	0x3000	// Set for block and burst-block
+#define DMADT_REPEAT	0x4000
+
+// USCI registers and bits, UART (Ax) and I2C (Bx) modes
+#define UC_CTL1			0x00
+#define UC_BRW			0x06
+#define UC_MCTL			0x08	// UART only
+#define UC_STAT			0x0A
+#define UC_RXBUF		0x0C
+#define UC_TXBUF		0x0E
+#define UC_I2CSA		0x12	// I2C only
+#define UC_IE			0x1C
+#define UC_IFG			0x1D
+#define UC_IV			0x1E
+#define UCSWRST			0x01
+#define UCTXSTT			0x02
+#define UCTXSTP			0x04
+#define UCTR			0x10
+#define UCRXIFG			0x01
+#define UCTXIFG			0x02
+#define UCSTTIFG		0x04
+#define UCSTPIFG		0x08
+#define UCALIFG			0x10
+#define UCNACKIFG		0x20
+#define UCBUSY			0x01	// UCAxSTAT
+#define UCOE			0x20
+#define UCBBUSY			0x10	// UCBxSTAT
+#define UCOS16			0x01
+#define UART_FRAME_BITS	10		// 8N1
+
+// Digital I/O registers, from PxIN
+#define PORT_OUT		0x02
+#define PORT_DIR		0x04
+#define PORT_IES		0x18
+#define PORT_IE			0x1A
+#define PORT_IFG		0x1C
+
+// I2C master steps
+#define I2C_IDLE		0
+#define I2C_ADDRESS		1		// (Repeated) START, address and acknowledge
+#define I2C_TX			2		// A byte out and the slave's acknowledge
+#define I2C_RX			3		// A byte in
+#define I2C_STOP		4
+#define I2C_HOLD_TX		5		// SCL held low until TXBUF, UCTXSTT or UCTXSTP
+#define I2C_HOLD_NACK	6		// Not acknowledged; until UCTXSTT or UCTXSTP
+#define I2C_HOLD_RX		7		// A byte in with RXBUF still full
+
+typedef struct TimerA {
+	uint16_t base;
+	uint32_t clockHz;
+	uint64_t fraction;				// Clock edges owed, times SIM_MCLK
+	uint8_t ccr0Vector;				// TIMERx_A0_VECTOR
+	uint8_t vector;					// TIMERx_A1_VECTOR
+	uint32_t edges[TA_CCRS];		// Rising edges of each output
+	uint64_t readAt;				// Sim_cycles at the last TAxR read
+	uint8_t reads;					// TAxR reads since time last moved
+} TimerA;
+
+typedef struct Crc16 {
+	uint16_t base;
+	uint16_t crc;
+} Crc16;
+
+typedef struct Mpy32 {
+	uint16_t base;
+	uint32_t op1;
+	uint32_t op2;
+	uint64_t raw;					// RES0-RES3 as the hardware holds them
+	__int128 result;				// Unwrapped, for saturation
+	bool wide;						// 64-bit result, else 32 in RES0-RES1
+} Mpy32;
+
+typedef struct Adc12 {
+	uint16_t base;
+	Sim_Model *timer;				// Output 1 is sample-and-hold source 1
+	uint32_t edges;					// Of that output, already converted on
+	uint8_t vector;
+	Sim_AdcInput input;
+	uint8_t next;					// ADC12MEMx the next conversion goes to
+	bool enabled;					// ENC when last seen
+	bool stopped;					// Single conversion or sequence done
+} Adc12;
+
+typedef struct DmaChannel {
+	uint32_t source;				// The temporary registers
+	uint32_t destination;
+	uint16_t size;
+	uint16_t length;				// DMAxSZ when enabled, reloaded at 0
+	bool armed;						// DMAEN when last seen
+} DmaChannel;
+
+typedef struct Dma {
+	uint16_t base;
+	uint8_t vector;
+	DmaChannel channel[SIM_DMA_CHANNELS];
+} Dma;
+
+typedef struct Uart {
+	uint16_t base;
+	uint32_t clockHz;
+	uint8_t vector;
+	uint8_t rxTrigger;				// SIM_TRIGGER_x of RXIFG and TXIFG
+	uint8_t txTrigger;
+	Sim_UartOutput output;
+	uint8_t shift;					// Byte going out
+	bool shifting;
+	bool txFull;					// TXBUF written, not yet shifting
+	uint32_t txLeft;				// Cycles to the end of the byte going out
+	uint8_t queue[SIM_UART_QUEUE];	// Bytes on their way in, back to back
+	uint16_t queueHead;
+	uint16_t queueTail;
+	uint32_t rxLeft;				// Cycles to the end of the byte coming in
+	uint8_t ifg;					// UCAxIFG when last seen, for DMA trigger edges
+} Uart;
+
+typedef struct I2c {
+	uint16_t base;
+	uint32_t clockHz;
+	uint8_t vector;
+	uint8_t rxTrigger;
+	uint8_t txTrigger;
+	Sim_I2cDevice *devices;
+	Sim_I2cDevice *slave;			// Addressed by the transfer in progress
+	uint8_t step;					// I2C_x
+	uint32_t left;					// Cycles to the end of the step
+	uint8_t shift;					// Byte on the wire
+	bool read;
+	bool txFull;
+	uint8_t ctl1;					// UCBxCTL1 and UCBxIFG when last seen
+	uint8_t ifg;
+} I2c;
+
+typedef struct Port {
+	uint16_t in;					// PxIN
+	uint8_t vector;
+	uint8_t lines;					// Levels from outside, pulled up
+	uint8_t level;					// PxIN when last seen, for edges
+} Port;
+
+static Dma *dma = 0;				// The one controller, for Sim_dmaRequest()
+
+//private functions
+// Highest priority pending, enabled TAxIV source, 0 for none
+static uint16_t Sim_timerIv(TimerA *t) {
+	uint8_t n;
+	for (n = 1; n < TA_CCRS; n++) {
+		uint16_t cctl = Sim_peek16(t->base + TA_CCTL0 + 2 * n);
+		if ((cctl & CCIE) && (cctl & CCIFG))
+			return 2 * n;
+	}
+	if ((Sim_peek16(t->base + TA_CTL) & (TAIE | TAIFG)) == (TAIE | TAIFG))
+		return 0x0E;
+	return 0;
+}
+
+static void Sim_timerUpdate(TimerA *t) {
+	uint16_t cctl0 = Sim_peek16(t->base + TA_CCTL0);
+	uint16_t iv = Sim_timerIv(t);
+	Sim_poke16(t->base + TA_IV, iv);
+	if (iv)
+		Sim_raise(t->vector);
+	else
+		Sim_clear(t->vector);
+	if ((cctl0 & CCIE) && (cctl0 & CCIFG)) {
+		// CCIFG0 clears itself when its interrupt is serviced
+		Sim_poke16(t->base + TA_CCTL0, cctl0 & ~CCIFG);
+		Sim_raise(t->ccr0Vector);
+	}
+}
+
+static void Sim_timerSet(TimerA *t, uint16_t offset, uint16_t bits) {
+	Sim_poke16(t->base + offset, Sim_peek16(t->base + offset) | bits);
+}
+
+// Output unit n at EQUn (equal) or EQU0, SLAU208 table 17-2.  Mode 0 is
+// the OUT bit as written.
+static uint16_t Sim_timerOutput(TimerA *t, uint8_t n, uint16_t cctl, bool equal) {
+	uint16_t out = cctl & TA_OUT;
+	switch ((cctl & OUTMOD_MASK) >> 5) {
+	case 1:							// Set
+		out = equal ? TA_OUT : out;
+		break;
+	case 2:							// Toggle/reset
+		out = equal ? out ^ TA_OUT : 0;
+		break;
+	case 3:							// Set/reset
+		out = equal ? TA_OUT : 0;
+		break;
+	case 4:							// Toggle
+		out = equal ? out ^ TA_OUT : out;
+		break;
+	case 5:							// Reset
+		out = equal ? 0 : out;
+		break;
+	case 6:							// Toggle/set
+		out = equal ? out ^ TA_OUT : TA_OUT;
+		break;
+	case 7:							// Reset/set
+		out = equal ? 0 : TA_OUT;
+		break;
+	}
+	if (out && !(cctl & TA_OUT))
+		t->edges[n]++;
+	return (cctl & ~TA_OUT) | out;
+}
+
+static void Sim_timerCount(TimerA *t) {
+	uint16_t mc = Sim_peek16(t->base + TA_CTL) & MC_MASK;
+	uint16_t r = Sim_peek16(t->base + TA_R);
+	uint16_t cctl;
+	bool equal0, equal;
+	uint8_t n;
+	if (mc == MC_UP && r >= Sim_peek16(t->base + TA_CCR0)) {
+		r = 0;
+		Sim_timerSet(t, TA_CTL, TAIFG);
+	} else {
+		r++;
+		if (r == 0)
+			Sim_timerSet(t, TA_CTL, TAIFG);
+	}
+	Sim_poke16(t->base + TA_R, r);
+	equal0 = Sim_peek16(t->base + TA_CCR0) == r;
+	for (n = 0; n < TA_CCRS; n++) {
+		cctl = Sim_peek16(t->base + TA_CCTL0 + 2 * n);
+		if (cctl & CAP)
+			continue;
+		equal = Sim_peek16(t->base + TA_CCR0 + 2 * n) == r;
+		if (equal)
+			cctl |= CCIFG;
+		if (n > 0 && (equal || equal0))
+			cctl = Sim_timerOutput(t, n, cctl, equal);
+		Sim_poke16(t->base + TA_CCTL0 + 2 * n, cctl);
+	}
+}
+
+static void Sim_timerTick(Sim_Model *model, uint32_t cycles) {
+	TimerA *t = model->state;
+	uint16_t mc = Sim_peek16(t->base + TA_CTL) & MC_MASK;
+	if (mc == 0)
+		return;
+	t->fraction += (uint64_t) cycles * t->clockHz;
+	if (t->fraction < SIM_MCLK)
+		return;
+	while (t->fraction >= SIM_MCLK) {
+		t->fraction -= SIM_MCLK;
+		Sim_timerCount(t);
+	}
+	Sim_timerUpdate(t);
+}
+
+static void Sim_timerAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	TimerA *t = model->state;
+	uint16_t ctl = Sim_peek16(t->base + TA_CTL);
+	uint16_t iv;
+	if (address == t->base + TA_CTL && (ctl & TACLR)) {
+		Sim_poke16(t->base + TA_CTL, ctl & ~TACLR);
+		Sim_poke16(t->base + TA_R, 0);
+		t->fraction = 0;
+	}
+	if (address == t->base + TA_R) {
+		// A read to confirm the last is normal, but more with no time
+		// between is a loop waiting for the count to move
+		if (t->readAt != Sim_cycles) {
+			t->readAt = Sim_cycles;
+			t->reads = 0;
+		}
+		if (++t->reads > 2)
+			Sim_poll();
+	}
+	if (address == t->base + TA_IV) {
+		// Reading TAxIV clears the flag it reported
+		iv = (uint16_t) before;
+		if (iv == 0x0E)
+			Sim_poke16(t->base + TA_CTL, ctl & ~TAIFG);
+		else if (iv)
+			Sim_poke16(t->base + TA_CCTL0 + iv,
+					Sim_peek16(t->base + TA_CCTL0 + iv) & ~CCIFG);
+	}
+	Sim_timerUpdate(t);
+}
+
+// CRC-CCITT polynomial 0x1021, one bit at a time as the hardware does
+static void Sim_crcBit(Crc16 *c, uint8_t bit) {
+	uint8_t feedback = ((c->crc >> 15) & 1) ^ bit;
+	c->crc <<= 1;
+	if (feedback)
+		c->crc ^= 0x1021;
+}
+
+static void Sim_crcByte(Crc16 *c, uint8_t byte, bool msbFirst) {
+	uint8_t i;
+	for (i = 0; i < 8; i++)
+		Sim_crcBit(c, msbFirst ? (byte >> (7 - i)) & 1 : (byte >> i) & 1);
+}
+
+static uint16_t Sim_reverse16(uint16_t value) {
+	uint16_t result = 0;
+	uint8_t i;
+	for (i = 0; i < 16; i++)
+		result = (result << 1) | ((value >> i) & 1);
+	return result;
+}
+
+// Every access to CRCDI/CRCDIRB is taken as data in, so CRC_getData()
+// would feed the module its last input again; nothing here calls it.
+static void Sim_crcAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Crc16 *c = model->state;
+	uint16_t offset = address - c->base;
+	uint16_t data = Sim_peek16(address & ~1);
+	switch (offset) {
+	case CRC_DI:
+		Sim_crcByte(c, (uint8_t) data, false);
+		if (width > 1)
+			Sim_crcByte(c, (uint8_t) (data >> 8), false);
+		break;
+	case CRC_DIRB:
+		if (width > 1)
+			Sim_crcByte(c, (uint8_t) (data >> 8), true);
+		Sim_crcByte(c, (uint8_t) data, true);
+		break;
+	case CRC_INIRES:
+		c->crc = data;
+		break;
+	default:
+		return;
+	}
+	Sim_poke16(c->base + CRC_INIRES, c->crc);
+	Sim_poke16(c->base + CRC_RESR, Sim_reverse16(c->crc));
+}
+
+static bool Sim_mpySigned(uint16_t ctl) {
+	return (ctl & MPY_MODE) == 0x0010 || (ctl & MPY_MODE) == 0x0030;
+}
+
+// Put the result registers up as they read: raw, or clamped to the result
+// width in saturation mode
+static void Sim_mpyShow(Mpy32 *m) {
+	uint16_t ctl = Sim_peek16(m->base + MPY_CTL0);
+	__int128 limit = (__int128) 1 << (m->wide ? 63 : 31);
+	uint64_t view = m->raw;
+	uint8_t i;
+	if ((ctl & MPY_SAT) && Sim_mpySigned(ctl)) {
+		if (m->result >= limit)
+			view = (uint64_t) (limit - 1);
+		else if (m->result < -limit)
+			view = (uint64_t) -limit;
+		if (!m->wide)
+			view = (uint64_t) (int64_t) (int32_t) view;
+	}
+	for (i = 0; i < 4; i++)
+		Sim_poke16(m->base + MPY_RES0 + 2 * i, (uint16_t) (view >> (16 * i)));
+	Sim_poke16(m->base + MPY_RESLO, (uint16_t) view);
+	Sim_poke16(m->base + MPY_RESHI, (uint16_t) (view >> 16));
+	Sim_poke16(m->base + MPY_SUMEXT,
+			(Sim_mpySigned(ctl) && m->result < 0) ? 0xFFFF : 0);
+}
+
+// The low bits of value, sign extended or not
+static __int128 Sim_mpyExtend(uint64_t value, uint8_t bits, bool sign) {
+	uint64_t top = (uint64_t) 1 << (bits - 1);
+	if (bits < 64)
+		value &= (top << 1) - 1;
+	if (sign && (value & top))
+		return (__int128) value - ((__int128) top << 1);
+	return value;
+}
+
+static __int128 Sim_mpyOperand(uint32_t value, bool wide, bool sign) {
+	return Sim_mpyExtend(value, wide ? 32 : 16, sign);
+}
+
+// Writing operand 2 starts the operation the operand 1 register chose.  A
+// MAC adds to the raw registers, 32 bits of them for a 16 x 16 product.
+static void Sim_mpyRun(Mpy32 *m, bool op2Wide) {
+	uint16_t ctl = Sim_peek16(m->base + MPY_CTL0);
+	bool sign = Sim_mpySigned(ctl);
+	bool op1Wide = ctl & MPY_OP1WIDE;
+	__int128 a, b, base = 0;
+	a = Sim_mpyOperand(m->op1, op1Wide, sign);
+	b = Sim_mpyOperand(m->op2, op2Wide, sign);
+	m->wide = op1Wide || op2Wide;
+	if (ctl & 0x0020)				// MAC, MACS
+		base = Sim_mpyExtend(m->raw, m->wide ? 64 : 32, sign);
+	m->result = base + a * b * ((ctl & MPY_FRAC) ? 2 : 1);
+	m->raw = (uint64_t) m->result;
+	if (!m->wide)					// RES2-RES3 extend RES0-RES1
+		m->raw = (uint64_t) Sim_mpyExtend(m->raw, 32, sign);
+	Sim_poke16(m->base + MPY_CTL0,
+			op2Wide ? ctl | MPY_OP2WIDE : ctl & ~MPY_OP2WIDE);
+	Sim_mpyShow(m);
+}
+
+// Operand registers are write only here, so every access to one counts.
+// A result register access that changes it is a preload, taken as a
+// 64-bit value; one that writes what a saturated register already reads
+// is missed.  The carry bit, MPYC, isn't modelled.
+static void Sim_mpyAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Mpy32 *m = model->state;
+	uint16_t offset = (address - m->base) & ~1;
+	uint16_t data = Sim_peek16(address & ~1);
+	uint16_t ctl = Sim_peek16(m->base + MPY_CTL0);
+	uint8_t word;
+	if (offset < MPY_OP2) {
+		m->op1 = data;
+		Sim_poke16(m->base + MPY_CTL0,
+				(ctl & ~(MPY_MODE | MPY_OP1WIDE)) | (offset << 3));
+	} else if (offset == MPY_OP2) {
+		m->op2 = data;
+		Sim_mpyRun(m, false);
+	} else if (offset >= MPY_OP1_32 && offset < MPY_OP2L) {
+		ctl = (ctl & ~MPY_MODE) | (((offset - MPY_OP1_32) & 0x0C) << 2);
+		if (offset & 2) {
+			m->op1 = (m->op1 & 0xFFFF) | ((uint32_t) data << 16);
+			ctl |= MPY_OP1WIDE;
+		} else {
+			m->op1 = data;
+			ctl &= ~MPY_OP1WIDE;
+		}
+		Sim_poke16(m->base + MPY_CTL0, ctl);
+	} else if (offset == MPY_OP2L) {
+		m->op2 = data;
+	} else if (offset == MPY_OP2H) {
+		m->op2 = (m->op2 & 0xFFFF) | ((uint32_t) data << 16);
+		Sim_mpyRun(m, true);
+	} else if (offset == MPY_CTL0) {
+		Sim_mpyShow(m);
+	} else if (offset != MPY_SUMEXT && data != (uint16_t) before) {
+		word = (offset >= MPY_RES0) ? (offset - MPY_RES0) / 2
+				: (offset - MPY_RESLO) / 2;
+		m->raw &= ~((uint64_t) 0xFFFF << (16 * word));
+		m->raw |= (uint64_t) data << (16 * word);
+		m->result = (int64_t) m->raw;
+		m->wide = true;
+		Sim_poke16(m->base + MPY_RES0 + 2 * word, data);
+		if (word < 2)
+			Sim_poke16(m->base + MPY_RESLO + 2 * word, data);
+	}
+}
+
+// Lowest ADC12MEMx with its flag and interrupt enable set, as ADC12IV
+// reports it.  The overflow flags aren't modelled.
+static void Sim_adcUpdate(Adc12 *a) {
+	uint16_t pending = Sim_peek16(a->base + ADC_IFG) & Sim_peek16(a->base + ADC_IE);
+	uint8_t i;
+	for (i = 0; i < ADC_MEMS && !(pending & (1 << i)); i++)
+		;
+	Sim_poke16(a->base + ADC_IV, (i < ADC_MEMS) ? 6 + 2 * i : 0);
+	if (i < ADC_MEMS)
+		Sim_raise(a->vector);
+	else
+		Sim_clear(a->vector);
+}
+
+// One sample-and-hold trigger: a conversion into ADC12MEMx, or with MSC
+// set in a sequence mode, the rest of the sequence.  The end of a sequence,
+// or every conversion in the single channel modes, is the DMA trigger.
+static void Sim_adcConvert(Adc12 *a) {
+	uint16_t ctl0 = Sim_peek16(a->base + ADC_CTL0);
+	uint16_t ctl1 = Sim_peek16(a->base + ADC_CTL1);
+	uint8_t mode = (ctl1 & ADC_CONSEQ) >> 1;
+	bool sequence = mode & 1;
+	bool end;
+	uint8_t mctl;
+	if (!(ctl0 & ADC12ON) || !(ctl0 & ADC12ENC) || a->stopped)
+		return;
+	do {
+		mctl = Sim_memory[a->base + ADC_MCTL0 + a->next];
+		Sim_poke16(a->base + ADC_MEM0 + 2 * a->next,
+				a->input(mctl & ADC_INCH) & 0x0FFF);
+		Sim_poke16(a->base + ADC_IFG,
+				Sim_peek16(a->base + ADC_IFG) | (1 << a->next));
+		end = !sequence || (mctl & ADC_EOS);
+		if (sequence)
+			a->next = end ? ctl1 >> 12 : (a->next + 1) % ADC_MEMS;
+		if (end) {
+			a->stopped = mode < 2;	// The single modes wait for ENC again
+			Sim_dmaRequest(SIM_TRIGGER_ADC12IFG);
+		}
+	} while (!end && (ctl0 & ADC12MSC));
+	Sim_adcUpdate(a);
+}
+
+static void Sim_adcTick(Sim_Model *model, uint32_t cycles) {
+	Adc12 *a = model->state;
+	uint32_t edges = a->timer ? Sim_timerEdges(a->timer, 1) : 0;
+	bool timed = (Sim_peek16(a->base + ADC_CTL1) & ADC_SHS) == ADC_SHS_1;
+	while (a->edges != edges) {
+		a->edges++;
+		if (timed)
+			Sim_adcConvert(a);
+	}
+}
+
+static void Sim_adcAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Adc12 *a = model->state;
+	uint16_t offset = (address - a->base) & ~1;
+	uint16_t ctl0 = Sim_peek16(a->base + ADC_CTL0);
+	uint16_t iv;
+	if (offset == ADC_CTL0) {
+		// Setting ENC latches CSTARTADD
+		if ((ctl0 & ADC12ENC) && !a->enabled) {
+			a->next = Sim_peek16(a->base + ADC_CTL1) >> 12;
+			a->stopped = false;
+		}
+		a->enabled = ctl0 & ADC12ENC;
+		if (ctl0 & ADC12SC) {
+			Sim_poke16(a->base + ADC_CTL0, ctl0 & ~ADC12SC);
+			if (!(Sim_peek16(a->base + ADC_CTL1) & ADC_SHS))
+				Sim_adcConvert(a);
+		}
+	} else if (offset >= ADC_MEM0) {
+		// Reading ADC12MEMx, by the CPU or the DMA, clears its flag
+		Sim_poke16(a->base + ADC_IFG, Sim_peek16(a->base + ADC_IFG)
+				& ~(1 << ((offset - ADC_MEM0) / 2)));
+	} else if (offset == ADC_IV) {
+		iv = (uint16_t) before;
+		if (iv >= 6)
+			Sim_poke16(a->base + ADC_IFG, Sim_peek16(a->base + ADC_IFG)
+					& ~(1 << ((iv - 6) / 2)));
+	}
+	Sim_adcUpdate(a);
+}
+
+static uint16_t Sim_dmaControl(Dma *d, uint8_t n) {
+	return d->base + DMA_CH0 + DMA_STRIDE * n;
+}
+
+// DMAxTSEL
+static uint8_t Sim_dmaSelect(Dma *d, uint8_t n) {
+	return Sim_memory[d->base + DMA_TSEL0 + n] & 0x1F;
+}
+
+static uint32_t Sim_dmaPeek20(uint16_t address) {
+	return (Sim_peek16(address) | ((uint32_t) Sim_peek16(address + 2) << 16))
+			& 0xFFFFF;
+}
+
+// DMAEN set: the address and size registers go to the temporaries
+static void Sim_dmaLoad(Dma *d, uint8_t n) {
+	DmaChannel *c = &d->channel[n];
+	uint16_t ctl = Sim_dmaControl(d, n);
+	c->source = Sim_dmaPeek20(ctl + DMA_SA);
+	c->destination = Sim_dmaPeek20(ctl + DMA_DA);
+	c->length = Sim_peek16(ctl + DMA_SZ);
+	c->size = c->length;
+}
+
+// DMAxSRCINCR or DMAxDSTINCR
+static uint32_t Sim_dmaStep(uint32_t address, uint16_t increment, uint8_t unit) {
+	if (increment == 3)
+		return address + unit;
+	if (increment == 2)
+		return address - unit;
+	return address;
+}
+
+// Lowest channel with its flag and interrupt enable set, as DMAIV reports it
+static void Sim_dmaUpdate(Dma *d) {
+	uint16_t ctl;
+	uint8_t n;
+	for (n = 0; n < SIM_DMA_CHANNELS; n++) {
+		ctl = Sim_peek16(Sim_dmaControl(d, n));
+		if ((ctl & (DMAIE | DMAIFG)) == (DMAIE | DMAIFG))
+			break;
+	}
+	Sim_poke16(d->base + DMA_IV, (n < SIM_DMA_CHANNELS) ? 2 * (n + 1) : 0);
+	if (n < SIM_DMA_CHANNELS)
+		Sim_raise(d->vector);
+	else
+		Sim_clear(d->vector);
+}
+
+// One trigger's worth: a unit, or in the block modes all of them.  The
+// moves go through Sim_reg8/16 so the models at either end see them.
+static void Sim_dmaTransfer(Dma *d, uint8_t n) {
+	DmaChannel *c = &d->channel[n];
+	uint16_t address = Sim_dmaControl(d, n);
+	uint16_t ctl = Sim_peek16(address);
+	uint8_t sourceUnit = (ctl & DMASRCBYTE) ? 1 : 2;
+	uint8_t destinationUnit = (ctl & DMADSTBYTE) ? 1 : 2;
+	uint16_t data;
+	if (!c->armed || c->size == 0)
+		return;
+	do {
+		if (sourceUnit == 1)
+			data = *Sim_reg8((uint16_t) c->source);
+		else
+			data = *Sim_reg16((uint16_t) c->source);
+		if (destinationUnit == 1)
+			*Sim_reg8((uint16_t) c->destination) = (uint8_t) data;
+		else
+			*Sim_reg16((uint16_t) c->destination) = data;
+		c->source = Sim_dmaStep(c->source, (ctl >> 8) & 3, sourceUnit);
+		c->destination = Sim_dmaStep(c->destination, (ctl >> 10) & 3,
+				destinationUnit);
+		c->size--;
+	} while (c->size && (ctl & DMADT_BLOCKS));
+	Sim_commit();
+	ctl = Sim_peek16(address);
+	if (c->size == 0) {
+		ctl |= DMAIFG;
+		if (ctl & DMADT_REPEAT) {
+			Sim_dmaLoad(d, n);
+		} else {
+			ctl &= ~DMAEN;
+			c->armed = false;
+		}
+	}
+	Sim_poke16(address, ctl);
+	Sim_poke16(address + DMA_SZ, c->size ? c->size : c->length);
+}
+
+static void Sim_dmaAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Dma *d = model->state;
+	uint16_t offset = (address - d->base) & ~1;
+	uint16_t control, ctl, iv;
+	uint8_t n;
+	if (offset == DMA_IV) {
+		// Reading DMAIV clears the flag it reported
+		iv = (uint16_t) before;
+		if (iv) {
+			control = Sim_dmaControl(d, iv / 2 - 1);
+			Sim_poke16(control, Sim_peek16(control) & ~DMAIFG);
+		}
+	} else if (offset >= DMA_CH0 && (offset - DMA_CH0) % DMA_STRIDE == 0) {
+		n = (offset - DMA_CH0) / DMA_STRIDE;
+		control = Sim_dmaControl(d, n);
+		ctl = Sim_peek16(control);
+		if ((ctl & DMAEN) && !d->channel[n].armed)
+			Sim_dmaLoad(d, n);
+		d->channel[n].armed = ctl & DMAEN;
+		if (ctl & DMAREQ) {
+			Sim_poke16(control, ctl & ~DMAREQ);
+			if (Sim_dmaSelect(d, n) == 0)
+				Sim_dmaTransfer(d, n);
+		}
+	}
+	Sim_dmaUpdate(d);
+}
+
+// UCAxIV or UCBxIV source for each flag, highest priority first
+static uint8_t Sim_usciIv(uint8_t pending, const uint8_t flags[], uint8_t count) {
+	uint8_t i;
+	for (i = 0; i < count; i++)
+		if (pending & flags[i])
+			return 2 * (i + 1);
+	return 0;
+}
+
+static void Sim_usciSet(uint16_t address, uint8_t bits) {
+	Sim_memory[address] |= bits;
+}
+
+static void Sim_usciClear(uint16_t address, uint8_t bits) {
+	Sim_memory[address] &= ~bits;
+}
+
+// Rising flags are DMA triggers
+static void Sim_usciTrigger(uint8_t *last, uint8_t ifg, uint8_t rxTrigger,
+		uint8_t txTrigger) {
+	uint8_t rising = ifg & ~*last;
+	*last = ifg;
+	if ((rising & UCRXIFG) && rxTrigger != SIM_TRIGGER_NONE)
+		Sim_dmaRequest(rxTrigger);
+	if ((rising & UCTXIFG) && txTrigger != SIM_TRIGGER_NONE)
+		Sim_dmaRequest(txTrigger);
+}
+
+// An 8N1 frame in MCLK cycles from UCAxBRW and UCAxMCTL, bit by bit as in
+// the BITCLK timing of SLAU208
+static uint32_t Sim_uartFrame(Uart *u) {
+	static const uint8_t pattern[8] = { 0x00, 0x02, 0x22, 0x2A, 0xAA, 0xAE,
+			0xEE, 0xFE };
+	uint16_t br = Sim_peek16(u->base + UC_BRW);
+	uint8_t mctl = Sim_memory[u->base + UC_MCTL];
+	uint64_t clocks = 0;
+	uint8_t i, m;
+	for (i = 0; i < UART_FRAME_BITS; i++) {
+		m = (pattern[(mctl >> 1) & 7] >> (i & 7)) & 1;
+		clocks += (mctl & UCOS16) ? (uint64_t) (16 + m) * br + (mctl >> 4)
+				: (uint64_t) br + m;
+	}
+	clocks = (clocks * SIM_MCLK + u->clockHz / 2) / u->clockHz;
+	return clocks ? (uint32_t) clocks : 1;
+}
+
+static bool Sim_uartReset(Uart *u) {
+	return Sim_memory[u->base + UC_CTL1] & UCSWRST;
+}
+
+static void Sim_uartUpdate(Uart *u) {
+	static const uint8_t flags[2] = { UCRXIFG, UCTXIFG };
+	uint8_t ifg = Sim_memory[u->base + UC_IFG];
+	uint8_t iv = Sim_usciIv(ifg & Sim_memory[u->base + UC_IE], flags, 2);
+	bool busy = u->shifting || u->txFull || u->queueHead != u->queueTail;
+	Sim_poke16(u->base + UC_IV, iv);
+	if (busy)
+		Sim_usciSet(u->base + UC_STAT, UCBUSY);
+	else
+		Sim_usciClear(u->base + UC_STAT, UCBUSY);
+	if (iv)
+		Sim_raise(u->vector);
+	else
+		Sim_clear(u->vector);
+	Sim_usciTrigger(&u->ifg, ifg, u->rxTrigger, u->txTrigger);
+}
+
+// TXBUF to the shift register, which frees TXBUF
+static void Sim_uartLoad(Uart *u) {
+	if (u->shifting || !u->txFull)
+		return;
+	u->shift = Sim_memory[u->base + UC_TXBUF];
+	u->txFull = false;
+	u->shifting = true;
+	u->txLeft = Sim_uartFrame(u);
+	Sim_usciSet(u->base + UC_IFG, UCTXIFG);
+	Sim_uartUpdate(u);
+}
+
+// A byte in; one arriving with the last still unread overruns it
+static void Sim_uartArrive(Uart *u, uint8_t data) {
+	if (Sim_uartReset(u))
+		return;
+	if (Sim_memory[u->base + UC_IFG] & UCRXIFG)
+		Sim_usciSet(u->base + UC_STAT, UCOE);
+	Sim_memory[u->base + UC_RXBUF] = data;
+	Sim_usciSet(u->base + UC_IFG, UCRXIFG);
+	Sim_uartUpdate(u);
+}
+
+static void Sim_uartTick(Sim_Model *model, uint32_t cycles) {
+	Uart *u = model->state;
+	uint32_t left = cycles;
+	while (u->shifting && left >= u->txLeft) {
+		left -= u->txLeft;
+		u->shifting = false;
+		if (u->output)
+			u->output(u->shift);
+		Sim_uartLoad(u);
+		Sim_uartUpdate(u);
+	}
+	if (u->shifting)
+		u->txLeft -= left;
+	left = cycles;
+	while (u->queueHead != u->queueTail && left >= u->rxLeft) {
+		left -= u->rxLeft;
+		Sim_uartArrive(u, u->queue[u->queueTail++ % SIM_UART_QUEUE]);
+		u->rxLeft = Sim_uartFrame(u);
+	}
+	if (u->queueHead != u->queueTail)
+		u->rxLeft -= left;
+	Sim_uartUpdate(u);
+}
+
+// UCSWRST holds the USCI as SLAU208 describes: the interrupt enables and
+// UCRXIFG cleared, UCTXIFG set, anything shifting lost
+static void Sim_uartAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Uart *u = model->state;
+	uint16_t offset = address - u->base;
+	uint8_t iv;
+	bool poll = false;
+	if (Sim_uartReset(u)) {
+		Sim_memory[u->base + UC_IE] = 0;
+		Sim_memory[u->base + UC_IFG] = UCTXIFG;
+		Sim_usciClear(u->base + UC_STAT, UCOE);
+		u->shifting = false;
+		u->txFull = false;
+		u->ifg = UCTXIFG;
+	} else if (offset == UC_TXBUF) {
+		Sim_usciClear(u->base + UC_IFG, UCTXIFG);
+		u->txFull = true;
+		Sim_uartUpdate(u);
+		Sim_uartLoad(u);
+	} else if (offset == UC_RXBUF) {
+		Sim_usciClear(u->base + UC_IFG, UCRXIFG);
+		Sim_usciClear(u->base + UC_STAT, UCOE);
+	} else if (offset == UC_IV) {
+		// Reading UCAxIV clears the flag it reported
+		iv = (uint8_t) before;
+		if (iv)
+			Sim_usciClear(u->base + UC_IFG, iv == 2 ? UCRXIFG : UCTXIFG);
+	} else if (offset == UC_STAT) {
+		poll = (before & UCBUSY) && Sim_memory[address] == (uint8_t) before;
+	}
+	Sim_uartUpdate(u);
+	if (poll)
+		Sim_poll();
+}
+
+static uint32_t Sim_i2cBit(I2c *i) {
+	uint16_t br = Sim_peek16(i->base + UC_BRW);
+	uint64_t cycles = ((uint64_t) (br ? br : 1) * SIM_MCLK + i->clockHz / 2)
+			/ i->clockHz;
+	return cycles ? (uint32_t) cycles : 1;
+}
+
+static void Sim_i2cUpdate(I2c *i) {
+	static const uint8_t flags[6] = { UCALIFG, UCNACKIFG, UCSTTIFG, UCSTPIFG,
+			UCRXIFG, UCTXIFG };
+	uint8_t ifg = Sim_memory[i->base + UC_IFG];
+	uint8_t iv = Sim_usciIv(ifg & Sim_memory[i->base + UC_IE], flags, 6);
+	Sim_poke16(i->base + UC_IV, iv);
+	if (i->step == I2C_IDLE)
+		Sim_usciClear(i->base + UC_STAT, UCBBUSY);
+	else
+		Sim_usciSet(i->base + UC_STAT, UCBBUSY);
+	if (iv)
+		Sim_raise(i->vector);
+	else
+		Sim_clear(i->vector);
+	Sim_usciTrigger(&i->ifg, ifg, i->rxTrigger, i->txTrigger);
+}
+
+static void Sim_i2cSetCtl1(I2c *i, uint8_t bits, bool set) {
+	if (set)
+		Sim_usciSet(i->base + UC_CTL1, bits);
+	else
+		Sim_usciClear(i->base + UC_CTL1, bits);
+	i->ctl1 = Sim_memory[i->base + UC_CTL1];
+}
+
+// (Repeated) START with the slave address and UCTR as they are now.  In
+// transmit mode TXBUF is ready for the first byte straight away.
+static void Sim_i2cStart(I2c *i) {
+	i->read = !(Sim_memory[i->base + UC_CTL1] & UCTR);
+	i->step = I2C_ADDRESS;
+	i->left = 10 * Sim_i2cBit(i);
+	i->txFull = false;
+	if (!i->read)
+		Sim_usciSet(i->base + UC_IFG, UCTXIFG);
+}
+
+static void Sim_i2cStop(I2c *i) {
+	i->step = I2C_STOP;
+	i->left = Sim_i2cBit(i);
+}
+
+// After an acknowledge in transmit mode: a repeated START or STOP if one
+// is asked for, else the next byte or SCL held until there is one
+static void Sim_i2cNextTx(I2c *i) {
+	uint8_t ctl1 = Sim_memory[i->base + UC_CTL1];
+	if (ctl1 & UCTXSTT) {
+		Sim_i2cStart(i);
+	} else if (ctl1 & UCTXSTP) {
+		Sim_i2cStop(i);
+	} else if (i->txFull) {
+		i->shift = Sim_memory[i->base + UC_TXBUF];
+		i->txFull = false;
+		i->step = I2C_TX;
+		i->left = 9 * Sim_i2cBit(i);
+		Sim_usciSet(i->base + UC_IFG, UCTXIFG);
+	} else {
+		i->step = I2C_HOLD_TX;
+	}
+}
+
+// The byte in to RXBUF.  UCTXSTP set by now means it was NACKed and the
+// STOP follows; UCTXSTT, a repeated START.  The next step is chosen before
+// RXIFG can start the DMA on it.
+static void Sim_i2cDeliver(I2c *i) {
+	uint8_t ctl1 = Sim_memory[i->base + UC_CTL1];
+	Sim_memory[i->base + UC_RXBUF] = i->shift;
+	if (ctl1 & UCTXSTP) {
+		Sim_i2cStop(i);
+	} else if (ctl1 & UCTXSTT) {
+		Sim_i2cStart(i);
+	} else {
+		i->step = I2C_RX;
+		i->left = 9 * Sim_i2cBit(i);
+	}
+	Sim_usciSet(i->base + UC_IFG, UCRXIFG);
+}
+
+static void Sim_i2cNack(I2c *i) {
+	Sim_usciSet(i->base + UC_IFG, UCNACKIFG);
+	i->step = I2C_HOLD_NACK;
+}
+
+// The end of a timed step
+static void Sim_i2cComplete(I2c *i) {
+	Sim_I2cDevice *d;
+	switch (i->step) {
+	case I2C_ADDRESS:
+		Sim_i2cSetCtl1(i, UCTXSTT, false);
+		for (d = i->devices; d; d = d->next)
+			if (d->address == (Sim_peek16(i->base + UC_I2CSA) & 0x7F))
+				break;
+		if (i->slave && i->slave != d && i->slave->stop)
+			i->slave->stop(i->slave);	// Repeated START to another slave
+		i->slave = d;
+		if (!d || !d->start(d, i->read)) {
+			i->slave = 0;
+			Sim_i2cNack(i);
+		} else if (i->read) {
+			i->step = I2C_RX;
+			i->left = 9 * Sim_i2cBit(i);
+		} else {
+			Sim_i2cNextTx(i);
+		}
+		break;
+	case I2C_TX:
+		if (i->slave->write(i->slave, i->shift))
+			Sim_i2cNextTx(i);
+		else
+			Sim_i2cNack(i);
+		break;
+	case I2C_RX:
+		i->shift = i->slave->read(i->slave);
+		if (Sim_memory[i->base + UC_IFG] & UCRXIFG)
+			i->step = I2C_HOLD_RX;		// SCL held until RXBUF is read
+		else
+			Sim_i2cDeliver(i);
+		break;
+	case I2C_STOP:
+		if (i->slave && i->slave->stop)
+			i->slave->stop(i->slave);
+		i->slave = 0;
+		i->step = I2C_IDLE;
+		Sim_i2cSetCtl1(i, UCTXSTP, false);
+		if (Sim_memory[i->base + UC_CTL1] & UCTXSTT)
+			Sim_i2cStart(i);
+		break;
+	}
+}
+
+static bool Sim_i2cTimed(I2c *i) {
+	return i->step >= I2C_ADDRESS && i->step <= I2C_STOP;
+}
+
+static void Sim_i2cTick(Sim_Model *model, uint32_t cycles) {
+	I2c *i = model->state;
+	while (Sim_i2cTimed(i) && cycles >= i->left) {
+		cycles -= i->left;
+		Sim_i2cComplete(i);
+		Sim_i2cUpdate(i);
+	}
+	if (Sim_i2cTimed(i))
+		i->left -= cycles;
+	Sim_i2cUpdate(i);
+}
+
+// A repeated START goes out at the end of the byte on the wire and STOP
+// after it, but either goes out at once while SCL is held.  Returns whether
+// the CPU is waiting on one.
+static bool Sim_i2cControl(I2c *i, uint8_t before) {
+	uint8_t ctl1 = Sim_memory[i->base + UC_CTL1];
+	uint8_t rising = ctl1 & ~i->ctl1;
+	bool held = i->step == I2C_HOLD_TX || i->step == I2C_HOLD_NACK;
+	i->ctl1 = ctl1;
+	if (rising & UCTXSTT) {
+		if (i->step == I2C_IDLE || held)
+			Sim_i2cStart(i);
+	} else if (rising & UCTXSTP) {
+		if (i->step == I2C_IDLE)
+			Sim_i2cSetCtl1(i, UCTXSTP, false);
+		else if (held)
+			Sim_i2cStop(i);
+	}
+	return ctl1 == before && (ctl1 & (UCTXSTT | UCTXSTP));
+}
+
+static void Sim_i2cAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	I2c *i = model->state;
+	uint16_t offset = address - i->base;
+	uint8_t iv;
+	bool poll = false;
+	if (Sim_memory[i->base + UC_CTL1] & UCSWRST) {
+		if (i->slave && i->step != I2C_IDLE && i->slave->stop)
+			i->slave->stop(i->slave);
+		i->slave = 0;
+		i->step = I2C_IDLE;
+		i->txFull = false;
+		Sim_memory[i->base + UC_IE] = 0;
+		Sim_memory[i->base + UC_IFG] = 0;
+		Sim_i2cSetCtl1(i, UCTXSTT | UCTXSTP, false);
+		i->ifg = 0;
+	} else if (offset == UC_CTL1) {
+		poll = Sim_i2cControl(i, (uint8_t) before);
+	} else if (offset == UC_TXBUF) {
+		Sim_usciClear(i->base + UC_IFG, UCTXIFG);
+		i->txFull = true;
+		if (i->step == I2C_HOLD_TX)
+			Sim_i2cNextTx(i);
+	} else if (offset == UC_RXBUF) {
+		Sim_usciClear(i->base + UC_IFG, UCRXIFG);
+		if (i->step == I2C_HOLD_RX)
+			Sim_i2cDeliver(i);
+	} else if (offset == UC_IV) {
+		// Reading UCBxIV clears the flag it reported
+		static const uint8_t flags[6] = { UCALIFG, UCNACKIFG, UCSTTIFG,
+				UCSTPIFG, UCRXIFG, UCTXIFG };
+		iv = (uint8_t) before;
+		if (iv >= 2 && iv <= 12)
+			Sim_usciClear(i->base + UC_IFG, flags[iv / 2 - 1]);
+	}
+	Sim_i2cUpdate(i);
+	if (poll)
+		Sim_poll();
+}
+
+// Pin levels: outputs as driven, inputs as driven from outside
+static uint8_t Sim_portLevel(Port *p) {
+	uint8_t dir = Sim_memory[p->in + PORT_DIR];
+	return (dir & Sim_memory[p->in + PORT_OUT]) | (~dir & p->lines);
+}
+
+// PxIN from the pins, edges selected by PxIES into PxIFG
+static void Sim_portUpdate(Port *p) {
+	uint8_t level = Sim_portLevel(p);
+	uint8_t changed = level ^ p->level;
+	uint8_t ies = Sim_memory[p->in + PORT_IES];
+	uint8_t edges = changed & ((level & ~ies) | (~level & ies));
+	p->level = level;
+	Sim_memory[p->in] = level;
+	Sim_memory[p->in + PORT_IFG] |= edges;
+	if (Sim_memory[p->in + PORT_IFG] & Sim_memory[p->in + PORT_IE])
+		Sim_raise(p->vector);
+	else
+		Sim_clear(p->vector);
+}
+
+static void Sim_portAccess(Sim_Model *model, uint16_t address, uint8_t width,
+		uint32_t before) {
+	Sim_portUpdate(model->state);
+}
+
+//public functions
+/** Timer_A counting from a clock of clockHz, with compare interrupts and
+ * the output units, as the OUT bit in TAxCCTLn.  Capture inputs and the
+ * output pins aren't modelled.  From the third read of TAxR at the same
+ * instant, each read is taken as a turn of a loop waiting on the count.
+ */
+Sim_Model *Sim_timerA(uint16_t base, uint32_t clockHz, uint8_t ccr0Vector,
+		uint8_t vector) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	TimerA *t = calloc(1, sizeof(TimerA));
+	t->base = base;
+	t->clockHz = clockHz;
+	t->ccr0Vector = ccr0Vector;
+	t->vector = vector;
+	model->name = "Timer_A";
+	model->first = base;
+	model->last = base + TA_IV + 1;
+	model->access = Sim_timerAccess;
+	model->tick = Sim_timerTick;
+	model->state = t;
+	Sim_addModel(model);
+	return model;
+}
+
+/** Rising edges of a timer's output unit so far, for the models it
+ * triggers.
+ */
+uint32_t Sim_timerEdges(Sim_Model *timer, uint8_t ccr) {
+	return ((TimerA *) timer->state)->edges[ccr];
+}
+
+/** 32-bit hardware multiplier: signed and unsigned multiply and
+ * multiply-accumulate on 16 and 32-bit operands, with fractional and
+ * saturation modes.  Saturation applies to the result as it reads, with
+ * the registers' own contents wrapped, which is how driverlib describes it.
+ */
+Sim_Model *Sim_mpy32(uint16_t base) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Mpy32 *m = calloc(1, sizeof(Mpy32));
+	m->base = base;
+	model->name = "MPY32";
+	model->first = base;
+	model->last = base + MPY_CTL0 + 1;
+	model->access = Sim_mpyAccess;
+	model->state = m;
+	Sim_addModel(model);
+	return model;
+}
+
+/** CRC16 module (CRC-CCITT) with its bit-reversed input and result views. */
+Sim_Model *Sim_crc16(uint16_t base) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Crc16 *c = calloc(1, sizeof(Crc16));
+	c->base = base;
+	model->name = "CRC16";
+	model->first = base;
+	model->last = base + CRC_RESR + 1;
+	model->access = Sim_crcAccess;
+	model->state = c;
+	Sim_addModel(model);
+	return model;
+}
+
+/** ADC12_A converting whatever input returns for each INCHx, in no time.
+ * Sample-and-hold source 1 is output 1 of timer (TA0.1 on the F5xx); other
+ * sources are taken as ADC12SC, which starts one conversion or sequence.
+ * The conversion time, ADC12BUSY and the overflow flags aren't modelled.
+ */
+Sim_Model *Sim_adc12(uint16_t base, Sim_Model *timer, uint8_t vector,
+		Sim_AdcInput input) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Adc12 *a = calloc(1, sizeof(Adc12));
+	a->base = base;
+	a->timer = timer;
+	a->edges = timer ? Sim_timerEdges(timer, 1) : 0;
+	a->vector = vector;
+	a->input = input;
+	model->name = "ADC12_A";
+	model->first = base;
+	model->last = base + ADC_MEM0 + 2 * ADC_MEMS - 1;
+	model->access = Sim_adcAccess;
+	model->tick = Sim_adcTick;
+	model->state = a;
+	Sim_addModel(model);
+	return model;
+}
+
+/** DMA controller: single, block and repeated transfers of bytes or words,
+ * started by DMAREQ or by another model through Sim_dmaRequest().
+ * Burst-block runs as block, a whole block moves at once, and the CPU
+ * isn't held while it does.  Only addresses in the modelled 64 KB work.
+ */
+Sim_Model *Sim_dma(uint16_t base, uint8_t vector) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Dma *d = calloc(1, sizeof(Dma));
+	d->base = base;
+	d->vector = vector;
+	model->name = "DMA";
+	model->first = base;
+	model->last = base + DMA_CH0 + DMA_STRIDE * SIM_DMA_CHANNELS - 1;
+	model->access = Sim_dmaAccess;
+	model->state = d;
+	Sim_addModel(model);
+	dma = d;
+	return model;
+}
+
+/** A trigger from another model, SIM_TRIGGER_x: runs each enabled channel
+ * that selects it, lowest channel first.
+ */
+void Sim_dmaRequest(uint8_t trigger) {
+	uint8_t n;
+	if (!dma)
+		return;
+	for (n = 0; n < SIM_DMA_CHANNELS; n++)
+		if (dma->channel[n].armed && Sim_dmaSelect(dma, n) == trigger)
+			Sim_dmaTransfer(dma, n);
+	Sim_dmaUpdate(dma);
+}
+
+/** USCI_A in UART mode, 8N1, with a clock of clockHz: frames take the time
+ * UCAxBRW and UCAxMCTL give them, TXBUF is double buffered behind the shift
+ * register, and each byte sent goes to output as its stop bit ends.
+ * UCAxRXIFG and UCAxTXIFG trigger the DMA on their rising edges.  Parity,
+ * address modes, IrDA and the receive errors other than overrun aren't
+ * modelled.
+ */
+Sim_Model *Sim_usciUart(uint16_t base, uint32_t clockHz, uint8_t vector,
+		uint8_t rxTrigger, uint8_t txTrigger, Sim_UartOutput output) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Uart *u = calloc(1, sizeof(Uart));
+	u->base = base;
+	u->clockHz = clockHz;
+	u->vector = vector;
+	u->rxTrigger = rxTrigger;
+	u->txTrigger = txTrigger;
+	u->output = output;
+	u->ifg = UCTXIFG;
+	Sim_memory[base + UC_CTL1] = UCSWRST;
+	Sim_memory[base + UC_IFG] = UCTXIFG;
+	model->name = "USCI_A UART";
+	model->first = base;
+	model->last = base + UC_IV + 1;
+	model->access = Sim_uartAccess;
+	model->tick = Sim_uartTick;
+	model->state = u;
+	Sim_addModel(model);
+	return model;
+}
+
+/** USCI_B as a single I2C master with a clock of clockHz and the slaves
+ * attached by Sim_i2cAttach().  Each step takes the SCL periods UCBxBRW
+ * gives it: 10 for (repeated) START, address and acknowledge, 9 for a byte
+ * and 1 for STOP.  SCL is held low while TXBUF is empty, after a NACK and
+ * while a byte waits in RXBUF with the next one in.  UCBxRXIFG and
+ * UCBxTXIFG trigger the DMA on their rising edges.  Slave mode, 10-bit
+ * addresses and arbitration aren't modelled.
+ */
+Sim_Model *Sim_usciI2c(uint16_t base, uint32_t clockHz, uint8_t vector,
+		uint8_t rxTrigger, uint8_t txTrigger) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	I2c *i = calloc(1, sizeof(I2c));
+	i->base = base;
+	i->clockHz = clockHz;
+	i->vector = vector;
+	i->rxTrigger = rxTrigger;
+	i->txTrigger = txTrigger;
+	i->ctl1 = UCSWRST;
+	Sim_memory[base + UC_CTL1] = UCSWRST;
+	model->name = "USCI_B I2C";
+	model->first = base;
+	model->last = base + UC_IV + 1;
+	model->access = Sim_i2cAccess;
+	model->tick = Sim_i2cTick;
+	model->state = i;
+	Sim_addModel(model);
+	return model;
+}
+
+/** A digital I/O port from its PxIN address: PxIN follows the outputs and
+ * the levels given by Sim_portInput(), and edges selected by PxIES set
+ * PxIFG and raise vector.  Pins start high, as if pulled up.  PxIV isn't
+ * modelled, and the window takes in the other port of a pair (P1 with P2),
+ * so only one of them can be.
+ */
+Sim_Model *Sim_port(uint16_t in, uint8_t vector) {
+	Sim_Model *model = calloc(1, sizeof(Sim_Model));
+	Port *p = calloc(1, sizeof(Port));
+	p->in = in;
+	p->vector = vector;
+	p->lines = 0xFF;
+	p->level = Sim_portLevel(p);
+	Sim_memory[in] = p->level;
+	model->name = "Port";
+	model->first = in;
+	model->last = in + PORT_IFG;
+	model->access = Sim_portAccess;
+	model->state = p;
+	Sim_addModel(model);
+	return model;
+}
+
+/** Bytes arriving back to back from the far end, after any still on
+ * their way.  Those that don't fit in SIM_UART_QUEUE are lost.
+ */
+void Sim_uartReceive(Sim_Model *uart, const uint8_t data[], uint16_t length) {
+	Uart *u = uart->state;
+	uint16_t n;
+	if (u->queueHead == u->queueTail)
+		u->rxLeft = Sim_uartFrame(u);
+	for (n = 0; n < length; n++) {
+		if ((uint16_t) (u->queueHead - u->queueTail) == SIM_UART_QUEUE)
+			break;
+		u->queue[u->queueHead++ % SIM_UART_QUEUE] = data[n];
+	}
+	Sim_uartUpdate(u);
+}
+
+/** An 8N1 frame at the current settings, in MCLK cycles. */
+uint32_t Sim_uartFrameCycles(Sim_Model *uart) {
+	return Sim_uartFrame(uart->state);
+}
+
+void Sim_i2cAttach(Sim_Model *i2c, Sim_I2cDevice *device) {
+	I2c *i = i2c->state;
+	device->next = i->devices;
+	i->devices = device;
+}
+
+/** An SCL period at the current settings, in MCLK cycles. */
+uint32_t Sim_i2cBitCycles(Sim_Model *i2c) {
+	return Sim_i2cBit(i2c->state);
+}
+
+/** Drive pins of a port high or low from outside. */
+void Sim_portInput(Sim_Model *port, uint8_t pins, bool high) {
+	Port *p = port->state;
+	if (high)
+		p->lines |= pins;
+	else
+		p->lines &= ~pins;
+	Sim_portUpdate(p);
+}
@@ -0,0 +1,83 @@
+/*
+ * sim_regs.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * The registers the drivers in this project name directly, as HWREG
+ * accesses, so they reach the models like driverlib's own accesses do.
+ * inc/hw_memmap.h includes this in DRIVERLIB_HOST_SIM builds, after
+ * msp430.h has declared the names.  Add a register here when a driver the
+ * host tools build starts naming it.
+ */
+
+#ifndef SIM_REGS_H_
+#define SIM_REGS_H_
+
+// USCI_A1, BCUart.c
+#undef UCA1CTL1
+#undef UCA1BRW
+#undef UCA1MCTL
+#undef UCA1STAT
+#undef UCA1RXBUF
+#undef UCA1TXBUF
+#undef UCA1IE
+#undef UCA1IFG
+#undef UCA1IV
+#define UCA1CTL1	HWREG8(USCI_A1_BASE + OFS_UCAxCTL1)
+#define UCA1BRW		HWREG16(USCI_A1_BASE + OFS_UCAxBRW)
+#define UCA1MCTL	HWREG8(USCI_A1_BASE + OFS_UCAxMCTL)
+#define UCA1STAT	HWREG8(USCI_A1_BASE + OFS_UCAxSTAT)
+#define UCA1RXBUF	HWREG8(USCI_A1_BASE + OFS_UCAxRXBUF)
+#define UCA1TXBUF	HWREG8(USCI_A1_BASE + OFS_UCAxTXBUF)
+#define UCA1IE		HWREG8(USCI_A1_BASE + OFS_UCAxIE)
+#define UCA1IFG		HWREG8(USCI_A1_BASE + OFS_UCAxIFG)
+#define UCA1IV		HWREG16(USCI_A1_BASE + OFS_UCAxIV)
+
+// Ports 2-4, BCUart.c, HMC5883L.c and I2CEngine.c
+#undef P2DIR
+#undef P2IES
+#undef P2IE
+#undef P2IFG
+#undef P3DIR
+#undef P3OUT
+#undef P3SEL
+#undef P4DIR
+#undef P4OUT
+#undef P4SEL
+#define P2DIR		HWREG8(P2_BASE + OFS_P2DIR)
+#define P2IES		HWREG8(P2_BASE + OFS_P2IES)
+#define P2IE		HWREG8(P2_BASE + OFS_P2IE)
+#define P2IFG		HWREG8(P2_BASE + OFS_P2IFG)
+#define P3DIR		HWREG8(P3_BASE + OFS_P3DIR)
+#define P3OUT		HWREG8(P3_BASE + OFS_P3OUT)
+#define P3SEL		HWREG8(P3_BASE + OFS_P3SEL)
+#define P4DIR		HWREG8(P4_BASE + OFS_P4DIR)
+#define P4OUT		HWREG8(P4_BASE + OFS_P4OUT)
+#define P4SEL		HWREG8(P4_BASE + OFS_P4SEL)
+
+// Timer_A1, Timebase.c, and Timer_A2, Bench.c
+#undef TA1CTL
+#undef TA1CCTL1
+#undef TA1R
+#undef TA1CCR1
+#undef TA1IV
+#undef TA2CTL
+#undef TA2CCTL0
+#undef TA2CCR0
+#undef TA2IV
+#define TA1CTL		HWREG16(TIMER_A1_BASE + OFS_TAxCTL)
+#define TA1CCTL1	HWREG16(TIMER_A1_BASE + OFS_TAxCCTL1)
+#define TA1R		HWREG16(TIMER_A1_BASE + OFS_TAxR)
+#define TA1CCR1		HWREG16(TIMER_A1_BASE + OFS_TAxCCR1)
+#define TA1IV		HWREG16(TIMER_A1_BASE + OFS_TAxIV)
+#define TA2CTL		HWREG16(TIMER_A2_BASE + OFS_TAxCTL)
+#define TA2CCTL0	HWREG16(TIMER_A2_BASE + OFS_TAxCCTL0)
+#define TA2CCR0		HWREG16(TIMER_A2_BASE + OFS_TAxCCR0)
+#define TA2IV		HWREG16(TIMER_A2_BASE + OFS_TAxIV)
+
+// DMA, DMAService.c
+#undef DMAIV
+#define DMAIV		HWREG16(DMA_BASE + OFS_DMAIV)
+
+#endif /* SIM_REGS_H_ */
@@ -0,0 +1,227 @@
+/*
+ * telemetry_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Frames built by Telemetry.c, on the CRC model in tools/sim, run back
+ * through telemetry_decode.c.  The decoder is compiled in with its main()
+ * renamed and reads each capture from a file as it would a recording, so
+ * its own COBS, CRC, sync and sequence checks count what comes out.  Each
+ * section checks those counts, and the number of sample rows printed,
+ * against what went in.
+ *
+ * binary   Telemetry_sendFrame() for every sample
+ * delta    Telemetry_sendDelta() filling blocks, then one more block built
+ *          here and sent with Telemetry_sendBlock()
+ * garbage  binary frames with, in between, a command reply, a run of
+ *          bytes longer than any frame, back to back delimiters, a frame
+ *          of the right length with the wrong sync word, one with a byte
+ *          changed, a dropped frame, and a delta frame whose block runs
+ *          on past its samples.  The changed and the dropped frame leave
+ *          gaps in the sequence numbers.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o telemetry_check tools/telemetry_check.c Telemetry.c
+ *        DeltaCodec.c Heading.c CrcCcitt.c SecureLink.c Aes128.c Ccm.c
+ *        tools/sim/sim.c tools/sim/sim_models.c tools/sim/sim_flash.c
+ *        driverlib/MSP430F5xx_6xx/crc.c
+ * Usage:      telemetry_check
+ */
+#define main telemetry_decode
+#include "tools/telemetry_decode.c"
+#undef main
+#include <driverlib.h>
+#include "tools/sim/sim.h"
+
+#define SAMPLES			200
+#define GARBAGE_FRAMES	12
+#define CORRUPTED		4			// Frame with a byte changed
+#define DROPPED			8			// Frame never sent
+#define OVERLONG		(MAX_ENCODED + 40)
+
+typedef struct Counts {
+	unsigned long good, badLength, badSync, badCrc, badBlock, gaps, missed;
+	unsigned long rows;
+} Counts;
+
+static uint8_t capture[1 << 16];	// Back channel output
+static size_t captured;
+static HMC_Sample samples[SAMPLES];
+
+// What Telemetry.c calls outside the model
+void BackChannel_WriteBytes(const uint8_t data[], uint16_t length) {
+	if (captured + length > sizeof capture)
+		length = (uint16_t) (sizeof capture - captured);
+	memcpy(&capture[captured], data, length);
+	captured += length;
+}
+
+// A slow turn at 75 Hz with a couple of counts of noise
+static void makeSamples() {
+	uint16_t i;
+	for (i = 0; i < SAMPLES; i++) {
+		samples[i].timestamp = 1000 + i * 437;
+		samples[i].x = (int16_t) (300 + i / 4 + rand() % 5 - 2);
+		samples[i].y = (int16_t) (-150 + i / 6 + rand() % 5 - 2);
+		samples[i].z = (int16_t) (-420 + rand() % 3 - 1);
+		samples[i].gain = 1;
+	}
+}
+
+static void put(const void *data, size_t length) {
+	memcpy(&capture[captured], data, length);
+	captured += length;
+}
+
+// The capture through telemetry_decode's main(), as a recording would go,
+// with the rows it prints counted and its summary dropped
+static Counts decode() {
+	char path[] = "/tmp/telemetry_checkXXXXXX";
+	char *argv[] = { "telemetry_decode", path, 0 };
+	Counts c;
+	FILE *rows;
+	int fd, out, err, ch;
+
+	fd = mkstemp(path);
+	if (fd < 0 || write(fd, capture, captured) != (ssize_t) captured) {
+		perror(path);
+		exit(1);
+	}
+	close(fd);
+	rows = tmpfile();
+	fflush(stdout);
+	out = dup(STDOUT_FILENO);
+	err = dup(STDERR_FILENO);
+	dup2(fileno(rows), STDOUT_FILENO);
+	close(STDERR_FILENO);
+	optind = 1;
+	telemetry_decode(2, argv);
+	fflush(stdout);
+	dup2(out, STDOUT_FILENO);
+	dup2(err, STDERR_FILENO);
+	close(out);
+	close(err);
+	unlink(path);
+
+	c.rows = 0;
+	rewind(rows);
+	while ((ch = fgetc(rows)) != EOF)
+		c.rows += ch == '\n';
+	fclose(rows);
+	c.rows--;						// The header
+	c.good = framesGood;
+	c.badLength = framesBadLength;
+	c.badSync = framesBadSync;
+	c.badCrc = framesBadCrc;
+	c.badBlock = framesBadBlock;
+	c.gaps = sequenceGaps;
+	c.missed = framesMissed;
+	framesGood = framesBadLength = framesBadSync = framesBadCrc = 0;
+	framesBadBlock = sequenceGaps = framesMissed = 0;
+	captured = 0;
+	return c;
+}
+
+static uint32_t report(const char *name, const Counts *got, const Counts *want) {
+	uint32_t bad = memcmp(got, want, sizeof *got) != 0;
+	printf("%s,%lu good,%lu rows,%lu bad length,%lu bad sync,%lu bad CRC,"
+			"%lu bad block,%lu gaps,%lu missed,%s\n", name, got->good,
+			got->rows, got->badLength, got->badSync, got->badCrc,
+			got->badBlock, got->gaps, got->missed, bad ? "bad" : "ok");
+	return bad;
+}
+
+static uint32_t checkBinary() {
+	Counts want = { 0 }, got;
+	uint16_t i;
+	Telemetry_setFormat(TELEMETRY_FORMAT_BINARY);
+	for (i = 0; i < SAMPLES; i++)
+		Telemetry_sendFrame(&samples[i], Heading_fromXY(samples[i].x,
+				samples[i].y));
+	want.good = SAMPLES;
+	want.rows = SAMPLES;
+	got = decode();
+	return report("binary", &got, &want);
+}
+
+static uint32_t checkDelta() {
+	uint8_t block[TELEMETRY_BLOCK_MAX];
+	DeltaCodec_State codec;
+	Counts want = { 0 }, got;
+	size_t i;
+	Telemetry_setFormat(TELEMETRY_FORMAT_DELTA);
+	for (i = 0; i < SAMPLES; i++)
+		Telemetry_sendDelta(&samples[i]);
+	Telemetry_flush();
+	DeltaCodec_begin(&codec, block, sizeof block);
+	for (i = 0; i < DELTACODEC_KEYFRAME_INTERVAL / 2; i++)
+		DeltaCodec_add(&codec, &samples[i]);
+	Telemetry_sendBlock(block, codec.length);
+	for (i = 0; i < captured; i++)
+		want.good += capture[i] == 0;
+	want.rows = SAMPLES + DELTACODEC_KEYFRAME_INTERVAL / 2;
+	got = decode();
+	return report("delta", &got, &want);
+}
+
+static uint32_t checkGarbage() {
+	static const uint8_t reply[] = "OK\r\n";
+	uint8_t raw[TELEMETRY_FRAME_SIZE], encoded[TELEMETRY_ENCODED_MAX];
+	uint8_t block[TELEMETRY_BLOCK_MAX];
+	DeltaCodec_State codec;
+	Counts want = { 0 }, got;
+	size_t start, i;
+	uint16_t n;
+
+	Telemetry_setFormat(TELEMETRY_FORMAT_BINARY);
+	for (n = 0; n < GARBAGE_FRAMES; n++) {
+		start = captured;
+		Telemetry_sendFrame(&samples[n], 0);
+		if (n == DROPPED)
+			captured = start;
+		if (n == CORRUPTED)
+			capture[captured - 2] ^= 0x01;	// The CRC's high byte
+	}
+	put(reply, sizeof reply);				// Its NUL too, as Command_endLine() sends
+	for (i = 0; i < OVERLONG; i++)
+		capture[captured++] = (uint8_t) (1 + i % 255);
+	put("\0\0\0", 3);
+	memset(raw, 0x11, sizeof raw);
+	raw[TELEMETRY_OFFSET_SYNC] = 0x34;
+	raw[TELEMETRY_OFFSET_SYNC + 1] = 0x12;
+	n = crc16(raw, TELEMETRY_OFFSET_CRC);
+	raw[TELEMETRY_OFFSET_CRC] = (uint8_t) n;
+	raw[TELEMETRY_OFFSET_CRC + 1] = (uint8_t) (n >> 8);
+	put(encoded, Telemetry_cobsEncode(raw, sizeof raw, encoded));
+	DeltaCodec_begin(&codec, block, sizeof block);
+	for (i = 0; i < 4; i++)
+		DeltaCodec_add(&codec, &samples[i]);
+	memset(&block[codec.length], 0xFF, 3);	// A varint that never ends
+	Telemetry_setFormat(TELEMETRY_FORMAT_DELTA);
+	Telemetry_sendBlock(block, codec.length + 3);
+
+	want.good = GARBAGE_FRAMES - 2 + 1;		// And the delta frame
+	want.rows = GARBAGE_FRAMES - 2 + 4;
+	want.badLength = 2;						// The reply and the long run
+	want.badSync = 1;
+	want.badCrc = 1;
+	want.badBlock = 1;
+	want.gaps = 2;
+	want.missed = 2;
+	got = decode();
+	return report("garbage", &got, &want);
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t bad;
+	Sim_reset();
+	Sim_crc16(CRC_BASE);
+	makeSamples();
+	bad = checkBinary();
+	bad += checkDelta();
+	bad += checkGarbage();
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,386 @@
+/*
+ * telemetry_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Host side decoder for the binary back channel frames in Telemetry.h.
+ * Reads a serial port or a recorded capture, splits the stream on zero
+ * bytes, undoes the COBS encoding and checks length, sync word and CRC.
+ * Good frames are printed as CSV on stdout; a summary of rejected frames
+ * and sequence gaps goes to stderr at the end.  Delta frames are expanded
+ * into one row per sample, with the heading worked out here the way the
+ * firmware does it.
+ *
+ * Given the key with -k, encrypted frames are opened with the firmware's
+ * own Aes128.c and Ccm.c, then decoded as above; a frame whose tag doesn't
+ * match, or whose nonce isn't past the last one, is rejected.  The cipher
+ * is first checked against the FIPS-197 and SP 800-38C known answers, and
+ * -t runs just that check.
+ *
+ * On a serial port a bare CR goes out every KEEPALIVE_SEC, which the
+ * command parser ignores, so the firmware sees the link up and streams
+ * samples rather than logging them to flash (BackChannel_HostPresent()).
+ *
+ * Build on Linux:  cc -O2 -o telemetry_decode telemetry_decode.c
+ *                      ../DeltaCodec.c ../Heading.c ../Aes128.c ../Ccm.c
+ * Usage:           telemetry_decode [-t] [-k <32 hex digits>]
+ *                      [/dev/ttyACM0 [baud] | capture.bin]
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "../Ccm.h"
+#include "../DeltaCodec.h"
+#include "../Heading.h"
+#include "../Telemetry.h"
+
+#define TICKS_PER_SEC	32768.0		// TIMEBASE_TICKS_PER_SEC
+#define MAX_ENCODED		256
+#define KEEPALIVE_SEC	1			// Well inside BACKCHANNEL_LINK_TIMEOUT
+
+static unsigned long framesGood, framesBadLength, framesBadSync, framesBadCrc;
+static unsigned long sequenceGaps, framesMissed, framesBadBlock;
+static unsigned long framesNoKey, framesBadTag, framesReplayed;
+static Aes128_Key key;
+static int haveKey = 0;
+
+// Known answers: FIPS-197 appendix C.1, then SP 800-38C appendix C examples
+// 1 to 3, which between them cover short and multi-block data and AAD.
+typedef struct Vector {
+	const char *key, *nonce, *aad, *plain, *cipher;	// Cipher ends in the tag
+	int tagLength;					// 0 for a single AES block
+} Vector;
+
+static const Vector vectors[] = {
+	{ "000102030405060708090a0b0c0d0e0f", "", "",
+		"00112233445566778899aabbccddeeff", "69c4e0d86a7b0430d8cdb78070b4c55a", 0 },
+	{ "404142434445464748494a4b4c4d4e4f", "10111213141516", "0001020304050607",
+		"20212223", "7162015b4dac255d", 4 },
+	{ "404142434445464748494a4b4c4d4e4f", "1011121314151617",
+		"000102030405060708090a0b0c0d0e0f", "202122232425262728292a2b2c2d2e2f",
+		"d2a1f0e051ea5f62081a7792073d593d1fc64fbfaccd", 6 },
+	{ "404142434445464748494a4b4c4d4e4f", "101112131415161718191a1b",
+		"000102030405060708090a0b0c0d0e0f10111213",
+		"202122232425262728292a2b2c2d2e2f3031323334353637",
+		"e3b201a9f5b71a7a9b1ceaeccd97e70b6176aad9a4428aa5484392fbc1b09951", 8 },
+};
+#define VECTORS			(sizeof vectors / sizeof vectors[0])
+
+// CRC16-CCITT, poly 0x1021, seed 0xFFFF, MSB first, the same as the CRC module
+static uint16_t crc16(const uint8_t *data, size_t length) {
+	uint16_t crc = 0xFFFF;
+	int bit;
+	while (length--) {
+		crc ^= (uint16_t) *data++ << 8;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+// Returns the decoded length, or -1 if the block isn't valid COBS
+static int cobsDecode(const uint8_t *in, size_t length, uint8_t *out) {
+	size_t i = 0;
+	int o = 0;
+	uint8_t code, n;
+	while (i < length) {
+		code = in[i++];
+		if (code == 0 || i + code - 1 > length)
+			return -1;
+		for (n = 1; n < code; n++)
+			out[o++] = in[i++];
+		if (code != 0xFF && i < length)
+			out[o++] = 0;
+	}
+	return o;
+}
+
+static uint16_t get16(const uint8_t *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+	return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+// Returns the number of bytes, or -1 if text isn't all hex digit pairs
+static int hex(const char *text, uint8_t *out, size_t size) {
+	size_t n = 0;
+	unsigned int value;
+	while (text[0] && text[1] && n < size && sscanf(text, "%2x", &value) == 1) {
+		out[n++] = (uint8_t) value;
+		text += 2;
+	}
+	return *text ? -1 : (int) n;
+}
+
+// Each vector sealed and opened, and opened again with the tag broken.
+// Returns the number that failed.
+static int selfTest() {
+	uint8_t k[AES128_KEY_SIZE], nonce[CCM_NONCE_MAX], aad[32], plain[32],
+			cipher[48], data[32];
+	Aes128_Key test;
+	int nonceLength, aadLength, length, failed = 0;
+	unsigned int i;
+	for (i = 0; i < VECTORS; i++) {
+		hex(vectors[i].key, k, sizeof k);
+		nonceLength = hex(vectors[i].nonce, nonce, sizeof nonce);
+		aadLength = hex(vectors[i].aad, aad, sizeof aad);
+		length = hex(vectors[i].plain, plain, sizeof plain);
+		hex(vectors[i].cipher, cipher, sizeof cipher);
+		Aes128_setKey(&test, k);
+		memcpy(data, plain, length);
+		if (vectors[i].tagLength == 0) {
+			Aes128_encrypt(&test, data, data);
+			failed += memcmp(data, cipher, AES128_BLOCK_SIZE) != 0;
+			continue;
+		}
+		failed += !Ccm_seal(&test, nonce, nonceLength, aad, aadLength, data,
+				length, data + length, vectors[i].tagLength)
+				|| memcmp(data, cipher, length + vectors[i].tagLength) != 0
+				|| !Ccm_open(&test, nonce, nonceLength, aad, aadLength, data,
+						length, cipher + length, vectors[i].tagLength)
+				|| memcmp(data, plain, length) != 0;
+		memcpy(data, cipher, length);
+		cipher[length] ^= 1;
+		failed += Ccm_open(&test, nonce, nonceLength, aad, aadLength, data,
+				length, cipher + length, vectors[i].tagLength);
+	}
+	fprintf(stderr, "AES-128 and CCM known answers: %u vectors, %d failed\n",
+			(unsigned int) VECTORS, failed);
+	return failed;
+}
+
+static void sample(uint16_t sequence, const HMC_Sample *s) {
+	printf("%u,%.6f,%d,%d,%d,%.1f,%u\n", sequence, s->timestamp / TICKS_PER_SEC,
+			s->x, s->y, s->z, Heading_fromXY(s->x, s->y) / 10.0, s->gain);
+}
+
+// Rows for each sample in a delta frame's block.  DeltaCodec_next() stops
+// at a sample cut short by the end of the block as it does at the end, so
+// only a stop short of the end is clean.
+static void delta(uint16_t sequence, const uint8_t *block, int length) {
+	DeltaCodec_State codec;
+	HMC_Sample s;
+	DeltaCodec_open(&codec, block, (uint16_t) length);
+	while (codec.length < length) {
+		if (!DeltaCodec_next(&codec, &s)) {
+			framesBadBlock++;
+			return;
+		}
+		sample(sequence, &s);
+	}
+}
+
+// A binary or delta frame, decoded or decrypted
+static void plain(const uint8_t *f, int decoded) {
+	static int haveSequence = 0;
+	static uint16_t lastSequence;
+	uint16_t sequence;
+	uint32_t timestamp;
+	int isDelta;
+
+	isDelta = decoded >= TELEMETRY_OFFSET_BLOCK + 2
+			&& get16(&f[TELEMETRY_OFFSET_SYNC]) == TELEMETRY_DELTA_SYNC;
+	if (!isDelta && decoded != TELEMETRY_FRAME_SIZE) {
+		framesBadLength++;
+		return;
+	}
+	if (!isDelta && get16(&f[TELEMETRY_OFFSET_SYNC]) != TELEMETRY_SYNC) {
+		framesBadSync++;
+		return;
+	}
+	if (get16(&f[decoded - 2]) != crc16(f, decoded - 2)) {
+		framesBadCrc++;
+		return;
+	}
+	framesGood++;
+	sequence = get16(&f[TELEMETRY_OFFSET_SEQUENCE]);
+	if (haveSequence && sequence != (uint16_t) (lastSequence + 1)) {
+		sequenceGaps++;
+		framesMissed += (uint16_t) (sequence - lastSequence - 1);
+	}
+	haveSequence = 1;
+	lastSequence = sequence;
+	if (isDelta) {
+		delta(sequence, &f[TELEMETRY_OFFSET_BLOCK],
+				decoded - TELEMETRY_OFFSET_BLOCK - 2);
+		return;
+	}
+	timestamp = get16(&f[TELEMETRY_OFFSET_TIMESTAMP])
+			| ((uint32_t) get16(&f[TELEMETRY_OFFSET_TIMESTAMP + 2]) << 16);
+	printf("%u,%.6f,%d,%d,%d,%.1f,%u\n", sequence, timestamp / TICKS_PER_SEC,
+			(int16_t) get16(&f[TELEMETRY_OFFSET_X]),
+			(int16_t) get16(&f[TELEMETRY_OFFSET_Y]),
+			(int16_t) get16(&f[TELEMETRY_OFFSET_Z]),
+			(int16_t) get16(&f[TELEMETRY_OFFSET_HEADING]) / 10.0,
+			f[TELEMETRY_OFFSET_GAIN]);
+}
+
+// The nonce must move on from the last good frame's: an epoch per boot, a
+// count per frame
+static void secure(uint8_t *f, int decoded) {
+	static int haveNonce = 0;
+	static uint32_t lastEpoch, lastCount;
+	uint8_t *nonce = &f[TELEMETRY_OFFSET_NONCE];
+	uint8_t *data = &f[TELEMETRY_OFFSET_CIPHERTEXT];
+	int length = decoded - TELEMETRY_SECURE_OVERHEAD;
+	uint32_t epoch = get32(nonce), count = get32(nonce + 4);
+
+	if (!haveKey) {
+		framesNoKey++;
+		return;
+	}
+	if (!Ccm_open(&key, nonce, SECURELINK_NONCE_SIZE, f, 2, data,
+			(uint16_t) length, data + length, SECURELINK_TAG_SIZE)) {
+		framesBadTag++;
+		return;
+	}
+	if (haveNonce && (epoch < lastEpoch || (epoch == lastEpoch && count <= lastCount))) {
+		framesReplayed++;
+		return;
+	}
+	haveNonce = 1;
+	lastEpoch = epoch;
+	lastCount = count;
+	plain(data, length);
+}
+
+static void frame(const uint8_t *encoded, size_t length) {
+	uint8_t f[MAX_ENCODED];
+	int decoded;
+
+	if (length == 0)
+		return;		// Back to back delimiters, e.g. after a resync
+	decoded = cobsDecode(encoded, length, f);
+	if (decoded > TELEMETRY_SECURE_OVERHEAD
+			&& get16(&f[TELEMETRY_OFFSET_SYNC]) == TELEMETRY_SECURE_SYNC) {
+		secure(f, decoded);
+		return;
+	}
+	plain(f, decoded);
+}
+
+static speed_t baudConstant(long baud) {
+	switch (baud) {
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	case 460800: return B460800;
+	case 921600: return B921600;
+	default: return 0;
+	}
+}
+
+static int openInput(const char *path, long baud) {
+	struct termios tio;
+	int fd = open(path, O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		fd = open(path, O_RDONLY | O_NOCTTY);
+	if (fd < 0 || !isatty(fd))
+		return fd;		// A recorded capture
+	if (tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, baudConstant(baud));
+		cfsetospeed(&tio, baudConstant(baud));
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+// Wait for input, sending the keep-alive meanwhile if fd is a serial port
+static ssize_t readInput(int fd, uint8_t buf[], size_t size) {
+	static time_t sent = 0;
+	struct pollfd p = { fd, POLLIN, 0 };
+	if (!isatty(fd))
+		return read(fd, buf, size);
+	for (;;) {
+		if (time(0) - sent >= KEEPALIVE_SEC) {
+			if (write(fd, "\r", 1) == 1)
+				sent = time(0);
+		}
+		if (poll(&p, 1, 1000 * KEEPALIVE_SEC) != 0)
+			return read(fd, buf, size);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	uint8_t buf[512];
+	uint8_t encoded[MAX_ENCODED];
+	uint8_t k[AES128_KEY_SIZE];
+	size_t used = 0;
+	int overlong = 0;
+	ssize_t n, i;
+	long baud;
+	int fd, option;
+
+	while ((option = getopt(argc, argv, "tk:")) != -1) {
+		switch (option) {
+		case 't':
+			return selfTest() ? 1 : 0;
+		case 'k':
+			if (hex(optarg, k, sizeof k) != AES128_KEY_SIZE) {
+				fprintf(stderr, "the key is %d hex digits\n", 2 * AES128_KEY_SIZE);
+				return 1;
+			}
+			Aes128_setKey(&key, k);
+			haveKey = 1;
+			break;
+		default:
+			return 1;
+		}
+	}
+	if (haveKey && selfTest())
+		return 1;
+	argc -= optind - 1;
+	argv += optind - 1;
+	baud = (argc > 2) ? strtol(argv[2], 0, 10) : 57600;
+	fd = (argc > 1) ? openInput(argv[1], baud) : STDIN_FILENO;
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	if (!baudConstant(baud)) {
+		fprintf(stderr, "unsupported baud rate %ld\n", baud);
+		return 1;
+	}
+	printf("sequence,seconds,x,y,z,heading,gain\n");
+	while ((n = readInput(fd, buf, sizeof buf)) > 0) {
+		for (i = 0; i < n; i++) {
+			if (buf[i] != 0) {
+				if (used < sizeof encoded)
+					encoded[used++] = buf[i];
+				else
+					overlong = 1;	// Garbage or ASCII output, wait for a zero
+				continue;
+			}
+			if (overlong)
+				framesBadLength++;
+			else
+				frame(encoded, used);
+			used = 0;
+			overlong = 0;
+		}
+		fflush(stdout);
+	}
+	fprintf(stderr, "%lu good, %lu bad length, %lu bad sync, %lu bad CRC, "
+			"%lu bad blocks, %lu gaps (%lu frames missed)\n", framesGood,
+			framesBadLength, framesBadSync, framesBadCrc, framesBadBlock,
+			sequenceGaps, framesMissed);
+	if (haveKey || framesNoKey)
+		fprintf(stderr, "%lu encrypted with no key, %lu bad tag, %lu replayed\n",
+				framesNoKey, framesBadTag, framesReplayed);
+	return framesGood ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+/*
+ * trace_decode.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Host side decoder for the event trace frames in Trace.h, sent by firmware
+ * built with TRACE_ENABLE.  Splits the stream on zero bytes, undoes the
+ * COBS encoding and checks length, sync word and CRC like telemetry_decode.
+ * Each event is printed as a CSV timeline row, with the 24-bit timestamps
+ * unwrapped into a running microsecond count.  At the end, latency
+ * histograms for the acquisition path and a frame summary go to stderr.
+ *
+ * Build on Linux:  cc -O2 -o trace_decode trace_decode.c
+ * Usage:           trace_decode [/dev/ttyACM0 [baud] | capture.bin]
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../Trace.h"
+
+#define MAX_ENCODED		(TRACE_FRAME_MAX + TRACE_FRAME_MAX / 254 + 1)
+#define TIME_MASK		((1UL << TRACE_TIME_BITS) - 1)
+#define BUCKETS			20		// Powers of two up to 0.5 s
+#define EVENT_IDS		16
+
+static const char *names[EVENT_IDS] = {
+	"?", "drdy", "i2c_start", "i2c_done", "i2c_timeout", "sample_ready",
+	"task_start", "task_end", "wake", "uart_rx", "uart_tx_done"
+};
+
+// Time from the latest 'from' event to the next 'to' event
+typedef struct Latency {
+	const char *name;
+	uint8_t from, to;
+	int armed;
+	unsigned long long start;
+	unsigned long count, max;
+	unsigned long long total;
+	unsigned long histogram[BUCKETS];
+} Latency;
+
+static Latency latencies[] = {
+	{ .name = "drdy -> sample_ready", .from = TRACE_DRDY, .to = TRACE_SAMPLE_READY },
+	{ .name = "drdy -> task_start", .from = TRACE_DRDY, .to = TRACE_TASK_START },
+	{ .name = "i2c_start -> i2c_done", .from = TRACE_I2C_START, .to = TRACE_I2C_DONE },
+	{ .name = "task_start -> task_end", .from = TRACE_TASK_START, .to = TRACE_TASK_END },
+};
+#define LATENCIES	(sizeof latencies / sizeof latencies[0])
+
+static unsigned long framesGood, framesBadLength, framesBadSync, framesBadCrc;
+static unsigned long events, eventsDropped;
+static unsigned long long now;
+static int haveTime = 0;
+static uint32_t lastTime;
+
+// CRC16-CCITT, poly 0x1021, seed 0xFFFF, MSB first, the same as the CRC module
+static uint16_t crc16(const uint8_t *data, size_t length) {
+	uint16_t crc = 0xFFFF;
+	int bit;
+	while (length--) {
+		crc ^= (uint16_t) *data++ << 8;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+// Returns the decoded length, or -1 if the block isn't valid COBS
+static int cobsDecode(const uint8_t *in, size_t length, uint8_t *out) {
+	size_t i = 0;
+	int o = 0;
+	uint8_t code, n;
+	while (i < length) {
+		code = in[i++];
+		if (code == 0 || i + code - 1 > length)
+			return -1;
+		for (n = 1; n < code; n++)
+			out[o++] = in[i++];
+		if (code != 0xFF && i < length)
+			out[o++] = 0;
+	}
+	return o;
+}
+
+static uint16_t get16(const uint8_t *p) {
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+	return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+static int bucket(unsigned long us) {
+	int b = 0;
+	while (us > 1 && b < BUCKETS - 1) {
+		us >>= 1;
+		b++;
+	}
+	return b;
+}
+
+static void measure(uint8_t id) {
+	Latency *l;
+	unsigned long us;
+	for (l = latencies; l < latencies + LATENCIES; l++) {
+		if (id == l->to && l->armed) {
+			us = (unsigned long) (now - l->start);
+			l->armed = 0;
+			l->count++;
+			l->total += us;
+			if (us > l->max)
+				l->max = us;
+			l->histogram[bucket(us)]++;
+		}
+		if (id == l->from) {
+			l->armed = 1;
+			l->start = now;
+		}
+	}
+}
+
+static void event(uint32_t word) {
+	uint8_t id = (uint8_t) word;
+	uint32_t time = word >> 8;
+	unsigned long delta = haveTime ? (time - lastTime) & TIME_MASK : 0;
+
+	// Unwrapping assumes events come closer together than 16.7 s, which the
+	// 10 ms bus watchdog task guarantees
+	now += delta;
+	haveTime = 1;
+	lastTime = time;
+	events++;
+	printf("%llu,%lu,%s\n", now, delta,
+			id < EVENT_IDS && names[id] ? names[id] : "?");
+	measure(id);
+}
+
+static void frame(const uint8_t *encoded, size_t length) {
+	uint8_t f[MAX_ENCODED];
+	int decoded;
+	uint16_t dropped;
+	uint8_t count, i;
+	Latency *l;
+
+	if (length == 0)
+		return;		// Back to back delimiters, e.g. after a resync
+	decoded = cobsDecode(encoded, length, f);
+	if (decoded < TRACE_OFFSET_EVENTS + 2
+			|| decoded != TRACE_OFFSET_EVENTS + 4 * f[TRACE_OFFSET_COUNT] + 2) {
+		framesBadLength++;
+		return;
+	}
+	if (get16(&f[TRACE_OFFSET_SYNC]) != TRACE_SYNC) {
+		framesBadSync++;
+		return;
+	}
+	if (get16(&f[decoded - 2]) != crc16(f, decoded - 2)) {
+		framesBadCrc++;
+		return;
+	}
+	framesGood++;
+	dropped = get16(&f[TRACE_OFFSET_DROPPED]);
+	if (dropped) {
+		// Pairs straddling the gap would be measured wrongly
+		eventsDropped += dropped;
+		printf("%llu,,dropped %u\n", now, dropped);
+		for (l = latencies; l < latencies + LATENCIES; l++)
+			l->armed = 0;
+	}
+	count = f[TRACE_OFFSET_COUNT];
+	for (i = 0; i < count; i++)
+		event(get32(&f[TRACE_OFFSET_EVENTS + 4 * i]));
+}
+
+static void report() {
+	Latency *l;
+	int b, first, last;
+	for (l = latencies; l < latencies + LATENCIES; l++) {
+		fprintf(stderr, "%s: %lu", l->name, l->count);
+		if (l->count)
+			fprintf(stderr, ", avg %llu us, max %lu us",
+					l->total / l->count, l->max);
+		fprintf(stderr, "\n");
+		for (first = 0; first < BUCKETS - 1 && !l->histogram[first]; first++)
+			;
+		for (last = BUCKETS - 1; last > first && !l->histogram[last]; last--)
+			;
+		for (b = first; l->count && b <= last; b++)
+			fprintf(stderr, "  <%7lu us %lu\n", 2UL << b, l->histogram[b]);
+	}
+	fprintf(stderr, "%lu good, %lu bad length, %lu bad sync, %lu bad CRC, "
+			"%lu events, %lu dropped\n", framesGood, framesBadLength,
+			framesBadSync, framesBadCrc, events, eventsDropped);
+}
+
+static speed_t baudConstant(long baud) {
+	switch (baud) {
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	case 460800: return B460800;
+	case 921600: return B921600;
+	default: return 0;
+	}
+}
+
+static int openInput(const char *path, long baud) {
+	struct termios tio;
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+	if (fd < 0 || !isatty(fd))
+		return fd;		// A recorded capture
+	if (tcgetattr(fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, baudConstant(baud));
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+int main(int argc, char *argv[]) {
+	uint8_t buf[512];
+	uint8_t encoded[MAX_ENCODED];
+	size_t used = 0;
+	int overlong = 0;
+	ssize_t n, i;
+	long baud = (argc > 2) ? strtol(argv[2], 0, 10) : 57600;
+	int fd = (argc > 1) ? openInput(argv[1], baud) : STDIN_FILENO;
+
+	if (fd < 0) {
+		fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	if (!baudConstant(baud)) {
+		fprintf(stderr, "unsupported baud rate %ld\n", baud);
+		return 1;
+	}
+	printf("time_us,delta_us,event\n");
+	while ((n = read(fd, buf, sizeof buf)) > 0) {
+		for (i = 0; i < n; i++) {
+			if (buf[i] != 0) {
+				if (used < sizeof encoded)
+					encoded[used++] = buf[i];
+				else
+					overlong = 1;	// Garbage or ASCII output, wait for a zero
+				continue;
+			}
+			if (overlong)
+				framesBadLength++;
+			else
+				frame(encoded, used);
+			used = 0;
+			overlong = 0;
+		}
+		fflush(stdout);
+	}
+	report();
+	return framesGood ? 0 : 1;
+}
@@ -0,0 +1,564 @@
+/*
+ * usci_check.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ *
+ * Runs BCUart.c, I2CEngine.c and HMC5883L.c, with Timebase.c and
+ * DMAService.c under them, against the USCI_A UART, USCI_B I2C, port,
+ * Timer_A and DMA models in tools/sim.
+ *
+ * The back channel: the frame time the divisors give against the baud
+ * rate, a message sent by DMA arriving intact with no gaps between frames,
+ * one longer than the ring sent with the blocking policy, bytes received
+ * into the ring, the ring overflowing into bcUartRxOverruns, the USCI's own
+ * overrun with the ISR held off, and a baud rate change.
+ *
+ * The magnetometer on USCI_B1: an HMC5883L register file at 0x1E whose
+ * DRDY pin, P2.6, pulses at 75 Hz in continuous mode with new data each
+ * time.  HMC_testConnection() reads the ID, HMC_initialize() has to write
+ * the configuration in one transaction and wait for DRDY, and readings by
+ * DMA and by the per-byte ISR have to match the data registers.  A read
+ * takes the bus for I2CEngine_busTime(), give or take the last STOP.  Two
+ * transactions submitted back to back run in turn, each through its
+ * completion callback, the read after the write by a repeated START, and a
+ * read from an address nobody answers fails without upsetting the next.
+ * The CPU has to sleep through a read but for setting it up and taking its
+ * interrupts: the cycles it is kept busy per transaction, Sim_cycles less
+ * Sim_sleepCycles, may come to no more than BUSY_DMA or BUSY_ISR.  The
+ * USCI_B1 and DMA ISRs are entered through counting wrappers: a DMA burst,
+ * of 6 bytes or of LONG_BURST, has to take the same USCI_B1 interrupts
+ * whatever its length and finish with a single DMA interrupt, where the
+ * per-byte ISR takes one more for each byte.
+ *
+ * The configuration benchmark counts I2CEngine_transactions and bus cycles
+ * for the four settings the driver used to make one read-modify-write at a
+ * time, replayed here as it did them, against the same settings through
+ * the shadow registers: eight transactions against one.  HMC_get* calls
+ * must not touch the bus, and HMC_resyncConfig() reads it once.
+ *
+ * Build on Linux, from the project directory:
+ *     cc -O2 -fcommon -DDRIVERLIB_HOST_SIM -D__MSP430F5529__
+ *        -I <ccs>/ccs_base/msp430/include -I driverlib/MSP430F5xx_6xx -I .
+ *        -o usci_check tools/usci_check.c BCUart.c BaudRate.c I2CEngine.c
+ *        HMC5883L.c Timebase.c DMAService.c tools/sim/sim.c
+ *        tools/sim/sim_models.c tools/sim/sim_devices.c
+ *        driverlib/MSP430F5xx_6xx/dma.c driverlib/MSP430F5xx_6xx/gpio.c
+ *        driverlib/MSP430F5xx_6xx/timer_a.c
+ *        driverlib/MSP430F5xx_6xx/usci_a_uart.c
+ *        driverlib/MSP430F5xx_6xx/usci_b_i2c.c
+ * Usage:      usci_check
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <driverlib.h>
+#include "BCUart.h"
+#include "HMC5883L.h"
+#include "I2CEngine.h"
+#include "Timebase.h"
+#include "tools/sim/sim.h"
+
+// MSP430F5529 vector numbers, so the priorities are the device's
+#define PORT2_VECTOR_SIM	42
+#define USCI_B1_VECTOR_SIM	45
+#define USCI_A1_VECTOR_SIM	46
+#define TIMER1_A1_SIM		48
+#define TIMER1_A0_SIM		49
+#define DMA_VECTOR_SIM		50
+
+#define SENT_MAX			1024
+#define MESSAGE				200			// Bytes, fits the transmit ring
+#define LONG_MESSAGE		600			// Wraps the ring twice
+#define RECEIVED			100
+#define OVERFLOW			(BC_RXBUF_SIZE + 72)
+#define FAST_BAUDRATE		230400
+#define DRDY_CYCLES			(SIM_MCLK / 75)
+#define DRDY_PIN			0x40		// P2.6
+#define SAMPLES				20
+#define ABSENT_ADDRESS		0x2A
+#define BUSY_DMA			(6 * SIM_ISR_CYCLES)	// CPU cycles a reading may take
+#define BUSY_ISR			(10 * SIM_ISR_CYCLES)
+#define LONG_BURST			12			// Configuration to Y, in one read
+
+typedef struct Sent {
+	uint8_t data;
+	uint64_t cycles;
+} Sent;
+
+// The drivers' ISRs and flags, declared in their .c files only
+void bcUartISR(void);
+void I2CEngine_USCI_B1_ISR(void);
+void HMC_PORT2_ISR(void);
+void Timebase_TIMER1_A1_ISR(void);
+void DMAService_ISR(void);
+extern bool dataReady;
+extern uint8_t R_Data[6];
+extern volatile uint16_t bcUartRxOverruns;
+
+static Sim_Model *uart;
+static Sim_Model *i2c;
+static Sim_Model *port;
+static Sent sent[SENT_MAX];
+static uint16_t sentCount;
+static uint8_t hmc[HMC5883L_RA_ID_C + 1];
+static uint32_t drdyLeft = DRDY_CYCLES;
+static uint16_t samples;
+static uint32_t usciEntries, dmaEntries;
+static I2CEngine_Transaction *finished[2];
+static uint8_t finishedCount;
+
+static const I2CEngine_Device absent = { USCI_B1_BASE, ABSENT_ADDRESS, 1,
+		HMC5883L_I2C_SPEED };
+
+// What the drivers call outside the models
+uint32_t UCS_getSMCLK() {
+	return SIM_MCLK;
+}
+
+bool BackChannel_Connected() {
+	return false;
+}
+
+void BackChannel_Write(unsigned char text[]) {
+}
+
+void BackChannel_WriteLine(unsigned char text[]) {
+}
+
+void BackChannel_Printf(const char *format, ...) {
+}
+
+bool HMCAcquire_onDataReady() {
+	return true;
+}
+
+void HMCAcquire_resume() {
+}
+
+static bool callback(I2CEngine_Transaction *transaction) {
+	if (finishedCount < 2)
+		finished[finishedCount] = transaction;
+	finishedCount++;
+	return true;
+}
+
+static void usciB1Isr(void) {
+	usciEntries++;
+	I2CEngine_USCI_B1_ISR();
+}
+
+static void dmaIsr(void) {
+	dmaEntries++;
+	DMAService_ISR();
+}
+
+static void output(uint8_t data) {
+	if (sentCount < SENT_MAX) {
+		sent[sentCount].data = data;
+		sent[sentCount].cycles = Sim_cycles;
+	}
+	sentCount++;
+}
+
+// New data registers in continuous mode, then DRDY low and back, each
+// 1/75 s: the field moves on by a count per axis each time
+static void drdyTick(Sim_Model *model, uint32_t cycles) {
+	int16_t field[3];
+	uint8_t i;
+	if ((hmc[HMC5883L_RA_MODE] & 0x03) != HMC5883L_MODE_CONTINUOUS)
+		return;
+	while (cycles >= drdyLeft) {
+		cycles -= drdyLeft;
+		drdyLeft = DRDY_CYCLES;
+		samples++;
+		field[0] = (int16_t) (100 + samples);		// X, Z, Y as registered
+		field[1] = (int16_t) (-200 - samples);
+		field[2] = (int16_t) (300 + 2 * samples);
+		for (i = 0; i < 3; i++) {
+			hmc[HMC5883L_RA_DATAX_H + 2 * i] = (uint8_t) (field[i] >> 8);
+			hmc[HMC5883L_RA_DATAX_L + 2 * i] = (uint8_t) field[i];
+		}
+		Sim_portInput(port, DRDY_PIN, false);
+		Sim_portInput(port, DRDY_PIN, true);
+	}
+	drdyLeft -= cycles;
+}
+
+static void busy(uint64_t cycles) {
+	uint64_t end = Sim_cycles + cycles;
+	while (Sim_cycles < end)
+		__delay_cycles(SIM_IDLE_STEP);
+}
+
+// Sent bytes against what was queued, each frame straight after the last.
+// The times are those of the step each frame ended in, so they can be out
+// by a step either way.  Returns mismatches.
+static uint32_t checkSent(const uint8_t message[], uint16_t length) {
+	uint32_t frame = Sim_uartFrameCycles(uart);
+	uint32_t bad = sentCount != length;
+	uint16_t n;
+	for (n = 0; n < length && n < sentCount; n++) {
+		bad += sent[n].data != message[n];
+		if (n > 0)
+			bad += labs((long) (sent[n].cycles - sent[n - 1].cycles)
+					- (long) frame) >= SIM_IDLE_STEP;
+	}
+	return bad;
+}
+
+static uint32_t checkUart() {
+	static uint8_t message[LONG_MESSAGE];
+	uint8_t received[BC_RXBUF_SIZE];
+	BaudRate_Setting baud;
+	uint32_t bad = 0, stepBad, frame, expected, slack;
+	uint16_t n, count;
+
+	bcUartInit();
+	__enable_interrupt();
+	frame = Sim_uartFrameCycles(uart);
+	expected = BAUDRATE_FRAME_BITS * SIM_MCLK / BC_DEFAULT_BAUDRATE;
+	slack = (uint32_t) ((uint64_t) BAUDRATE_MAX_ERROR * SIM_MCLK
+			/ BC_DEFAULT_BAUDRATE / 10000) + 1;
+	bad += labs((long) frame - (long) expected) > (long) slack;
+	printf("frame,%lu baud,%lu cycles,%lu nominal\n",
+			(unsigned long) BC_DEFAULT_BAUDRATE, (unsigned long) frame,
+			(unsigned long) expected);
+
+	for (n = 0; n < LONG_MESSAGE; n++)
+		message[n] = (uint8_t) (n * 7 + 3);
+	sentCount = 0;
+	bcUartSend(message, MESSAGE);
+	bcUartFlush();
+	stepBad = checkSent(message, MESSAGE);
+	printf("send,%u bytes,%u out,%lu mismatched\n", MESSAGE, sentCount,
+			(unsigned long) stepBad);
+	bad += stepBad;
+
+	sentCount = 0;
+	bcUartSetTxPolicy(BC_TX_BLOCK);
+	for (n = 0; n < LONG_MESSAGE; n += count) {
+		count = (LONG_MESSAGE - n > 250) ? 250 : LONG_MESSAGE - n;
+		bcUartSend(&message[n], (uint8_t) count);
+	}
+	bcUartFlush();
+	stepBad = checkSent(message, LONG_MESSAGE);
+	printf("wrap,%u bytes,%u out,%lu mismatched\n", LONG_MESSAGE, sentCount,
+			(unsigned long) stepBad);
+	bad += stepBad;
+
+	Sim_uartReceive(uart, message, RECEIVED);
+	while (bcUartRxAvailable() < RECEIVED)
+		__bis_SR_register(LPM0_bits + GIE);
+	count = bcUartReceiveBytesInBuffer(received);
+	stepBad = (count != RECEIVED) + (memcmp(received, message, RECEIVED) != 0)
+			+ (bcUartRxOverruns != 0);
+	printf("receive,%u bytes,%u read,%u overruns\n", RECEIVED, count,
+			bcUartRxOverruns);
+	bad += stepBad;
+
+	// Nobody reading: the ring fills and the rest are dropped
+	Sim_uartReceive(uart, message, OVERFLOW);
+	busy((uint64_t) (OVERFLOW + 1) * frame);
+	count = bcUartReceiveBytesInBuffer(received);
+	stepBad = (count != BC_RXBUF_SIZE)
+			+ (memcmp(received, message, BC_RXBUF_SIZE) != 0)
+			+ (bcUartRxOverruns != OVERFLOW - BC_RXBUF_SIZE);
+	printf("ring full,%u bytes,%u read,%u overruns\n", OVERFLOW, count,
+			bcUartRxOverruns);
+	bad += stepBad;
+
+	// The ISR held off over two frames: the USCI overruns the first
+	__disable_interrupt();
+	Sim_uartReceive(uart, message, 2);
+	busy(3 * frame);
+	stepBad = !(UCA1STAT & UCOE) + (Sim_memory[USCI_A1_BASE + OFS_UCAxRXBUF]
+			!= message[1]);
+	__enable_interrupt();
+	count = bcUartReceiveBytesInBuffer(received);
+	stepBad += count != 1 || received[0] != message[1] || (UCA1STAT & UCOE);
+	printf("usci overrun,%s\n", stepBad ? "bad" : "ok");
+	bad += stepBad;
+
+	stepBad = bcUartSetBaudRate(FAST_BAUDRATE, &baud) != STATUS_SUCCESS;
+	frame = Sim_uartFrameCycles(uart);
+	expected = BAUDRATE_FRAME_BITS * SIM_MCLK / FAST_BAUDRATE;
+	slack = (uint32_t) ((uint64_t) BAUDRATE_MAX_ERROR * SIM_MCLK
+			/ FAST_BAUDRATE / 10000) + 1;
+	stepBad += labs((long) frame - (long) expected) > (long) slack;
+	sentCount = 0;
+	bcUartSend(message, 10);
+	bcUartFlush();
+	stepBad += checkSent(message, 10);
+	printf("rate change,%lu baud,%lu cycles,%lu nominal,%s\n",
+			(unsigned long) FAST_BAUDRATE, (unsigned long) frame,
+			(unsigned long) expected, stepBad ? "bad" : "ok");
+	bad += stepBad;
+	return bad;
+}
+
+// A reading against the data registers, X, Z, Y in them
+static uint32_t checkReading(const uint8_t raw[6]) {
+	return memcmp(raw, &hmc[HMC5883L_RA_DATAX_H], 6) != 0;
+}
+
+// What HMC_set* did before the shadow: read the register, write it back
+static bool readModifyWrite(uint8_t reg, uint8_t bitStart, uint8_t length,
+		uint8_t data) {
+	uint8_t mask = ((1 << length) - 1) << (bitStart - length + 1);
+	uint8_t value;
+	if (I2CEngine_read(&HMC_device, reg, &value, 1) != STATUS_SUCCESS)
+		return STATUS_FAIL;
+	value = (value & ~mask) | ((data << (bitStart - length + 1)) & mask);
+	return I2CEngine_write(&HMC_device, reg, &value, 1);
+}
+
+// Transactions and bus cycles for HMC_initialize()'s old settings, one
+// read-modify-write each and then through the shadow.  Returns failures.
+static uint32_t checkConfig() {
+	uint32_t bad = 0, stepBad, cycles[2];
+	uint16_t transactions[2], start;
+	uint64_t began;
+	uint8_t way;
+	bool ok;
+
+	for (way = 0; way < 2; way++) {
+		start = I2CEngine_transactions;
+		began = Sim_cycles;
+		if (way == 0) {
+			ok = readModifyWrite(HMC5883L_RA_CONFIG_A,
+					HMC5883L_CRA_AVERAGE_BIT, HMC5883L_CRA_AVERAGE_LENGTH,
+					HMC5883L_AVERAGING_4);
+			ok &= readModifyWrite(HMC5883L_RA_CONFIG_A,
+					HMC5883L_CRA_RATE_BIT, HMC5883L_CRA_RATE_LENGTH,
+					HMC5883L_RATE_75);
+			ok &= readModifyWrite(HMC5883L_RA_CONFIG_A,
+					HMC5883L_CRA_BIAS_BIT, HMC5883L_CRA_BIAS_LENGTH,
+					HMC5883L_BIAS_NORMAL);
+			ok &= readModifyWrite(HMC5883L_RA_CONFIG_B,
+					HMC5883L_CRB_GAIN_BIT, HMC5883L_CRB_GAIN_LENGTH,
+					HMC5883L_GAIN_390);
+		} else {
+			HMC_beginConfig();
+			ok = HMC_setSampleAveraging(HMC5883L_AVERAGING_4);
+			ok &= HMC_setDataRate(HMC5883L_RATE_75);
+			ok &= HMC_setMeasurementBias(HMC5883L_BIAS_NORMAL);
+			ok &= HMC_setGain(HMC5883L_GAIN_390);
+			ok &= HMC_commitConfig();
+		}
+		transactions[way] = I2CEngine_transactions - start;
+		cycles[way] = (uint32_t) (Sim_cycles - began);
+		stepBad = ok != STATUS_SUCCESS || hmc[HMC5883L_RA_CONFIG_A] != 0x58
+				|| hmc[HMC5883L_RA_CONFIG_B] != 0xA0
+				|| transactions[way] != (way ? 1 : 8);
+		printf("config,%s,4 settings,%u transactions,%lu bus cycles,%s\n",
+				way ? "shadow" : "read-modify-write", transactions[way],
+				(unsigned long) cycles[way], stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+
+	start = I2CEngine_transactions;
+	stepBad = HMC_getSampleAveraging() != HMC5883L_AVERAGING_4
+			|| HMC_getDataRate() != HMC5883L_RATE_75
+			|| HMC_getMeasurementBias() != HMC5883L_BIAS_NORMAL
+			|| HMC_getGain() != HMC5883L_GAIN_390
+			|| HMC_getMode() != HMC5883L_MODE_CONTINUOUS;
+	transactions[0] = I2CEngine_transactions - start;
+	stepBad += HMC_resyncConfig() != STATUS_SUCCESS;
+	transactions[1] = I2CEngine_transactions - start - transactions[0];
+	stepBad += transactions[0] != 0 || transactions[1] != 1
+			|| HMC_getGain() != HMC5883L_GAIN_390;
+	printf("config,5 gets %u transactions,resync %u transactions,%s\n",
+			transactions[0], transactions[1], stepBad ? "bad" : "ok");
+	bad += stepBad;
+	return bad;
+}
+
+// ISR entries over a burst read, by DMA and by the per-byte ISR, of 6 bytes
+// and of LONG_BURST.  Returns failures.
+static uint32_t checkEntries() {
+	uint8_t raw[LONG_BURST];
+	uint32_t bad = 0, stepBad, usci[2][2], dma[2][2];
+	uint8_t mode, n, length;
+
+	for (mode = 0; mode < 2; mode++) {
+		for (n = 0; n < 2; n++) {
+			length = n ? LONG_BURST : 6;
+			usciEntries = 0;
+			dmaEntries = 0;
+			bad += I2CEngine_transfer(&HMC_device, n ? HMC5883L_RA_CONFIG_A
+					: HMC5883L_RA_DATAX_H, 0, 0, raw, length,
+					mode ? 0 : I2CENGINE_FLAG_DMA) != STATUS_SUCCESS;
+			bad += memcmp(raw, &hmc[n ? HMC5883L_RA_CONFIG_A
+					: HMC5883L_RA_DATAX_H], length) != 0;
+			usci[mode][n] = usciEntries;
+			dma[mode][n] = dmaEntries;
+		}
+	}
+	for (mode = 0; mode < 2; mode++) {
+		stepBad = mode ? dma[1][0] || dma[1][1]
+				|| usci[1][1] - usci[1][0] != LONG_BURST - 6
+				: dma[0][0] != 1 || dma[0][1] != 1 || usci[0][1] != usci[0][0];
+		printf("interrupts,%s,6 bytes %lu usci %lu dma,%u bytes %lu usci %lu dma,"
+				"%s\n", mode ? "isr" : "dma", (unsigned long) usci[mode][0],
+				(unsigned long) dma[mode][0], LONG_BURST,
+				(unsigned long) usci[mode][1], (unsigned long) dma[mode][1],
+				stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+	return bad;
+}
+
+// A write and a read queued together: the read waits for the write and
+// follows it with a repeated START.  The write leaves the mode as it is.
+static uint32_t checkQueue() {
+	I2CEngine_Transaction write, read;
+	uint8_t mode = hmc[HMC5883L_RA_MODE];
+	uint8_t raw[3] = { 0 };
+	uint16_t starts = I2CEngine_repeatedStarts;
+	uint32_t bad;
+
+	memset(&write, 0, sizeof write);
+	write.device = &HMC_device;
+	write.reg = HMC5883L_RA_MODE;
+	write.txData = &mode;
+	write.txLength = 1;
+	write.callback = callback;
+	memset(&read, 0, sizeof read);
+	read.device = &HMC_device;
+	read.reg = HMC5883L_RA_ID_A;
+	read.rxData = raw;
+	read.rxLength = 3;
+	read.flags = I2CENGINE_FLAG_DMA;
+	read.callback = callback;
+	finishedCount = 0;
+	bad = I2CEngine_submit(&write) != STATUS_SUCCESS;
+	bad += I2CEngine_submit(&read) != STATUS_SUCCESS;
+	bad += read.status != I2CENGINE_QUEUED;
+	bad += I2CEngine_wait(&read) != STATUS_SUCCESS;
+	bad += write.status != I2CENGINE_DONE || finishedCount != 2
+			|| finished[0] != &write || finished[1] != &read;
+	bad += memcmp(raw, "H43", 3) != 0 || I2CEngine_repeatedStarts != starts + 1;
+	printf("queue,2 transactions,%u callbacks,%u repeated starts,%s\n",
+			finishedCount, I2CEngine_repeatedStarts - starts,
+			bad ? "bad" : "ok");
+	return bad ? 1 : 0;
+}
+
+static uint32_t checkI2c() {
+	static const uint8_t config[3] = { 0x58, 0xA0, 0x00 };	// HMC_initialize()
+	uint8_t raw[6];
+	static const uint32_t busyMax[2] = { BUSY_DMA, BUSY_ISR };
+	uint32_t bad = 0, stepBad, elapsed, busCycles, bit, busyCycles[2];
+	uint64_t slept;
+	uint16_t transactions;
+	int16_t x, y, z;
+	uint8_t i;
+
+	I2CEngine_initBus(USCI_B1_BASE, I2CENGINE_FAST_MODE);
+	stepBad = HMC_testConnection() != STATUS_SUCCESS;
+	printf("id,%c%c%c,%s\n", R_Data[0], R_Data[1], R_Data[2],
+			stepBad ? "bad" : "ok");
+	bad += stepBad;
+
+	transactions = I2CEngine_transactions;
+	dataReady = false;
+	stepBad = HMC_initialize() != STATUS_SUCCESS;
+	stepBad += memcmp(&hmc[HMC5883L_RA_CONFIG_A], config, 3) != 0;
+	printf("initialize,%u transactions,%02X %02X %02X,%s\n",
+			I2CEngine_transactions - transactions, hmc[0], hmc[1], hmc[2],
+			stepBad ? "bad" : "ok");
+	bad += stepBad + (I2CEngine_transactions - transactions != 1);
+
+	// Each reading straight after DRDY, by DMA then by the ISR
+	stepBad = 0;
+	for (i = 0; i < SAMPLES; i++) {
+		dataReady = false;
+		while (!dataReady)
+			__bis_SR_register(LPM0_bits + GIE);
+		if (i & 1) {
+			stepBad += I2CEngine_transfer(&HMC_device, HMC5883L_RA_DATAX_H, 0, 0,
+					raw, 6, 0) != STATUS_SUCCESS;
+			stepBad += checkReading(raw);
+		} else {
+			HMC_getHeading(&x, &y, &z);
+			stepBad += x != (int16_t) (100 + samples)
+					|| z != (int16_t) (-200 - samples)
+					|| y != (int16_t) (300 + 2 * samples);
+		}
+	}
+	printf("readings,%u,%lu mismatched\n", SAMPLES, (unsigned long) stepBad);
+	bad += stepBad;
+
+	// Bus time, less the STOP the transaction finishes ahead of
+	bit = Sim_i2cBitCycles(i2c);
+	busCycles = (uint32_t) I2CEngine_busTime(&HMC_device, 0, 6) * (SIM_MCLK
+			/ 1000000);
+	for (i = 0; i < 2; i++) {
+		dataReady = false;
+		while (!dataReady)
+			__bis_SR_register(LPM0_bits + GIE);
+		elapsed = (uint32_t) Sim_cycles;
+		slept = Sim_sleepCycles;
+		stepBad = I2CEngine_transfer(&HMC_device, HMC5883L_RA_DATAX_H, 0, 0, raw,
+				6, i ? 0 : I2CENGINE_FLAG_DMA) != STATUS_SUCCESS;
+		elapsed = (uint32_t) Sim_cycles - elapsed;
+		busyCycles[i] = elapsed - (uint32_t) (Sim_sleepCycles - slept);
+		stepBad += checkReading(raw) + (labs((long) elapsed - (long) busCycles)
+				> (long) (2 * bit));
+		printf("bus time,%s,%lu cycles,%lu from I2CEngine_busTime,%s\n",
+				i ? "isr" : "dma", (unsigned long) elapsed,
+				(unsigned long) busCycles, stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+
+	// The CPU's share of each: setting up and the interrupts, asleep for
+	// the rest
+	for (i = 0; i < 2; i++) {
+		stepBad = busyCycles[i] > busyMax[i];
+		printf("busy,%s,%lu cycles,%lu%% of the bus time,%lu allowed,%s\n",
+				i ? "isr" : "dma", (unsigned long) busyCycles[i],
+				(unsigned long) (100 * busyCycles[i] / busCycles),
+				(unsigned long) busyMax[i], stepBad ? "bad" : "ok");
+		bad += stepBad;
+	}
+
+	bad += checkEntries();
+	bad += checkQueue();
+	bad += checkConfig();
+
+	stepBad = I2CEngine_read(&absent, 0, raw, 1) != STATUS_FAIL;
+	stepBad += I2CEngine_read(&HMC_device, HMC5883L_RA_ID_A, raw, 3)
+			!= STATUS_SUCCESS || memcmp(raw, "H43", 3) != 0;
+	printf("nack,0x%02X,%s\n", ABSENT_ADDRESS, stepBad ? "bad" : "ok");
+	bad += stepBad;
+	return bad;
+}
+
+int main(int argc, char *argv[]) {
+	Sim_Model drdy = { .name = "DRDY", .tick = drdyTick };
+	uint32_t bad;
+
+	Sim_reset();
+	Sim_timerA(TIMER_A1_BASE, TIMEBASE_TICKS_PER_SEC, TIMER1_A0_SIM,
+			TIMER1_A1_SIM);
+	Sim_dma(DMA_BASE, DMA_VECTOR_SIM);
+	uart = Sim_usciUart(USCI_A1_BASE, SIM_MCLK, USCI_A1_VECTOR_SIM,
+			SIM_TRIGGER_UCA1RXIFG, SIM_TRIGGER_UCA1TXIFG, output);
+	i2c = Sim_usciI2c(USCI_B1_BASE, SIM_MCLK, USCI_B1_VECTOR_SIM,
+			SIM_TRIGGER_UCB1RXIFG, SIM_TRIGGER_UCB1TXIFG);
+	port = Sim_port(P2_BASE + OFS_P2IN, PORT2_VECTOR_SIM);
+	memcpy(hmc, "\x10\x20\x01\0\0\0\0\0\0\0H43", sizeof hmc);	// Power-on
+	Sim_i2cAttach(i2c, Sim_i2cMemory(HMC5883L_ADDRESS, hmc, sizeof hmc));
+	Sim_addModel(&drdy);
+	Sim_attach(USCI_A1_VECTOR_SIM, bcUartISR);
+	Sim_attach(USCI_B1_VECTOR_SIM, usciB1Isr);
+	Sim_attach(PORT2_VECTOR_SIM, HMC_PORT2_ISR);
+	Sim_attach(TIMER1_A1_SIM, Timebase_TIMER1_A1_ISR);
+	Sim_attach(DMA_VECTOR_SIM, dmaIsr);
+
+	Timebase_init();
+	bad = checkUart();
+	bad += checkI2c();
+	return bad ? 1 : 0;
+}